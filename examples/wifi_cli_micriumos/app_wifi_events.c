@@ -31,6 +31,11 @@
 #include "wifi_cli_lwip.h"
 #include "app_wifi_events.h"
 #include "wifi_cli_params.h"
+#include "wifi_cli_ap_clients.h"
+#include "wifi_cli_boot.h"
+#include "wifi_cli_tx_latency.h"
+#include "wifi_cli_ps_policy.h"
+#include "wifi_cli_metrics.h"
 
 // Event Task Configurations
 #define WFX_EVENTS_TASK_PRIO              21u
@@ -159,6 +164,11 @@ sl_status_t sl_wfx_host_process_event(sl_wfx_generic_message_t *event_payload)
     /******** CONFIRMATION ********/
     case SL_WFX_SEND_FRAME_CNF_ID:
     {
+      sl_wfx_send_frame_cnf_t *frame_cnf = (sl_wfx_send_frame_cnf_t *)event_payload;
+      tx_latency_frame_confirmed((frame_cnf->header.info & SL_WFX_MSG_INFO_INTERFACE_MASK)
+                                 >> SL_WFX_MSG_INFO_INTERFACE_OFFSET,
+                                 frame_cnf->body.packet_id,
+                                 frame_cnf->body.status);
       break;
     }
   }
@@ -233,6 +243,7 @@ void sl_wfx_connect_callback(sl_wfx_connect_ind_t *connect)
   switch (connect->body.status) {
     case WFM_STATUS_SUCCESS:
     {
+      boot_trace_mark(BOOT_STAGE_STA_CONNECTED);
       printf("Connected\r\n");
       sl_wfx_context->state |= SL_WFX_STA_INTERFACE_CONNECTED;
 
@@ -371,6 +382,7 @@ void sl_wfx_stop_ap_callback(sl_wfx_stop_ap_ind_t *stop_ap)
 
   printf("SoftAP stopped\r\n");
   dhcpserver_clear_stored_mac();
+  ap_clients_disconnect_all();
   sl_wfx_context->state &= ~SL_WFX_AP_INTERFACE_UP;
 
   status = sl_wfx_host_allocate_buffer(&buffer,
@@ -386,6 +398,7 @@ void sl_wfx_stop_ap_callback(sl_wfx_stop_ap_ind_t *stop_ap)
  *****************************************************************************/
 void sl_wfx_ap_client_connected_callback(sl_wfx_ap_client_connected_ind_t *ap_client_connected)
 {
+  ap_clients_connected(ap_client_connected->body.mac);
   printf("Client connected, MAC: %02X:%02X:%02X:%02X:%02X:%02X\r\n",
          ap_client_connected->body.mac[0],
          ap_client_connected->body.mac[1],
@@ -403,6 +416,7 @@ void sl_wfx_ap_client_rejected_callback(sl_wfx_ap_client_rejected_ind_t *ap_clie
   struct eth_addr mac_addr;
   memcpy(&mac_addr, ap_client_rejected->body.mac, SL_WFX_BSSID_SIZE);
   dhcpserver_remove_mac(&mac_addr);
+  ap_clients_disconnected(ap_client_rejected->body.mac);
   printf("Client rejected, reason: %d, MAC: %02X:%02X:%02X:%02X:%02X:%02X\r\n",
          ap_client_rejected->body.reason,
          ap_client_rejected->body.mac[0],
@@ -421,6 +435,7 @@ void sl_wfx_ap_client_disconnected_callback(sl_wfx_ap_client_disconnected_ind_t
   struct eth_addr mac_addr;
   memcpy(&mac_addr, ap_client_disconnected->body.mac, SL_WFX_BSSID_SIZE);
   dhcpserver_remove_mac(&mac_addr);
+  ap_clients_disconnected(ap_client_disconnected->body.mac);
   printf("Client disconnected, reason: %d, MAC: %02X:%02X:%02X:%02X:%02X:%02X\r\n",
          ap_client_disconnected->body.reason,
          ap_client_disconnected->body.mac[0],
@@ -448,12 +463,16 @@ static void wfx_events_task(void *p_arg)
   RTOS_ERR err;
   OS_MSG_SIZE msg_size;
   sl_wfx_generic_message_t *msg;
+  uint32_t timeout = 0;
+  uint32_t rssi_timeout;
 
   (void)p_arg;
 
   while (1) {
+    /* Wake up for the samples of the power save policy, if running, and
+       the station RSSI refresh */
     msg = (sl_wfx_generic_message_t *)OSQPend(&wifi_events,
-                                              0,
+                                              timeout,
                                               OS_OPT_PEND_BLOCKING,
                                               &msg_size,
                                               NULL,
@@ -466,14 +485,17 @@ static void wfx_events_task(void *p_arg)
         {
           set_sta_link_up();
           ret = wifi_cli_resume(&g_cli_sem, SL_WFX_CONNECT_IND_ID);
+          ps_policy_link_changed();
 
 #ifdef SL_CATALOG_POWER_MANAGER_PRESENT
           if (!(wifi.state & SL_WFX_AP_INTERFACE_UP)) {
             // Enable the WFX power save mode
             // Note: this mode is independent from the host power saving
             //       but has been linked to simplicfy the example.
+            wifi_cli_wfx_lock();
             sl_wfx_set_power_mode(WFM_PM_MODE_PS, 1);
             sl_wfx_enable_device_power_save();
+            wifi_cli_wfx_unlock();
           }
 #endif
           break;
@@ -482,17 +504,21 @@ static void wfx_events_task(void *p_arg)
         {
           set_sta_link_down();
           ret = wifi_cli_resume(&g_cli_sem, SL_WFX_DISCONNECT_IND_ID);
+          ps_policy_link_changed();
           break;
         }
         case SL_WFX_START_AP_IND_ID:
         {
           set_ap_link_up();
           ret = wifi_cli_resume(&g_cli_sem, SL_WFX_START_AP_IND_ID);
+          ps_policy_link_changed();
 
 #ifdef SL_CATALOG_POWER_MANAGER_PRESENT
           // Power save always disabled when SoftAP mode enabled
+          wifi_cli_wfx_lock();
           sl_wfx_set_power_mode(WFM_PM_MODE_ACTIVE, 0);
           sl_wfx_disable_device_power_save();
+          wifi_cli_wfx_unlock();
 #endif
           break;
         }
@@ -500,14 +526,17 @@ static void wfx_events_task(void *p_arg)
         {
           set_ap_link_down();
           ret = wifi_cli_resume(&g_cli_sem, SL_WFX_STOP_AP_IND_ID);
+          ps_policy_link_changed();
 
 #ifdef SL_CATALOG_POWER_MANAGER_PRESENT
           if (wifi.state & SL_WFX_STA_INTERFACE_CONNECTED) {
             // Enable the WFX power save mode
             // Note: this mode is independent from the host power saving
             //       but has been linked to simplicfy the example.
+            wifi_cli_wfx_lock();
             sl_wfx_set_power_mode(WFM_PM_MODE_PS, 1);
             sl_wfx_enable_device_power_save();
+            wifi_cli_wfx_unlock();
           }
 #endif
           break;
@@ -525,6 +554,12 @@ static void wfx_events_task(void *p_arg)
 
       sl_wfx_host_free_buffer(msg, SL_WFX_RX_FRAME_BUFFER);
     }
+
+    timeout = ps_policy_poll();
+    rssi_timeout = metrics_refresh_rssi();
+    if ((timeout == 0) || ((rssi_timeout != 0) && (rssi_timeout < timeout))) {
+      timeout = rssi_timeout;
+    }
   }
 }
 
@@ -20,6 +20,7 @@
  *****************************************************************************/
 #include "lwip/dhcp.h"
 #include "wifi_cli_params.h"
+#include "wifi_cli_boot.h"
 #include <kernel/include/os.h>
 #include <common/include/rtos_utils.h>
 #include <common/include/rtos_err.h>
@@ -69,9 +70,6 @@ void dhcpclient_set_link_state(int link_up)
 static void dhcp_client_task(void *arg)
 {
   struct netif *netif = (struct netif *) arg;
-  ip_addr_t ipaddr;
-  ip_addr_t netmask;
-  ip_addr_t gw;
   struct dhcp *dhcp;
   for (;; ) {
     switch (dhcp_state) {
@@ -89,6 +87,7 @@ static void dhcp_client_task(void *arg)
       {
         if (dhcp_supplied_address(netif)) {
           dhcp_state = DHCP_ADDRESS_ASSIGNED;
+          boot_trace_mark(BOOT_STAGE_STA_IP);
           printf("IP address : %d.%d.%d.%d\r\n",
                  (uint8_t)(sta_netif.ip_addr.addr & 0xff),
                  (uint8_t)(sta_netif.ip_addr.addr >> 8),
@@ -105,10 +104,7 @@ static void dhcp_client_task(void *arg)
             dhcp_stop(netif);
 
             // Static address used
-            IP_ADDR4(&ipaddr, sta_ip_addr0, sta_ip_addr1, sta_ip_addr2, sta_ip_addr3);
-            IP_ADDR4(&netmask, sta_netmask_addr0, sta_netmask_addr1, sta_netmask_addr2, sta_netmask_addr3);
-            IP_ADDR4(&gw, sta_gw_addr0, sta_gw_addr1, sta_gw_addr2, sta_gw_addr3);
-            netif_set_addr(netif, ip_2_ip4(&ipaddr), ip_2_ip4(&netmask), ip_2_ip4(&gw));
+            wifi_cli_netif_set_static(netif);
           }
         }
       }
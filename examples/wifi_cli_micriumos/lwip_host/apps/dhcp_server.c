@@ -120,7 +120,7 @@ ip_addr_t dhcpserver_get_ip(struct eth_addr *mac)
         && saved_mac[i].addr[2] == mac->addr[2] && saved_mac[i].addr[3] == mac->addr[3]
         && saved_mac[i].addr[4] == mac->addr[4] && saved_mac[i].addr[5] == mac->addr[5]) {
       /* index is used to increment IP address. */
-      offer_ip.addr = ((10 + i) << 24) + ap_ip_addr0 + (ap_ip_addr1 << 8) + (ap_ip_addr2 << 16);
+      offer_ip.addr = ((10 + i) << 24) + (ip4_addr_get_u32(ip_2_ip4(&ap_static_addr.ip_addr)) & 0x00ffffff);
       return offer_ip;
     }
   }
@@ -288,7 +288,7 @@ static void dhcpserver_fn(void *arg, struct udp_pcb *dhcp_pcb_recv,
       options_offset++;
       pbuf_put_at(pbuf_out, options_offset, 4);
       options_offset++;
-      IP4_ADDR(&r, ap_netmask_addr0, ap_netmask_addr1, ap_netmask_addr2, ap_netmask_addr3);
+      ip_addr_copy(r, ap_static_addr.netmask);
       pbuf_put_at(pbuf_out, options_offset, r.addr & 0xff);
       pbuf_put_at(pbuf_out, options_offset + 1, (r.addr >> 8) & 0xff);
       pbuf_put_at(pbuf_out, options_offset + 2, (r.addr >> 16) & 0xff);
@@ -299,7 +299,7 @@ static void dhcpserver_fn(void *arg, struct udp_pcb *dhcp_pcb_recv,
       options_offset++;
       pbuf_put_at(pbuf_out, options_offset, 4);
       options_offset++;
-      IP4_ADDR(&r, ap_ip_addr0, ap_ip_addr1, ap_ip_addr2, ap_ip_addr3);
+      ip_addr_copy(r, ap_static_addr.ip_addr);
       pbuf_put_at(pbuf_out, options_offset, r.addr & 0xff);
       pbuf_put_at(pbuf_out, options_offset + 1, (r.addr >> 8) & 0xff);
       pbuf_put_at(pbuf_out, options_offset + 2, (r.addr >> 16) & 0xff);
@@ -320,7 +320,7 @@ static void dhcpserver_fn(void *arg, struct udp_pcb *dhcp_pcb_recv,
       options_offset++;
       pbuf_put_at(pbuf_out, options_offset, 4);
       options_offset++;
-      IP4_ADDR(&r, ap_ip_addr0, ap_ip_addr1, ap_ip_addr2, ap_ip_addr3);
+      ip_addr_copy(r, ap_static_addr.ip_addr);
       pbuf_put_at(pbuf_out, options_offset, r.addr & 0xff);
       pbuf_put_at(pbuf_out, options_offset + 1, (r.addr >> 8) & 0xff);
       pbuf_put_at(pbuf_out, options_offset + 2, (r.addr >> 16) & 0xff);
@@ -394,7 +394,7 @@ static void dhcpserver_fn(void *arg, struct udp_pcb *dhcp_pcb_recv,
         options_offset++;
         pbuf_put_at(pbuf_out, options_offset, 4);
         options_offset++;
-        IP4_ADDR(&r, ap_netmask_addr0, ap_netmask_addr1, ap_netmask_addr2, ap_netmask_addr3);
+        ip_addr_copy(r, ap_static_addr.netmask);
         pbuf_put_at(pbuf_out, options_offset, r.addr & 0xff);
         pbuf_put_at(pbuf_out, options_offset + 1, (r.addr >> 8) & 0xff);
         pbuf_put_at(pbuf_out, options_offset + 2, (r.addr >> 16) & 0xff);
@@ -405,7 +405,7 @@ static void dhcpserver_fn(void *arg, struct udp_pcb *dhcp_pcb_recv,
         options_offset++;
         pbuf_put_at(pbuf_out, options_offset, 4);
         options_offset++;
-        IP4_ADDR(&r, ap_ip_addr0, ap_ip_addr1, ap_ip_addr2, ap_ip_addr3);
+        ip_addr_copy(r, ap_static_addr.ip_addr);
         pbuf_put_at(pbuf_out, options_offset, r.addr & 0xff);
         pbuf_put_at(pbuf_out, options_offset + 1, (r.addr >> 8) & 0xff);
         pbuf_put_at(pbuf_out, options_offset + 2, (r.addr >> 16) & 0xff);
@@ -428,7 +428,7 @@ static void dhcpserver_fn(void *arg, struct udp_pcb *dhcp_pcb_recv,
         options_offset++;
         pbuf_put_at(pbuf_out, options_offset, 4);
         options_offset++;
-        IP4_ADDR(&r, ap_ip_addr0, ap_ip_addr1, ap_ip_addr2, ap_ip_addr3);
+        ip_addr_copy(r, ap_static_addr.ip_addr);
         pbuf_put_at(pbuf_out, options_offset, r.addr & 0xff);
         pbuf_put_at(pbuf_out, options_offset + 1, (r.addr >> 8) & 0xff);
         pbuf_put_at(pbuf_out, options_offset + 2, (r.addr >> 16) & 0xff);
@@ -0,0 +1,253 @@
+/***************************************************************************//**
+ * @file
+ * @brief Internet checksum over 32-bit words for LwIP (LWIP_CHKSUM)
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#include <string.h>
+#include "chksum.h"
+
+/* Fold a sum of 32-bit words to 16 bits, end-around carries included */
+#define CHKSUM_FOLD32(sum)  (((sum) & 0xFFFFu) + ((sum) >> 16))
+
+/***************************************************************************//**
+ * @brief
+ *    This function computes the Internet checksum of a buffer, loading 32-bit
+ *    words.
+ *
+ *    The one's complement sum doesn't depend on the byte order: words are
+ *    summed as loaded, with the carries kept in a 64-bit accumulator, and the
+ *    result is in network byte order. A buffer starting on an odd address is
+ *    summed as if it started one byte earlier and the result is swapped back.
+ *
+ * @param[in]
+ *    + dataptr: The data
+ *    + len: The data length in bytes
+ *
+ * @param[out] None
+ *
+ * @return  The sum of the data, not complemented
+ ******************************************************************************/
+uint16_t chksum_fast(const void *dataptr, int len)
+{
+  const uint8_t *pb = (const uint8_t *)dataptr;
+  const uint32_t *pw;
+  uint64_t sum = 0;
+  uint32_t sum32;
+  uint16_t t = 0;
+  int odd = (int)((uintptr_t)pb & 1u);
+
+  /* Head: reach a halfword boundary, then a word boundary */
+  if (odd && (len > 0)) {
+      ((uint8_t *)&t)[1] = *pb++;
+      sum += t;
+      len--;
+  }
+  if (((uintptr_t)pb & 2u) && (len >= 2)) {
+      sum += *(const uint16_t *)pb;
+      pb += 2;
+      len -= 2;
+  }
+
+  /* Body: 8 words per iteration, the carries pile up in the upper word */
+  pw = (const uint32_t *)pb;
+  while (len >= 32) {
+      sum += pw[0];
+      sum += pw[1];
+      sum += pw[2];
+      sum += pw[3];
+      sum += pw[4];
+      sum += pw[5];
+      sum += pw[6];
+      sum += pw[7];
+      pw += 8;
+      len -= 32;
+  }
+  while (len >= 4) {
+      sum += *pw++;
+      len -= 4;
+  }
+
+  /* Tail: last halfword & byte, padded with 0 */
+  pb = (const uint8_t *)pw;
+  if (len >= 2) {
+      sum += *(const uint16_t *)pb;
+      pb += 2;
+      len -= 2;
+  }
+  if (len > 0) {
+      t = 0;
+      ((uint8_t *)&t)[0] = *pb;
+      sum += t;
+  }
+
+  /* 64 -> 32 -> 16 bits */
+  sum = (sum & 0xFFFFFFFFu) + (sum >> 32);
+  sum = (sum & 0xFFFFFFFFu) + (sum >> 32);
+  sum32 = (uint32_t)sum;
+  sum32 = CHKSUM_FOLD32(sum32);
+  sum32 = CHKSUM_FOLD32(sum32);
+
+  if (odd) {
+      sum32 = ((sum32 & 0xFFu) << 8) | ((sum32 >> 8) & 0xFFu);
+  }
+  return (uint16_t)sum32;
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function copies a buffer and computes its Internet checksum in the
+ *    same pass, as chksum_fast() does.
+ *
+ *    The words are loaded aligned on the source. The destination may have
+ *    another alignment, its stores go through memcpy(), a single STR on
+ *    Cortex-M3/M4 which handle unaligned accesses.
+ *
+ * @param[in]
+ *    + src: The data
+ *    + len: The data length in bytes
+ *
+ * @param[out]
+ *    + dst: The copy
+ *
+ * @return  The sum of the data, not complemented
+ ******************************************************************************/
+uint16_t chksum_copy(void *dst, const void *src, int len)
+{
+  const uint8_t *pb = (const uint8_t *)src;
+  uint8_t *pd = (uint8_t *)dst;
+  const uint32_t *pw;
+  uint64_t sum = 0;
+  uint32_t sum32;
+  uint32_t w[8];
+  uint16_t t = 0;
+  int odd = (int)((uintptr_t)pb & 1u);
+
+  /* Head: reach a halfword boundary, then a word boundary of the source */
+  if (odd && (len > 0)) {
+      *pd++ = *pb;
+      ((uint8_t *)&t)[1] = *pb++;
+      sum += t;
+      len--;
+  }
+  if (((uintptr_t)pb & 2u) && (len >= 2)) {
+      t = *(const uint16_t *)pb;
+      memcpy(pd, &t, 2);
+      sum += t;
+      pb += 2;
+      pd += 2;
+      len -= 2;
+  }
+
+  /* Body: 8 words per iteration, loaded once for the sum & the copy */
+  pw = (const uint32_t *)pb;
+  while (len >= 32) {
+      w[0] = pw[0];
+      w[1] = pw[1];
+      w[2] = pw[2];
+      w[3] = pw[3];
+      w[4] = pw[4];
+      w[5] = pw[5];
+      w[6] = pw[6];
+      w[7] = pw[7];
+      sum += w[0];
+      sum += w[1];
+      sum += w[2];
+      sum += w[3];
+      sum += w[4];
+      sum += w[5];
+      sum += w[6];
+      sum += w[7];
+      memcpy(pd, w, 32);
+      pw += 8;
+      pd += 32;
+      len -= 32;
+  }
+  while (len >= 4) {
+      w[0] = *pw++;
+      sum += w[0];
+      memcpy(pd, w, 4);
+      pd += 4;
+      len -= 4;
+  }
+
+  /* Tail: last halfword & byte, padded with 0 */
+  pb = (const uint8_t *)pw;
+  if (len >= 2) {
+      t = *(const uint16_t *)pb;
+      memcpy(pd, &t, 2);
+      sum += t;
+      pb += 2;
+      pd += 2;
+      len -= 2;
+  }
+  if (len > 0) {
+      *pd = *pb;
+      t = 0;
+      ((uint8_t *)&t)[0] = *pb;
+      sum += t;
+  }
+
+  /* 64 -> 32 -> 16 bits */
+  sum = (sum & 0xFFFFFFFFu) + (sum >> 32);
+  sum = (sum & 0xFFFFFFFFu) + (sum >> 32);
+  sum32 = (uint32_t)sum;
+  sum32 = CHKSUM_FOLD32(sum32);
+  sum32 = CHKSUM_FOLD32(sum32);
+
+  if (odd) {
+      sum32 = ((sum32 & 0xFFu) << 8) | ((sum32 >> 8) & 0xFFu);
+  }
+  return (uint16_t)sum32;
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function computes the Internet checksum of a buffer byte by byte
+ *    (RFC 1071), the reference of chksum_fast()
+ *
+ * @param[in]
+ *    + dataptr: The data
+ *    + len: The data length in bytes
+ *
+ * @param[out] None
+ *
+ * @return  The sum of the data, not complemented, in network byte order
+ ******************************************************************************/
+uint16_t chksum_ref(const void *dataptr, int len)
+{
+  const uint8_t *pb = (const uint8_t *)dataptr;
+  uint32_t sum = 0;
+  uint16_t be_sum;
+  int i;
+
+  /* Big-endian 16-bit words */
+  for (i = 0; i + 1 < len; i += 2) {
+      sum += ((uint32_t)pb[i] << 8) | pb[i + 1];
+  }
+  if (len & 1) {
+      sum += (uint32_t)pb[len - 1] << 8;
+  }
+  sum = CHKSUM_FOLD32(sum);
+  sum = CHKSUM_FOLD32(sum);
+
+  /* Back to the memory byte order */
+  ((uint8_t *)&be_sum)[0] = (uint8_t)(sum >> 8);
+  ((uint8_t *)&be_sum)[1] = (uint8_t)sum;
+  return be_sum;
+}
@@ -0,0 +1,53 @@
+/***************************************************************************//**
+ * @file
+ * @brief Internet checksum over 32-bit words for LwIP (LWIP_CHKSUM)
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+#ifndef __CHKSUM_H__
+#define __CHKSUM_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**************************************************************************//**
+ * @brief: Internet checksum of a buffer, as expected by LWIP_CHKSUM: the
+ *         16-bit one's complement sum of the data, not complemented, in
+ *         network byte order. Any alignment & length are accepted.
+ *****************************************************************************/
+uint16_t chksum_fast(const void *dataptr, int len);
+
+/**************************************************************************//**
+ * @brief: Copy a buffer and return its checksum as chksum_fast() does, the
+ *         data being read once (LWIP_CHKSUM_COPY). The buffers may have
+ *         different alignments but must not overlap.
+ *****************************************************************************/
+uint16_t chksum_copy(void *dst, const void *src, int len);
+
+/**************************************************************************//**
+ * @brief: Portable reference of chksum_fast(), summing the data byte by byte.
+ *****************************************************************************/
+uint16_t chksum_ref(const void *dataptr, int len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CHKSUM_H__ */
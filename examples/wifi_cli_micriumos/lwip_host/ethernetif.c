@@ -29,6 +29,9 @@
 #include "sl_wfx.h"
 #include "wifi_cli_params.h"
 #include "app_wifi_events.h"
+#include "wifi_cli_ap_clients.h"
+#include "wifi_cli_trace.h"
+#include "wifi_cli_tx_latency.h"
 
 #include <kernel/include/os.h>
 #include <common/include/rtos_utils.h>
@@ -41,6 +44,9 @@
 const char *station_netif = "st";
 const char *softap_netif = "ap";
 
+/* Frame counters, indexed by sl_wfx_interface_t */
+static ethernetif_stats_t ethernetif_stats[ETHERNETIF_NB_INTERFACES];
+
 /***************************************************************************//**
  * Initializes the hardware parameters. Called from ethernetif_init().
  *
@@ -86,6 +92,9 @@ static err_t low_level_output(struct netif *netif, struct pbuf *p)
   uint8_t *buffer;
   sl_wfx_packet_queue_item_t *queue_item;
   sl_status_t result;
+  sl_wfx_interface_t interface;
+
+  interface = (memcmp(netif->name, station_netif, 2) == 0) ?  SL_WFX_STA_INTERFACE : SL_WFX_SOFTAP_INTERFACE;
 
   /* Take TX queue mutex */
   OSMutexPend(&sl_wfx_tx_queue_mutex, 0, OS_OPT_PEND_BLOCKING, 0, &err);
@@ -97,6 +106,9 @@ static err_t low_level_output(struct netif *netif, struct pbuf *p)
                                           p->tot_len + sizeof(sl_wfx_packet_queue_item_t));
 
   if ((result != SL_STATUS_OK) || (queue_item == NULL)) {
+    TRACE_EVENT(TRACE_EV_TX_NO_BUFFER, interface, p->tot_len);
+    ethernetif_stats[interface].tx_drops++;
+    OSMutexPost(&sl_wfx_tx_queue_mutex, OS_OPT_POST_NONE, &err);
     return ERR_MEM;
   }
 
@@ -109,9 +121,13 @@ static err_t low_level_output(struct netif *netif, struct pbuf *p)
   }
 
   /* Provide the data length the interface information to the pbuf */
-  queue_item->interface = (memcmp(netif->name, station_netif, 2) == 0) ?  SL_WFX_STA_INTERFACE : SL_WFX_SOFTAP_INTERFACE;
+  queue_item->interface = interface;
   queue_item->data_length = p->tot_len;
 
+  if (queue_item->interface == SL_WFX_SOFTAP_INTERFACE) {
+    ap_clients_record_tx(queue_item->buffer.body.packet_data, p->tot_len);
+  }
+
   /* Determine if there is anything on the tx packet queue */
   if (sl_wfx_tx_queue_context.head_ptr != NULL) {
     sl_wfx_tx_queue_context.tail_ptr->next = queue_item;
@@ -122,9 +138,14 @@ static err_t low_level_output(struct netif *netif, struct pbuf *p)
 
   /* Update the tail pointer */
   sl_wfx_tx_queue_context.tail_ptr = queue_item;
+  TRACE_EVENT(TRACE_EV_TX_ENQUEUE, interface, p->tot_len);
+  tx_latency_frame_queued(interface);
+  ethernetif_stats[interface].tx_frames++;
+  ethernetif_stats[interface].tx_bytes += p->tot_len;
 
   /* Notify that a TX frame is ready */
   OSFlagPost(&bus_events, SL_WFX_BUS_EVENT_FLAG_TX, OS_OPT_POST_FLAG_SET, &err);
+  TRACE_EVENT(TRACE_EV_TX_BUS_WAKE, interface, 0);
 
   /* Release TX queue mutex */
   OSMutexPost(&sl_wfx_tx_queue_mutex, OS_OPT_POST_NONE, &err);
@@ -184,21 +205,37 @@ void sl_wfx_host_received_frame_callback(sl_wfx_received_ind_t* rx_buffer)
 {
   struct pbuf *p;
   struct netif *netif;
+  ethernetif_stats_t *stats;
+  err_t result;
   /* Check packet interface to send to AP or STA interface */
   if ((rx_buffer->header.info & SL_WFX_MSG_INFO_INTERFACE_MASK)
       == (SL_WFX_STA_INTERFACE << SL_WFX_MSG_INFO_INTERFACE_OFFSET)) {
     /* Send to station interface */
     netif = &sta_netif;
+    stats = &ethernetif_stats[SL_WFX_STA_INTERFACE];
+    TRACE_EVENT(TRACE_EV_RX_DISPATCH, SL_WFX_STA_INTERFACE, rx_buffer->body.frame_length);
   } else {
     /* Send to softAP interface */
     netif = &ap_netif;
+    stats = &ethernetif_stats[SL_WFX_SOFTAP_INTERFACE];
+    TRACE_EVENT(TRACE_EV_RX_DISPATCH, SL_WFX_SOFTAP_INTERFACE, rx_buffer->body.frame_length);
+    ap_clients_record_rx(&rx_buffer->body.frame[rx_buffer->body.frame_padding],
+                         rx_buffer->body.frame_length);
   }
   if (netif != NULL) {
     p = low_level_input(netif, rx_buffer);
     if (p != NULL) {
-      if (netif->input(p, netif) != ERR_OK ) {
+      result = netif->input(p, netif);
+      TRACE_EVENT(TRACE_EV_TCPIP_INPUT, (netif == &sta_netif) ? SL_WFX_STA_INTERFACE : SL_WFX_SOFTAP_INTERFACE, result);
+      if (result != ERR_OK ) {
         pbuf_free(p);
+        stats->rx_drops++;
+      } else {
+        stats->rx_frames++;
+        stats->rx_bytes += rx_buffer->body.frame_length;
       }
+    } else {
+      stats->rx_drops++;
     }
   }
 }
@@ -252,3 +289,36 @@ err_t ap_ethernetif_init(struct netif *netif)
 
   return ERR_OK;
 }
+
+/***************************************************************************//**
+ * Gets the frame counters of an interface.
+ *
+ * @param interface the interface (sl_wfx_interface_t)
+ * @param stats the counters
+ ******************************************************************************/
+void ethernetif_get_stats(uint8_t interface, ethernetif_stats_t *stats)
+{
+  *stats = ethernetif_stats[interface % ETHERNETIF_NB_INTERFACES];
+}
+
+/***************************************************************************//**
+ * Gets the number of frames waiting for the bus task.
+ *
+ * @returns the TX queue depth
+ ******************************************************************************/
+uint32_t ethernetif_get_tx_queue_depth(void)
+{
+  RTOS_ERR err;
+  sl_wfx_packet_queue_item_t *queue_item;
+  uint32_t depth = 0;
+
+  OSMutexPend(&sl_wfx_tx_queue_mutex, 0, OS_OPT_PEND_BLOCKING, 0, &err);
+  for (queue_item = sl_wfx_tx_queue_context.head_ptr;
+       queue_item != NULL;
+       queue_item = queue_item->next) {
+    depth++;
+  }
+  OSMutexPost(&sl_wfx_tx_queue_mutex, OS_OPT_POST_NONE, &err);
+
+  return depth;
+}
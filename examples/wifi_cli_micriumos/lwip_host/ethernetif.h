@@ -23,6 +23,19 @@
 #ifdef __cplusplus
 extern "C" {
 #endif
+
+#define ETHERNETIF_NB_INTERFACES  2   ///< Indexed by sl_wfx_interface_t
+
+/* Frame counters of an interface */
+typedef struct {
+  uint32_t rx_frames;
+  uint32_t rx_bytes;
+  uint32_t rx_drops;    ///< No pbuf or rejected by lwIP
+  uint32_t tx_frames;
+  uint32_t tx_bytes;
+  uint32_t tx_drops;    ///< No WF200 buffer
+} ethernetif_stats_t;
+
 /***************************************************************************//**
  * Sets up the station network interface.
  *
@@ -38,6 +51,21 @@ err_t sta_ethernetif_init(struct netif *netif);
  * @returns ERR_OK if successful
  ******************************************************************************/
 err_t ap_ethernetif_init(struct netif *netif);
+
+/***************************************************************************//**
+ * Gets the frame counters of an interface.
+ *
+ * @param interface the interface (sl_wfx_interface_t)
+ * @param stats the counters
+ ******************************************************************************/
+void ethernetif_get_stats(uint8_t interface, ethernetif_stats_t *stats);
+
+/***************************************************************************//**
+ * Gets the number of frames waiting for the bus task.
+ *
+ * @returns the TX queue depth
+ ******************************************************************************/
+uint32_t ethernetif_get_tx_queue_depth(void);
 #ifdef __cplusplus
 }
 #endif
@@ -28,32 +28,79 @@
 
 #define NO_SYS                  0
 
+/* Memory & TCP profiles, selected by adding LWIPOPTS_PROFILE=<n> to the
+ * project defines. The RAM cost is the lwIP heap + the pbuf pool (1600 bytes
+ * per pbuf) + the TCP segment & pbuf descriptors, "sys ram" displays it:
+ *  - low-memory: about 37 KB, the original settings of the example, default
+ *  - balanced:   about 65 KB
+ *  - throughput: about 115 KB, for iperf & bulk transfers
+ * The README gives the iperf recipe to measure each profile. */
+#define LWIPOPTS_PROFILE_LOW_MEMORY     0
+#define LWIPOPTS_PROFILE_BALANCED       1
+#define LWIPOPTS_PROFILE_THROUGHPUT     2
+
+#ifndef LWIPOPTS_PROFILE
+#define LWIPOPTS_PROFILE                LWIPOPTS_PROFILE_LOW_MEMORY
+#endif
+
 /* Memory options */
 #define MEM_ALIGNMENT           4
 
-/* the size of the heap memory.  */
-#define MEM_SIZE                (20 * 1024)
+/* TCP Maximum segment size. */
+#define TCP_MSS                 (1500 - 40)
 
-/* the number of memp struct pbufs. */
+/* the size of each pbuf in the pbuf pool. */
+#define PBUF_POOL_BUFSIZE       1582
+
+/* Per profile:
+ * - MEM_SIZE holds the TX data queued by TCP (TCP_SND_BUF) and the
+ *   application buffers,
+ * - PBUF_POOL_SIZE holds the received frames: TCP_WND must fit in it, and
+ *   the tcpip mailbox must hold all of them so input frames aren't dropped,
+ * - MEMP_NUM_TCP_SEG covers TCP_SND_QUEUELEN plus out-of-order segments. */
+#if (LWIPOPTS_PROFILE == LWIPOPTS_PROFILE_LOW_MEMORY)
+#define LWIPOPTS_PROFILE_NAME   "low-memory"
+#define MEM_SIZE                (20 * 1024)
+#define PBUF_POOL_SIZE          10
 #define MEMP_NUM_PBUF           10
+#define MEMP_NUM_TCP_SEG        16
+#define TCP_SND_BUF             (8 * TCP_MSS)
+#define TCP_WND                 (8 * TCP_MSS)
+#define TCPIP_MBOX_SIZE         10
+#define DEFAULT_TCP_RECVMBOX_SIZE 10
+#elif (LWIPOPTS_PROFILE == LWIPOPTS_PROFILE_BALANCED)
+#define LWIPOPTS_PROFILE_NAME   "balanced"
+#define MEM_SIZE                (32 * 1024)
+#define PBUF_POOL_SIZE          20
+#define MEMP_NUM_PBUF           16
+#define MEMP_NUM_TCP_SEG        40
+#define TCP_SND_BUF             (16 * TCP_MSS)
+#define TCP_WND                 (16 * TCP_MSS)
+#define TCPIP_MBOX_SIZE         24
+#define DEFAULT_TCP_RECVMBOX_SIZE 16
+#elif (LWIPOPTS_PROFILE == LWIPOPTS_PROFILE_THROUGHPUT)
+#define LWIPOPTS_PROFILE_NAME   "throughput"
+#define MEM_SIZE                (48 * 1024)
+#define PBUF_POOL_SIZE          40
+#define MEMP_NUM_PBUF           32
+#define MEMP_NUM_TCP_SEG        80
+#define TCP_SND_BUF             (24 * TCP_MSS)
+#define TCP_WND                 (32 * TCP_MSS)
+#define TCPIP_MBOX_SIZE         48
+#define DEFAULT_TCP_RECVMBOX_SIZE 32
+#else
+#error "LWIPOPTS_PROFILE: unknown profile"
+#endif
+
 /* the number of UDP protocol control blocks. One per active UDP "connection". */
 #define MEMP_NUM_UDP_PCB        6
 /* the number of simultaneously active TCP connections. */
 #define MEMP_NUM_TCP_PCB        10
 /* the number of listening TCP connections. */
 #define MEMP_NUM_TCP_PCB_LISTEN 5
-/* the number of simultaneously queued TCP segments. */
-#define MEMP_NUM_TCP_SEG        16
 /*  the number of simultaneously active timeouts. */
 #define MEMP_NUM_SYS_TIMEOUT    10
 
-// pbuf options
-/* the number of buffers in the pbuf pool. */
-#define PBUF_POOL_SIZE          10
-
-/* the size of each pbuf in the pbuf pool. */
-#define PBUF_POOL_BUFSIZE       1582
-
 /* TCP options  */
 #define LWIP_TCP                1
 #define TCP_TTL                 255
@@ -62,18 +109,28 @@
    order. Define to 0 if your device is low on memory. */
 #define TCP_QUEUE_OOSEQ         1
 
-/* TCP Maximum segment size. */
-#define TCP_MSS                 (1500 - 40)
-
-/* TCP sender buffer space (bytes). */
-#define TCP_SND_BUF             (8 * TCP_MSS)
-
 /*  TCP sender buffer space (pbufs). This must be at least
    as much as (2 * TCP_SND_BUF/TCP_MSS) for things to work. */
 #define TCP_SND_QUEUELEN        (2 * TCP_SND_BUF / TCP_MSS)
 
-/* TCP receive window. */
-#define TCP_WND                 (8 * TCP_MSS)
+/* Allocate a full segment on each write so that small writes are merged in
+ * the same pbuf instead of queueing one segment each. */
+#define TCP_OVERSIZE            TCP_MSS
+
+/* Window scaling is only needed beyond 64 KB (about 43 pool pbufs) */
+#if (TCP_WND > 0xFFFF)
+#define LWIP_WND_SCALE          1
+#define TCP_RCV_SCALE           1
+#else
+#define LWIP_WND_SCALE          0
+#endif
+
+#if (TCP_SND_QUEUELEN > MEMP_NUM_TCP_SEG)
+#error "lwipopts.h: MEMP_NUM_TCP_SEG must cover TCP_SND_QUEUELEN"
+#endif
+#if (TCPIP_MBOX_SIZE < PBUF_POOL_SIZE)
+#error "lwipopts.h: TCPIP_MBOX_SIZE must hold the whole pbuf pool"
+#endif
 
 /* ICMP options */
 #define LWIP_ICMP                       1
@@ -89,6 +146,8 @@
 /* Statistics options */
 #define LWIP_STATS              1
 #define LWIP_STATS_DISPLAY      1
+/* 32-bit counters: the 16-bit ones wrap within minutes under iperf */
+#define LWIP_STATS_LARGE        1
 
 #define LWIP_RAW                1
 
@@ -102,6 +161,33 @@
 
 #define CHECKSUM_BY_HARDWARE 0
 
+/* Software checksum over 32-bit words (lwip_host/chksum.c). Set
+ * LWIP_CHKSUM_FAST=0 in the project defines to use its byte-by-byte
+ * reference instead, e.g. to compare the CPU load with "sys cpu". */
+#ifndef LWIP_CHKSUM_FAST
+#define LWIP_CHKSUM_FAST                1
+#endif
+#include "chksum.h"
+#if LWIP_CHKSUM_FAST
+#define LWIP_CHKSUM                     chksum_fast
+#else
+#define LWIP_CHKSUM                     chksum_ref
+#endif
+
+/* Sum the TCP & UDP payloads while they are copied into the segments, instead
+ * of reading them again when the headers are built. Off until a "sys cpu"
+ * run on the target shows a gain: set LWIP_CHECKSUM_ON_COPY=1 in the project
+ * defines to try it. */
+#ifndef LWIP_CHECKSUM_ON_COPY
+#define LWIP_CHECKSUM_ON_COPY           0
+#endif
+#if LWIP_CHECKSUM_ON_COPY
+#define TCP_CHECKSUM_ON_COPY            1
+#if LWIP_CHKSUM_FAST
+#define LWIP_CHKSUM_COPY(dst, src, len) chksum_copy(dst, src, len)
+#endif
+#endif
+
 /* Generate checksums in software for outgoing IP packets.*/
 #define CHECKSUM_GEN_IP                 1
 /* Generate checksums in software for outgoing UDP packets.*/
@@ -137,15 +223,24 @@
 /* LwIP Stack Parameters (modified compared to initialization value in opt.h) -*/
 #define LWIP_HTTPD_DYNAMIC_HEADERS 1
 #define LWIP_HTTPD_MAX_TAG_INSERT_LEN 4096
+/* Metrics snapshots, generated while they are sent (wifi_cli_metrics.c) */
+#define LWIP_HTTPD_CUSTOM_FILES 1
+#define LWIP_HTTPD_DYNAMIC_FILE_READ 1
 
 // OS related options
 #define TCPIP_THREAD_NAME              "TCP/IP"
 #define TCPIP_THREAD_STACKSIZE          1000
-#define TCPIP_MBOX_SIZE                 10
 #define DEFAULT_UDP_RECVMBOX_SIZE       10
-#define DEFAULT_TCP_RECVMBOX_SIZE       10
 #define DEFAULT_ACCEPTMBOX_SIZE         10
 #define DEFAULT_THREAD_STACKSIZE        500
 #define TCPIP_THREAD_PRIO               16u
 
+// Hot-path trace (wifi_cli_trace.h): record the TCP ACKs processed. tcp_input()
+// has already converted the header numbers to host order.
+#if defined(WIFI_CLI_TRACE_EN) && WIFI_CLI_TRACE_EN
+void trace_tcp_input(unsigned long ackno, unsigned int flags);
+#define LWIP_HOOK_TCP_INPACKET_PCB(pcb, hdr, optlen, opt1len, opt2, p) \
+  (trace_tcp_input((hdr)->ackno, TCPH_FLAGS(hdr)), ERR_OK)
+#endif
+
 #endif /* __LWIPOPTS_H__ */
@@ -53,6 +53,7 @@
 
 #include "lwip/tcp.h"
 #include "lwip/sys.h"
+#include "lwip/memp.h"
 
 #include <string.h>
 
@@ -72,11 +73,17 @@
 #define LWIPERF_SERVER_IP_TYPE      IPADDR_TYPE_ANY
 #endif
 
-/* File internal memory allocation (struct lwiperf_*): this defaults to
-   the heap */
+/** Number of session states: a server listener and its connection, plus a
+    client connection and the listener of a dual/tradeoff test */
+#ifndef LWIPERF_NUM_STATES
+#define LWIPERF_NUM_STATES          6
+#endif
+
+/* File internal memory allocation (struct lwiperf_*): a dedicated pool, so
+   that starting and stopping tests doesn't fragment the heap of the packets */
 #ifndef LWIPERF_ALLOC
-#define LWIPERF_ALLOC(type)         mem_malloc(sizeof(type))
-#define LWIPERF_FREE(type, item)    mem_free(item)
+#define LWIPERF_ALLOC(type)         LWIP_MEMPOOL_ALLOC(LWIPERF_STATE)
+#define LWIPERF_FREE(type, item)    LWIP_MEMPOOL_FREE(LWIPERF_STATE, item)
 #endif
 
 /** If this is 1, check that received data has the correct format */
@@ -84,6 +91,10 @@
 #define LWIPERF_CHECK_RX_DATA       0
 #endif
 
+/** Largest chunk passed to a single tcp_write() when streaming from
+    lwiperf_txbuf_const (the pattern offset can be up to 9 bytes) */
+#define LWIPERF_TXBUF_CHUNK_MAX     (sizeof(lwiperf_txbuf_const) - 10)
+
 /** This is the Iperf settings struct sent from the client */
 typedef struct _lwiperf_settings {
 #define LWIPERF_FLAGS_ANSWER_TEST 0x80000000
@@ -91,7 +102,7 @@ typedef struct _lwiperf_settings {
   u32_t flags;
   u32_t num_threads; /* unused for now */
   u32_t remote_port;
-  u32_t buffer_len; /* unused for now */
+  u32_t buffer_len; /* client write size in bytes, 0 = TCP_MSS */
   u32_t win_band; /* TCP window / UDP rate: unused for now */
   u32_t amount; /* pos. value: bytes?; neg. values: time (unit is 10ms: 1/100 second) */
 } lwiperf_settings_t;
@@ -128,6 +139,8 @@ struct _lwiperf_state_tcp {
   /* 1=start server when client is closed */
   u8_t client_tradeoff_mode;
   u32_t bytes_transferred;
+  /* TCP samples, a server passes them on to its connections */
+  struct lwiperf_tcp_sampler sampler;
   lwiperf_settings_t settings;
   u8_t have_settings_buf;
   u8_t specific_remote;
@@ -150,6 +163,8 @@ union _lwiperf_state_session {
   lwiperf_state_udp_t *udp_session;
 };
 
+LWIP_MEMPOOL_DECLARE(LWIPERF_STATE, LWIPERF_NUM_STATES, sizeof(lwiperf_state_tcp_t), "LWIPERF_STATE")
+
 /** List of active iperf sessions */
 static lwiperf_state_base_t *lwiperf_all_connections;
 /** A const buffer to send from: we want to measure sending, not copying! */
@@ -245,6 +260,71 @@ lwiperf_list_find(lwiperf_state_base_t *item)
   return NULL;
 }
 
+/**
+ * @ingroup iperf
+ * Initialize the pool of the session states, from the tcpip thread before
+ * any test is started.
+ */
+void
+lwiperf_init(void)
+{
+  LWIP_MEMPOOL_INIT(LWIPERF_STATE);
+}
+
+/**
+ * @ingroup iperf
+ * Register a function receiving a sample of the TCP connection internals of
+ * a session on every poll (every second), NULL to stop sampling. For a
+ * server, the function applies to its running and next connections.
+ */
+void
+lwiperf_set_tcp_sample_fn(void *lwiperf_session,
+                          lwiperf_tcp_sample_fn sample_fn, void *sample_arg)
+{
+  lwiperf_state_base_t *i;
+  lwiperf_state_tcp_t *conn;
+
+  LWIP_ASSERT_CORE_LOCKED();
+  for (i = lwiperf_all_connections; i != NULL; i = i->next) {
+    if ((i == lwiperf_session) || (i->related_master_state == lwiperf_session)) {
+      conn = (lwiperf_state_tcp_t *)i->conn_session;
+      conn->sampler.fn = sample_fn;
+      conn->sampler.arg = sample_arg;
+    }
+  }
+}
+
+/** Sample the internals of a session pcb and pass them to the sample
+ * function of the session, if any. Also used by lwiperf3. */
+void
+lwiperf_tcp_sample(struct lwiperf_tcp_sampler *sampler, struct tcp_pcb *pcb,
+                   u32_t ms_elapsed, u32_t bytes_transferred)
+{
+  struct lwiperf_tcp_sample sample;
+
+  if ((sampler->fn == NULL) || (pcb == NULL)) {
+    return;
+  }
+  sample.ms_elapsed = ms_elapsed;
+  sample.interval_ms = ms_elapsed - sampler->last_ms;
+  sample.bytes_transferred = bytes_transferred;
+  sample.interval_bytes = bytes_transferred - sampler->last_bytes;
+  sampler->last_ms = ms_elapsed;
+  sampler->last_bytes = bytes_transferred;
+  sample.cwnd = pcb->cwnd;
+  sample.ssthresh = pcb->ssthresh;
+  sample.snd_wnd = pcb->snd_wnd;
+  /* sa is the smoothed RTT scaled by 8, both in slow timer ticks */
+  sample.srtt_ms = (u32_t)(pcb->sa >> 3) * TCP_SLOW_INTERVAL;
+  sample.rto_ms = (u32_t)pcb->rto * TCP_SLOW_INTERVAL;
+  sample.nrtx = pcb->nrtx;
+  sample.dupacks = pcb->dupacks;
+  sample.snd_queuelen = pcb->snd_queuelen;
+  sample.unacked_bytes = pcb->snd_nxt - pcb->lastack;
+  sample.unsent_bytes = pcb->snd_lbb - pcb->snd_nxt;
+  sampler->fn(sampler->arg, &sample);
+}
+
 /** Call the report function of an iperf tcp session */
 static void
 lwip_tcp_conn_report(lwiperf_state_tcp_t *conn, enum lwiperf_report_type report_type)
@@ -292,6 +372,34 @@ lwiperf_tcp_close(lwiperf_state_tcp_t *conn, enum lwiperf_report_type report_typ
   LWIPERF_FREE(lwiperf_state_tcp_t, conn);
 }
 
+/** Return the length of the next data write of an iperf tcp client session.
+ * Writes follow the buffer length requested with '-l' and never exceed the
+ * amount of bytes left for a byte-limited session. */
+static u16_t
+lwiperf_tcp_client_write_len(lwiperf_state_tcp_t *conn)
+{
+  u32_t write_len = lwip_htonl(conn->settings.buffer_len);
+
+  if (write_len == 0) {
+    write_len = TCP_MSS;
+    if (conn->bytes_transferred == 48) { /* @todo: fix this for intermediate settings, too */
+      write_len = TCP_MSS - 24;
+    }
+  }
+  if (write_len > LWIPERF_TXBUF_CHUNK_MAX) {
+    /* longer writes are streamed from the const buffer chunk by chunk */
+    write_len = LWIPERF_TXBUF_CHUNK_MAX;
+  }
+  if ((conn->settings.amount & PP_HTONL(0x80000000)) == 0) {
+    /* byte-limited session: don't send more than requested */
+    u32_t bytes_left = lwip_htonl(conn->settings.amount) - conn->bytes_transferred;
+    if (write_len > bytes_left) {
+      write_len = bytes_left;
+    }
+  }
+  return (u16_t)write_len;
+}
+
 /** Try to send more data on an iperf tcp session */
 static err_t
 lwiperf_tcp_client_send_more(lwiperf_state_tcp_t *conn)
@@ -321,8 +429,7 @@ lwiperf_tcp_client_send_more(lwiperf_state_tcp_t *conn)
     } else {
       /* this session is byte-limited */
       u32_t amount_bytes = lwip_htonl(conn->settings.amount);
-      /* @todo: this can send up to 1*MSS more than requested... */
-      if (amount_bytes >= conn->bytes_transferred) {
+      if (conn->bytes_transferred >= amount_bytes) {
         /* all requested bytes transferred -> close the connection */
         lwiperf_tcp_close(conn, LWIPERF_TCP_DONE_CLIENT);
         return ERR_OK;
@@ -344,20 +451,17 @@ lwiperf_tcp_client_send_more(lwiperf_state_tcp_t *conn)
       /* transmit data */
       /* @todo: every x bytes, transmit the settings again */
       txptr = LWIP_CONST_CAST(void *, &lwiperf_txbuf_const[conn->bytes_transferred % 10]);
-      txlen_max = TCP_MSS;
-      if (conn->bytes_transferred == 48) { /* @todo: fix this for intermediate settings, too */
-        txlen_max = TCP_MSS - 24;
-      }
+      txlen_max = lwiperf_tcp_client_write_len(conn);
       apiflags = 0; /* no copying needed */
       send_more = 1;
     }
     txlen = txlen_max;
     do {
       err = tcp_write(conn->conn_pcb, txptr, txlen, apiflags);
-      if (err ==  ERR_MEM) {
+      if ((err == ERR_MEM) && (conn->settings.buffer_len == 0)) {
         txlen /= 2;
       }
-    } while ((err == ERR_MEM) && (txlen >= (TCP_MSS / 2)));
+    } while ((err == ERR_MEM) && (conn->settings.buffer_len == 0) && (txlen >= (TCP_MSS / 2)));
 
     if (err == ERR_OK) {
       conn->bytes_transferred += txlen;
@@ -602,6 +706,9 @@ lwiperf_tcp_poll(void *arg, struct tcp_pcb *tpcb)
     return ERR_OK; /* lwiperf_tcp_close frees conn */
   }
 
+  lwiperf_tcp_sample(&conn->sampler, tpcb, sys_now() - conn->time_started,
+                     conn->bytes_transferred);
+
   if (!conn->base.server) {
     lwiperf_tcp_client_send_more(conn);
   }
@@ -645,6 +752,8 @@ lwiperf_tcp_accept(void *arg, struct tcp_pcb *newpcb, err_t err)
   conn->time_started = sys_now();
   conn->report_fn = s->report_fn;
   conn->report_arg = NULL;
+  conn->sampler.fn = s->sampler.fn;
+  conn->sampler.arg = s->sampler.arg;
 
   /* setup the tcp rx connection */
   tcp_arg(newpcb, conn);
@@ -734,11 +843,14 @@ static err_t lwiperf_start_tcp_server_impl(const ip_addr_t *local_addr, u16_t lo
 
   pcb = tcp_new_ip_type(LWIPERF_SERVER_IP_TYPE);
   if (pcb == NULL) {
+    LWIPERF_FREE(lwiperf_state_tcp_t, s);
     return ERR_MEM;
   }
   err = tcp_bind(pcb, local_addr, local_port);
   if (err != ERR_OK) {
     printf("Bind error %d\r\n", err);
+    tcp_close(pcb);
+    LWIPERF_FREE(lwiperf_state_tcp_t, s);
     return err;
   }
   s->server_pcb = tcp_listen_with_backlog(pcb, 1);
@@ -772,18 +884,24 @@ void* lwiperf_start_tcp_client_default(const ip_addr_t* remote_addr,
                                        void* report_arg)
 {
   return lwiperf_start_tcp_client(remote_addr, LWIPERF_TCP_PORT_DEFAULT, LWIPERF_CLIENT,
-                                  duration_sec, report_fn, report_arg);
+                                  duration_sec, 0, 0, report_fn, report_arg);
 }
 
 /**
  * @ingroup iperf
  * Start a TCP iperf client to a specific IP address and port.
  *
+ * @param duration_sec test duration, used when amount_bytes is 0
+ * @param amount_bytes number of bytes to transmit (iperf '-n'), 0 for a
+ *                     time-limited test
+ * @param buffer_len size of each write (iperf '-l'), 0 for TCP_MSS
+ *
  * @returns a connection handle that can be used to abort the client
  *          by calling @ref lwiperf_abort()
  */
 void* lwiperf_start_tcp_client(const ip_addr_t* remote_addr, u16_t remote_port,
                                enum lwiperf_client_type type, u32_t duration_sec,
+                               u32_t amount_bytes, u32_t buffer_len,
                                lwiperf_report_fn report_fn, void* report_arg)
 {
   err_t ret;
@@ -810,8 +928,17 @@ void* lwiperf_start_tcp_client(const ip_addr_t* remote_addr, u16_t remote_port,
   }
   settings.num_threads = htonl(1);
   settings.remote_port = htonl(remote_port);
-  /* Update the test duration */
-  settings.amount = htonl((u32_t)-(duration_sec*1000/10));
+  settings.buffer_len = htonl(buffer_len);
+  if (amount_bytes != 0) {
+    /* Byte-limited test: positive amount */
+    if (amount_bytes & 0x80000000) {
+      return NULL;
+    }
+    settings.amount = htonl(amount_bytes);
+  } else {
+    /* Update the test duration */
+    settings.amount = htonl((u32_t)-(duration_sec*1000/10));
+  }
 
   ret = lwiperf_tx_start_impl(remote_addr, remote_port, &settings, report_fn, report_arg, NULL, &state);
   if (ret == ERR_OK) {
@@ -39,6 +39,7 @@
 
 #include "lwip/opt.h"
 #include "lwip/ip_addr.h"
+#include "lwip/memp.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -81,11 +82,62 @@ typedef void (*lwiperf_report_fn)(void *arg, enum lwiperf_report_type report_typ
   const ip_addr_t* local_addr, u16_t local_port, const ip_addr_t* remote_addr, u16_t remote_port,
   u32_t bytes_transferred, u32_t ms_duration, u32_t bandwidth_kbitpsec);
 
+/** TCP connection internals of a running session, sampled on each poll */
+struct lwiperf_tcp_sample
+{
+  /** Time since the start of the session and the last sample */
+  u32_t ms_elapsed;
+  u32_t interval_ms;
+  /** Bytes transferred since the start of the session and the last sample */
+  u32_t bytes_transferred;
+  u32_t interval_bytes;
+  /** Congestion window, slow start threshold and peer receive window */
+  u32_t cwnd;
+  u32_t ssthresh;
+  u32_t snd_wnd;
+  /** Smoothed RTT and retransmission timeout (TCP_SLOW_INTERVAL granularity) */
+  u32_t srtt_ms;
+  u32_t rto_ms;
+  /** Retransmissions of the oldest unacked segment */
+  u8_t nrtx;
+  /** Duplicate ACKs received */
+  u8_t dupacks;
+  /** pbufs queued for sending, bytes sent but not acked, bytes not sent yet */
+  u16_t snd_queuelen;
+  u32_t unacked_bytes;
+  u32_t unsent_bytes;
+};
+
+/** Prototype of a function called with each sample of a running session.
+    Called from the tcpip thread: keep it short. */
+typedef void (*lwiperf_tcp_sample_fn)(void *arg, const struct lwiperf_tcp_sample *sample);
+
+/** Sampling state of a session, the first sample has last_ms 0 */
+struct lwiperf_tcp_sampler
+{
+  lwiperf_tcp_sample_fn fn;
+  void *arg;
+  u32_t last_ms;
+  u32_t last_bytes;
+};
+
+struct tcp_pcb;
+
+/** Pool of the session states, for its usage statistics */
+LWIP_MEMPOOL_PROTOTYPE(LWIPERF_STATE);
+
+void  lwiperf_init(void);
+void  lwiperf_set_tcp_sample_fn(void* lwiperf_session,
+                                lwiperf_tcp_sample_fn sample_fn, void* sample_arg);
+void  lwiperf_tcp_sample(struct lwiperf_tcp_sampler* sampler, struct tcp_pcb* pcb,
+                         u32_t ms_elapsed, u32_t bytes_transferred);
+
 void* lwiperf_start_tcp_server(const ip_addr_t* local_addr, u16_t local_port,
                                lwiperf_report_fn report_fn, void* report_arg);
 void* lwiperf_start_tcp_server_default(lwiperf_report_fn report_fn, void* report_arg);
 void* lwiperf_start_tcp_client(const ip_addr_t* remote_addr, u16_t remote_port,
                                enum lwiperf_client_type type, u32_t duration_sec,
+                               u32_t amount_bytes, u32_t buffer_len,
                                lwiperf_report_fn report_fn, void* report_arg);
 void* lwiperf_start_tcp_client_default(const ip_addr_t* remote_addr, u32_t duration_sec,
                                lwiperf_report_fn report_fn, void* report_arg);
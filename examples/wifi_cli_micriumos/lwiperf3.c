@@ -0,0 +1,1231 @@
+/***************************************************************************//**
+ * @file
+ * @brief iPerf3 protocol server and client on top of the lwIP raw TCP API
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+
+/*
+ * An iperf3 test uses a control connection and one data connection per
+ * stream, both to the server port. The control connection carries:
+ *  - the 37-byte cookie identifying the test (sent first by the client),
+ *  - one-byte test states,
+ *  - the test parameters and the test results, as JSON strings prefixed
+ *    with their 32-bit big-endian length.
+ * The data connections start with the cookie then carry the test data.
+ *
+ * Only single-stream TCP tests are supported (no -P, -u or --bidir), in
+ * both directions (-R).
+ */
+
+#include "lwiperf3.h"
+
+#include "lwip/tcp.h"
+#include "lwip/sys.h"
+#include "lwip/memp.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if LWIP_TCP && LWIP_CALLBACK_API
+
+/** Specify the idle timeout (in seconds) after that the test fails */
+#ifndef LWIPERF3_TCP_MAX_IDLE_SEC
+#define LWIPERF3_TCP_MAX_IDLE_SEC   10U
+#endif
+#if LWIPERF3_TCP_MAX_IDLE_SEC > 255
+#error LWIPERF3_TCP_MAX_IDLE_SEC must fit into an u8_t
+#endif
+
+/** Change this if you don't want to lwiperf3 to listen to any IP version */
+#ifndef LWIPERF3_SERVER_IP_TYPE
+#define LWIPERF3_SERVER_IP_TYPE     IPADDR_TYPE_ANY
+#endif
+
+/** Number of listeners and sessions: a server listener with its test, plus
+    a client test */
+#ifndef LWIPERF3_NUM_STATES
+#define LWIPERF3_NUM_STATES         3
+#endif
+
+/* File internal memory allocation (struct lwiperf3_*): a dedicated pool, so
+   that starting and stopping tests doesn't fragment the heap of the packets */
+#ifndef LWIPERF3_ALLOC
+#define LWIPERF3_ALLOC(type)        LWIP_MEMPOOL_ALLOC(LWIPERF3_STATE)
+#define LWIPERF3_FREE(type, item)   LWIP_MEMPOOL_FREE(LWIPERF3_STATE, item)
+#endif
+
+/** Size of the buffer holding the JSON strings exchanged on the control
+    connection, longer strings received are truncated */
+#ifndef LWIPERF3_JSON_BUF_SIZE
+#define LWIPERF3_JSON_BUF_SIZE      384
+#endif
+
+/** iperf3 version announced to the servers in the test parameters: the
+    protocol followed is the one of iperf3 3.1.3, without -P, -u or --bidir */
+#ifndef LWIPERF3_CLIENT_VERSION
+#define LWIPERF3_CLIENT_VERSION     "3.1.3"
+#endif
+
+/** Size of the cookie, including the terminating null character */
+#define LWIPERF3_COOKIE_SIZE        37
+
+/** Test states, as defined by iperf3 */
+#define LWIPERF3_TEST_START         1
+#define LWIPERF3_TEST_RUNNING       2
+#define LWIPERF3_TEST_END           4
+#define LWIPERF3_PARAM_EXCHANGE     9
+#define LWIPERF3_CREATE_STREAMS     10
+#define LWIPERF3_SERVER_TERMINATE   11
+#define LWIPERF3_CLIENT_TERMINATE   12
+#define LWIPERF3_EXCHANGE_RESULTS   13
+#define LWIPERF3_DISPLAY_RESULTS    14
+#define LWIPERF3_IPERF_DONE         16
+#define LWIPERF3_ACCESS_DENIED      (-1)
+#define LWIPERF3_SERVER_ERROR       (-2)
+
+/** iperf3 error code sent along with SERVER_ERROR for unsupported tests */
+#define LWIPERF3_IENUMSTREAMS       6
+
+/** What the control connection expects to receive next */
+enum lwiperf3_rx_phase {
+  LWIPERF3_RX_COOKIE,
+  LWIPERF3_RX_STATE,
+  LWIPERF3_RX_JSON_LEN,
+  LWIPERF3_RX_JSON,
+  LWIPERF3_RX_ERROR
+};
+
+typedef struct _lwiperf3_state_base lwiperf3_state_base_t;
+typedef struct _lwiperf3_listener lwiperf3_listener_t;
+typedef struct _lwiperf3_session lwiperf3_session_t;
+
+/** Basic handle, used to find and abort listeners and sessions */
+struct _lwiperf3_state_base {
+  /* linked list */
+  lwiperf3_state_base_t *next;
+  /* 1=listener, 0=test session */
+  u8_t listener;
+};
+
+/** Handle of an iperf3 server: iperf3 runs one test at a time */
+struct _lwiperf3_listener {
+  lwiperf3_state_base_t base;
+  struct tcp_pcb *server_pcb;
+  lwiperf3_session_t *session;
+  lwiperf_report_fn report_fn;
+  void *report_arg;
+  /* sample function passed on to the tests */
+  struct lwiperf_tcp_sampler sampler;
+};
+
+/** Handle of an iperf3 test, on the server or on the client side */
+struct _lwiperf3_session {
+  lwiperf3_state_base_t base;
+  /* listener of a server session, NULL for a client session */
+  lwiperf3_listener_t *listener;
+  struct tcp_pcb *ctrl_pcb;
+  struct tcp_pcb *data_pcb;
+  lwiperf_report_fn report_fn;
+  void *report_arg;
+  /* last test state sent or received */
+  s8_t state;
+  /* enum lwiperf3_rx_phase */
+  u8_t rx_phase;
+  /* position in the cookie, the JSON length or the error being received */
+  u8_t rx_pos;
+  /* position in the cookie received on the data connection */
+  u8_t data_cookie_pos;
+  /* 1=this side sends the test data */
+  u8_t sender;
+  /* 1=test data is being counted */
+  u8_t running;
+  u8_t poll_count;
+  u32_t duration_ms;
+  u32_t amount_bytes;
+  u32_t buffer_len;
+  u32_t time_started;
+  u32_t time_ended;
+  u32_t bytes_transferred;
+  /* TCP samples of the data connection */
+  struct lwiperf_tcp_sampler sampler;
+  u32_t json_len;
+  u32_t json_pos;
+  u8_t rx_buf[8];
+  ip_addr_t local_addr;
+  ip_addr_t remote_addr;
+  u16_t local_port;
+  u16_t remote_port;
+  char cookie[LWIPERF3_COOKIE_SIZE];
+  char json[LWIPERF3_JSON_BUF_SIZE];
+};
+
+/** Pool element: a listener or a session */
+typedef union {
+  lwiperf3_listener_t listener;
+  lwiperf3_session_t session;
+} lwiperf3_state_t;
+
+LWIP_MEMPOOL_DECLARE(LWIPERF3_STATE, LWIPERF3_NUM_STATES, sizeof(lwiperf3_state_t), "LWIPERF3_STATE")
+
+/** List of active iperf3 listeners and sessions */
+static lwiperf3_state_base_t *lwiperf3_all_states;
+/** A const buffer to send from: iperf3 does not check the data content */
+static const u8_t lwiperf3_txbuf_const[TCP_MSS] = { 0 };
+
+static err_t lwiperf3_ctrl_recv(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err);
+static err_t lwiperf3_ctrl_poll(void *arg, struct tcp_pcb *tpcb);
+static void lwiperf3_ctrl_err(void *arg, err_t err);
+static err_t lwiperf3_data_recv(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err);
+static err_t lwiperf3_data_sent(void *arg, struct tcp_pcb *tpcb, u16_t len);
+static err_t lwiperf3_data_poll(void *arg, struct tcp_pcb *tpcb);
+static void lwiperf3_data_err(void *arg, err_t err);
+
+
+/** Add an iperf3 handle to the 'active' list */
+static void
+lwiperf3_list_add(lwiperf3_state_base_t *item)
+{
+  item->next = lwiperf3_all_states;
+  lwiperf3_all_states = item;
+}
+
+/** Remove an iperf3 handle from the 'active' list */
+static void
+lwiperf3_list_remove(lwiperf3_state_base_t *item)
+{
+  lwiperf3_state_base_t *prev = NULL;
+  lwiperf3_state_base_t *iter;
+  for (iter = lwiperf3_all_states; iter != NULL; prev = iter, iter = iter->next) {
+    if (iter == item) {
+      if (prev == NULL) {
+        lwiperf3_all_states = iter->next;
+      } else {
+        prev->next = iter->next;
+      }
+      break;
+    }
+  }
+}
+
+/** Convert the return value of a session function to a callback one */
+static err_t
+lwiperf3_cb_ret(err_t err)
+{
+  return (err == ERR_ABRT) ? ERR_ABRT : ERR_OK;
+}
+
+/** Call the report function of an iperf3 session */
+static void
+lwiperf3_report(lwiperf3_session_t *s, enum lwiperf_report_type report_type)
+{
+  if (s->report_fn != NULL) {
+    u32_t duration_ms, bandwidth_kbitpsec;
+    duration_ms = (s->running ? sys_now() : s->time_ended) - s->time_started;
+    if (duration_ms == 0) {
+      bandwidth_kbitpsec = 0;
+    } else {
+      bandwidth_kbitpsec = (s->bytes_transferred / duration_ms) * 8U;
+    }
+    s->report_fn(s->report_arg, report_type,
+                 &s->local_addr, s->local_port,
+                 &s->remote_addr, s->remote_port,
+                 s->bytes_transferred, duration_ms, bandwidth_kbitpsec);
+  }
+}
+
+/** Remember the endpoints of a connection for the report */
+static void
+lwiperf3_set_endpoints(lwiperf3_session_t *s, struct tcp_pcb *pcb)
+{
+  ip_addr_copy(s->local_addr, pcb->local_ip);
+  ip_addr_copy(s->remote_addr, pcb->remote_ip);
+  s->local_port = pcb->local_port;
+  s->remote_port = pcb->remote_port;
+}
+
+/** Close a connection of a session, returns ERR_ABRT if it had to be aborted */
+static err_t
+lwiperf3_pcb_close(struct tcp_pcb *pcb)
+{
+  tcp_arg(pcb, NULL);
+  tcp_poll(pcb, NULL, 0);
+  tcp_sent(pcb, NULL);
+  tcp_recv(pcb, NULL);
+  tcp_err(pcb, NULL);
+  if (tcp_close(pcb) != ERR_OK) {
+    /* don't want to wait for free memory here... */
+    tcp_abort(pcb);
+    return ERR_ABRT;
+  }
+  return ERR_OK;
+}
+
+/** Close an iperf3 session.
+ * @return ERR_ABRT if one of its pcbs had to be aborted, ERR_CLSD otherwise:
+ *         callbacks of the session return ERR_ABRT to lwIP in the first case */
+static err_t
+lwiperf3_close(lwiperf3_session_t *s, enum lwiperf_report_type report_type)
+{
+  err_t ret = ERR_CLSD;
+
+  lwiperf3_list_remove(&s->base);
+  lwiperf3_report(s, report_type);
+  if (s->listener != NULL) {
+    s->listener->session = NULL;
+  }
+  if (s->data_pcb != NULL) {
+    if (lwiperf3_pcb_close(s->data_pcb) == ERR_ABRT) {
+      ret = ERR_ABRT;
+    }
+  }
+  if (s->ctrl_pcb != NULL) {
+    if (lwiperf3_pcb_close(s->ctrl_pcb) == ERR_ABRT) {
+      ret = ERR_ABRT;
+    }
+  }
+  LWIPERF3_FREE(lwiperf3_session_t, s);
+  return ret;
+}
+
+/** Send a test state on the control connection */
+static err_t
+lwiperf3_send_state(lwiperf3_session_t *s, s8_t state)
+{
+  err_t err;
+
+  s->state = state;
+  err = tcp_write(s->ctrl_pcb, &state, 1, TCP_WRITE_FLAG_COPY);
+  if (err == ERR_OK) {
+    err = tcp_output(s->ctrl_pcb);
+  }
+  return err;
+}
+
+/** Send the JSON string of the session buffer on the control connection */
+static err_t
+lwiperf3_send_json(lwiperf3_session_t *s, int len)
+{
+  err_t err;
+  u32_t len_be;
+
+  if ((len < 0) || (len >= (int)sizeof(s->json))) {
+    return ERR_BUF;
+  }
+  len_be = lwip_htonl((u32_t)len);
+  err = tcp_write(s->ctrl_pcb, &len_be, sizeof(len_be), TCP_WRITE_FLAG_COPY | TCP_WRITE_FLAG_MORE);
+  if (err == ERR_OK) {
+    err = tcp_write(s->ctrl_pcb, s->json, (u16_t)len, TCP_WRITE_FLAG_COPY);
+  }
+  if (err == ERR_OK) {
+    err = tcp_output(s->ctrl_pcb);
+  }
+  return err;
+}
+
+/** Send the results of the test (a single stream, with id 1) */
+static err_t
+lwiperf3_send_results(lwiperf3_session_t *s)
+{
+  u32_t duration_ms = s->time_ended - s->time_started;
+  int len;
+
+  len = snprintf(s->json, sizeof(s->json),
+                 "{\"cpu_util_total\":0,\"cpu_util_user\":0,\"cpu_util_system\":0,"
+                 "\"sender_has_retransmits\":%d,\"streams\":[{\"id\":1,"
+                 "\"bytes\":%"U32_F",\"retransmits\":-1,\"jitter\":0,\"errors\":0,"
+                 "\"packets\":0,\"start_time\":0,\"end_time\":%"U32_F".%03"U32_F"}]}",
+                 s->sender ? 0 : -1, s->bytes_transferred,
+                 duration_ms / 1000, duration_ms % 1000);
+  return lwiperf3_send_json(s, len);
+}
+
+/** Find the value of a key in a flat JSON object
+ * @return a pointer to the value, NULL if the key is not found */
+static const char *
+lwiperf3_json_find(const char *json, const char *key)
+{
+  size_t key_len = strlen(key);
+  const char *str;
+  const char *p = json;
+
+  while ((p = strchr(p, '"')) != NULL) {
+    str = p + 1;
+    p = strchr(str, '"');
+    if (p == NULL) {
+      break;
+    }
+    p++;
+    if (((size_t)(p - 1 - str) == key_len) && (strncmp(str, key, key_len) == 0)) {
+      while (*p == ' ') {
+        p++;
+      }
+      if (*p == ':') {
+        p++;
+        while (*p == ' ') {
+          p++;
+        }
+        return p;
+      }
+    }
+  }
+  return NULL;
+}
+
+/** Get a numeric JSON value, returns 'def' if the key is not found */
+static u32_t
+lwiperf3_json_get_u32(const char *json, const char *key, u32_t def)
+{
+  const char *value = lwiperf3_json_find(json, key);
+  return (value != NULL) ? (u32_t)strtoul(value, NULL, 10) : def;
+}
+
+/** Get a boolean JSON value, returns 0 if the key is not found */
+static u8_t
+lwiperf3_json_get_bool(const char *json, const char *key)
+{
+  const char *value = lwiperf3_json_find(json, key);
+  return (value != NULL) && (strncmp(value, "true", 4) == 0);
+}
+
+/** Check if the data transfer of the test is over. The client ends
+    time-limited tests, the sender of a byte-limited test stops by itself. */
+static u8_t
+lwiperf3_test_is_over(lwiperf3_session_t *s)
+{
+  if (s->amount_bytes != 0) {
+    return s->bytes_transferred >= s->amount_bytes;
+  }
+  if (s->listener != NULL) {
+    return 0;
+  }
+  return (sys_now() - s->time_started) >= s->duration_ms;
+}
+
+/** End the data transfer of the test (client side) */
+static err_t
+lwiperf3_client_test_end(lwiperf3_session_t *s)
+{
+  err_t err;
+
+  s->running = 0;
+  s->time_ended = sys_now();
+  err = lwiperf3_send_state(s, LWIPERF3_TEST_END);
+  if (err != ERR_OK) {
+    return lwiperf3_close(s, LWIPERF_TCP_ABORTED_LOCAL);
+  }
+  return ERR_OK;
+}
+
+/** Send as much test data as possible */
+static err_t
+lwiperf3_send_data(lwiperf3_session_t *s)
+{
+  err_t err;
+  u32_t txlen;
+
+  if (!s->running || !s->sender || (s->data_pcb == NULL)) {
+    return ERR_OK;
+  }
+  for (;;) {
+    if (lwiperf3_test_is_over(s)) {
+      if (s->listener == NULL) {
+        return lwiperf3_client_test_end(s);
+      }
+      break;
+    }
+    txlen = (s->buffer_len != 0) ? s->buffer_len : TCP_MSS;
+    if (txlen > sizeof(lwiperf3_txbuf_const)) {
+      txlen = sizeof(lwiperf3_txbuf_const);
+    }
+    if ((s->amount_bytes != 0) && (txlen > s->amount_bytes - s->bytes_transferred)) {
+      txlen = s->amount_bytes - s->bytes_transferred;
+    }
+    if (tcp_sndbuf(s->data_pcb) < txlen) {
+      /* wait for the sent callback */
+      break;
+    }
+    err = tcp_write(s->data_pcb, lwiperf3_txbuf_const, (u16_t)txlen, 0);
+    if (err == ERR_MEM) {
+      break;
+    }
+    if (err != ERR_OK) {
+      return lwiperf3_close(s, LWIPERF_TCP_ABORTED_LOCAL_TXERROR);
+    }
+    s->bytes_transferred += txlen;
+  }
+  tcp_output(s->data_pcb);
+  return ERR_OK;
+}
+
+/** Start counting the test data */
+static err_t
+lwiperf3_test_running(lwiperf3_session_t *s)
+{
+  s->running = 1;
+  s->time_started = sys_now();
+  s->bytes_transferred = 0;
+  s->sampler.last_ms = 0;
+  s->sampler.last_bytes = 0;
+  return lwiperf3_send_data(s);
+}
+
+/** Server side: check the test parameters sent by the client */
+static err_t
+lwiperf3_server_params(lwiperf3_session_t *s)
+{
+  err_t err;
+  u32_t ie[2];
+
+  if (lwiperf3_json_get_bool(s->json, "udp")
+      || lwiperf3_json_get_bool(s->json, "sctp")
+      || lwiperf3_json_get_bool(s->json, "bidirectional")) {
+    /* unsupported protocol or mode */
+    return lwiperf3_close(s, LWIPERF_TCP_ABORTED_LOCAL);
+  }
+  if (lwiperf3_json_get_u32(s->json, "parallel", 1) != 1) {
+    err = lwiperf3_send_state(s, LWIPERF3_SERVER_ERROR);
+    if (err == ERR_OK) {
+      /* iperf3 error code then errno */
+      ie[0] = PP_HTONL(LWIPERF3_IENUMSTREAMS);
+      ie[1] = 0;
+      tcp_write(s->ctrl_pcb, ie, sizeof(ie), TCP_WRITE_FLAG_COPY);
+      tcp_output(s->ctrl_pcb);
+    }
+    return lwiperf3_close(s, LWIPERF_TCP_ABORTED_LOCAL);
+  }
+  s->duration_ms = lwiperf3_json_get_u32(s->json, "time", 0) * 1000;
+  s->amount_bytes = lwiperf3_json_get_u32(s->json, "num", 0);
+  s->buffer_len = lwiperf3_json_get_u32(s->json, "len", 0);
+  s->sender = lwiperf3_json_get_bool(s->json, "reverse");
+
+  err = lwiperf3_send_state(s, LWIPERF3_CREATE_STREAMS);
+  if (err != ERR_OK) {
+    return lwiperf3_close(s, LWIPERF_TCP_ABORTED_LOCAL);
+  }
+  return ERR_OK;
+}
+
+/** Client side: send the test parameters */
+static err_t
+lwiperf3_client_params(lwiperf3_session_t *s)
+{
+  int len;
+
+  len = snprintf(s->json, sizeof(s->json),
+                 "{\"tcp\":true,\"omit\":0,\"time\":%"U32_F",\"parallel\":1,\"len\":%"U32_F,
+                 (s->amount_bytes != 0) ? 0 : s->duration_ms / 1000,
+                 (s->buffer_len != 0) ? s->buffer_len : (u32_t)TCP_MSS);
+  if (s->amount_bytes != 0) {
+    len += snprintf(&s->json[len], sizeof(s->json) - len, ",\"num\":%"U32_F, s->amount_bytes);
+  }
+  if (!s->sender) {
+    len += snprintf(&s->json[len], sizeof(s->json) - len, ",\"reverse\":true");
+  }
+  len += snprintf(&s->json[len], sizeof(s->json) - len, ",\"client_version\":\"" LWIPERF3_CLIENT_VERSION "\"}");
+  return lwiperf3_send_json(s, len);
+}
+
+/** Client side: the data connection is established, send the cookie */
+static err_t
+lwiperf3_data_connected(void *arg, struct tcp_pcb *tpcb, err_t err)
+{
+  lwiperf3_session_t *s = (lwiperf3_session_t *)arg;
+  LWIP_ASSERT("invalid session", s->data_pcb == tpcb);
+
+  if (err == ERR_OK) {
+    lwiperf3_set_endpoints(s, tpcb);
+    err = tcp_write(tpcb, s->cookie, LWIPERF3_COOKIE_SIZE, TCP_WRITE_FLAG_COPY);
+  }
+  if (err != ERR_OK) {
+    return lwiperf3_cb_ret(lwiperf3_close(s, LWIPERF_TCP_ABORTED_REMOTE));
+  }
+  tcp_output(tpcb);
+  return ERR_OK;
+}
+
+/** Client side: open the data connection to the server */
+static err_t
+lwiperf3_client_create_stream(lwiperf3_session_t *s)
+{
+  err_t err;
+  struct tcp_pcb *newpcb;
+  ip_addr_t remote_addr;
+
+  newpcb = tcp_new_ip_type(IP_GET_TYPE(&s->ctrl_pcb->remote_ip));
+  if (newpcb == NULL) {
+    return lwiperf3_close(s, LWIPERF_TCP_ABORTED_LOCAL);
+  }
+  s->data_pcb = newpcb;
+  tcp_arg(newpcb, s);
+  tcp_recv(newpcb, lwiperf3_data_recv);
+  tcp_sent(newpcb, lwiperf3_data_sent);
+  tcp_poll(newpcb, lwiperf3_data_poll, 2U);
+  tcp_err(newpcb, lwiperf3_data_err);
+
+  ip_addr_copy(remote_addr, s->ctrl_pcb->remote_ip);
+  err = tcp_connect(newpcb, &remote_addr, s->ctrl_pcb->remote_port, lwiperf3_data_connected);
+  if (err != ERR_OK) {
+    return lwiperf3_close(s, LWIPERF_TCP_ABORTED_LOCAL);
+  }
+  return ERR_OK;
+}
+
+/** Handle a test state received on the control connection */
+static err_t
+lwiperf3_ctrl_state(lwiperf3_session_t *s, s8_t state)
+{
+  err_t err = ERR_OK;
+
+  if (s->listener != NULL) {
+    /* server side: states sent by the client */
+    switch (state) {
+      case LWIPERF3_TEST_END:
+        s->running = 0;
+        s->time_ended = sys_now();
+        err = lwiperf3_send_state(s, LWIPERF3_EXCHANGE_RESULTS);
+        /* the client sends its results first */
+        s->rx_phase = LWIPERF3_RX_JSON_LEN;
+        break;
+      case LWIPERF3_IPERF_DONE:
+        return lwiperf3_close(s, LWIPERF_TCP_DONE_SERVER);
+      case LWIPERF3_CLIENT_TERMINATE:
+        return lwiperf3_close(s, LWIPERF_TCP_ABORTED_REMOTE);
+      default:
+        break;
+    }
+  } else {
+    /* client side: states sent by the server */
+    s->state = state;
+    switch (state) {
+      case LWIPERF3_PARAM_EXCHANGE:
+        err = lwiperf3_client_params(s);
+        break;
+      case LWIPERF3_CREATE_STREAMS:
+        return lwiperf3_client_create_stream(s);
+      case LWIPERF3_TEST_RUNNING:
+        return lwiperf3_test_running(s);
+      case LWIPERF3_EXCHANGE_RESULTS:
+        err = lwiperf3_send_results(s);
+        /* then the server sends its results */
+        s->rx_phase = LWIPERF3_RX_JSON_LEN;
+        break;
+      case LWIPERF3_DISPLAY_RESULTS:
+        lwiperf3_send_state(s, LWIPERF3_IPERF_DONE);
+        return lwiperf3_close(s, LWIPERF_TCP_DONE_CLIENT);
+      case LWIPERF3_SERVER_ERROR:
+        /* iperf3 error code and errno follow */
+        s->rx_phase = LWIPERF3_RX_ERROR;
+        s->rx_pos = 0;
+        break;
+      case LWIPERF3_SERVER_TERMINATE:
+      case LWIPERF3_ACCESS_DENIED:
+        return lwiperf3_close(s, LWIPERF_TCP_ABORTED_REMOTE);
+      default:
+        break;
+    }
+  }
+  if (err != ERR_OK) {
+    return lwiperf3_close(s, LWIPERF_TCP_ABORTED_LOCAL);
+  }
+  return ERR_OK;
+}
+
+/** Handle a complete JSON string received on the control connection */
+static err_t
+lwiperf3_ctrl_json(lwiperf3_session_t *s)
+{
+  err_t err;
+
+  s->rx_phase = LWIPERF3_RX_STATE;
+  if (s->listener == NULL) {
+    /* results of the server, not used */
+    return ERR_OK;
+  }
+  if (s->state == LWIPERF3_PARAM_EXCHANGE) {
+    return lwiperf3_server_params(s);
+  }
+  if (s->state == LWIPERF3_EXCHANGE_RESULTS) {
+    err = lwiperf3_send_results(s);
+    if (err == ERR_OK) {
+      err = lwiperf3_send_state(s, LWIPERF3_DISPLAY_RESULTS);
+    }
+    if (err != ERR_OK) {
+      return lwiperf3_close(s, LWIPERF_TCP_ABORTED_LOCAL);
+    }
+  }
+  return ERR_OK;
+}
+
+/** Process one byte received on the control connection
+ * @return ERR_OK to go on, another value if the session has been closed */
+static err_t
+lwiperf3_ctrl_input(lwiperf3_session_t *s, u8_t c)
+{
+  switch (s->rx_phase) {
+    case LWIPERF3_RX_COOKIE:
+      s->cookie[s->rx_pos++] = (char)c;
+      if (s->rx_pos == LWIPERF3_COOKIE_SIZE) {
+        s->cookie[LWIPERF3_COOKIE_SIZE - 1] = '\0';
+        s->rx_phase = LWIPERF3_RX_JSON_LEN;
+        s->rx_pos = 0;
+        if (lwiperf3_send_state(s, LWIPERF3_PARAM_EXCHANGE) != ERR_OK) {
+          return lwiperf3_close(s, LWIPERF_TCP_ABORTED_LOCAL);
+        }
+      }
+      break;
+
+    case LWIPERF3_RX_STATE:
+      return lwiperf3_ctrl_state(s, (s8_t)c);
+
+    case LWIPERF3_RX_JSON_LEN:
+      s->rx_buf[s->rx_pos++] = c;
+      if (s->rx_pos == 4) {
+        s->rx_pos = 0;
+        s->json_len = ((u32_t)s->rx_buf[0] << 24) | ((u32_t)s->rx_buf[1] << 16)
+                      | ((u32_t)s->rx_buf[2] << 8) | s->rx_buf[3];
+        s->json_pos = 0;
+        s->json[0] = '\0';
+        if (s->json_len == 0) {
+          return lwiperf3_ctrl_json(s);
+        }
+        s->rx_phase = LWIPERF3_RX_JSON;
+      }
+      break;
+
+    case LWIPERF3_RX_JSON:
+      if (s->json_pos < sizeof(s->json) - 1) {
+        s->json[s->json_pos] = (char)c;
+        s->json[s->json_pos + 1] = '\0';
+      }
+      if (++s->json_pos == s->json_len) {
+        return lwiperf3_ctrl_json(s);
+      }
+      break;
+
+    case LWIPERF3_RX_ERROR:
+      s->rx_buf[s->rx_pos++] = c;
+      if (s->rx_pos == 8) {
+        printf("iperf3 server error %d\r\n",
+               (int)(((u32_t)s->rx_buf[0] << 24) | ((u32_t)s->rx_buf[1] << 16)
+                     | ((u32_t)s->rx_buf[2] << 8) | s->rx_buf[3]));
+        return lwiperf3_close(s, LWIPERF_TCP_ABORTED_REMOTE);
+      }
+      break;
+
+    default:
+      break;
+  }
+  return ERR_OK;
+}
+
+/** Receive data on the control connection */
+static err_t
+lwiperf3_ctrl_recv(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err)
+{
+  u16_t i;
+  err_t ret;
+  struct pbuf *q;
+  lwiperf3_session_t *s = (lwiperf3_session_t *)arg;
+
+  LWIP_ASSERT("pcb mismatch", s->ctrl_pcb == tpcb);
+
+  if ((err != ERR_OK) || (p == NULL)) {
+    if (p != NULL) {
+      pbuf_free(p);
+    }
+    return lwiperf3_cb_ret(lwiperf3_close(s, LWIPERF_TCP_ABORTED_REMOTE));
+  }
+  s->poll_count = 0;
+  tcp_recved(tpcb, p->tot_len);
+
+  for (q = p; q != NULL; q = q->next) {
+    for (i = 0; i < q->len; i++) {
+      ret = lwiperf3_ctrl_input(s, ((u8_t *)q->payload)[i]);
+      if (ret != ERR_OK) {
+        /* the session is gone */
+        pbuf_free(p);
+        return lwiperf3_cb_ret(ret);
+      }
+    }
+  }
+  pbuf_free(p);
+  return ERR_OK;
+}
+
+/** TCP poll callback of the control connection: end time-limited tests on
+    the client side and abort stalled sessions */
+static err_t
+lwiperf3_ctrl_poll(void *arg, struct tcp_pcb *tpcb)
+{
+  lwiperf3_session_t *s = (lwiperf3_session_t *)arg;
+  LWIP_ASSERT("pcb mismatch", s->ctrl_pcb == tpcb);
+
+  if (++s->poll_count >= LWIPERF3_TCP_MAX_IDLE_SEC) {
+    return lwiperf3_cb_ret(lwiperf3_close(s, LWIPERF_TCP_ABORTED_LOCAL));
+  }
+  if ((s->listener == NULL) && s->running && lwiperf3_test_is_over(s)) {
+    return lwiperf3_cb_ret(lwiperf3_client_test_end(s));
+  }
+  return ERR_OK;
+}
+
+/** Error callback of the control connection */
+static void
+lwiperf3_ctrl_err(void *arg, err_t err)
+{
+  lwiperf3_session_t *s = (lwiperf3_session_t *)arg;
+  LWIP_UNUSED_ARG(err);
+
+  /* the pcb is already freed */
+  s->ctrl_pcb = NULL;
+  lwiperf3_close(s, LWIPERF_TCP_ABORTED_REMOTE);
+}
+
+/** Client side: the control connection is established, send the cookie */
+static err_t
+lwiperf3_ctrl_connected(void *arg, struct tcp_pcb *tpcb, err_t err)
+{
+  lwiperf3_session_t *s = (lwiperf3_session_t *)arg;
+  LWIP_ASSERT("pcb mismatch", s->ctrl_pcb == tpcb);
+
+  if (err == ERR_OK) {
+    lwiperf3_set_endpoints(s, tpcb);
+    err = tcp_write(tpcb, s->cookie, LWIPERF3_COOKIE_SIZE, TCP_WRITE_FLAG_COPY);
+  }
+  if (err != ERR_OK) {
+    return lwiperf3_cb_ret(lwiperf3_close(s, LWIPERF_TCP_ABORTED_REMOTE));
+  }
+  s->poll_count = 0;
+  tcp_output(tpcb);
+  return ERR_OK;
+}
+
+/** Receive data on the data connection */
+static err_t
+lwiperf3_data_recv(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err)
+{
+  u16_t offset = 0;
+  u16_t tot_len;
+  lwiperf3_session_t *s = (lwiperf3_session_t *)arg;
+
+  LWIP_ASSERT("pcb mismatch", s->data_pcb == tpcb);
+
+  if (err != ERR_OK) {
+    if (p != NULL) {
+      pbuf_free(p);
+    }
+    return lwiperf3_cb_ret(lwiperf3_close(s, LWIPERF_TCP_ABORTED_REMOTE));
+  }
+  if (p == NULL) {
+    /* stream closed by the peer, the end of the test comes on the
+       control connection */
+    s->data_pcb = NULL;
+    return lwiperf3_pcb_close(tpcb);
+  }
+  tot_len = p->tot_len;
+  s->poll_count = 0;
+
+  if ((s->listener != NULL) && (s->data_cookie_pos < LWIPERF3_COOKIE_SIZE)) {
+    /* a stream starts with the cookie of its test */
+    while ((offset < tot_len) && (s->data_cookie_pos < LWIPERF3_COOKIE_SIZE)) {
+      if (pbuf_get_at(p, offset) != (u8_t)s->cookie[s->data_cookie_pos]) {
+        /* not a stream of this test */
+        pbuf_free(p);
+        s->data_pcb = NULL;
+        return lwiperf3_pcb_close(tpcb);
+      }
+      offset++;
+      s->data_cookie_pos++;
+    }
+    if (s->data_cookie_pos == LWIPERF3_COOKIE_SIZE) {
+      lwiperf3_set_endpoints(s, tpcb);
+      if ((lwiperf3_send_state(s, LWIPERF3_TEST_START) != ERR_OK)
+          || (lwiperf3_send_state(s, LWIPERF3_TEST_RUNNING) != ERR_OK)) {
+        pbuf_free(p);
+        return lwiperf3_cb_ret(lwiperf3_close(s, LWIPERF_TCP_ABORTED_LOCAL));
+      }
+      err = lwiperf3_test_running(s);
+      if (err != ERR_OK) {
+        pbuf_free(p);
+        return lwiperf3_cb_ret(err);
+      }
+    }
+  }
+  if (s->running && !s->sender) {
+    s->bytes_transferred += (u32_t)(tot_len - offset);
+  }
+  tcp_recved(tpcb, tot_len);
+  pbuf_free(p);
+
+  if ((s->listener == NULL) && s->running && !s->sender && lwiperf3_test_is_over(s)) {
+    return lwiperf3_cb_ret(lwiperf3_client_test_end(s));
+  }
+  return ERR_OK;
+}
+
+/** TCP sent callback of the data connection, try to send more data */
+static err_t
+lwiperf3_data_sent(void *arg, struct tcp_pcb *tpcb, u16_t len)
+{
+  lwiperf3_session_t *s = (lwiperf3_session_t *)arg;
+  LWIP_ASSERT("pcb mismatch", s->data_pcb == tpcb);
+  LWIP_UNUSED_ARG(tpcb);
+  LWIP_UNUSED_ARG(len);
+
+  s->poll_count = 0;
+  return lwiperf3_cb_ret(lwiperf3_send_data(s));
+}
+
+/** TCP poll callback of the data connection, sample the connection and
+    try to send more data */
+static err_t
+lwiperf3_data_poll(void *arg, struct tcp_pcb *tpcb)
+{
+  lwiperf3_session_t *s = (lwiperf3_session_t *)arg;
+  LWIP_ASSERT("pcb mismatch", s->data_pcb == tpcb);
+
+  if (s->running) {
+    lwiperf_tcp_sample(&s->sampler, tpcb, sys_now() - s->time_started,
+                       s->bytes_transferred);
+  }
+
+  return lwiperf3_cb_ret(lwiperf3_send_data(s));
+}
+
+/** Error callback of the data connection */
+static void
+lwiperf3_data_err(void *arg, err_t err)
+{
+  lwiperf3_session_t *s = (lwiperf3_session_t *)arg;
+  LWIP_UNUSED_ARG(err);
+
+  /* the pcb is already freed */
+  s->data_pcb = NULL;
+  if (s->running) {
+    lwiperf3_close(s, LWIPERF_TCP_ABORTED_REMOTE);
+  }
+}
+
+/** Allocate and initialize a session */
+static lwiperf3_session_t *
+lwiperf3_session_new(lwiperf_report_fn report_fn, void *report_arg)
+{
+  lwiperf3_session_t *s;
+
+  s = (lwiperf3_session_t *)LWIPERF3_ALLOC(lwiperf3_session_t);
+  if (s == NULL) {
+    return NULL;
+  }
+  memset(s, 0, sizeof(lwiperf3_session_t));
+  s->report_fn = report_fn;
+  s->report_arg = report_arg;
+  s->time_started = sys_now();
+  s->time_ended = s->time_started;
+  return s;
+}
+
+/** This is called when an iperf3 client connects, for the control or the
+    data connection of a test */
+static err_t
+lwiperf3_tcp_accept(void *arg, struct tcp_pcb *newpcb, err_t err)
+{
+  s8_t denied = LWIPERF3_ACCESS_DENIED;
+  lwiperf3_listener_t *l = (lwiperf3_listener_t *)arg;
+  lwiperf3_session_t *s;
+
+  if ((err != ERR_OK) || (newpcb == NULL) || (l == NULL)) {
+    return ERR_VAL;
+  }
+
+  s = l->session;
+  if (s == NULL) {
+    /* new test: this is its control connection. Like lwiperf, the test
+       reports don't carry the argument of the server */
+    s = lwiperf3_session_new(l->report_fn, NULL);
+    if (s == NULL) {
+      return ERR_MEM;
+    }
+    s->listener = l;
+    s->sampler.fn = l->sampler.fn;
+    s->sampler.arg = l->sampler.arg;
+    s->ctrl_pcb = newpcb;
+    s->rx_phase = LWIPERF3_RX_COOKIE;
+    lwiperf3_set_endpoints(s, newpcb);
+    l->session = s;
+
+    tcp_arg(newpcb, s);
+    tcp_recv(newpcb, lwiperf3_ctrl_recv);
+    tcp_poll(newpcb, lwiperf3_ctrl_poll, 2U);
+    tcp_err(newpcb, lwiperf3_ctrl_err);
+    lwiperf3_list_add(&s->base);
+    return ERR_OK;
+  }
+
+  if ((s->state == LWIPERF3_CREATE_STREAMS) && (s->data_pcb == NULL)) {
+    /* expected stream, checked against the cookie on reception */
+    s->data_pcb = newpcb;
+    s->data_cookie_pos = 0;
+    tcp_arg(newpcb, s);
+    tcp_recv(newpcb, lwiperf3_data_recv);
+    tcp_sent(newpcb, lwiperf3_data_sent);
+    tcp_poll(newpcb, lwiperf3_data_poll, 2U);
+    tcp_err(newpcb, lwiperf3_data_err);
+    return ERR_OK;
+  }
+
+  /* a test is already running */
+  tcp_write(newpcb, &denied, 1, TCP_WRITE_FLAG_COPY);
+  if (tcp_close(newpcb) != ERR_OK) {
+    tcp_abort(newpcb);
+    return ERR_ABRT;
+  }
+  return ERR_OK;
+}
+
+/**
+ * @ingroup iperf
+ * Initialize the pool of the listeners and sessions, from the tcpip thread
+ * before any test is started.
+ */
+void
+lwiperf3_init(void)
+{
+  LWIP_MEMPOOL_INIT(LWIPERF3_STATE);
+}
+
+/**
+ * @ingroup iperf
+ * Start a TCP iperf3 server on a specific IP address and port and listen for
+ * incoming connections from iperf3 clients.
+ *
+ * @returns a connection handle that can be used to abort the server
+ *          by calling @ref lwiperf3_abort()
+ */
+void *
+lwiperf3_start_tcp_server(const ip_addr_t *local_addr, u16_t local_port,
+                          lwiperf_report_fn report_fn, void *report_arg)
+{
+  err_t err;
+  struct tcp_pcb *pcb;
+  lwiperf3_listener_t *l;
+
+  LWIP_ASSERT_CORE_LOCKED();
+
+  if (local_addr == NULL) {
+    return NULL;
+  }
+
+  l = (lwiperf3_listener_t *)LWIPERF3_ALLOC(lwiperf3_listener_t);
+  if (l == NULL) {
+    return NULL;
+  }
+  memset(l, 0, sizeof(lwiperf3_listener_t));
+  l->base.listener = 1;
+  l->report_fn = report_fn;
+  l->report_arg = report_arg;
+
+  pcb = tcp_new_ip_type(LWIPERF3_SERVER_IP_TYPE);
+  if (pcb == NULL) {
+    LWIPERF3_FREE(lwiperf3_listener_t, l);
+    return NULL;
+  }
+  err = tcp_bind(pcb, local_addr, local_port);
+  if (err != ERR_OK) {
+    printf("Bind error %d\r\n", err);
+    tcp_close(pcb);
+    LWIPERF3_FREE(lwiperf3_listener_t, l);
+    return NULL;
+  }
+  /* room for the data connection while the control one is accepted */
+  l->server_pcb = tcp_listen_with_backlog(pcb, 2);
+  if (l->server_pcb == NULL) {
+    tcp_close(pcb);
+    LWIPERF3_FREE(lwiperf3_listener_t, l);
+    return NULL;
+  }
+
+  tcp_arg(l->server_pcb, l);
+  tcp_accept(l->server_pcb, lwiperf3_tcp_accept);
+
+  lwiperf3_list_add(&l->base);
+  return l;
+}
+
+/**
+ * @ingroup iperf
+ * Start a TCP iperf3 client to a specific IP address and port.
+ *
+ * @param duration_sec test duration, used when amount_bytes is 0
+ * @param amount_bytes number of bytes to transfer (iperf3 '-n'), 0 for a
+ *                     time-limited test
+ * @param buffer_len size of each write (iperf3 '-l'), 0 for TCP_MSS
+ * @param reverse 1 to let the server send the data (iperf3 '-R')
+ *
+ * @returns a connection handle that can be used to abort the client
+ *          by calling @ref lwiperf3_abort()
+ */
+void *
+lwiperf3_start_tcp_client(const ip_addr_t *remote_addr, u16_t remote_port,
+                          u32_t duration_sec, u32_t amount_bytes,
+                          u32_t buffer_len, u8_t reverse,
+                          lwiperf_report_fn report_fn, void *report_arg)
+{
+  /* iperf3 cookie characters */
+  static const char cookie_chars[] = "abcdefghijklmnopqrstuvwxyz234567";
+  static u32_t rand_state;
+  err_t err;
+  u8_t i;
+  lwiperf3_session_t *s;
+  struct tcp_pcb *pcb;
+  ip_addr_t addr;
+
+  LWIP_ASSERT_CORE_LOCKED();
+
+  if ((remote_addr == NULL) || (amount_bytes & 0x80000000)) {
+    return NULL;
+  }
+
+  s = lwiperf3_session_new(report_fn, report_arg);
+  if (s == NULL) {
+    return NULL;
+  }
+  pcb = tcp_new_ip_type(IP_GET_TYPE(remote_addr));
+  if (pcb == NULL) {
+    LWIPERF3_FREE(lwiperf3_session_t, s);
+    return NULL;
+  }
+  s->ctrl_pcb = pcb;
+  s->rx_phase = LWIPERF3_RX_STATE;
+  s->sender = !reverse;
+  s->duration_ms = duration_sec * 1000;
+  s->amount_bytes = amount_bytes;
+  s->buffer_len = buffer_len;
+  ip_addr_copy(s->remote_addr, *remote_addr);
+  s->remote_port = remote_port;
+
+  /* the cookie only has to be unique among the server's tests */
+  rand_state ^= sys_now();
+  for (i = 0; i < LWIPERF3_COOKIE_SIZE - 1; i++) {
+    rand_state = rand_state * 1103515245U + 12345U;
+    s->cookie[i] = cookie_chars[(rand_state >> 16) % (sizeof(cookie_chars) - 1)];
+  }
+  s->cookie[LWIPERF3_COOKIE_SIZE - 1] = '\0';
+
+  tcp_arg(pcb, s);
+  tcp_recv(pcb, lwiperf3_ctrl_recv);
+  tcp_poll(pcb, lwiperf3_ctrl_poll, 2U);
+  tcp_err(pcb, lwiperf3_ctrl_err);
+
+  ip_addr_copy(addr, *remote_addr);
+  err = tcp_connect(pcb, &addr, remote_port, lwiperf3_ctrl_connected);
+  if (err != ERR_OK) {
+    s->report_fn = NULL;
+    lwiperf3_close(s, LWIPERF_TCP_ABORTED_LOCAL);
+    return NULL;
+  }
+  lwiperf3_list_add(&s->base);
+  return s;
+}
+
+/**
+ * @ingroup iperf
+ * Register a function receiving a sample of the data connection internals of
+ * a session on every poll (every second), NULL to stop sampling. For a
+ * server, the function applies to its running and next tests.
+ */
+void
+lwiperf3_set_tcp_sample_fn(void *lwiperf3_session,
+                           lwiperf_tcp_sample_fn sample_fn, void *sample_arg)
+{
+  lwiperf3_state_base_t *iter;
+  lwiperf3_listener_t *l;
+  lwiperf3_session_t *s = NULL;
+
+  LWIP_ASSERT_CORE_LOCKED();
+
+  for (iter = lwiperf3_all_states; iter != NULL; iter = iter->next) {
+    if (iter == lwiperf3_session) {
+      break;
+    }
+  }
+  if (iter == NULL) {
+    return;
+  }
+
+  if (iter->listener) {
+    l = (lwiperf3_listener_t *)iter;
+    l->sampler.fn = sample_fn;
+    l->sampler.arg = sample_arg;
+    s = l->session;
+  } else {
+    s = (lwiperf3_session_t *)iter;
+  }
+  if (s != NULL) {
+    s->sampler.fn = sample_fn;
+    s->sampler.arg = sample_arg;
+  }
+}
+
+/**
+ * @ingroup iperf
+ * Abort an iperf3 session (handle returned by lwiperf3_start_tcp_server*()
+ * or lwiperf3_start_tcp_client*())
+ */
+void
+lwiperf3_abort(void *lwiperf3_session)
+{
+  lwiperf3_state_base_t *iter;
+  lwiperf3_listener_t *l;
+  lwiperf3_session_t *s;
+
+  LWIP_ASSERT_CORE_LOCKED();
+
+  for (iter = lwiperf3_all_states; iter != NULL; iter = iter->next) {
+    if (iter == lwiperf3_session) {
+      break;
+    }
+  }
+  if (iter == NULL) {
+    /* already closed */
+    return;
+  }
+
+  if (iter->listener) {
+    l = (lwiperf3_listener_t *)iter;
+    if (l->session != NULL) {
+      s = l->session;
+      if (s->ctrl_pcb != NULL) {
+        lwiperf3_send_state(s, LWIPERF3_SERVER_TERMINATE);
+      }
+      lwiperf3_close(s, LWIPERF_TCP_ABORTED_LOCAL);
+    }
+    lwiperf3_list_remove(&l->base);
+    if (l->report_fn != NULL) {
+      /* like lwiperf, the listener reports once it is stopped */
+      l->report_fn(l->report_arg, LWIPERF_TCP_ABORTED_LOCAL,
+                   IP_ADDR_ANY, 0, IP_ADDR_ANY, 0, 0, 0, 0);
+    }
+    tcp_close(l->server_pcb);
+    LWIPERF3_FREE(lwiperf3_listener_t, l);
+  } else {
+    s = (lwiperf3_session_t *)iter;
+    if ((s->ctrl_pcb != NULL) && (s->state != 0)) {
+      lwiperf3_send_state(s, LWIPERF3_CLIENT_TERMINATE);
+    }
+    lwiperf3_close(s, LWIPERF_TCP_ABORTED_LOCAL);
+  }
+}
+
+#endif /* LWIP_TCP && LWIP_CALLBACK_API */
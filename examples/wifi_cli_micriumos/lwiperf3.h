@@ -0,0 +1,53 @@
+/***************************************************************************//**
+ * @file
+ * @brief iPerf3 protocol server and client on top of the lwIP raw TCP API
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+#ifndef LWIPERF3_H
+#define LWIPERF3_H
+
+#include "lwip/opt.h"
+#include "lwip/ip_addr.h"
+#include "lwip/memp.h"
+#include "lwiperf.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LWIPERF3_TCP_PORT_DEFAULT  5201
+
+/* Pool of the listeners and sessions, for its usage statistics */
+LWIP_MEMPOOL_PROTOTYPE(LWIPERF3_STATE);
+
+void  lwiperf3_init(void);
+
+/* Test results are reported through the lwiperf report function, with the
+ * same report types as the iperf2 sessions. */
+void* lwiperf3_start_tcp_server(const ip_addr_t* local_addr, u16_t local_port,
+                                lwiperf_report_fn report_fn, void* report_arg);
+void* lwiperf3_start_tcp_client(const ip_addr_t* remote_addr, u16_t remote_port,
+                                u32_t duration_sec, u32_t amount_bytes,
+                                u32_t buffer_len, u8_t reverse,
+                                lwiperf_report_fn report_fn, void* report_arg);
+
+void  lwiperf3_set_tcp_sample_fn(void* lwiperf3_session,
+                                 lwiperf_tcp_sample_fn sample_fn, void* sample_arg);
+void  lwiperf3_abort(void* lwiperf3_session);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LWIPERF3_H */
@@ -0,0 +1,130 @@
+/***************************************************************************//**
+ * @file
+ * @brief Host microbenchmark of the checksum on copy
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************
+ *
+ * Measures the cycles per byte of a copy followed by its checksum
+ * (memcpy() + chksum_fast(), "separate") against chksum_copy() ("fused"),
+ * for the segment sizes lwIP copies. The buffers stay in the cache, so the
+ * figures are the lower bound of the target, where the copy reads RAM.
+ * From this directory:
+ *
+ *   gcc -std=gnu99 -O2 -Wall -Wextra -I../../lwip_host \
+ *       chksum_bench.c ../../lwip_host/chksum.c \
+ *       -o chksum_bench && ./chksum_bench
+ *
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "chksum.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAS_TSC  1
+#else
+#define BENCH_HAS_TSC  0
+#endif
+
+#define BENCH_BUF_LEN     2048
+#define BENCH_MIN_BYTES   (64u * 1024u * 1024u) ///< Bytes summed per run
+#define BENCH_RUNS        5                     ///< Best run kept
+
+static const int bench_lens[] = { 64, 256, 536, 1460 };
+
+/* 64-bit aligned, a source & destination offset is added to them */
+static uint64_t bench_src[BENCH_BUF_LEN / 8 + 1];
+static uint64_t bench_dst[BENCH_BUF_LEN / 8 + 1];
+
+/* Keeps the sums alive */
+static volatile uint16_t bench_sink;
+
+/* Cycle counter, or nanoseconds where there is no TSC */
+static uint64_t bench_now(void)
+{
+#if BENCH_HAS_TSC
+  return __rdtsc();
+#else
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+static double bench_run(int fused, int len, int src_off, int dst_off)
+{
+  uint8_t *src = (uint8_t *)bench_src + src_off;
+  uint8_t *dst = (uint8_t *)bench_dst + dst_off;
+  uint32_t i, iterations = BENCH_MIN_BYTES / (uint32_t)len;
+  uint64_t start, best = UINT64_MAX;
+  uint16_t sum = 0;
+  int run;
+
+  for (run = 0; run < BENCH_RUNS; run++) {
+      start = bench_now();
+      if (fused) {
+          for (i = 0; i < iterations; i++) {
+              sum += chksum_copy(dst, src, len);
+          }
+      } else {
+          for (i = 0; i < iterations; i++) {
+              memcpy(dst, src, len);
+              sum += chksum_fast(dst, len);
+          }
+      }
+      start = bench_now() - start;
+      if (start < best) {
+          best = start;
+      }
+  }
+  bench_sink = sum;
+  return (double)best / ((double)iterations * len);
+}
+
+int main(void)
+{
+  uint32_t i;
+  int l, src_off, dst_off;
+  double separate, fused;
+
+  for (i = 0; i < sizeof(bench_src); i++) {
+      ((uint8_t *)bench_src)[i] = (uint8_t)rand();
+  }
+
+  printf("%s per byte, best of %d runs\n",
+         BENCH_HAS_TSC ? "TSC cycles" : "ns", BENCH_RUNS);
+  printf("%6s %4s %4s %9s %9s %7s\n",
+         "len", "src", "dst", "separate", "fused", "gain%");
+  for (l = 0; l < (int)(sizeof(bench_lens) / sizeof(bench_lens[0])); l++) {
+      /* Aligned, then the 2-byte offset of a TCP payload after 14 + 40 bytes
+       * of headers, then an odd destination */
+      for (src_off = 0; src_off <= 2; src_off += 2) {
+          for (dst_off = 0; dst_off <= src_off + 1; dst_off += src_off + 1) {
+              separate = bench_run(0, bench_lens[l], src_off, dst_off);
+              fused = bench_run(1, bench_lens[l], src_off, dst_off);
+              printf("%6d %4d %4d %9.3f %9.3f %6.1f%%\n",
+                     bench_lens[l], src_off, dst_off, separate, fused,
+                     100.0 * (separate - fused) / separate);
+          }
+      }
+  }
+  return EXIT_SUCCESS;
+}
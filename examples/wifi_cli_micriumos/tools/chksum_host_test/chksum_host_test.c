@@ -0,0 +1,137 @@
+/***************************************************************************//**
+ * @file
+ * @brief Host test of the 32-bit word Internet checksum
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************
+ *
+ * chksum_fast() & chksum_copy() are compared with chksum_ref() for every
+ * start alignment within a 64-bit word & every length up to a jumbo frame,
+ * over random, all-ones & all-zeros data. chksum_copy() writes to another
+ * alignment, its copy is compared too. From this directory:
+ *
+ *   gcc -std=gnu99 -O2 -Wall -Wextra -I../../lwip_host \
+ *       chksum_host_test.c ../../lwip_host/chksum.c \
+ *       -o chksum_host_test && ./chksum_host_test
+ *
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "chksum.h"
+
+#define TEST_MAX_ALIGN    8      ///< Start offsets tested
+#define TEST_MAX_LEN      9018   ///< Jumbo frame payload + headers
+#define TEST_LARGE_LEN    65535  ///< Largest IPv4 datagram
+
+typedef enum {
+  FILL_RANDOM,
+  FILL_ONES,
+  FILL_ZEROS,
+  FILL_NB
+} test_fill_t;
+
+static const char *const test_fill_names[FILL_NB] = {
+  "random", "all-ones", "all-zeros"
+};
+
+/* 64-bit aligned, with room for the start offset */
+static uint64_t test_buf[(TEST_LARGE_LEN + TEST_MAX_ALIGN) / 8 + 1];
+static uint64_t test_copy[(TEST_MAX_LEN + TEST_MAX_ALIGN) / 8 + 1];
+
+static void test_fill(uint8_t *buf, int len, test_fill_t fill)
+{
+  int i;
+
+  for (i = 0; i < len; i++) {
+      switch (fill) {
+        case FILL_RANDOM:
+          buf[i] = (uint8_t)rand();
+          break;
+        case FILL_ONES:
+          buf[i] = 0xFF;
+          break;
+        default:
+          buf[i] = 0;
+          break;
+      }
+  }
+}
+
+static int test_range(int max_len, test_fill_t fill)
+{
+  uint8_t *base = (uint8_t *)test_buf;
+  uint8_t *copy;
+  uint16_t fast, ref, fused;
+  int align, len, mismatches = 0;
+
+  test_fill(base, sizeof(test_buf), fill);
+  for (align = 0; align < TEST_MAX_ALIGN; align++) {
+      /* Every source alignment meets several destination alignments */
+      copy = (uint8_t *)test_copy + ((align * 3) % TEST_MAX_ALIGN);
+      for (len = 0; len <= max_len; len++) {
+          fast = chksum_fast(base + align, len);
+          ref = chksum_ref(base + align, len);
+          memset(copy, 0xA5, len + 1);
+          fused = chksum_copy(copy, base + align, len);
+          if ((fast != ref) || (fused != ref)
+              || (memcmp(copy, base + align, len) != 0)
+              || (copy[len] != 0xA5)) {
+              if (mismatches++ < 10) {
+                  printf("%s: align %d len %d: fast 0x%04x copy 0x%04x "
+                         "ref 0x%04x\n",
+                         test_fill_names[fill], align, len, fast, fused, ref);
+              }
+          }
+      }
+  }
+  return mismatches;
+}
+
+/* The carries of the largest datagram, at each alignment */
+static int test_large(void)
+{
+  uint8_t *base = (uint8_t *)test_buf;
+  int align, mismatches = 0;
+
+  test_fill(base, sizeof(test_buf), FILL_ONES);
+  for (align = 0; align < TEST_MAX_ALIGN; align++) {
+      if (chksum_fast(base + align, TEST_LARGE_LEN)
+          != chksum_ref(base + align, TEST_LARGE_LEN)) {
+          printf("all-ones: align %d len %d: mismatch\n",
+                 align, TEST_LARGE_LEN);
+          mismatches++;
+      }
+  }
+  return mismatches;
+}
+
+int main(void)
+{
+  int fill, mismatches = 0;
+
+  srand(1);
+  for (fill = 0; fill < FILL_NB; fill++) {
+      mismatches += test_range(TEST_MAX_LEN, (test_fill_t)fill);
+  }
+
+  mismatches += test_large();
+
+  printf("chksum_host_test: %d mismatches, %s\n",
+         mismatches, (mismatches == 0) ? "PASSED" : "FAILED");
+  return (mismatches == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,849 @@
+/***************************************************************************//**
+ * @file
+ * @brief Host test of the iperf3 protocol of lwiperf3 against iperf3 exchanges
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ *******************************************************************************
+ *
+ * lwiperf3.c is built on Linux against a stand-in of the lwIP raw TCP API.
+ * The control connections of iperf3 3.9 clients & servers are replayed
+ * against it, in both directions, and what lwiperf3 answers is checked
+ * against what iperf3 expects: the test states, a JSON iperf3 can parse with
+ * the keys it requires, and a byte stream still in sync after a JSON string
+ * longer than LWIPERF3_JSON_BUF_SIZE. From this directory:
+ *
+ *   gcc -std=gnu99 -Wall -Wextra -Istubs -I../.. lwiperf3_host_test.c \
+ *       -o lwiperf3_host_test && ./lwiperf3_host_test [client_ctrl.bin]
+ *
+ * The exchanges below follow the messages of iperf3 3.9 (iperf_api.c,
+ * send_parameters() & send_results()). To check another iperf3 version,
+ * capture a test of its client against the device and save the bytes the
+ * client sent on the control connection, the first TCP connection to port
+ * 5201 (Wireshark: Follow TCP Stream, client side only, Raw, Save as). The
+ * file given as argument is replayed against the lwiperf3 server.
+ *
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+/* The unit under test, its static functions included */
+#include "lwiperf3.c"
+
+/*******************************************************************************
+ *****************************   lwIP stand-in   *******************************
+ ******************************************************************************/
+#define TEST_MAX_PCBS       32
+#define TEST_SND_BUF        (4 * TCP_MSS)
+
+const ip_addr_t ip_addr_any = { 0, IPADDR_TYPE_ANY };
+
+static struct tcp_pcb test_pcbs[TEST_MAX_PCBS];
+static uint32_t test_pcb_count;
+static u32_t test_now_ms = 1000;
+
+u32_t sys_now(void)
+{
+  return test_now_ms;
+}
+
+struct tcp_pcb *tcp_new_ip_type(u8_t type)
+{
+  struct tcp_pcb *pcb;
+
+  (void)type;
+  if (test_pcb_count >= TEST_MAX_PCBS) {
+      return NULL;
+  }
+  pcb = &test_pcbs[test_pcb_count++];
+  memset(pcb, 0, sizeof(*pcb));
+  pcb->in_use = 1;
+  pcb->snd_buf = TEST_SND_BUF;
+  return pcb;
+}
+
+err_t tcp_bind(struct tcp_pcb *pcb, const ip_addr_t *ipaddr, u16_t port)
+{
+  pcb->local_ip = *ipaddr;
+  pcb->local_port = port;
+  return ERR_OK;
+}
+
+struct tcp_pcb *tcp_listen_with_backlog(struct tcp_pcb *pcb, u8_t backlog)
+{
+  (void)backlog;
+  return pcb;
+}
+
+void tcp_accept(struct tcp_pcb *pcb, tcp_accept_fn accept)
+{
+  pcb->accept = accept;
+}
+
+err_t tcp_connect(struct tcp_pcb *pcb, const ip_addr_t *ipaddr, u16_t port,
+                  tcp_connected_fn connected)
+{
+  pcb->remote_ip = *ipaddr;
+  pcb->remote_port = port;
+  pcb->local_port = (u16_t)(50000 + test_pcb_count);
+  pcb->connected = connected;
+  return ERR_OK;
+}
+
+void tcp_arg(struct tcp_pcb *pcb, void *arg)
+{
+  pcb->callback_arg = arg;
+}
+
+void tcp_recv(struct tcp_pcb *pcb, tcp_recv_fn recv)
+{
+  pcb->recv = recv;
+}
+
+void tcp_sent(struct tcp_pcb *pcb, tcp_sent_fn sent)
+{
+  pcb->sent = sent;
+}
+
+void tcp_poll(struct tcp_pcb *pcb, tcp_poll_fn poll, u8_t interval)
+{
+  (void)interval;
+  pcb->poll = poll;
+}
+
+void tcp_err(struct tcp_pcb *pcb, tcp_err_fn err)
+{
+  pcb->errf = err;
+}
+
+err_t tcp_write(struct tcp_pcb *pcb, const void *dataptr, u16_t len,
+                u8_t apiflags)
+{
+  uint32_t copy;
+
+  (void)apiflags;
+  if (pcb->closed) {
+      return ERR_CONN;
+  }
+  if (len > pcb->snd_buf) {
+      return ERR_MEM;
+  }
+  pcb->snd_buf -= len;
+  pcb->out_total += len;
+
+  copy = TEST_TCP_OUT_MAX - pcb->out_len;
+  if (copy > len) {
+      copy = len;
+  }
+  memcpy(&pcb->out[pcb->out_len], dataptr, copy);
+  pcb->out_len += copy;
+  return ERR_OK;
+}
+
+err_t tcp_output(struct tcp_pcb *pcb)
+{
+  (void)pcb;
+  return ERR_OK;
+}
+
+void tcp_recved(struct tcp_pcb *pcb, u16_t len)
+{
+  (void)pcb;
+  (void)len;
+}
+
+err_t tcp_close(struct tcp_pcb *pcb)
+{
+  pcb->closed = 1;
+  return ERR_OK;
+}
+
+void tcp_abort(struct tcp_pcb *pcb)
+{
+  pcb->closed = 1;
+}
+
+u8_t pbuf_free(struct pbuf *p)
+{
+  (void)p;
+  return 1;
+}
+
+u8_t pbuf_get_at(const struct pbuf *p, u16_t offset)
+{
+  while ((p != NULL) && (offset >= p->len)) {
+      offset -= p->len;
+      p = p->next;
+  }
+  return (p != NULL) ? ((const u8_t *)p->payload)[offset] : 0;
+}
+
+void lwiperf_tcp_sample(struct lwiperf_tcp_sampler *sampler, struct tcp_pcb *pcb,
+                        u32_t ms_elapsed, u32_t bytes_transferred)
+{
+  (void)sampler;
+  (void)pcb;
+  (void)ms_elapsed;
+  (void)bytes_transferred;
+}
+
+/*******************************************************************************
+ *************************   iperf3 3.9 exchanges   ****************************
+ ******************************************************************************/
+/* Cookie of the tests, 36 characters of [a-z2-7] and the terminator */
+static const char test_cookie[LWIPERF3_COOKIE_SIZE] =
+  "nh4xtv7dlqgk2fjr3wpzc5mbyeo6asiu27kx";
+
+/* iperf3 -c <device> -t 10 */
+static const char test_params_upload[] =
+  "{\"tcp\":true,\"omit\":0,\"time\":10,\"parallel\":1,\"len\":131072,"
+  "\"pacing_timer\":1000,\"client_version\":\"3.9\"}";
+
+/* iperf3 -c <device> -R -n 10M -M 1400 -N -w 256K -S 16 -C cubic
+ *        --get-server-output -T <title> --extra-data <data>:
+ * longer than LWIPERF3_JSON_BUF_SIZE, the options used by lwiperf3 first */
+static const char test_params_download_long[] =
+  "{\"tcp\":true,\"omit\":0,\"time\":0,\"num\":10485760,\"MSS\":1400,"
+  "\"nodelay\":true,\"parallel\":1,\"reverse\":true,\"window\":262144,"
+  "\"len\":131072,\"pacing_timer\":1000,\"TOS\":16,"
+  "\"title\":\"wf200 station, office access point, channel 6, "
+  "low-memory profile, regression campaign of the release candidate\","
+  "\"extra_data\":\"build 2020-11-17, lwIP 2.1.2, FMAC driver 3.3.2, "
+  "firmware 3.12.2, GG11 starter kit at 72 MHz, SPI bus\","
+  "\"congestion\":\"cubic\",\"get_server_output\":1,"
+  "\"client_version\":\"3.9\"}";
+
+/* iperf3 -c <device> -P 2 */
+static const char test_params_parallel[] =
+  "{\"tcp\":true,\"omit\":0,\"time\":10,\"parallel\":2,\"len\":131072,"
+  "\"pacing_timer\":1000,\"client_version\":\"3.9\"}";
+
+/* Results of an iperf3 client, sender of the test */
+static const char test_results_client_sender[] =
+  "{\"cpu_util_total\":1.7905632495840267,"
+  "\"cpu_util_user\":0.10187069124830745,"
+  "\"cpu_util_system\":1.6886925583357193,\"sender_has_retransmits\":1,"
+  "\"congestion_used\":\"cubic\",\"streams\":[{\"id\":1,\"bytes\":101000,"
+  "\"retransmits\":0,\"jitter\":0,\"errors\":0,\"packets\":0,"
+  "\"start_time\":0,\"end_time\":10.000214}]}";
+
+/* Results of an iperf3 client, receiver of the test */
+static const char test_results_client_receiver[] =
+  "{\"cpu_util_total\":0.8790491247139645,"
+  "\"cpu_util_user\":0.049287953590624904,"
+  "\"cpu_util_system\":0.82976117112334,\"sender_has_retransmits\":-1,"
+  "\"congestion_used\":\"cubic\",\"streams\":[{\"id\":1,"
+  "\"bytes\":10485760,\"retransmits\":-1,\"jitter\":0,\"errors\":0,"
+  "\"packets\":0,\"start_time\":0,\"end_time\":8.273411}]}";
+
+/* Results of an iperf3 server, receiver of the test */
+static const char test_results_server_receiver[] =
+  "{\"cpu_util_total\":0.61842379329085,\"cpu_util_user\":0.0307813725411,"
+  "\"cpu_util_system\":0.58764242074975,\"sender_has_retransmits\":-1,"
+  "\"congestion_used\":\"cubic\",\"streams\":[{\"id\":1,\"bytes\":1226400,"
+  "\"retransmits\":-1,\"jitter\":0,\"errors\":0,\"packets\":0,"
+  "\"start_time\":0,\"end_time\":1.000671}]}";
+
+/* Keys iperf3 requires in the results (get_results()), else IERECVRESULTS */
+static const char *const test_results_keys[] = {
+  "cpu_util_total", "cpu_util_user", "cpu_util_system",
+  "sender_has_retransmits", "streams", "id", "bytes", "retransmits",
+  "jitter", "errors", "packets"
+};
+
+/*******************************************************************************
+ ********************************   Tests   ************************************
+ ******************************************************************************/
+static int failures;
+static int nb_tests;
+
+#define CHECK(cond)                                                        \
+  do {                                                                     \
+    if (!(cond)) {                                                         \
+        printf("%s:%d: FAILED: %s\n", __FILE__, __LINE__, #cond);          \
+        failures++;                                                        \
+    }                                                                      \
+  } while (0)
+
+static int test_reports;
+static enum lwiperf_report_type test_last_report;
+static u32_t test_last_bytes;
+
+static void test_report(void *arg, enum lwiperf_report_type report_type,
+                        const ip_addr_t *local_addr, u16_t local_port,
+                        const ip_addr_t *remote_addr, u16_t remote_port,
+                        u32_t bytes_transferred, u32_t ms_duration,
+                        u32_t bandwidth_kbitpsec)
+{
+  (void)arg;
+  (void)local_addr;
+  (void)local_port;
+  (void)remote_addr;
+  (void)remote_port;
+  (void)ms_duration;
+  (void)bandwidth_kbitpsec;
+  test_reports++;
+  test_last_report = report_type;
+  test_last_bytes = bytes_transferred;
+}
+
+/* JSON syntax, as strict as the cJSON parser of iperf3 */
+static const char *json_value(const char *p, int depth);
+
+static const char *json_skip_ws(const char *p)
+{
+  while ((*p == ' ') || (*p == '\t') || (*p == '\r') || (*p == '\n')) {
+      p++;
+  }
+  return p;
+}
+
+static const char *json_string(const char *p)
+{
+  if (*p++ != '"') {
+      return NULL;
+  }
+  while (*p != '"') {
+      if ((unsigned char)*p < 0x20) {
+          return NULL;
+      }
+      if ((*p == '\\') && (*++p == '\0')) {
+          return NULL;
+      }
+      p++;
+  }
+  return p + 1;
+}
+
+static const char *json_number(const char *p)
+{
+  if (*p == '-') {
+      p++;
+  }
+  if (!isdigit((unsigned char)*p)) {
+      return NULL;
+  }
+  while (isdigit((unsigned char)*p)) {
+      p++;
+  }
+  if (*p == '.') {
+      p++;
+      if (!isdigit((unsigned char)*p)) {
+          return NULL;
+      }
+      while (isdigit((unsigned char)*p)) {
+          p++;
+      }
+  }
+  return p;
+}
+
+static const char *json_value(const char *p, int depth)
+{
+  char close;
+
+  p = json_skip_ws(p);
+  if ((*p == '{') || (*p == '[')) {
+      if (depth > 8) {
+          return NULL;
+      }
+      close = (*p == '{') ? '}' : ']';
+      p = json_skip_ws(p + 1);
+      if (*p == close) {
+          return p + 1;
+      }
+      for (;;) {
+          if (close == '}') {
+              p = json_string(json_skip_ws(p));
+              if (p == NULL) {
+                  return NULL;
+              }
+              p = json_skip_ws(p);
+              if (*p++ != ':') {
+                  return NULL;
+              }
+          }
+          p = json_value(p, depth + 1);
+          if (p == NULL) {
+              return NULL;
+          }
+          p = json_skip_ws(p);
+          if (*p == close) {
+              return p + 1;
+          }
+          if (*p++ != ',') {
+              return NULL;
+          }
+      }
+  }
+  if (*p == '"') {
+      return json_string(p);
+  }
+  if (strncmp(p, "true", 4) == 0) {
+      return p + 4;
+  }
+  if (strncmp(p, "false", 5) == 0) {
+      return p + 5;
+  }
+  if (strncmp(p, "null", 4) == 0) {
+      return p + 4;
+  }
+  return json_number(p);
+}
+
+static int json_is_valid(const char *json)
+{
+  const char *p = json_value(json, 0);
+
+  return (p != NULL) && (*json_skip_ws(p) == '\0');
+}
+
+static int json_has(const char *json, const char *key_value)
+{
+  return strstr(json, key_value) != NULL;
+}
+
+/* Sends bytes to lwiperf3 in two chained pbufs, as lwIP may deliver them */
+static void test_input(struct tcp_pcb *pcb, const void *data, size_t len)
+{
+  struct pbuf p1, p2;
+
+  CHECK(pcb->recv != NULL);
+  if ((pcb->recv == NULL) || (len == 0) || (len > 0xFFFF)) {
+      return;
+  }
+  p1.next = (len > 1) ? &p2 : NULL;
+  p1.payload = (void *)data;
+  p1.len = (u16_t)((len > 1) ? len / 2 : len);
+  p1.tot_len = (u16_t)len;
+  p2.next = NULL;
+  p2.payload = (u8_t *)data + p1.len;
+  p2.len = (u16_t)(len - p1.len);
+  p2.tot_len = p2.len;
+  pcb->recv(pcb->callback_arg, pcb, &p1, ERR_OK);
+}
+
+static void test_input_state(struct tcp_pcb *pcb, s8_t state)
+{
+  test_input(pcb, &state, 1);
+}
+
+static void test_input_json(struct tcp_pcb *pcb, const char *json)
+{
+  static u8_t buf[2048];
+  u32_t len = (u32_t)strlen(json);
+
+  buf[0] = (u8_t)(len >> 24);
+  buf[1] = (u8_t)(len >> 16);
+  buf[2] = (u8_t)(len >> 8);
+  buf[3] = (u8_t)len;
+  memcpy(&buf[4], json, len);
+  test_input(pcb, buf, 4 + len);
+}
+
+static void test_input_data(struct tcp_pcb *pcb, u32_t len)
+{
+  static const u8_t zeros[TCP_MSS];
+
+  while ((len > 0) && (pcb->recv != NULL)) {
+      u32_t seg = (len > TCP_MSS) ? TCP_MSS : len;
+      test_input(pcb, zeros, seg);
+      len -= seg;
+  }
+}
+
+/* Next byte written by lwiperf3 on a connection, -1 if none */
+static int test_output_byte(struct tcp_pcb *pcb)
+{
+  if (pcb->out_pos >= pcb->out_len) {
+      return -1;
+  }
+  return pcb->out[pcb->out_pos++];
+}
+
+/* Next JSON string written by lwiperf3, with its length prefix */
+static int test_output_json(struct tcp_pcb *pcb, char *json, size_t size)
+{
+  u32_t len = 0;
+  int i, c;
+
+  for (i = 0; i < 4; i++) {
+      c = test_output_byte(pcb);
+      if (c < 0) {
+          return -1;
+      }
+      len = (len << 8) | (u32_t)c;
+  }
+  if ((len >= size) || (pcb->out_pos + len > pcb->out_len)) {
+      return -1;
+  }
+  memcpy(json, &pcb->out[pcb->out_pos], len);
+  json[len] = '\0';
+  pcb->out_pos += len;
+  return (int)len;
+}
+
+static void check_results_json(const char *json)
+{
+  size_t i;
+  char key[32];
+
+  CHECK(json_is_valid(json));
+  for (i = 0; i < sizeof(test_results_keys) / sizeof(test_results_keys[0]); i++) {
+      snprintf(key, sizeof(key), "\"%s\":", test_results_keys[i]);
+      CHECK(json_has(json, key));
+  }
+}
+
+static struct tcp_pcb *test_server_pcb;
+
+/* A client connects to the server */
+static struct tcp_pcb *test_connect(void)
+{
+  struct tcp_pcb *pcb = tcp_new_ip_type(IPADDR_TYPE_V4);
+
+  pcb->local_port = LWIPERF3_TCP_PORT_DEFAULT;
+  pcb->remote_port = (u16_t)(40000 + test_pcb_count);
+  CHECK(test_server_pcb->accept(test_server_pcb->callback_arg, pcb, ERR_OK)
+        == ERR_OK);
+  return pcb;
+}
+
+static void test_server_upload(void)
+{
+  char json[LWIPERF3_JSON_BUF_SIZE];
+  u8_t first[LWIPERF3_COOKIE_SIZE + 1000];
+  struct tcp_pcb *ctrl, *data, *other;
+  int reports = test_reports;
+
+  nb_tests++;
+  ctrl = test_connect();
+  test_input(ctrl, test_cookie, LWIPERF3_COOKIE_SIZE);
+  CHECK(test_output_byte(ctrl) == LWIPERF3_PARAM_EXCHANGE);
+  test_input_json(ctrl, test_params_upload);
+  CHECK(test_output_byte(ctrl) == LWIPERF3_CREATE_STREAMS);
+
+  /* The stream starts with the cookie, test data in the same segment */
+  data = test_connect();
+  memcpy(first, test_cookie, LWIPERF3_COOKIE_SIZE);
+  memset(&first[LWIPERF3_COOKIE_SIZE], 0, 1000);
+  test_input(data, first, sizeof(first));
+  CHECK(test_output_byte(ctrl) == LWIPERF3_TEST_START);
+  CHECK(test_output_byte(ctrl) == LWIPERF3_TEST_RUNNING);
+  test_input_data(data, 100000);
+
+  /* iperf3 runs one test at a time */
+  other = test_connect();
+  CHECK(test_output_byte(other) == (u8_t)LWIPERF3_ACCESS_DENIED);
+  CHECK(other->closed);
+
+  test_now_ms += 10000;
+  test_input_state(ctrl, LWIPERF3_TEST_END);
+  CHECK(test_output_byte(ctrl) == LWIPERF3_EXCHANGE_RESULTS);
+  test_input_json(ctrl, test_results_client_sender);
+  CHECK(test_output_json(ctrl, json, sizeof(json)) > 0);
+  check_results_json(json);
+  CHECK(json_has(json, "\"bytes\":101000,"));
+  CHECK(json_has(json, "\"sender_has_retransmits\":-1,"));
+  CHECK(json_has(json, "\"end_time\":10.000}"));
+  CHECK(test_output_byte(ctrl) == LWIPERF3_DISPLAY_RESULTS);
+  CHECK(test_output_byte(ctrl) < 0);
+
+  test_input_state(ctrl, LWIPERF3_IPERF_DONE);
+  CHECK(test_reports == reports + 1);
+  CHECK(test_last_report == LWIPERF_TCP_DONE_SERVER);
+  CHECK(test_last_bytes == 101000);
+  CHECK(ctrl->closed && data->closed);
+}
+
+static void test_server_download_long_params(void)
+{
+  char json[LWIPERF3_JSON_BUF_SIZE];
+  struct tcp_pcb *ctrl, *data;
+  lwiperf3_session_t *s;
+  u32_t sent;
+
+  nb_tests++;
+  CHECK(strlen(test_params_download_long) >= LWIPERF3_JSON_BUF_SIZE);
+  ctrl = test_connect();
+  test_input(ctrl, test_cookie, LWIPERF3_COOKIE_SIZE);
+  CHECK(test_output_byte(ctrl) == LWIPERF3_PARAM_EXCHANGE);
+
+  /* Truncated: the end of the string is skipped, the options lwiperf3 uses
+   * are all before the cut */
+  test_input_json(ctrl, test_params_download_long);
+  CHECK(test_output_byte(ctrl) == LWIPERF3_CREATE_STREAMS);
+  s = ((lwiperf3_listener_t *)test_server_pcb->callback_arg)->session;
+  CHECK(s != NULL);
+  if (s == NULL) {
+      return;
+  }
+  CHECK(s->sender == 1);
+  CHECK(s->amount_bytes == 10485760);
+  CHECK(s->buffer_len == 131072);
+  CHECK(s->duration_ms == 0);
+
+  /* The server sends the requested amount, then waits for the client */
+  data = test_connect();
+  test_input(data, test_cookie, LWIPERF3_COOKIE_SIZE);
+  CHECK(test_output_byte(ctrl) == LWIPERF3_TEST_START);
+  CHECK(test_output_byte(ctrl) == LWIPERF3_TEST_RUNNING);
+  do {
+      sent = data->out_total;
+      data->snd_buf = TEST_SND_BUF;
+      data->sent(data->callback_arg, data, TEST_SND_BUF);
+  } while (data->out_total != sent);
+  CHECK(data->out_total == 10485760);
+
+  test_now_ms += 8273;
+  test_input_state(ctrl, LWIPERF3_TEST_END);
+  CHECK(test_output_byte(ctrl) == LWIPERF3_EXCHANGE_RESULTS);
+  test_input_json(ctrl, test_results_client_receiver);
+  CHECK(test_output_json(ctrl, json, sizeof(json)) > 0);
+  check_results_json(json);
+  CHECK(json_has(json, "\"sender_has_retransmits\":0,"));
+  CHECK(json_has(json, "\"bytes\":10485760,"));
+  CHECK(test_output_byte(ctrl) == LWIPERF3_DISPLAY_RESULTS);
+
+  test_input_state(ctrl, LWIPERF3_IPERF_DONE);
+  CHECK(test_last_report == LWIPERF_TCP_DONE_SERVER);
+  CHECK(test_last_bytes == 10485760);
+}
+
+static void test_server_parallel_refused(void)
+{
+  static const u8_t ienumstreams[8] = { 0, 0, 0, LWIPERF3_IENUMSTREAMS,
+                                        0, 0, 0, 0 };
+  struct tcp_pcb *ctrl;
+  int i;
+
+  nb_tests++;
+  ctrl = test_connect();
+  test_input(ctrl, test_cookie, LWIPERF3_COOKIE_SIZE);
+  CHECK(test_output_byte(ctrl) == LWIPERF3_PARAM_EXCHANGE);
+  test_input_json(ctrl, test_params_parallel);
+
+  /* iperf3 prints "the server ... number of streams" from the error code */
+  CHECK(test_output_byte(ctrl) == (u8_t)LWIPERF3_SERVER_ERROR);
+  for (i = 0; i < 8; i++) {
+      CHECK(test_output_byte(ctrl) == ienumstreams[i]);
+  }
+  CHECK(test_last_report == LWIPERF_TCP_ABORTED_LOCAL);
+  CHECK(ctrl->closed);
+}
+
+/* Replays the client bytes of a captured control connection */
+static void test_server_replay(const char *path)
+{
+  static u8_t capture[4096];
+  u8_t first[LWIPERF3_COOKIE_SIZE + TCP_MSS];
+  struct tcp_pcb *ctrl, *data = NULL;
+  lwiperf3_session_t *s;
+  size_t len, i;
+  FILE *f;
+
+  nb_tests++;
+  f = fopen(path, "rb");
+  CHECK(f != NULL);
+  if (f == NULL) {
+      return;
+  }
+  len = fread(capture, 1, sizeof(capture), f);
+  fclose(f);
+  CHECK(len > LWIPERF3_COOKIE_SIZE);
+  if (len <= LWIPERF3_COOKIE_SIZE) {
+      return;
+  }
+
+  /* One byte per segment: the worst split of the messages */
+  ctrl = test_connect();
+  for (i = 0; (i < len) && (ctrl->recv != NULL); i++) {
+      test_input(ctrl, &capture[i], 1);
+      s = ((lwiperf3_listener_t *)test_server_pcb->callback_arg)->session;
+      if ((s != NULL) && (s->state == LWIPERF3_CREATE_STREAMS)
+          && (data == NULL)) {
+          /* The stream of the test, the data itself is not replayed */
+          data = test_connect();
+          memcpy(first, capture, LWIPERF3_COOKIE_SIZE);
+          memset(&first[LWIPERF3_COOKIE_SIZE], 0, TCP_MSS);
+          test_input(data, first, sizeof(first));
+      }
+  }
+  CHECK(i == len);
+  CHECK(data != NULL);
+  CHECK(test_last_report == LWIPERF_TCP_DONE_SERVER);
+  printf("Replayed %u bytes of %s\n", (unsigned)len, path);
+}
+
+static void test_client(u8_t reverse, const char *server_results)
+{
+  char json[LWIPERF3_JSON_BUF_SIZE];
+  u8_t segment[2048];
+  struct tcp_pcb *ctrl, *data;
+  lwiperf3_session_t *s;
+  ip_addr_t server = { 0x0a000001, IPADDR_TYPE_V4 };
+  u32_t len;
+  int i;
+
+  nb_tests++;
+  s = lwiperf3_start_tcp_client(&server, LWIPERF3_TCP_PORT_DEFAULT, 1, 0, 0,
+                                reverse, test_report, NULL);
+  CHECK(s != NULL);
+  if (s == NULL) {
+      return;
+  }
+  ctrl = s->ctrl_pcb;
+  ctrl->connected(ctrl->callback_arg, ctrl, ERR_OK);
+
+  /* The cookie, checked by iperf3 on each stream */
+  CHECK(ctrl->out_len == LWIPERF3_COOKIE_SIZE);
+  for (i = 0; i < LWIPERF3_COOKIE_SIZE - 1; i++) {
+      CHECK(strchr("abcdefghijklmnopqrstuvwxyz234567", ctrl->out[i]) != NULL);
+  }
+  CHECK(ctrl->out[LWIPERF3_COOKIE_SIZE - 1] == '\0');
+  ctrl->out_pos = LWIPERF3_COOKIE_SIZE;
+
+  /* The parameters as iperf3 get_parameters() reads them */
+  test_input_state(ctrl, LWIPERF3_PARAM_EXCHANGE);
+  CHECK(test_output_json(ctrl, json, sizeof(json)) > 0);
+  CHECK(json_is_valid(json));
+  CHECK(json_has(json, "\"tcp\":true"));
+  CHECK(json_has(json, "\"time\":1,"));
+  CHECK(json_has(json, "\"parallel\":1,"));
+  CHECK(json_has(json, "\"len\":1460"));
+  CHECK(json_has(json, "\"reverse\":true") == (reverse != 0));
+  CHECK(json_has(json, "\"client_version\":\"" LWIPERF3_CLIENT_VERSION "\""));
+
+  test_input_state(ctrl, LWIPERF3_CREATE_STREAMS);
+  data = s->data_pcb;
+  CHECK(data != NULL);
+  if (data == NULL) {
+      return;
+  }
+  data->connected(data->callback_arg, data, ERR_OK);
+  CHECK(memcmp(data->out, ctrl->out, LWIPERF3_COOKIE_SIZE) == 0);
+
+  segment[0] = LWIPERF3_TEST_START;
+  segment[1] = LWIPERF3_TEST_RUNNING;
+  test_input(ctrl, segment, 2);
+  if (reverse) {
+      CHECK(data->out_total == LWIPERF3_COOKIE_SIZE);
+      test_input_data(data, 50000);
+  } else {
+      CHECK(data->out_total > LWIPERF3_COOKIE_SIZE);
+  }
+
+  /* The client ends time-limited tests */
+  test_now_ms += 1000;
+  ctrl->poll(ctrl->callback_arg, ctrl);
+  CHECK(test_output_byte(ctrl) == LWIPERF3_TEST_END);
+  test_input_state(ctrl, LWIPERF3_EXCHANGE_RESULTS);
+  CHECK(test_output_json(ctrl, json, sizeof(json)) > 0);
+  check_results_json(json);
+  if (reverse) {
+      CHECK(json_has(json, "\"bytes\":50000,"));
+  }
+
+  /* The server results & the next state in one segment: the state is read
+   * at the right place even when the results don't fit the buffer */
+  len = (u32_t)strlen(server_results);
+  CHECK(len + 5 <= sizeof(segment));
+  if (len + 5 > sizeof(segment)) {
+      return;
+  }
+  segment[0] = (u8_t)(len >> 24);
+  segment[1] = (u8_t)(len >> 16);
+  segment[2] = (u8_t)(len >> 8);
+  segment[3] = (u8_t)len;
+  memcpy(&segment[4], server_results, len);
+  segment[4 + len] = LWIPERF3_DISPLAY_RESULTS;
+  test_input(ctrl, segment, 5 + len);
+  CHECK(test_output_byte(ctrl) == LWIPERF3_IPERF_DONE);
+  CHECK(test_last_report == LWIPERF_TCP_DONE_CLIENT);
+  CHECK(ctrl->closed && data->closed);
+}
+
+static void test_json_fits(void)
+{
+  char json[LWIPERF3_JSON_BUF_SIZE];
+  lwiperf3_session_t s;
+
+  nb_tests++;
+
+  /* The largest results & parameters lwiperf3 can send */
+  memset(&s, 0, sizeof(s));
+  s.ctrl_pcb = tcp_new_ip_type(IPADDR_TYPE_V4);
+  s.bytes_transferred = 0xFFFFFFFF;
+  s.time_ended = 0xFFFFFFFF;
+  CHECK(lwiperf3_send_results(&s) == ERR_OK);
+  CHECK(test_output_json(s.ctrl_pcb, json, sizeof(json)) > 0);
+  check_results_json(json);
+
+  s.duration_ms = 0xFFFFFFFF;
+  s.amount_bytes = 0x7FFFFFFF;
+  s.buffer_len = 0xFFFFFFFF;
+  CHECK(lwiperf3_client_params(&s) == ERR_OK);
+  CHECK(test_output_json(s.ctrl_pcb, json, sizeof(json)) > 0);
+  CHECK(json_is_valid(json));
+}
+
+int main(int argc, char *argv[])
+{
+  ip_addr_t local = { 0x0a000002, IPADDR_TYPE_V4 };
+  void *server;
+
+  lwiperf3_init();
+  server = lwiperf3_start_tcp_server(&local, LWIPERF3_TCP_PORT_DEFAULT,
+                                     test_report, NULL);
+  CHECK(server != NULL);
+  if (server == NULL) {
+      return EXIT_FAILURE;
+  }
+  test_server_pcb = ((lwiperf3_listener_t *)server)->server_pcb;
+
+  test_server_upload();
+  test_server_download_long_params();
+  test_server_parallel_refused();
+  if (argc > 1) {
+      test_server_replay(argv[1]);
+  }
+  lwiperf3_abort(server);
+  CHECK(test_server_pcb->closed);
+
+  test_client(0, test_results_server_receiver);
+
+  /* An iperf3 server adds its output on request, longer than the buffer */
+  {
+      static char long_results[1500];
+      snprintf(long_results, sizeof(long_results),
+               "{\"cpu_util_total\":0.5,\"cpu_util_user\":0.1,"
+               "\"cpu_util_system\":0.4,\"sender_has_retransmits\":0,"
+               "\"streams\":[{\"id\":1,\"bytes\":50000,\"retransmits\":0,"
+               "\"jitter\":0,\"errors\":0,\"packets\":0,\"start_time\":0,"
+               "\"end_time\":1.000311}],\"server_output_text\":\"%0*d\"}",
+               800, 0);
+      CHECK(strlen(long_results) >= LWIPERF3_JSON_BUF_SIZE);
+      test_client(1, long_results);
+  }
+
+  test_json_fits();
+
+  /* Every listener & session went back to the pool */
+  CHECK(memp_LWIPERF3_STATE.used == 0);
+
+  printf("lwiperf3_host_test: %d tests, %s\n",
+         nb_tests,
+         (failures == 0) ? "PASSED" : "FAILED");
+  return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
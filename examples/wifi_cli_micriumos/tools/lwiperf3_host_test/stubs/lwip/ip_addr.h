@@ -0,0 +1,20 @@
+#ifndef LWIPERF3_HOST_TEST_LWIP_IP_ADDR_H
+#define LWIPERF3_HOST_TEST_LWIP_IP_ADDR_H
+
+#include "lwip/opt.h"
+
+#define IPADDR_TYPE_V4              0U
+#define IPADDR_TYPE_ANY             46U
+
+typedef struct {
+  u32_t addr;
+  u8_t type;
+} ip_addr_t;
+
+extern const ip_addr_t ip_addr_any;
+
+#define IP_ADDR_ANY                 (&ip_addr_any)
+#define IP_GET_TYPE(ipaddr)         ((ipaddr)->type)
+#define ip_addr_copy(dest, src)     ((dest) = (src))
+
+#endif /* LWIPERF3_HOST_TEST_LWIP_IP_ADDR_H */
@@ -0,0 +1,38 @@
+#ifndef LWIPERF3_HOST_TEST_LWIP_MEMP_H
+#define LWIPERF3_HOST_TEST_LWIP_MEMP_H
+
+#include <assert.h>
+#include <stdlib.h>
+
+/* A pool of LWIP_MEMPOOL_DECLARE() keeps its element count, so that running
+ * out of elements and leaks show up */
+struct test_mempool {
+  unsigned int num;
+  size_t size;
+  unsigned int used;
+};
+
+#define LWIP_MEMPOOL_PROTOTYPE(name)  extern struct test_mempool memp_ ## name
+#define LWIP_MEMPOOL_DECLARE(name, num, size, desc) \
+  struct test_mempool memp_ ## name = { (num), (size), 0 };
+#define LWIP_MEMPOOL_INIT(name)       (memp_ ## name.used = 0)
+#define LWIP_MEMPOOL_ALLOC(name)      test_mempool_alloc(&memp_ ## name)
+#define LWIP_MEMPOOL_FREE(name, x)    test_mempool_free(&memp_ ## name, (x))
+
+static inline void *test_mempool_alloc(struct test_mempool *pool)
+{
+  if (pool->used >= pool->num) {
+    return NULL;
+  }
+  pool->used++;
+  return malloc(pool->size);
+}
+
+static inline void test_mempool_free(struct test_mempool *pool, void *item)
+{
+  assert(pool->used > 0);
+  pool->used--;
+  free(item);
+}
+
+#endif /* LWIPERF3_HOST_TEST_LWIP_MEMP_H */
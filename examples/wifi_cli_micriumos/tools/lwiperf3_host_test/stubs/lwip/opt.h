@@ -0,0 +1,39 @@
+#ifndef LWIPERF3_HOST_TEST_LWIP_OPT_H
+#define LWIPERF3_HOST_TEST_LWIP_OPT_H
+
+#include <assert.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <arpa/inet.h>
+
+typedef uint8_t  u8_t;
+typedef int8_t   s8_t;
+typedef uint16_t u16_t;
+typedef uint32_t u32_t;
+typedef int8_t   err_t;
+
+#define U32_F                       PRIu32
+
+#define ERR_OK                      0
+#define ERR_MEM                     -1
+#define ERR_BUF                     -2
+#define ERR_VAL                     -6
+#define ERR_CONN                    -11
+#define ERR_ABRT                    -13
+#define ERR_CLSD                    -15
+
+#define LWIP_TCP                    1
+#define LWIP_CALLBACK_API           1
+#define TCP_MSS                     1460
+
+#define LWIP_ASSERT(msg, cond)      assert((cond) && (msg))
+#define LWIP_ASSERT_CORE_LOCKED()
+#define LWIP_UNUSED_ARG(x)          (void)(x)
+
+#define lwip_htonl(x)               htonl(x)
+#define PP_HTONL(x)                 ((((x) & 0x000000ffUL) << 24) | \
+                                     (((x) & 0x0000ff00UL) << 8)  | \
+                                     (((x) & 0x00ff0000UL) >> 8)  | \
+                                     (((x) & 0xff000000UL) >> 24))
+
+#endif /* LWIPERF3_HOST_TEST_LWIP_OPT_H */
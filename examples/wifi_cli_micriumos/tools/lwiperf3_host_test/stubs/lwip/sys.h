@@ -0,0 +1,9 @@
+#ifndef LWIPERF3_HOST_TEST_LWIP_SYS_H
+#define LWIPERF3_HOST_TEST_LWIP_SYS_H
+
+#include "lwip/opt.h"
+
+/* Clock of the test, moved forward by hand */
+u32_t sys_now(void);
+
+#endif /* LWIPERF3_HOST_TEST_LWIP_SYS_H */
@@ -0,0 +1,76 @@
+#ifndef LWIPERF3_HOST_TEST_LWIP_TCP_H
+#define LWIPERF3_HOST_TEST_LWIP_TCP_H
+
+#include "lwip/opt.h"
+#include "lwip/ip_addr.h"
+
+#define TCP_WRITE_FLAG_COPY         0x01
+#define TCP_WRITE_FLAG_MORE         0x02
+
+/* Bytes of a connection output kept for the checks, the data connections
+ * only count the rest */
+#define TEST_TCP_OUT_MAX            2048
+
+struct pbuf {
+  struct pbuf *next;
+  void *payload;
+  u16_t tot_len;
+  u16_t len;
+};
+
+struct tcp_pcb;
+
+typedef err_t (*tcp_recv_fn)(void *arg, struct tcp_pcb *tpcb,
+                             struct pbuf *p, err_t err);
+typedef err_t (*tcp_sent_fn)(void *arg, struct tcp_pcb *tpcb, u16_t len);
+typedef err_t (*tcp_poll_fn)(void *arg, struct tcp_pcb *tpcb);
+typedef void  (*tcp_err_fn)(void *arg, err_t err);
+typedef err_t (*tcp_accept_fn)(void *arg, struct tcp_pcb *newpcb, err_t err);
+typedef err_t (*tcp_connected_fn)(void *arg, struct tcp_pcb *tpcb, err_t err);
+
+/* A connection of the test: what lwiperf3 writes is kept in 'out' */
+struct tcp_pcb {
+  ip_addr_t local_ip;
+  ip_addr_t remote_ip;
+  u16_t local_port;
+  u16_t remote_port;
+  void *callback_arg;
+  tcp_recv_fn recv;
+  tcp_sent_fn sent;
+  tcp_poll_fn poll;
+  tcp_err_fn errf;
+  tcp_accept_fn accept;
+  tcp_connected_fn connected;
+  u8_t in_use;
+  u8_t closed;
+  u16_t snd_buf;
+  u32_t out_total;
+  u32_t out_len;
+  u32_t out_pos;               ///< Next byte checked by the test
+  u8_t out[TEST_TCP_OUT_MAX];
+};
+
+#define tcp_sndbuf(pcb)             ((pcb)->snd_buf)
+
+struct tcp_pcb *tcp_new_ip_type(u8_t type);
+err_t tcp_bind(struct tcp_pcb *pcb, const ip_addr_t *ipaddr, u16_t port);
+struct tcp_pcb *tcp_listen_with_backlog(struct tcp_pcb *pcb, u8_t backlog);
+void  tcp_accept(struct tcp_pcb *pcb, tcp_accept_fn accept);
+err_t tcp_connect(struct tcp_pcb *pcb, const ip_addr_t *ipaddr, u16_t port,
+                  tcp_connected_fn connected);
+void  tcp_arg(struct tcp_pcb *pcb, void *arg);
+void  tcp_recv(struct tcp_pcb *pcb, tcp_recv_fn recv);
+void  tcp_sent(struct tcp_pcb *pcb, tcp_sent_fn sent);
+void  tcp_poll(struct tcp_pcb *pcb, tcp_poll_fn poll, u8_t interval);
+void  tcp_err(struct tcp_pcb *pcb, tcp_err_fn err);
+err_t tcp_write(struct tcp_pcb *pcb, const void *dataptr, u16_t len,
+                u8_t apiflags);
+err_t tcp_output(struct tcp_pcb *pcb);
+void  tcp_recved(struct tcp_pcb *pcb, u16_t len);
+err_t tcp_close(struct tcp_pcb *pcb);
+void  tcp_abort(struct tcp_pcb *pcb);
+
+u8_t  pbuf_free(struct pbuf *p);
+u8_t  pbuf_get_at(const struct pbuf *p, u16_t offset);
+
+#endif /* LWIPERF3_HOST_TEST_LWIP_TCP_H */
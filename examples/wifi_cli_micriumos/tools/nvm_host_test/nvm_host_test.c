@@ -0,0 +1,451 @@
+/***************************************************************************//**
+ * @file
+ * @brief Host test of the write-behind NVM3 persistence of the parameters
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ *******************************************************************************
+ *
+ * wifi_cli_nvm.c is built on Linux against a RAM stand-in of NVM3 & a test
+ * parameter table, then flushed & read back. From this directory:
+ *
+ *   gcc -std=gnu99 -Wall -Wextra -Istubs -I../.. nvm_host_test.c \
+ *       -o nvm_host_test && ./nvm_host_test
+ *
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* The unit under test, its static functions included */
+#include "wifi_cli_nvm.c"
+
+/*******************************************************************************
+ ****************************   NVM3 RAM stand-in   ****************************
+ ******************************************************************************/
+#define RAM_NVM3_MAX_OBJECTS    16
+#define RAM_NVM3_MAX_OBJ_LEN    256
+#define RAM_NVM3_PAGE_SIZE      1024 ///< Bytes written between two erases
+
+typedef struct {
+  bool used;
+  nvm3_ObjectKey_t key;
+  size_t len;
+  uint8_t data[RAM_NVM3_MAX_OBJ_LEN];
+} ram_nvm3_object_t;
+
+static ram_nvm3_object_t ram_nvm3[RAM_NVM3_MAX_OBJECTS];
+static uint32_t ram_nvm3_writes;
+static uint32_t ram_nvm3_bytes;
+static uint32_t ram_nvm3_fail_writes; ///< Next writes to fail
+
+nvm3_Handle_t *nvm3_defaultHandle = NULL;
+
+static ram_nvm3_object_t *ram_nvm3_find(nvm3_ObjectKey_t key)
+{
+  uint32_t i;
+
+  for (i = 0; i < RAM_NVM3_MAX_OBJECTS; i++) {
+      if (ram_nvm3[i].used && (ram_nvm3[i].key == key)) {
+          return &ram_nvm3[i];
+      }
+  }
+  return NULL;
+}
+
+Ecode_t nvm3_getObjectInfo(nvm3_Handle_t *h, nvm3_ObjectKey_t key,
+                           uint32_t *type, size_t *len)
+{
+  ram_nvm3_object_t *obj = ram_nvm3_find(key);
+
+  (void)h;
+  if (obj == NULL) {
+      return ECODE_NVM3_ERR_KEY_NOT_FOUND;
+  }
+  *type = NVM3_OBJECTTYPE_DATA;
+  *len = obj->len;
+  return ECODE_NVM3_OK;
+}
+
+Ecode_t nvm3_readData(nvm3_Handle_t *h, nvm3_ObjectKey_t key,
+                      void *value, size_t len)
+{
+  ram_nvm3_object_t *obj = ram_nvm3_find(key);
+
+  (void)h;
+  if ((obj == NULL) || (len > obj->len)) {
+      return ECODE_NVM3_ERR_KEY_NOT_FOUND;
+  }
+  memcpy(value, obj->data, len);
+  return ECODE_NVM3_OK;
+}
+
+Ecode_t nvm3_writeData(nvm3_Handle_t *h, nvm3_ObjectKey_t key,
+                       const void *value, size_t len)
+{
+  uint32_t i;
+  ram_nvm3_object_t *obj = ram_nvm3_find(key);
+
+  (void)h;
+  if (ram_nvm3_fail_writes > 0) {
+      ram_nvm3_fail_writes--;
+      return ECODE_NVM3_ERR_STORAGE_FULL;
+  }
+
+  for (i = 0; (obj == NULL) && (i < RAM_NVM3_MAX_OBJECTS); i++) {
+      if (!ram_nvm3[i].used) {
+          obj = &ram_nvm3[i];
+      }
+  }
+  if ((obj == NULL) || (len > RAM_NVM3_MAX_OBJ_LEN)) {
+      return ECODE_NVM3_ERR_STORAGE_FULL;
+  }
+
+  obj->used = true;
+  obj->key = key;
+  obj->len = len;
+  memcpy(obj->data, value, len);
+  ram_nvm3_writes++;
+  ram_nvm3_bytes += len;
+  return ECODE_NVM3_OK;
+}
+
+Ecode_t nvm3_getEraseCount(nvm3_Handle_t *h, uint32_t *erase_count)
+{
+  (void)h;
+  *erase_count = ram_nvm3_bytes / RAM_NVM3_PAGE_SIZE;
+  return ECODE_NVM3_OK;
+}
+
+bool nvm3_repackNeeded(nvm3_Handle_t *h)
+{
+  (void)h;
+  return false;
+}
+
+Ecode_t nvm3_repack(nvm3_Handle_t *h)
+{
+  (void)h;
+  return ECODE_NVM3_OK;
+}
+
+/*******************************************************************************
+ ***************************   Kernel stand-in   *******************************
+ ******************************************************************************/
+uint32_t OSCfg_TickRate_Hz = 1000;
+
+void OSSemCreate(OS_SEM *sem, const char *name, int count, RTOS_ERR *err)
+{
+  (void)name;
+  sem->count = count;
+  err->Code = RTOS_ERR_NONE;
+}
+
+void OSSemPend(OS_SEM *sem, uint32_t timeout, int opt, void *ts, RTOS_ERR *err)
+{
+  (void)sem; (void)timeout; (void)opt; (void)ts;
+  err->Code = RTOS_ERR_TIMEOUT;
+}
+
+void OSSemPost(OS_SEM *sem, int opt, RTOS_ERR *err)
+{
+  (void)opt;
+  sem->count++;
+  err->Code = RTOS_ERR_NONE;
+}
+
+void OSSemSet(OS_SEM *sem, int count, RTOS_ERR *err)
+{
+  sem->count = count;
+  err->Code = RTOS_ERR_NONE;
+}
+
+void OSMutexCreate(OS_MUTEX *mutex, const char *name, RTOS_ERR *err)
+{
+  (void)mutex; (void)name;
+  err->Code = RTOS_ERR_NONE;
+}
+
+void OSMutexPend(OS_MUTEX *mutex, uint32_t timeout, int opt, void *ts,
+                 RTOS_ERR *err)
+{
+  (void)mutex; (void)timeout; (void)opt; (void)ts;
+  err->Code = RTOS_ERR_NONE;
+}
+
+void OSMutexPost(OS_MUTEX *mutex, int opt, RTOS_ERR *err)
+{
+  (void)mutex; (void)opt;
+  err->Code = RTOS_ERR_NONE;
+}
+
+uint32_t OSTimeGet(RTOS_ERR *err)
+{
+  err->Code = RTOS_ERR_NONE;
+  return 0;
+}
+
+void OSTaskCreate(OS_TCB *tcb, const char *name, void (*task)(void *),
+                  void *arg, int prio, CPU_STK *stk, uint32_t stk_limit,
+                  uint32_t stk_size, int q_size, int quanta, void *ext,
+                  int opt, RTOS_ERR *err)
+{
+  /* The flushes are run by the test itself */
+  (void)tcb; (void)name; (void)task; (void)arg; (void)prio; (void)stk;
+  (void)stk_limit; (void)stk_size; (void)q_size; (void)quanta; (void)ext;
+  (void)opt;
+  err->Code = RTOS_ERR_NONE;
+}
+
+/*******************************************************************************
+ **************************   Test parameter table   ***************************
+ ******************************************************************************/
+static char test_ssid[33] = "home";
+static char test_passkey[65] = "secret";
+static char test_version[16] = "3.3.1";
+static char test_long[WIFI_CLI_NVM_OBJ_MAX_LEN] = "short";
+static int test_get_fail;
+
+static int test_get(char *name, void *addr, uint32_t size,
+                    char *out_buf, uint32_t out_buf_len)
+{
+  (void)name; (void)size;
+  if (test_get_fail || (strlen(addr) >= out_buf_len)) {
+      return -1;
+  }
+  strcpy(out_buf, addr);
+  return 0;
+}
+
+static int test_set(char *name, void *addr, uint32_t size, char *value)
+{
+  (void)name;
+  if (strlen(value) >= size) {
+      return -1;
+  }
+  strcpy(addr, value);
+  return 0;
+}
+
+/* Sorted by name, as the real table */
+const param_t wifi_params[] = {
+  { "station.passkey", test_passkey, "", test_get, test_set,
+    SL_WFX_CLI_PARAM_TYPE_CUSTOM, sizeof(test_passkey),
+    SL_WFX_CLI_PARAM_SET_RIGHT | SL_WFX_CLI_PARAM_GET_RIGHT },
+  { "station.ssid", test_ssid, "", test_get, test_set,
+    SL_WFX_CLI_PARAM_TYPE_CUSTOM, sizeof(test_ssid),
+    SL_WFX_CLI_PARAM_SET_RIGHT | SL_WFX_CLI_PARAM_GET_RIGHT },
+  { "test.long", test_long, "", test_get, test_set,
+    SL_WFX_CLI_PARAM_TYPE_CUSTOM, sizeof(test_long),
+    SL_WFX_CLI_PARAM_SET_RIGHT | SL_WFX_CLI_PARAM_GET_RIGHT },
+  { "version", test_version, "", test_get, NULL,
+    SL_WFX_CLI_PARAM_TYPE_CUSTOM, sizeof(test_version),
+    SL_WFX_CLI_PARAM_GET_RIGHT },
+};
+const uint32_t wifi_params_count = sizeof(wifi_params) / sizeof(wifi_params[0]);
+
+enum {
+  IDX_PASSKEY,
+  IDX_SSID,
+  IDX_LONG,
+  IDX_VERSION
+};
+
+/*******************************************************************************
+ ********************************   Tests   ************************************
+ ******************************************************************************/
+static int failures;
+
+#define CHECK(cond)                                                        \
+  do {                                                                     \
+    if (!(cond)) {                                                         \
+        printf("%s:%d: FAILED: %s\n", __FILE__, __LINE__, #cond);          \
+        failures++;                                                        \
+    }                                                                      \
+  } while (0)
+
+static void test_empty_store(void)
+{
+  char value[BUF_LEN];
+
+  CHECK(wifi_cli_nvm_read(IDX_SSID, value, sizeof(value)) < 0);
+  CHECK(wifi_cli_nvm_flush() == 0);
+}
+
+static void test_write_and_read_back(void)
+{
+  char value[BUF_LEN];
+
+  wifi_cli_nvm_mark_dirty(IDX_SSID);
+  wifi_cli_nvm_mark_dirty(IDX_PASSKEY);
+  CHECK(wifi_cli_nvm_flush() == 2);
+  CHECK(wifi_cli_nvm_read(IDX_SSID, value, sizeof(value)) == 0);
+  CHECK(strcmp(value, "home") == 0);
+  CHECK(wifi_cli_nvm_read(IDX_PASSKEY, value, sizeof(value)) == 0);
+  CHECK(strcmp(value, "secret") == 0);
+
+  /* The value must fit the caller buffer with its terminator */
+  CHECK(wifi_cli_nvm_read(IDX_SSID, value, 4) < 0);
+  CHECK(wifi_cli_nvm_read(IDX_SSID, value, 5) == 0);
+}
+
+static void test_unchanged_value_skipped(void)
+{
+  uint32_t writes = ram_nvm3_writes;
+  uint32_t skipped = nvm_stats.skipped;
+
+  wifi_cli_nvm_mark_dirty(IDX_SSID);
+  CHECK(wifi_cli_nvm_flush() == 0);
+  CHECK(ram_nvm3_writes == writes);
+  CHECK(nvm_stats.skipped == skipped + 1);
+
+  /* Nothing dirty: the flush is not counted */
+  CHECK(wifi_cli_nvm_flush() == 0);
+}
+
+static void test_changes_coalesced(void)
+{
+  char value[BUF_LEN];
+  uint32_t writes = ram_nvm3_writes;
+
+  strcpy(test_ssid, "office");
+  wifi_cli_nvm_mark_dirty(IDX_SSID);
+  strcpy(test_ssid, "lab");
+  wifi_cli_nvm_mark_dirty(IDX_SSID);
+  CHECK(wifi_cli_nvm_flush() == 1);
+  CHECK(ram_nvm3_writes == writes + 1);
+  CHECK(wifi_cli_nvm_read(IDX_SSID, value, sizeof(value)) == 0);
+  CHECK(strcmp(value, "lab") == 0);
+}
+
+static void test_not_persisted(void)
+{
+  char value[BUF_LEN];
+  uint32_t writes = ram_nvm3_writes;
+
+  /* Read-only & out of range parameters are ignored */
+  wifi_cli_nvm_mark_dirty(IDX_VERSION);
+  wifi_cli_nvm_mark_dirty(-1);
+  wifi_cli_nvm_mark_dirty(WIFI_CLI_NVM_MAX_PARAMS);
+  CHECK(wifi_cli_nvm_flush() == 0);
+  CHECK(ram_nvm3_writes == writes);
+  CHECK(wifi_cli_nvm_read(IDX_VERSION, value, sizeof(value)) < 0);
+}
+
+static void test_failed_write_retried(void)
+{
+  char value[BUF_LEN];
+  uint32_t failures_before = nvm_stats.failures;
+
+  strcpy(test_passkey, "changed");
+  wifi_cli_nvm_mark_dirty(IDX_PASSKEY);
+  ram_nvm3_fail_writes = 1;
+  CHECK(wifi_cli_nvm_flush() < 0);
+  CHECK(nvm_stats.failures == failures_before + 1);
+  CHECK(wifi_cli_nvm_read(IDX_PASSKEY, value, sizeof(value)) == 0);
+  CHECK(strcmp(value, "secret") == 0);
+
+  /* Kept dirty for the next flush */
+  CHECK(wifi_cli_nvm_flush() == 1);
+  CHECK(wifi_cli_nvm_read(IDX_PASSKEY, value, sizeof(value)) == 0);
+  CHECK(strcmp(value, "changed") == 0);
+
+  /* A failed rendering is retried the same way */
+  test_get_fail = 1;
+  strcpy(test_passkey, "again");
+  wifi_cli_nvm_mark_dirty(IDX_PASSKEY);
+  CHECK(wifi_cli_nvm_flush() < 0);
+  test_get_fail = 0;
+  CHECK(wifi_cli_nvm_flush() == 1);
+}
+
+static void test_foreign_object_rejected(void)
+{
+  char value[BUF_LEN];
+  static const char foreign[] = "station.ssidx=evil";
+  ram_nvm3_object_t *obj = ram_nvm3_find(nvm_param_key("station.ssid"));
+
+  /* An object of a colliding name is not taken for this parameter */
+  CHECK(obj != NULL);
+  if (obj == NULL) {
+      return;
+  }
+  memcpy(obj->data, foreign, sizeof(foreign) - 1);
+  obj->len = sizeof(foreign) - 1;
+  CHECK(wifi_cli_nvm_read(IDX_SSID, value, sizeof(value)) < 0);
+
+  /* The next write takes the key over */
+  wifi_cli_nvm_mark_dirty(IDX_SSID);
+  CHECK(wifi_cli_nvm_flush() == 1);
+  CHECK(wifi_cli_nvm_read(IDX_SSID, value, sizeof(value)) == 0);
+  CHECK(strcmp(value, "lab") == 0);
+}
+
+static void test_object_too_long(void)
+{
+  char value[WIFI_CLI_NVM_OBJ_MAX_LEN];
+  size_t max_value = WIFI_CLI_NVM_OBJ_MAX_LEN - strlen("test.long=") - 1;
+
+  /* The longest value fitting an object */
+  memset(test_long, 'a', max_value);
+  test_long[max_value] = '\0';
+  wifi_cli_nvm_mark_dirty(IDX_LONG);
+  CHECK(wifi_cli_nvm_flush() == 1);
+  CHECK(wifi_cli_nvm_read(IDX_LONG, value, sizeof(value)) == 0);
+  CHECK(strlen(value) == max_value);
+
+  /* One more byte is refused, the stored value is kept */
+  memset(test_long, 'b', max_value + 1);
+  test_long[max_value + 1] = '\0';
+  wifi_cli_nvm_mark_dirty(IDX_LONG);
+  CHECK(wifi_cli_nvm_flush() < 0);
+  CHECK(wifi_cli_nvm_read(IDX_LONG, value, sizeof(value)) == 0);
+  CHECK(value[0] == 'a');
+  test_long[0] = '\0';
+  wifi_cli_nvm_flush();
+}
+
+static void test_keys_distinct(void)
+{
+  uint32_t i, j;
+
+  for (i = 0; i < wifi_params_count; i++) {
+      for (j = i + 1; j < wifi_params_count; j++) {
+          CHECK(nvm_param_key(wifi_params[i].name)
+                != nvm_param_key(wifi_params[j].name));
+      }
+  }
+}
+
+int main(void)
+{
+  wifi_cli_nvm_init();
+
+  test_empty_store();
+  test_write_and_read_back();
+  test_unchanged_value_skipped();
+  test_changes_coalesced();
+  test_not_persisted();
+  test_failed_write_retried();
+  test_foreign_object_rejected();
+  test_object_too_long();
+  test_keys_distinct();
+
+  printf("nvm_host_test: %u writes, %u skipped, %u failures, "
+         "%u flushes, %s\n",
+         (unsigned)nvm_stats.writes,
+         (unsigned)nvm_stats.skipped,
+         (unsigned)nvm_stats.failures,
+         (unsigned)nvm_stats.flushes,
+         (failures == 0) ? "PASSED" : "FAILED");
+  return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
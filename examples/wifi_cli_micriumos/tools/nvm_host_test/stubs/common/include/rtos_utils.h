@@ -0,0 +1,8 @@
+#ifndef NVM_HOST_TEST_RTOS_UTILS_H
+#define NVM_HOST_TEST_RTOS_UTILS_H
+
+#include <assert.h>
+
+#define APP_RTOS_ASSERT_DBG(cond, ret_val)  assert(cond)
+
+#endif /* NVM_HOST_TEST_RTOS_UTILS_H */
@@ -0,0 +1,8 @@
+#ifndef NVM_HOST_TEST_EM_CORE_H
+#define NVM_HOST_TEST_EM_CORE_H
+
+#define CORE_DECLARE_IRQ_STATE  int irq_state = 0
+#define CORE_ENTER_ATOMIC()     (void)irq_state
+#define CORE_EXIT_ATOMIC()      (void)irq_state
+
+#endif /* NVM_HOST_TEST_EM_CORE_H */
@@ -0,0 +1,12 @@
+#ifndef NVM_HOST_TEST_LWIP_IP_ADDR_H
+#define NVM_HOST_TEST_LWIP_IP_ADDR_H
+
+#include <stdint.h>
+
+typedef struct {
+  uint32_t addr;
+} ip_addr_t;
+
+struct netif;
+
+#endif /* NVM_HOST_TEST_LWIP_IP_ADDR_H */
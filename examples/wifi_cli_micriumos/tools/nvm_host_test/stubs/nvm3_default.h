@@ -0,0 +1,31 @@
+/* RAM stand-in of the NVM3 API used by wifi_cli_nvm.c, implemented by
+ * nvm_host_test.c. Failures & an erase counter can be injected. */
+#ifndef NVM_HOST_TEST_NVM3_DEFAULT_H
+#define NVM_HOST_TEST_NVM3_DEFAULT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint32_t Ecode_t;
+typedef uint32_t nvm3_ObjectKey_t;
+typedef struct nvm3_HandleStub nvm3_Handle_t;
+
+#define ECODE_NVM3_OK                   0u
+#define ECODE_NVM3_ERR_KEY_NOT_FOUND    0xF00Du
+#define ECODE_NVM3_ERR_STORAGE_FULL     0xF00Eu
+#define NVM3_OBJECTTYPE_DATA            0u
+
+extern nvm3_Handle_t *nvm3_defaultHandle;
+
+Ecode_t nvm3_getObjectInfo(nvm3_Handle_t *h, nvm3_ObjectKey_t key,
+                           uint32_t *type, size_t *len);
+Ecode_t nvm3_readData(nvm3_Handle_t *h, nvm3_ObjectKey_t key,
+                      void *value, size_t len);
+Ecode_t nvm3_writeData(nvm3_Handle_t *h, nvm3_ObjectKey_t key,
+                       const void *value, size_t len);
+Ecode_t nvm3_getEraseCount(nvm3_Handle_t *h, uint32_t *erase_count);
+bool nvm3_repackNeeded(nvm3_Handle_t *h);
+Ecode_t nvm3_repack(nvm3_Handle_t *h);
+
+#endif /* NVM_HOST_TEST_NVM3_DEFAULT_H */
@@ -0,0 +1,46 @@
+/* Host stand-in of the Micrium OS kernel API used by wifi_cli_nvm.c: the
+ * test is single-threaded, the semaphores & mutexes are no-ops. */
+#ifndef NVM_HOST_TEST_OS_H
+#define NVM_HOST_TEST_OS_H
+
+#include <stdint.h>
+
+typedef uint32_t CPU_STK;
+typedef struct { int unused; } OS_TCB;
+typedef struct { int count; } OS_SEM;
+typedef struct { int unused; } OS_MUTEX;
+
+typedef enum {
+  RTOS_ERR_NONE = 0,
+  RTOS_ERR_TIMEOUT
+} RTOS_ERR_CODE;
+
+typedef struct {
+  RTOS_ERR_CODE Code;
+} RTOS_ERR;
+
+#define RTOS_ERR_CODE_GET(err)  ((err).Code)
+
+#define DEF_NULL                ((void *)0)
+#define OS_OPT_PEND_BLOCKING    0
+#define OS_OPT_POST_1           0
+#define OS_OPT_POST_NONE        0
+#define OS_OPT_TASK_STK_CLR     0
+
+extern uint32_t OSCfg_TickRate_Hz;
+
+void OSSemCreate(OS_SEM *sem, const char *name, int count, RTOS_ERR *err);
+void OSSemPend(OS_SEM *sem, uint32_t timeout, int opt, void *ts, RTOS_ERR *err);
+void OSSemPost(OS_SEM *sem, int opt, RTOS_ERR *err);
+void OSSemSet(OS_SEM *sem, int count, RTOS_ERR *err);
+void OSMutexCreate(OS_MUTEX *mutex, const char *name, RTOS_ERR *err);
+void OSMutexPend(OS_MUTEX *mutex, uint32_t timeout, int opt, void *ts,
+                 RTOS_ERR *err);
+void OSMutexPost(OS_MUTEX *mutex, int opt, RTOS_ERR *err);
+uint32_t OSTimeGet(RTOS_ERR *err);
+void OSTaskCreate(OS_TCB *tcb, const char *name, void (*task)(void *),
+                  void *arg, int prio, CPU_STK *stk, uint32_t stk_limit,
+                  uint32_t stk_size, int q_size, int quanta, void *ext,
+                  int opt, RTOS_ERR *err);
+
+#endif /* NVM_HOST_TEST_OS_H */
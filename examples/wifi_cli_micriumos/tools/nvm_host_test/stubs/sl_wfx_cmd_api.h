@@ -0,0 +1,14 @@
+/* Only the types wifi_cli_params.h declares variables of */
+#ifndef NVM_HOST_TEST_SL_WFX_CMD_API_H
+#define NVM_HOST_TEST_SL_WFX_CMD_API_H
+
+#include <stdint.h>
+
+typedef int sl_wfx_indications_ids_t;
+typedef int sl_wfx_security_mode_t;
+typedef struct sl_wfx_rx_stats_s sl_wfx_rx_stats_t;
+typedef struct {
+  uint8_t octet[6];
+} sl_wfx_mac_address_t;
+
+#endif /* NVM_HOST_TEST_SL_WFX_CMD_API_H */
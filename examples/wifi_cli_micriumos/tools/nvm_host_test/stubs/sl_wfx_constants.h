@@ -0,0 +1,3 @@
+#ifndef NVM_HOST_TEST_SL_WFX_CONSTANTS_H
+#define NVM_HOST_TEST_SL_WFX_CONSTANTS_H
+#endif /* NVM_HOST_TEST_SL_WFX_CONSTANTS_H */
@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+# Copyright 2020 Silicon Laboratories Inc. www.silabs.com
+#
+# Decode a `sys trace dump` console capture into a Chrome trace / Perfetto
+# JSON timeline (open it in chrome://tracing or https://ui.perfetto.dev).
+#
+# Usage: trace_decode.py <console capture> [output.json]
+
+import json
+import struct
+import sys
+
+RECORD_FORMAT = "<IHHI"   # trace_record_t: cycles, event, arg0, arg1
+SUPPORTED_VERSION = 1
+
+INTERFACES = {0: "station", 1: "softap"}
+
+# Event ID: (name, timeline row, arg0 name, arg1 name), see trace_event_t
+EVENTS = {
+    1: ("tx_enqueue", "TX", "interface", "length"),
+    2: ("tx_no_buffer", "TX", "interface", "length"),
+    3: ("tx_bus_wake", "bus", "interface", None),
+    4: ("rx_dispatch", "RX", "interface", "length"),
+    5: ("tcpip_input", "RX", "interface", "err"),
+    6: ("tcp_ack", "TCP", "flags", "ackno"),
+}
+
+
+def read_dump(lines):
+    """Return (header fields, record bytes) of the last dump of the capture."""
+    header, data, in_dump = None, None, False
+    for line in lines:
+        line = line.strip()
+        if line.startswith("TRACE END"):
+            in_dump = False
+        elif line.startswith("TRACE "):
+            header = [int(field) for field in line.split()[1:]]
+            data, in_dump = bytearray(), True
+        elif in_dump and line:
+            data += bytes.fromhex(line)
+    if header is None or in_dump:
+        raise ValueError("no complete trace dump found")
+    return header, bytes(data)
+
+
+def decode(header, data):
+    version, record_size, nb_records, cycles_hz, lost = header
+    if version != SUPPORTED_VERSION:
+        raise ValueError("unsupported trace version %d" % version)
+    if record_size != struct.calcsize(RECORD_FORMAT):
+        raise ValueError("unexpected record size %d" % record_size)
+    if len(data) != nb_records * record_size:
+        raise ValueError("truncated dump")
+
+    events, rows = [], {}
+    last_cycles, elapsed = None, 0
+    for cycles, event_id, arg0, arg1 in struct.iter_unpack(RECORD_FORMAT, data):
+        # Unwrap the 32-bit counter; records of preempted producers may land
+        # slightly out of order, hence the signed difference.
+        if last_cycles is not None:
+            delta = (cycles - last_cycles) & 0xFFFFFFFF
+            if delta >= 0x80000000:
+                delta -= 0x100000000
+            elapsed += delta
+        last_cycles = cycles
+
+        name, row, arg0_name, arg1_name = EVENTS.get(
+            event_id, ("event_%d" % event_id, "other", "arg0", "arg1"))
+        args = {arg0_name: INTERFACES.get(arg0, arg0)
+                if arg0_name == "interface" else arg0}
+        if arg1_name is not None:
+            args[arg1_name] = arg1
+        tid = rows.setdefault(row, len(rows) + 1)
+        events.append({"name": name, "ph": "i", "s": "t", "pid": 1,
+                       "tid": tid, "ts": elapsed * 1e6 / cycles_hz,
+                       "args": args})
+
+    origin = min((event["ts"] for event in events), default=0)
+    for event in events:
+        event["ts"] -= origin
+    events.sort(key=lambda event: event["ts"])
+
+    for row, tid in rows.items():
+        events.append({"name": "thread_name", "ph": "M", "pid": 1,
+                       "tid": tid, "args": {"name": row}})
+    return {"traceEvents": events, "displayTimeUnit": "ns",
+            "otherData": {"records": nb_records, "lost": lost,
+                          "cycles_hz": cycles_hz}}
+
+
+def main(argv):
+    if len(argv) not in (2, 3):
+        sys.stderr.write("usage: %s <console capture> [output.json]\n" % argv[0])
+        return 2
+    with open(argv[1], errors="replace") as capture:
+        header, data = read_dump(capture)
+    trace = decode(header, data)
+    output = open(argv[2], "w") if len(argv) == 3 else sys.stdout
+    json.dump(trace, output)
+    if output is not sys.stdout:
+        output.close()
+    sys.stderr.write("%d records, %d lost\n" % (header[2], header[4]))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,272 @@
+/***************************************************************************//**
+ * @file
+ * @brief Per-client statistics of the SoftAP interface
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+#include <string.h>
+#include "em_core.h"
+#include "sl_sleeptimer.h"
+#include "wifi_cli_params.h"
+#include "wifi_cli_ap_clients.h"
+
+/* Client table, written by the Wi-Fi events task (slots) & the RX/TX paths
+ * (counters) */
+static ap_client_stats_t ap_clients[SL_WFX_CLI_MAX_CLIENTS];
+
+/* Entry of the last frame, most frames belong to the same client */
+static uint32_t ap_clients_last_idx;
+
+/***************************************************************************//**
+ * @brief
+ *    This function returns the current time base of the client table
+ *
+ * @param[in] None
+ *
+ * @param[out] None
+ *
+ * @return  milliseconds since boot
+ ******************************************************************************/
+uint32_t ap_clients_get_time_ms(void)
+{
+  return (uint32_t)((sl_sleeptimer_get_tick_count64() * 1000ULL)
+                    / sl_sleeptimer_get_timer_frequency());
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function looks up the entry of a client
+ *
+ * @param[in]
+ *    + mac: The client MAC address
+ *
+ * @param[out] None
+ *
+ * @return
+ *    The client entry if found
+ *    NULL if not found
+ ******************************************************************************/
+static ap_client_stats_t *ap_clients_find(const uint8_t *mac)
+{
+  uint32_t i;
+  ap_client_stats_t *client = &ap_clients[ap_clients_last_idx];
+
+  if (client->in_use && (memcmp(client->mac, mac, 6) == 0)) {
+      return client;
+  }
+
+  for (i = 0; i < SL_WFX_CLI_MAX_CLIENTS; i++) {
+      if (ap_clients[i].in_use && (memcmp(ap_clients[i].mac, mac, 6) == 0)) {
+          ap_clients_last_idx = i;
+          return &ap_clients[i];
+      }
+  }
+  return NULL;
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function records a client connection. A reconnecting client gets its
+ *    counters reset. When the table is full, the entry of the client
+ *    disconnected for the longest time is reused.
+ *
+ * @param[in]
+ *    + mac: The client MAC address
+ *
+ * @param[out] None
+ *
+ * @return  None
+ ******************************************************************************/
+void ap_clients_connected(const uint8_t *mac)
+{
+  uint32_t i;
+  uint32_t now = ap_clients_get_time_ms();
+  ap_client_stats_t *client = ap_clients_find(mac);
+  CORE_DECLARE_IRQ_STATE;
+
+  if (client == NULL) {
+      for (i = 0; i < SL_WFX_CLI_MAX_CLIENTS; i++) {
+          if (!ap_clients[i].in_use) {
+              client = &ap_clients[i];
+              break;
+          }
+          if (!ap_clients[i].connected
+              && ((client == NULL)
+                  || (now - ap_clients[i].last_seen > now - client->last_seen))) {
+              client = &ap_clients[i];
+          }
+      }
+  }
+
+  if (client == NULL) {
+      LOG_DEBUG("SoftAP client table full");
+      return;
+  }
+
+  /* Don't let the RX/TX paths see a half-written entry */
+  CORE_ENTER_ATOMIC();
+  memset(client, 0, sizeof(*client));
+  memcpy(client->mac, mac, 6);
+  client->connect_time = now;
+  client->last_seen = now;
+  client->last_rssi = AP_CLIENT_RSSI_UNKNOWN;
+  client->connected = true;
+  client->in_use = true;
+  CORE_EXIT_ATOMIC();
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function records a client disconnection, its statistics are kept
+ *
+ * @param[in]
+ *    + mac: The client MAC address
+ *
+ * @param[out] None
+ *
+ * @return  None
+ ******************************************************************************/
+void ap_clients_disconnected(const uint8_t *mac)
+{
+  ap_client_stats_t *client = ap_clients_find(mac);
+
+  if (client != NULL) {
+      client->connected = false;
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function records the disconnection of all the clients
+ *
+ * @param[in] None
+ *
+ * @param[out] None
+ *
+ * @return  None
+ ******************************************************************************/
+void ap_clients_disconnect_all(void)
+{
+  uint32_t i;
+
+  for (i = 0; i < SL_WFX_CLI_MAX_CLIENTS; i++) {
+      ap_clients[i].connected = false;
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function counts a frame received on the SoftAP interface
+ *
+ * @param[in]
+ *    + frame: The Ethernet frame
+ *    + len: The frame length
+ *
+ * @param[out] None
+ *
+ * @return  None
+ ******************************************************************************/
+void ap_clients_record_rx(const uint8_t *frame, uint32_t len)
+{
+  ap_client_stats_t *client;
+
+  if (len < 12) {
+      return;
+  }
+
+  /* Source address */
+  client = ap_clients_find(&frame[6]);
+  if (client != NULL) {
+      client->rx_frames++;
+      client->rx_bytes += len;
+      client->last_seen = ap_clients_get_time_ms();
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function counts a frame sent on the SoftAP interface, broadcast &
+ *    multicast frames are not counted
+ *
+ * @param[in]
+ *    + frame: The Ethernet frame
+ *    + len: The frame length
+ *
+ * @param[out] None
+ *
+ * @return  None
+ ******************************************************************************/
+void ap_clients_record_tx(const uint8_t *frame, uint32_t len)
+{
+  ap_client_stats_t *client;
+
+  /* Destination address, skip group addresses */
+  if ((len < 6) || (frame[0] & 0x01)) {
+      return;
+  }
+
+  client = ap_clients_find(frame);
+  if (client != NULL) {
+      client->tx_frames++;
+      client->tx_bytes += len;
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function records the last RSSI measured for a client
+ *
+ * @param[in]
+ *    + mac: The client MAC address
+ *    + rssi: The RSSI in dBm
+ *
+ * @param[out] None
+ *
+ * @return  None
+ ******************************************************************************/
+void ap_clients_record_rssi(const uint8_t *mac, int16_t rssi)
+{
+  ap_client_stats_t *client = ap_clients_find(mac);
+
+  if (client != NULL) {
+      client->last_rssi = rssi;
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function copies the client table entries in use
+ *
+ * @param[in]
+ *    + max_clients: The output array size
+ *
+ * @param[out]
+ *    + clients: The client entries
+ *
+ * @return  The number of entries copied
+ ******************************************************************************/
+uint32_t ap_clients_get_all(ap_client_stats_t *clients, uint32_t max_clients)
+{
+  uint32_t i;
+  uint32_t nb_clients = 0;
+  CORE_DECLARE_IRQ_STATE;
+
+  for (i = 0; (i < SL_WFX_CLI_MAX_CLIENTS) && (nb_clients < max_clients); i++) {
+      CORE_ENTER_ATOMIC();
+      if (ap_clients[i].in_use) {
+          clients[nb_clients++] = ap_clients[i];
+      }
+      CORE_EXIT_ATOMIC();
+  }
+  return nb_clients;
+}
@@ -0,0 +1,86 @@
+/***************************************************************************//**
+ * @file
+ * @brief Per-client statistics of the SoftAP interface
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+#ifndef WIFI_CLI_AP_CLIENTS_H
+#define WIFI_CLI_AP_CLIENTS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Unknown RSSI value */
+#define AP_CLIENT_RSSI_UNKNOWN  0
+
+/**
+ * Statistics of a SoftAP client. The entry of a disconnected client is kept
+ * until its slot is needed by a new client. Times are in milliseconds since
+ * boot.
+ */
+typedef struct {
+  uint8_t mac[6];
+  bool in_use;
+  bool connected;
+  int16_t last_rssi;      ///< dBm, AP_CLIENT_RSSI_UNKNOWN if never measured
+  uint32_t connect_time;
+  uint32_t last_seen;     ///< Last frame received from the client
+  uint32_t rx_frames;
+  uint32_t rx_bytes;
+  uint32_t tx_frames;
+  uint32_t tx_bytes;
+} ap_client_stats_t;
+
+/**************************************************************************//**
+ * @brief: Record a client connection/disconnection (Wi-Fi events task).
+ *****************************************************************************/
+void ap_clients_connected(const uint8_t *mac);
+void ap_clients_disconnected(const uint8_t *mac);
+
+/**************************************************************************//**
+ * @brief: Record the disconnection of all the clients (SoftAP stopped).
+ *****************************************************************************/
+void ap_clients_disconnect_all(void);
+
+/**************************************************************************//**
+ * @brief: Count an Ethernet frame received from/sent to a client.
+ *****************************************************************************/
+void ap_clients_record_rx(const uint8_t *frame, uint32_t len);
+void ap_clients_record_tx(const uint8_t *frame, uint32_t len);
+
+/**************************************************************************//**
+ * @brief: Record the last RSSI measured for a client.
+ *****************************************************************************/
+void ap_clients_record_rssi(const uint8_t *mac, int16_t rssi);
+
+/**************************************************************************//**
+ * @brief: Copy the client table entries in use.
+ *
+ * @return the number of entries copied.
+ *****************************************************************************/
+uint32_t ap_clients_get_all(ap_client_stats_t *clients, uint32_t max_clients);
+
+/**************************************************************************//**
+ * @brief: Get the current time base of the client table (ms since boot).
+ *****************************************************************************/
+uint32_t ap_clients_get_time_ms(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WIFI_CLI_AP_CLIENTS_H */
@@ -15,12 +15,19 @@
  *
  ******************************************************************************/
 #include "wifi_cli_app.h"
+#include "wifi_cli_nvm.h"
+#include "wifi_cli_boot.h"
+#include "wifi_cli_ram.h"
+#include "wifi_cli_tx_latency.h"
 
 /*******************************************************************************
  ******************   Wi-Fi CLI Start App Task Configuration   *****************
  ******************************************************************************/
 #define WFX_CLI_START_APP_TASK_PRIO             31u
-#define WFX_CLI_START_APP_TASK_STACK_SIZE       256u
+/* The parameter restore runs in this task: an NVM object & a value buffer
+ * (288 bytes), the set functions & printf(). The peak is listed by
+ * `sys ram` once the task has exited. */
+#define WFX_CLI_START_APP_TASK_STACK_SIZE       768u
 
 /* Wifi CLI start app task's stack */
 static CPU_STK wfx_cli_start_app_task_stack[WFX_CLI_START_APP_TASK_STACK_SIZE];
@@ -34,29 +41,45 @@ static void wfx_cli_start_app_task(void *p_arg) {
   PP_UNUSED_PARAM(p_arg);
   RTOS_ERR err;
 
+  /* Display Wi-Fi CLI application name */
+  printf("Wi-Fi CLI Application Example\r\n");
+
+  /* The stages below don't need the WF200: they run while its firmware is
+   * downloaded. The lwIP task runs when this task blocks. */
+
+  /* Start lwIP stack, the interfaces are added once the WF200 is up */
+  lwip_init_start();
+
+  /* Initialize global wifi get/set parameters */
+  wifi_cli_params_init();
+  boot_trace_mark(BOOT_STAGE_PARAMS_LOADED);
+
+  /* Start the write-behind persistence of the parameters */
+  wifi_cli_nvm_init();
+
   /* Wait until finishing wfx_driver initialization */
   OSSemPend(&wfx_init_sem,
             0,
             OS_OPT_PEND_BLOCKING,
             NULL,
             &err);
-
-  /* Display Wi-Fi CLI application name */
-  printf("Wi-Fi CLI Application Example\r\n");
+  boot_trace_mark(BOOT_STAGE_WFX_READY);
 
   /* Start wifi events task handling indication message from wf200 */
   app_wifi_events_start();
 
-  /* Start CLI's commands registration task */
-  wifi_cli_commands_init();
+  /* Restore the parameters applied to the WF200 */
+  wifi_cli_params_restore_wfx();
 
-  /* Start registering global wifi get/set parameters */
-  wifi_cli_params_init();
+  /* Add the network interfaces */
+  lwip_netif_start();
 
-  /* Start lwIP stack & related tasks */
-  lwip_init_start();
+  /* Start CLI's commands registration task, last: the commands use the
+   * WF200, the events task & the network interfaces */
+  wifi_cli_commands_init();
 
   /* Delete this init task */
+  ram_task_exit();
   OSTaskDel(NULL, &err);
 }
 
@@ -67,6 +90,11 @@ void cli_app_init(void)
 {
   RTOS_ERR err;
 
+  boot_trace_mark(BOOT_STAGE_APP_START);
+
+  /* Before the first frame is sent */
+  tx_latency_reset();
+
   /* CLI start app task */
   OSTaskCreate(&wfx_cli_start_app_task_tcb,
                "Wifi CLI app init",
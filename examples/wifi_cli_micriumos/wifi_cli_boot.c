@@ -0,0 +1,142 @@
+/***************************************************************************//**
+ * @file
+ * @brief Boot timeline trace
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+#include <stdio.h>
+#include "em_core.h"
+#include "sl_sleeptimer.h"
+#include "wifi_cli_boot.h"
+
+/* Stage names, indexed by boot_stage_t */
+static const char *const boot_stage_names[BOOT_STAGE_COUNT] = {
+  [BOOT_STAGE_APP_START]      = "app_start",
+  [BOOT_STAGE_TCPIP_READY]    = "tcpip_ready",
+  [BOOT_STAGE_PARAMS_LOADED]  = "params_loaded",
+  [BOOT_STAGE_WFX_READY]      = "wfx_ready",
+  [BOOT_STAGE_NETIF_UP]       = "netif_up",
+  [BOOT_STAGE_CLI_READY]      = "cli_ready",
+  [BOOT_STAGE_STA_CONNECTED]  = "sta_connected",
+  [BOOT_STAGE_STA_IP]         = "sta_ip",
+};
+
+/* Time each stage was reached, in sleeptimer ticks */
+static uint64_t boot_stage_ticks[BOOT_STAGE_COUNT];
+/* Bit per stage: the stage was reached */
+static uint32_t boot_stage_reached;
+
+/***************************************************************************//**
+ * @brief
+ *    This function records the time a stage is reached. Stages are marked
+ *    from several tasks, only the first mark of a stage is kept.
+ *
+ * @param[in]
+ *    + stage: The boot stage
+ *
+ * @param[out] None
+ *
+ * @return  None
+ ******************************************************************************/
+void boot_trace_mark(boot_stage_t stage)
+{
+  uint64_t ticks = sl_sleeptimer_get_tick_count64();
+  CORE_DECLARE_IRQ_STATE;
+
+  if (stage >= BOOT_STAGE_COUNT) {
+      return;
+  }
+
+  CORE_ENTER_ATOMIC();
+  if (!(boot_stage_reached & (1u << stage))) {
+      boot_stage_ticks[stage] = ticks;
+      boot_stage_reached |= (1u << stage);
+  }
+  CORE_EXIT_ATOMIC();
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function returns the time a stage was reached
+ *
+ * @param[in]
+ *    + stage: The boot stage
+ *
+ * @param[out]
+ *    + time_us: The time in microseconds since boot
+ *
+ * @return
+ *    true if the stage was reached
+ *    false otherwise
+ ******************************************************************************/
+bool boot_trace_get(boot_stage_t stage, uint32_t *time_us)
+{
+  if ((stage >= BOOT_STAGE_COUNT) || !(boot_stage_reached & (1u << stage))) {
+      return false;
+  }
+
+  *time_us = (uint32_t)((boot_stage_ticks[stage] * 1000000ULL)
+                        / sl_sleeptimer_get_timer_frequency());
+  return true;
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function displays the boot timeline in the order the stages were
+ *    reached, with the time since boot and since the previous stage. The
+ *    stages not reached yet come last.
+ *
+ * @param[in] None
+ *
+ * @param[out] None
+ *
+ * @return  None
+ ******************************************************************************/
+void boot_trace_print(void)
+{
+  uint32_t i, j, nb_reached = 0;
+  uint32_t time_us, prev_us = 0;
+  uint32_t times_us[BOOT_STAGE_COUNT];
+  uint8_t order[BOOT_STAGE_COUNT];
+
+  /* Sort the reached stages by time */
+  for (i = 0; i < BOOT_STAGE_COUNT; i++) {
+      if (!boot_trace_get((boot_stage_t)i, &time_us)) {
+          continue;
+      }
+      for (j = nb_reached; (j > 0) && (times_us[j - 1] > time_us); j--) {
+          times_us[j] = times_us[j - 1];
+          order[j] = order[j - 1];
+      }
+      times_us[j] = time_us;
+      order[j] = (uint8_t)i;
+      nb_reached++;
+  }
+
+  printf("%-16s %12s %12s\r\n", "stage", "time (ms)", "delta (ms)");
+  for (i = 0; i < nb_reached; i++) {
+      printf("%-16s %8lu.%03lu %8lu.%03lu\r\n",
+             boot_stage_names[order[i]],
+             (unsigned long)(times_us[i] / 1000),
+             (unsigned long)(times_us[i] % 1000),
+             (unsigned long)((times_us[i] - prev_us) / 1000),
+             (unsigned long)((times_us[i] - prev_us) % 1000));
+      prev_us = times_us[i];
+  }
+
+  for (i = 0; i < BOOT_STAGE_COUNT; i++) {
+      if (!(boot_stage_reached & (1u << i))) {
+          printf("%-16s %12s\r\n", boot_stage_names[i], "-");
+      }
+  }
+}
@@ -0,0 +1,64 @@
+/***************************************************************************//**
+ * @file
+ * @brief Boot timeline trace
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+#ifndef WIFI_CLI_BOOT_H
+#define WIFI_CLI_BOOT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Boot stages, in their nominal order. The stages before BOOT_STAGE_WFX_READY
+ * run concurrently with the WF200 firmware download.
+ */
+typedef enum {
+  BOOT_STAGE_APP_START = 0,   ///< Wi-Fi CLI app initialization
+  BOOT_STAGE_TCPIP_READY,     ///< lwIP tcpip thread running
+  BOOT_STAGE_PARAMS_LOADED,   ///< Parameters restored from NVM3
+  BOOT_STAGE_WFX_READY,       ///< WF200 firmware booted
+  BOOT_STAGE_NETIF_UP,        ///< Network interfaces added
+  BOOT_STAGE_CLI_READY,       ///< CLI commands registered
+  BOOT_STAGE_STA_CONNECTED,   ///< First station connection
+  BOOT_STAGE_STA_IP,          ///< First station address from the DHCP server
+  BOOT_STAGE_COUNT
+} boot_stage_t;
+
+/**************************************************************************//**
+ * @brief: Record the time a stage is reached, only the first time counts.
+ *****************************************************************************/
+void boot_trace_mark(boot_stage_t stage);
+
+/**************************************************************************//**
+ * @brief: Get the time a stage was reached.
+ *
+ * @return true if reached, the time is then in microseconds since boot.
+ *****************************************************************************/
+bool boot_trace_get(boot_stage_t stage, uint32_t *time_us);
+
+/**************************************************************************//**
+ * @brief: Display the boot timeline.
+ *****************************************************************************/
+void boot_trace_print(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WIFI_CLI_BOOT_H */
@@ -24,6 +24,8 @@
 #include "sl_cli_handles.h"
 #include "wifi_cli_cmd_registration.h"
 #include "wifi_cli_get_set_cb_func.h"
+#include "wifi_cli_boot.h"
+#include "wifi_cli_ram.h"
 
 /*******************************************************************************
  ***********  Wi-Fi CLI Commands Registration Task Configuration   *************
@@ -195,6 +197,12 @@ static const sl_cli_command_info_t cli_cmd_get_softap_client_list = \
                   "softap.client_list" SL_CLI_UNIT_SEPARATOR,
                   {SL_CLI_ARG_WILDCARD, SL_CLI_ARG_END, });
 
+static const sl_cli_command_info_t cli_cmd_get_all_params = \
+   SL_CLI_COMMAND(get_all_params,
+                  "Get all parameters (name=value lines)",
+                  "*" SL_CLI_UNIT_SEPARATOR,
+                  {SL_CLI_ARG_WILDCARD, SL_CLI_ARG_END, });
+
 /**************************************************************************//**
  * @brief: Grouping all get commands
  *****************************************************************************/
@@ -223,6 +231,7 @@ static const sl_cli_command_entry_t cmd_get_grp_table[] = {
     {"softap.mac", &cli_cmd_get_softap_mac, false},
     {"softap.dhcp_server_state", &cli_cmd_get_softap_dhcp_server_state, false},
     {"softap.client_list", &cli_cmd_get_softap_client_list, false},
+    {"*", &cli_cmd_get_all_params, false},
     {NULL, NULL, false}
 };
 
@@ -343,6 +352,12 @@ static const sl_cli_command_info_t cli_cmd_set_mac_key = \
                   "wifi.mac_key" SL_CLI_UNIT_SEPARATOR,
                   {SL_CLI_ARG_STRING, SL_CLI_ARG_END, });
 
+static const sl_cli_command_info_t cli_cmd_set_params_bulk = \
+   SL_CLI_COMMAND(set_params_bulk,
+                  "Set several parameters in one transaction",
+                  "-f <name=value> [name=value ...]" SL_CLI_UNIT_SEPARATOR,
+                  {SL_CLI_ARG_WILDCARD, SL_CLI_ARG_END, });
+
 /**************************************************************************//**
  * @brief: Grouping all set commands
  *****************************************************************************/
@@ -365,6 +380,7 @@ static const sl_cli_command_entry_t cmd_set_grp_table[] = {
     {"softap.mac", &cli_cmd_set_softap_mac, false},
     {"softap.dhcp_server_state", &cli_cmd_set_softap_dhcp_server_state, false},
     {"wifi.mac_key", &cli_cmd_set_mac_key, false},
+    {"-f", &cli_cmd_set_params_bulk, false},
     {NULL, NULL, false}
 };
 
@@ -382,12 +398,12 @@ static const sl_cli_command_info_t cli_cmd_wifi_init = \
                    {SL_CLI_ARG_WILDCARD, SL_CLI_ARG_END, });
 
 /**************************************************************************//**
- * @brief: Construct the wifi station's setting parameters save command
+ * @brief: Construct the parameters save command
  ******************************************************************************/
 static const sl_cli_command_info_t cli_cmd_wifi_save = \
     SL_CLI_COMMAND(wifi_save,
-                   "Save the Station information to NVM memory",
-                   "Save the Station information to NVM memory"
+                   "Write the pending parameter changes to NVM memory",
+                   "Write the pending parameter changes to NVM memory"
                    SL_CLI_UNIT_SEPARATOR,
                    {SL_CLI_ARG_WILDCARD, SL_CLI_ARG_END, });
 
@@ -411,7 +427,7 @@ static const sl_cli_command_info_t cli_cmd_wifi_sta_disconnect = \
 static const sl_cli_command_info_t cli_cmd_wifi_sta_scan = \
     SL_CLI_COMMAND(wifi_station_scan,
                    "Perform a Wi-Fi scan",
-                   "Wifi Scan" SL_CLI_UNIT_SEPARATOR,
+                   "[-j]: JSON output" SL_CLI_UNIT_SEPARATOR,
                    {SL_CLI_ARG_WILDCARD, SL_CLI_ARG_END, });
 
 static const sl_cli_command_info_t cli_cmd_wifi_sta_rssi = \
@@ -443,6 +459,23 @@ static const sl_cli_command_info_t cli_cmd_wifi_softap_rssi = \
                    "(MAC format: 00:00:00:00:00:00)" SL_CLI_UNIT_SEPARATOR,
                    {SL_CLI_ARG_STRING, SL_CLI_ARG_END, });
 
+static const sl_cli_command_info_t cli_cmd_wifi_softap_clients = \
+    SL_CLI_COMMAND(wifi_softap_clients,
+                   "Get the statistics of the SoftAP clients (JSON)",
+                   "[-r]: refresh the RSSI of the connected clients"
+                   SL_CLI_UNIT_SEPARATOR,
+                   {SL_CLI_ARG_WILDCARD, SL_CLI_ARG_END, });
+
+/**************************************************************************//**
+ * @brief: Construct the wifi TX latency command
+ ******************************************************************************/
+static const sl_cli_command_info_t cli_cmd_wifi_tx_latency = \
+    SL_CLI_COMMAND(wifi_tx_latency,
+                   "Get the TX frame latency, from enqueue to confirmation",
+                   "[-H]: print the histogram buckets, "
+                   "[-r]: clear the statistics" SL_CLI_UNIT_SEPARATOR,
+                   {SL_CLI_ARG_WILDCARD, SL_CLI_ARG_END, });
+
 /**************************************************************************//**
  * @brief: Construct wifi powermode, powersave commands
  ******************************************************************************/
@@ -455,6 +488,14 @@ static const sl_cli_command_info_t cli_cmd_wifi_power_mode = \
                    SL_CLI_UNIT_SEPARATOR,
                    {SL_CLI_ARG_STRING, SL_CLI_ARG_WILDCARD, SL_CLI_ARG_END, });
 
+static const sl_cli_command_info_t cli_cmd_wifi_ps_policy = \
+    SL_CLI_COMMAND(wifi_ps_policy,
+                   "Switch the station power mode with its traffic rate",
+                   "wifi ps_policy [ON | OFF] [-p period_ms] [-a active_fps] "
+                   "[-i idle_fps] [-A active_hold_ms] [-I idle_hold_ms] "
+                   "[-d dtim_skip]" SL_CLI_UNIT_SEPARATOR,
+                   {SL_CLI_ARG_WILDCARD, SL_CLI_ARG_END, });
+
 static const sl_cli_command_info_t cli_cmd_wifi_station_power_save = \
     SL_CLI_COMMAND(wifi_station_power_save,
                    "Enable/disable the Power Save on the WLAN interface "
@@ -514,8 +555,11 @@ static const sl_cli_command_entry_t wifi_cli_cmds_table[] = {
     {"start_softap", &cli_cmd_wifi_start_softap, false},
     {"stop_softap", &cli_cmd_wifi_stop_softap, false},
     {"softap_rssi", &cli_cmd_wifi_softap_rssi, false},
+    {"softap_clients", &cli_cmd_wifi_softap_clients, false},
+    {"tx_latency", &cli_cmd_wifi_tx_latency, false},
     {"powermode", &cli_cmd_wifi_power_mode, false},
     {"powersave", &cli_cmd_wifi_station_power_save, false},
+    {"ps_policy", &cli_cmd_wifi_ps_policy, false},
     {"test", &cli_cmd_wifi_test_agent, false},
     {"slk_renegotiate", &cli_cmd_wifi_slk_rekey, false},
     {"slk_add", &cli_cmd_wifi_slk_add, false},
@@ -541,8 +585,8 @@ static const sl_cli_command_entry_t wifi_table[] = {
 ******************************************************************************/
 static const sl_cli_command_info_t cli_cmd_lwip_ip_stats = \
     SL_CLI_COMMAND(lwip_ip_stats,
-                   "Display the LwIP stack statistics",
-                   "lwip-stats",
+                   "Display the LwIP stack counters changed since the previous call",
+                   "lwip stats [-w window_ms | -a]",
                    {SL_CLI_ARG_WILDCARD, SL_CLI_ARG_END, });
 
 /**************************************************************************//**
@@ -561,13 +605,75 @@ static const sl_cli_command_entry_t lwip_table[] = {
     {NULL, NULL, false}
 };
 
+/**************************************************************************//**
+* @brief: Construct the boot timeline command
+******************************************************************************/
+static const sl_cli_command_info_t cli_cmd_sys_boot = \
+    SL_CLI_COMMAND(sys_boot_timeline,
+                   "Display the boot timeline (ms since boot)",
+                   "sys boot",
+                   {SL_CLI_ARG_WILDCARD, SL_CLI_ARG_END, });
+
+/**************************************************************************//**
+* @brief: Construct the RAM usage command
+******************************************************************************/
+static const sl_cli_command_info_t cli_cmd_sys_ram = \
+    SL_CLI_COMMAND(sys_ram_report,
+                   "Display the task stack peaks, lwIP memory peaks & RAM budget",
+                   "sys ram",
+                   {SL_CLI_ARG_WILDCARD, SL_CLI_ARG_END, });
+
+/**************************************************************************//**
+* @brief: Construct the CPU usage command
+******************************************************************************/
+static const sl_cli_command_info_t cli_cmd_sys_cpu = \
+    SL_CLI_COMMAND(sys_cpu_report,
+                   "Display the per-task CPU usage over a sampling window",
+                   "sys cpu [-w window_ms]",
+                   {SL_CLI_ARG_WILDCARD, SL_CLI_ARG_END, });
+
+/**************************************************************************//**
+* @brief: Construct the hot-path trace command
+******************************************************************************/
+static const sl_cli_command_info_t cli_cmd_sys_trace = \
+    SL_CLI_COMMAND(sys_trace,
+                   "Record the TX/RX hot-path events & dump them",
+                   "sys trace <start | stop | dump>",
+                   {SL_CLI_ARG_WILDCARD, SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd_sys_metrics = \
+    SL_CLI_COMMAND(sys_metrics,
+                   "Display the metrics served over HTTP on /metrics",
+                   "[-j]: JSON snapshot (/metrics/json)" SL_CLI_UNIT_SEPARATOR,
+                   {SL_CLI_ARG_WILDCARD, SL_CLI_ARG_END, });
+
+/**************************************************************************//**
+* @brief: Create the sys_table
+******************************************************************************/
+static const sl_cli_command_entry_t sys_cli_cmds_table[] = {
+    {"boot", &cli_cmd_sys_boot, false},
+    {"ram", &cli_cmd_sys_ram, false},
+    {"cpu", &cli_cmd_sys_cpu, false},
+    {"trace", &cli_cmd_sys_trace, false},
+    {"metrics", &cli_cmd_sys_metrics, false},
+    {NULL, NULL, false}
+};
+
+static const sl_cli_command_info_t sys_cli_cmds = \
+    SL_CLI_COMMAND_GROUP(sys_cli_cmds_table, "System CLI commands");
+
+static const sl_cli_command_entry_t sys_table[] = {
+    {"sys", &sys_cli_cmds, false},
+    {NULL, NULL, false}
+};
+
 /**************************************************************************//**
 * @brief: Construct iperf-related commands
 *****************************************************************************/
 static const sl_cli_command_info_t cli_cmd_iperf = \
     SL_CLI_COMMAND(iperf,
                    "Start a TCP iPerf test as a client or a server",
-                   "iperf <-c ip [-t dur] [-p port] [-k] | -s>",
+                   "iperf <-c ip [-t dur | -n bytes] [-l len] [-p port] [-k] [-3 [-R]] [-i] | -s [-3] [-i]>",
                    {SL_CLI_ARG_WILDCARD, SL_CLI_ARG_END, });
 
 static const sl_cli_command_info_t cli_cmd_iperf_server_stop = \
@@ -588,7 +694,7 @@ static const sl_cli_command_info_t cli_cmd_iperf_client_stop = \
 static const sl_cli_command_info_t cli_cmd_ping = \
     SL_CLI_COMMAND(ping_cmd_cb,
                    "Send ICMP ECHO_REQUEST to network hosts",
-                   "[-n nb] <ip>",
+                   "[-n nb] [-i interval_ms | -f] [-s size] [-W timeout_ms] [-H] <ip>",
                    {SL_CLI_ARG_WILDCARD, SL_CLI_ARG_END, });
 
 /**************************************************************************//**
@@ -630,6 +736,15 @@ static sl_cli_command_group_t lwip_group = {
   lwip_table
 };
 
+/**************************************************************************//**
+* @brief: Create the sys_group as the top level from the sys_table
+*****************************************************************************/
+static sl_cli_command_group_t sys_group = {
+  { NULL },
+  false,
+  sys_table
+};
+
 /***************************************************************************//**
 * @brief
 *    This function calls APIs to add command groups to the CLI service
@@ -658,6 +773,10 @@ static bool register_cli_commands(void)
   status |= sl_cli_command_add_command_group(sl_cli_inst_handle, &lwip_group);
   EFM_ASSERT(status);
 
+  /* Add the sys_group commands */
+  status |= sl_cli_command_add_command_group(sl_cli_inst_handle, &sys_group);
+  EFM_ASSERT(status);
+
   return status;
 }
 
@@ -681,8 +800,10 @@ static void wfx_cli_cmd_registration_task(void *p_arg)
       LOG_DEBUG("Failed to register CLI commands \r\n");
       return;
   }
+  boot_trace_mark(BOOT_STAGE_CLI_READY);
 
   /* Delete this task */
+  ram_task_exit();
   OSTaskDel(NULL, &err);
 }
 
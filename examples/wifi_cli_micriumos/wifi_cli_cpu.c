@@ -0,0 +1,321 @@
+/***************************************************************************//**
+ * @file
+ * @brief Per-task CPU utilization profiler
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "os.h"
+#include "wifi_cli_cpu.h"
+
+/* The profiler needs the kernel task list, per-task profiling & timestamps */
+#if (OS_CFG_DBG_EN == DEF_ENABLED) && (OS_CFG_TASK_PROFILE_EN == DEF_ENABLED) \
+  && (OS_CFG_TS_EN == DEF_ENABLED)
+#define CPU_PROFILE_EN  1
+#else
+#define CPU_PROFILE_EN  0
+#endif
+
+/* Report working storage (the report is only displayed by the CLI task) */
+static cpu_profile_t cpu_report_prof;
+static cpu_task_usage_t cpu_report_usage[CPU_PROFILE_MAX_TASKS];
+
+#if CPU_PROFILE_EN
+/***************************************************************************//**
+ * @brief
+ *    This function converts timestamp cycles to microseconds
+ *
+ * @param[in]
+ *    + cycles: The number of timestamp cycles
+ *
+ * @param[out] None
+ *
+ * @return  The duration in microseconds
+ ******************************************************************************/
+static uint32_t cpu_cycles_to_us(uint32_t cycles)
+{
+  RTOS_ERR err;
+  CPU_TS_TMR_FREQ freq = CPU_TS_TmrFreqGet(&err);
+
+  if ((RTOS_ERR_CODE_GET(err) != RTOS_ERR_NONE) || (freq == 0)) {
+      return 0;
+  }
+  return (uint32_t)(((uint64_t)cycles * 1000000ULL) / freq);
+}
+#endif
+
+/***************************************************************************//**
+ * @brief
+ *    This function starts a sampling window: it records the counters of the
+ *    running tasks
+ *
+ * @param[in] None
+ *
+ * @param[out]
+ *    + prof: The profile
+ *
+ * @return  None
+ ******************************************************************************/
+void cpu_profile_begin(cpu_profile_t *prof)
+{
+#if CPU_PROFILE_EN
+  RTOS_ERR err;
+  OS_TCB *p_tcb;
+  uint32_t nb_tasks = 0;
+
+  /* Keep the task list stable while walking it */
+  OSSchedLock(&err);
+  prof->start_ts = (uint32_t)OS_TS_GET();
+  for (p_tcb = OSTaskDbgListPtr;
+       (p_tcb != NULL) && (nb_tasks < CPU_PROFILE_MAX_TASKS);
+       p_tcb = p_tcb->DbgNextPtr) {
+      prof->tcb[nb_tasks] = p_tcb;
+      prof->ctx_sw[nb_tasks] = (uint32_t)p_tcb->CtxSwCtr;
+      prof->cycles[nb_tasks] = (uint32_t)p_tcb->CyclesTotal;
+      nb_tasks++;
+  }
+  prof->nb_tasks = nb_tasks;
+  OSSchedUnlock(&err);
+#else
+  memset(prof, 0, sizeof(*prof));
+#endif
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function returns the usage of the tasks since the window start,
+ *    sorted by decreasing CPU usage, & starts the next window
+ *
+ * @param[in]
+ *    + prof: The profile
+ *    + max_usage: The output array size
+ *
+ * @param[out]
+ *    + usage: The task usage entries
+ *
+ * @return
+ *    The number of entries written
+ *    -1 if the kernel profiling is disabled
+ ******************************************************************************/
+int cpu_profile_sample(cpu_profile_t *prof,
+                       cpu_task_usage_t *usage,
+                       uint32_t max_usage)
+{
+#if CPU_PROFILE_EN
+  RTOS_ERR err;
+  OS_TCB *p_tcb;
+  cpu_task_usage_t entry;
+  uint32_t i, j, nb_usage = 0, nb_tasks = 0;
+  uint32_t now_ts, window, ctx_sw, cycles;
+  uint32_t prev_ctx_sw, prev_cycles;
+
+  OSSchedLock(&err);
+  now_ts = (uint32_t)OS_TS_GET();
+  window = now_ts - prof->start_ts;
+
+  for (p_tcb = OSTaskDbgListPtr; p_tcb != NULL; p_tcb = p_tcb->DbgNextPtr) {
+      ctx_sw = (uint32_t)p_tcb->CtxSwCtr;
+      cycles = (uint32_t)p_tcb->CyclesTotal;
+
+      /* A task missing from the previous sample was created since */
+      prev_ctx_sw = 0;
+      prev_cycles = 0;
+      for (i = 0; i < prof->nb_tasks; i++) {
+          if (prof->tcb[i] == p_tcb) {
+              prev_ctx_sw = prof->ctx_sw[i];
+              prev_cycles = prof->cycles[i];
+              break;
+          }
+      }
+      /* The counters restart from 0 after a statistics reset, the cycles
+       * may wrap: the unsigned difference stays right */
+      if (ctx_sw < prev_ctx_sw) {
+          prev_ctx_sw = 0;
+          prev_cycles = 0;
+      }
+
+      entry.name = p_tcb->NamePtr;
+      entry.ctx_switches = ctx_sw - prev_ctx_sw;
+      entry.usage = (window > 0)
+                    ? (uint32_t)(((uint64_t)(cycles - prev_cycles) * 10000u) / window)
+                    : 0;
+#ifdef CPU_CFG_INT_DIS_MEAS_EN
+      entry.int_dis_max_us = cpu_cycles_to_us((uint32_t)p_tcb->IntDisTimeMax);
+#else
+      entry.int_dis_max_us = 0;
+#endif
+
+      /* Insert sorted by decreasing usage, the least busy tasks drop out */
+      for (j = nb_usage; (j > 0) && (usage[j - 1].usage < entry.usage); j--) {
+          if (j < max_usage) {
+              usage[j] = usage[j - 1];
+          }
+      }
+      if (j < max_usage) {
+          usage[j] = entry;
+          if (nb_usage < max_usage) {
+              nb_usage++;
+          }
+      }
+
+      /* Start of the next window */
+      if (nb_tasks < CPU_PROFILE_MAX_TASKS) {
+          prof->tcb[nb_tasks] = p_tcb;
+          prof->ctx_sw[nb_tasks] = ctx_sw;
+          prof->cycles[nb_tasks] = cycles;
+          nb_tasks++;
+      }
+  }
+  prof->nb_tasks = nb_tasks;
+  prof->start_ts = now_ts;
+  OSSchedUnlock(&err);
+
+  return (int)nb_usage;
+#else
+  (void)prof;
+  (void)usage;
+  (void)max_usage;
+  return -1;
+#endif
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function returns the kernel counters of the running tasks. Unlike a
+ *    profile, it doesn't need a sampling window: the usage is the one
+ *    computed by the kernel statistic task over its last period.
+ *
+ * @param[in]
+ *    + max_tasks: The output array size
+ *
+ * @param[out]
+ *    + tasks: The task counters
+ *
+ * @return
+ *    The number of entries written
+ *    -1 if the kernel profiling is disabled
+ ******************************************************************************/
+int cpu_get_task_counters(cpu_task_counters_t *tasks, uint32_t max_tasks)
+{
+#if CPU_PROFILE_EN && (OS_CFG_STAT_TASK_EN == DEF_ENABLED)
+  RTOS_ERR err;
+  OS_TCB *p_tcb;
+  uint32_t nb_tasks = 0;
+
+  OSSchedLock(&err);
+  for (p_tcb = OSTaskDbgListPtr;
+       (p_tcb != NULL) && (nb_tasks < max_tasks);
+       p_tcb = p_tcb->DbgNextPtr) {
+      tasks[nb_tasks].name = p_tcb->NamePtr;
+      tasks[nb_tasks].usage = (uint32_t)p_tcb->CPUUsage;
+      tasks[nb_tasks].ctx_switches = (uint32_t)p_tcb->CtxSwCtr;
+      nb_tasks++;
+  }
+  OSSchedUnlock(&err);
+
+  return (int)nb_tasks;
+#else
+  (void)tasks;
+  (void)max_tasks;
+  return -1;
+#endif
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function returns the total CPU usage computed by the kernel
+ *    statistic task over its last period
+ *
+ * @param[in] None
+ *
+ * @param[out] None
+ *
+ * @return
+ *    The usage in 0.01 %
+ *    -1 if the kernel statistic task is disabled
+ ******************************************************************************/
+int32_t cpu_get_usage(void)
+{
+#if (OS_CFG_STAT_TASK_EN == DEF_ENABLED)
+  return (int32_t)OSStatTaskCPUUsage;
+#else
+  return -1;
+#endif
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function measures the tasks over a window & displays their CPU
+ *    usage, context switches & max interrupt-disable time. The calling task
+ *    sleeps during the window.
+ *
+ * @param[in]
+ *    + window_ms: The sampling window in milliseconds
+ *
+ * @param[out] None
+ *
+ * @return  None
+ ******************************************************************************/
+void cpu_report_print(uint32_t window_ms)
+{
+  RTOS_ERR err;
+  int nb_usage;
+  uint32_t i, total = 0;
+
+#if (OS_CFG_STAT_TASK_EN == DEF_ENABLED)
+  /* Restart the max values (interrupt-disable time, ...) with the window */
+  OSStatReset(&err);
+#endif
+  cpu_profile_begin(&cpu_report_prof);
+  OSTimeDly((OS_TICK)((window_ms * OSCfg_TickRate_Hz + 999u) / 1000u),
+            OS_OPT_TIME_DLY,
+            &err);
+  nb_usage = cpu_profile_sample(&cpu_report_prof,
+                                cpu_report_usage,
+                                CPU_PROFILE_MAX_TASKS);
+  if (nb_usage < 0) {
+      printf("CPU profiling not available (OS_CFG_DBG_EN, "
+             "OS_CFG_TASK_PROFILE_EN & OS_CFG_TS_EN needed)\r\n");
+      return;
+  }
+
+  printf("CPU usage over %lu ms", (unsigned long)window_ms);
+#if (OS_CFG_STAT_TASK_EN == DEF_ENABLED)
+  printf(" (stat task: %u.%02u%%)",
+         (unsigned int)(OSStatTaskCPUUsage / 100u),
+         (unsigned int)(OSStatTaskCPUUsage % 100u));
+#endif
+  printf("\r\n%-32s %7s %8s %12s\r\n",
+         "task", "cpu%", "ctx sw", "int dis (us)");
+  for (i = 0; i < (uint32_t)nb_usage; i++) {
+      printf("%-32.32s %4lu.%02lu %8lu %12lu\r\n",
+             (cpu_report_usage[i].name != NULL) ? cpu_report_usage[i].name : "?",
+             (unsigned long)(cpu_report_usage[i].usage / 100u),
+             (unsigned long)(cpu_report_usage[i].usage % 100u),
+             (unsigned long)cpu_report_usage[i].ctx_switches,
+             (unsigned long)cpu_report_usage[i].int_dis_max_us);
+      total += cpu_report_usage[i].usage;
+  }
+  /* Interrupt handlers & the kernel idle loop if there's no idle task */
+  total = (total < 10000u) ? 10000u - total : 0;
+  printf("%-32s %4lu.%02lu\r\n",
+         "other (ISR, idle)",
+         (unsigned long)(total / 100u),
+         (unsigned long)(total % 100u));
+
+#ifdef CPU_CFG_INT_DIS_MEAS_EN
+  printf("Max interrupt-disable time since boot: %lu us\r\n",
+         (unsigned long)cpu_cycles_to_us((uint32_t)CPU_IntDisMeasMaxGet()));
+#endif
+}
@@ -0,0 +1,97 @@
+/***************************************************************************//**
+ * @file
+ * @brief Per-task CPU utilization profiler
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+#ifndef WIFI_CLI_CPU_H
+#define WIFI_CLI_CPU_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CPU_PROFILE_MAX_TASKS       24    ///< Max tasks followed by a profile
+#define CPU_PROFILE_DEFAULT_WINDOW  1000  ///< Default sampling window (ms)
+
+/* CPU usage of a task over a sampling window */
+typedef struct {
+  const char *name;
+  uint32_t usage;             ///< 0.01 % of the window
+  uint32_t ctx_switches;      ///< Times the task was switched in
+  uint32_t int_dis_max_us;    ///< Max interrupt-disable time since the last
+                              ///< statistics reset
+} cpu_task_usage_t;
+
+/* Kernel counters of a task, since its creation or the last statistics reset */
+typedef struct {
+  const char *name;
+  uint32_t usage;             ///< 0.01 %, over the last statistic task period
+  uint32_t ctx_switches;      ///< Times the task was switched in
+} cpu_task_counters_t;
+
+/**
+ * Profile of the tasks: the counters at the start of the current window.
+ * Tasks created during the window are counted from their creation.
+ */
+typedef struct {
+  const void *tcb[CPU_PROFILE_MAX_TASKS];
+  uint32_t ctx_sw[CPU_PROFILE_MAX_TASKS];
+  uint32_t cycles[CPU_PROFILE_MAX_TASKS];
+  uint32_t nb_tasks;
+  uint32_t start_ts;
+} cpu_profile_t;
+
+/**************************************************************************//**
+ * @brief: Start a sampling window.
+ *****************************************************************************/
+void cpu_profile_begin(cpu_profile_t *prof);
+
+/**************************************************************************//**
+ * @brief: Get the task usage since the window start, sorted by decreasing
+ *         CPU usage, & start the next window.
+ *
+ * @return the number of entries written, -1 if the kernel profiling is
+ *         disabled.
+ *****************************************************************************/
+int cpu_profile_sample(cpu_profile_t *prof,
+                       cpu_task_usage_t *usage,
+                       uint32_t max_usage);
+
+/**************************************************************************//**
+ * @brief: Get the kernel counters of the running tasks, without blocking.
+ *
+ * @return the number of entries written, -1 if the kernel profiling is
+ *         disabled.
+ *****************************************************************************/
+int cpu_get_task_counters(cpu_task_counters_t *tasks, uint32_t max_tasks);
+
+/**************************************************************************//**
+ * @brief: Get the total CPU usage (0.01 %), -1 if the kernel statistic task
+ *         is disabled.
+ *****************************************************************************/
+int32_t cpu_get_usage(void);
+
+/**************************************************************************//**
+ * @brief: Measure the tasks over a window & display their usage (blocking).
+ *****************************************************************************/
+void cpu_report_print(uint32_t window_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WIFI_CLI_CPU_H */
@@ -21,6 +21,17 @@
 #include "app_wifi_events.h"
 #include "wifi_cli_params.h"
 #include "wifi_cli_lwip.h"
+#include "wifi_cli_nvm.h"
+#include "wifi_cli_json.h"
+#include "wifi_cli_ap_clients.h"
+#include "wifi_cli_tx_latency.h"
+#include "wifi_cli_boot.h"
+#include "wifi_cli_ram.h"
+#include "wifi_cli_cpu.h"
+#include "wifi_cli_trace.h"
+#include "wifi_cli_metrics.h"
+#include "wifi_cli_net_stats.h"
+#include "wifi_cli_ps_policy.h"
 
 
 /***************************************************************************//**
@@ -66,7 +77,9 @@ static int slk_bitmap_change(char *msg_id, secure_link_bitmap_change_fn_t func)
   func(slk_bitmap, (uint8_t)strtol(msg_id, NULL, 0));
 
   /* Update the driver bitmap */
+  wifi_cli_wfx_lock();
   status = sl_wfx_secure_link_configure(slk_bitmap, 0);
+  wifi_cli_wfx_unlock();
   if (status == SL_STATUS_OK) {
     res = 0;
   }
@@ -133,15 +146,19 @@ static void set_wifi_param_common(sl_cli_command_arg_t *args)
   }
 
   /* Invoke the registered set callback function */
-  wifi_params[param_idx].set_func(wifi_params[param_idx].name,
-                                  wifi_params[param_idx].address,
-                                  wifi_params[param_idx].size,
-                                  val_ptr);
+  if (wifi_params[param_idx].set_func(wifi_params[param_idx].name,
+                                      wifi_params[param_idx].address,
+                                      wifi_params[param_idx].size,
+                                      val_ptr) == 0) {
+      /* Persist the new value with the next flush */
+      wifi_cli_nvm_mark_dirty(param_idx);
+  }
 }
 
 /***************************************************************************//**
  * @brief
- *    This common function invokes the registered get function
+ *    This common function renders a parameter through its registered get
+ *    function & displays it
  *
  * @param[in]
  *
@@ -151,21 +168,16 @@ static void set_wifi_param_common(sl_cli_command_arg_t *args)
  ******************************************************************************/
 static void get_wifi_param_common(sl_cli_command_arg_t *args)
 {
-  /* Search the global param index with param name */
+  char value_buf[BUF_LEN];
   char *param_name = sl_cli_get_command_string(args, 2);
-  int param_idx = param_search(param_name);
-  if (param_idx < 0) {
-      LOG_DEBUG("The %s parameter hasn't been registered", param_name);
+
+  /* Render the parameter through its registered get callback function */
+  if (wifi_cli_param_get(param_name, value_buf, sizeof(value_buf)) < 0) {
+      LOG_DEBUG("Failed to render the %s parameter", param_name);
       printf("Failed to get the %s parameter\r\n", param_name);
       return;
   }
-
-  /* Invoke the registered get callback function */
-  wifi_params[param_idx].get_func(wifi_params[param_idx].name,
-                                  wifi_params[param_idx].address,
-                                  wifi_params[param_idx].size,
-                                  NULL,
-                                  0);
+  printf("%s\r\n", value_buf);
 }
 
 /***************************************************************************//**
@@ -317,94 +329,8 @@ void get_station_dhcp_client_state(sl_cli_command_arg_t *args)
  *****************************************************************************/
 void set_station_dhcp_client_state(sl_cli_command_arg_t *args)
 {
-  int param_idx;
-  char *cmd = NULL;
-  uint8_t new_state;
-  int station_netif_idx;
-  char *state_ptr = NULL;
-  struct netif *station_netif = NULL;
-  ip_addr_t sta_ipaddr, sta_netmask, sta_gw;
-
-  /* Get input string */
-  state_ptr = sl_cli_get_argument_string(args, 0);
-
-  if (get_on_off_state(state_ptr, &new_state) < 0) {
-      printf("Invalid argument.\n"
-             "Please input OFF for Disable; ON for Enable\r\n");
-      return;
-  }
-
-  /* Find and point to the station network interface struct */
-  station_netif_idx = param_search("station.ip");
-  if (station_netif_idx < 0) {
-      LOG_DEBUG("The sta_netif parameter hasn't been registered");
-      goto error;
-  }
-
-  /* Pointer to sta_netif struct */
-  station_netif = wifi_params[station_netif_idx].address;
-
-  /** To limit undefined behaviors and ease the development
-  *   only accept a DHCP state change while the WLAN interface is down.
-  */
-  if (wifi.state & SL_WFX_STA_INTERFACE_CONNECTED) {
-      printf("Operation denied: stop WLAN first\r\n");
-      return;
-  }
-
-  /* Retrieve use_dhcp_client param */
-  cmd = sl_cli_get_command_string(args, 2);
-  param_idx = param_search(cmd);
-
-  if (param_idx < 0) {
-      LOG_DEBUG("The use_dhcp_client parameter hasn't been registered");
-      goto error;
-  }
-
-  /* Check if the new_state differs from the old state */
-  if (*(uint8_t*)wifi_params[param_idx].address == new_state) {
-      printf("Station client DHCP state is already set to %s\r\n",
-             new_state == 0 ? "OFF" : "ON");
-      return;
-  }
-
-  /* Update the DHCP client state (use_dhcp_client) */
-  *(uint8_t*)wifi_params[param_idx].address = new_state;
-
-  if (new_state == 0) {
-      /* Disable the DHCP requests*/
-      dhcpclient_set_link_state(0);
-
-      /* Restore default static addresses*/
-      IP_ADDR4(&sta_ipaddr,
-               sta_ip_addr0,
-               sta_ip_addr1,
-               sta_ip_addr2,
-               sta_ip_addr3);
-
-      IP_ADDR4(&sta_netmask,
-               sta_netmask_addr0,
-               sta_netmask_addr1,
-               sta_netmask_addr2,
-               sta_netmask_addr3);
-
-      IP_ADDR4(&sta_gw,
-               sta_gw_addr0,
-               sta_gw_addr1,
-               sta_gw_addr2,
-               sta_gw_addr3);
-
-      netif_set_addr(station_netif, &sta_ipaddr, &sta_netmask, &sta_gw);
-  } else {
-      /* Clear current address*/
-      netif_set_addr(station_netif, NULL, NULL, NULL);
-      /* Let the connect event enable the DHCP requests*/
-  }
-  return; /* success */
-
-error:
-  printf("Command error\r\n");
-  return; /* Failed */
+  /* Call the common function to set parameter */
+  set_wifi_param_common(args);
 }
 
 /**************************************************************************//**
@@ -480,45 +406,12 @@ void set_station_ip(sl_cli_command_arg_t *args)
  *****************************************************************************/
 void get_station_pmk(sl_cli_command_arg_t *args)
 {
-  char *cmd = NULL;
-  int param_idx = -1;
-
   if (!(wifi.state & SL_WFX_STA_INTERFACE_CONNECTED)) {
      printf("Station is not connected to an AP\r\n");
      return;
   }
-
-  cmd = sl_cli_get_command_string(args, 2);
-  param_idx = param_search(cmd);
-  if (param_idx < 0) {
-      LOG_DEBUG("The wlan_pmk parameter hasn't been registered");
-      printf("Command error\r\n");
-      return;
-  }
-  sl_wfx_password_t station_pmk = {0};
-  uint32_t password_length;
-  sl_status_t status;
-
-  status = sl_wfx_get_pmk(&station_pmk,
-                          &password_length,
-                          SL_WFX_STA_INTERFACE);
-
-  if (status == SL_STATUS_OK) {
-    if (wifi_params[param_idx].size > (password_length + 2/*EOF*/)) {
-      memcpy((uint8_t *)wifi_params[param_idx].address,
-              station_pmk.password,
-              password_length);
-      printf("%s\r\n", (char *)wifi_params[param_idx].address);
-
-    } else {
-      LOG_DEBUG("Output buffer too small (%ld/%d)\r\n",
-                password_length,
-                wifi_params[param_idx].size);
-    }
-  } else {
-    printf("Interface down\r\n");
-  }
-  /* success */
+  /* Call the common function to get parameter */
+  get_wifi_param_common(args);
 }
 
 /**************************************************************************//**
@@ -526,31 +419,13 @@ void get_station_pmk(sl_cli_command_arg_t *args)
  *****************************************************************************/
 void get_station_mac(sl_cli_command_arg_t *args)
 {
-  char *cmd = NULL;
-  int param_idx = -1;
-
   if (!(wifi.state & SL_WFX_STA_INTERFACE_CONNECTED)) {
      printf("Station is not connected to an AP\r\n");
      return;
   }
-
-  cmd = sl_cli_get_command_string(args, 2);
-  param_idx = param_search(cmd);
-  if (param_idx < 0) {
-      LOG_DEBUG("The wifi parameter hasn't been registered");
-      printf("Command error\r\n");
-      return; /* failed */
-  }
-
-  uint8_t *station_mac_ptr = (uint8_t *)wifi_params[param_idx].address;
-  /* Convert to octet */
-  printf("%02X:%02X:%02X:%02X:%02X:%02X\r\n", station_mac_ptr[0], \
-                                               station_mac_ptr[1], \
-                                               station_mac_ptr[2], \
-                                               station_mac_ptr[3], \
-                                               station_mac_ptr[4], \
-                                               station_mac_ptr[5]);
- }
+  /* Call the common function to get parameter */
+  get_wifi_param_common(args);
+}
 
 /**************************************************************************//**
  * @brief: Wi-Fi CLI's callback: set station mac address (EUI-48 format).
@@ -624,17 +499,8 @@ void set_softap_security(sl_cli_command_arg_t *args)
  *****************************************************************************/
 void get_softap_channel(sl_cli_command_arg_t *args)
 {
-  (void)args;
-
-  char *cmd = sl_cli_get_command_string(args, 2);
-  /* Retrieve the parameter index by its name */
-  int param_idx = param_search(cmd);
-  if (param_idx < 0) {
-      LOG_DEBUG("The softap_channel parameter hasn't been registered");
-      printf("Command error\r\n");
-      return; /* failed */
-  }
-  printf("%d\r\n", *(uint8_t *)wifi_params[param_idx].address);
+  /* Call the common function to get parameter */
+  get_wifi_param_common(args);
 }
 
 /**************************************************************************//**
@@ -726,43 +592,12 @@ void set_softap_ip(sl_cli_command_arg_t *args)
  *****************************************************************************/
 void get_softap_pmk(sl_cli_command_arg_t *args)
 {
-  (void)args;
-  sl_wfx_password_t ap_pmk = {0};
-  uint32_t password_length;
-  sl_status_t status;
-
-  char *cmd = sl_cli_get_command_string(args, 2);
-  int param_idx = param_search(cmd);
-  if (param_idx < 0) {
-      LOG_DEBUG("The softap_pmk parameter hasn't been registered");
-      goto error;
-  }
-
-  status = sl_wfx_get_pmk(&ap_pmk,
-                          &password_length,
-                          SL_WFX_SOFTAP_INTERFACE);
-
-  if (status == SL_STATUS_OK) {
-    if (wifi_params[param_idx].size > (password_length + 2/*EOF*/)) {
-      memcpy((uint8_t *)wifi_params[param_idx].address,
-             ap_pmk.password,
-             password_length);
-      printf("%s\r\n", (char *) wifi_params[param_idx].address);
-
-    } else {
-      LOG_DEBUG("Output buffer too small (%ld/%d)\r\n",
-                password_length, wifi_params[param_idx].size);
-      goto error;
-    }
-  } else {
-    printf("Interface down\r\n");
+  if (!(wifi.state & SL_WFX_AP_INTERFACE_UP)) {
+      printf("Interface down\r\n");
+      return;
   }
-  return; /* success */
-
-error:
-  printf("Command error\r\n");
-  return; /* failed */
-
+  /* Call the common function to get parameter */
+  get_wifi_param_common(args);
 }
 
 /**************************************************************************//**
@@ -770,23 +605,8 @@ error:
  *****************************************************************************/
 void get_softap_mac(sl_cli_command_arg_t *args)
 {
-  (void)args;
-
-  char *cmd = sl_cli_get_command_string(args, 2);
-  int param_idx = param_search(cmd);
-  if (param_idx < 0) {
-      LOG_DEBUG("The wifi parameter hasn't been registered");
-      printf("Command error\r\n");
-      return; /* failed */
-  }
-  uint8_t *softap_mac_ptr = (uint8_t *)wifi_params[param_idx].address;
-  /* Convert softap mac string to octet */
-  printf("%02X:%02X:%02X:%02X:%02X:%02X\r\n", softap_mac_ptr[0], \
-                                              softap_mac_ptr[1], \
-                                              softap_mac_ptr[2], \
-                                              softap_mac_ptr[3], \
-                                              softap_mac_ptr[4], \
-                                              softap_mac_ptr[5]);
+  /* Call the common function to get parameter */
+  get_wifi_param_common(args);
 }
 
 /**************************************************************************//**
@@ -811,45 +631,8 @@ void get_softap_dhcp_server_state(sl_cli_command_arg_t *args)
  *****************************************************************************/
 void set_softap_dhcp_server_state(sl_cli_command_arg_t *args)
 {
-  uint8_t new_state;
-  char *dhcps_str = NULL;
-  char *cmd = NULL;
-  int param_idx = -1;
-
-  /* Get input string */
-  dhcps_str = sl_cli_get_argument_string(args, 0);
-
-  if (get_on_off_state(dhcps_str, &new_state) < 0) {
-      printf("Invalid argument\r\n"
-            "Please input ON for Enable; OFF for Disable\r\n");
-      return;
-  }
-
-  /* No known issues but limit this update for consistency with the DHCP client*/
-  if (wifi.state & SL_WFX_AP_INTERFACE_UP) {
-      printf("Operation denied: stop SoftAP first\r\n");
-      return;
-  }
-
-  /* Retrieve use_dhcp_client param */
-  cmd = sl_cli_get_command_string(args, 2);
-  param_idx = param_search(cmd);
-  if (param_idx < 0) {
-      LOG_DEBUG("The use_dhcp_client parameter hasn't been registered");
-      printf("Command error\r\n");
-      return; /* failed */
-  }
-
-  if (*(uint8_t*)wifi_params[param_idx].address == new_state) {
-     printf("SoftAP's DHCP server state is already set to %s\r\n",
-                                      new_state == 0 ? "OFF" : "ON");
-     return;
-  }
-
-  *(uint8_t *)wifi_params[param_idx].address = new_state; /* Update */
-  if (new_state == 0 && dhcpserver_is_started()) {
-      dhcpserver_stop();
-  } /*else let the SoftAP start configure the DHCP server*/
+  /* Call the common function to set parameter */
+  set_wifi_param_common(args);
 }
 
 /**************************************************************************//**
@@ -857,18 +640,18 @@ void set_softap_dhcp_server_state(sl_cli_command_arg_t *args)
  *****************************************************************************/
 void get_softap_client_list(sl_cli_command_arg_t *args)
 {
-  (void)args;
-  /// TODO: Need to be refactored, maybe!
-
-  uint8_t add_separator = 0;
-  char string_field[100];
-  char client_name[9] = { 'C', 'l', 'i', 'e', 'n', 't', ' ', ' ', '\0' };
+  json_writer_t json;
+  char field[18];
   char *cmd = sl_cli_get_command_string(args, 2);
   if (strcmp(cmd, "softap.client_list") != 0) {
       printf("wrong command\r\n");
       return;
   }
 
+  /* Stream the JSON array to the console */
+  json_writer_init(&json, json_sink_stdout, NULL);
+  json_begin_array(&json);
+
   for (uint8_t i = 0; i < DHCPS_MAX_CLIENT; i++) {
     struct eth_addr mac;
     dhcpserver_get_mac(i, &mac);
@@ -876,30 +659,92 @@ void get_softap_client_list(sl_cli_command_arg_t *args)
           && mac.addr[2] == 0 && mac.addr[3] == 0
           && mac.addr[4] == 0 && mac.addr[5] == 0)) {
       ip_addr_t ip_addr = dhcpserver_get_ip(&mac);
-      if (add_separator) {
-        strcat(string_list, ",");
-      }
-      client_name[7] = i + 49;
-      snprintf(string_field, 100,
-               "{\"name\":\"%s\", \"ip\":\"%d.%d.%d.%d\", "
-               "\"mac\":\"%02X:%02X:%02X:%02X:%02X:%02X\"}",
-               client_name,
+
+      json_begin_object(&json);
+
+      snprintf(field, sizeof(field), "Client %d", i + 1);
+      json_kv_string(&json, "name", field);
+
+      snprintf(field, sizeof(field), "%d.%d.%d.%d",
                (int)(ip_addr.addr & 0xff),
                (int)((ip_addr.addr >> 8) & 0xff),
                (int)((ip_addr.addr >> 16) & 0xff),
-               (int)((ip_addr.addr >> 24) & 0xff),
+               (int)((ip_addr.addr >> 24) & 0xff));
+      json_kv_string(&json, "ip", field);
+
+      snprintf(field, sizeof(field), "%02X:%02X:%02X:%02X:%02X:%02X",
                mac.addr[0],
                mac.addr[1],
                mac.addr[2],
                mac.addr[3],
                mac.addr[4],
                mac.addr[5]);
-      add_separator = 1;
-      strcat(string_list, string_field);
+      json_kv_string(&json, "mac", field);
+
+      json_end_object(&json);
     }
   }
-  printf("%s\r\n", string_list);
-  memset(string_list, 0x00, sizeof(string_list));
+
+  json_end_array(&json);
+  json_writer_finish(&json);
+  printf("\r\n");
+}
+
+/**************************************************************************//**
+ * @brief: Wi-Fi CLI's callback: get all parameters in one output.
+ *****************************************************************************/
+void get_all_params(sl_cli_command_arg_t *args)
+{
+  (void)args;
+
+  if (wifi_cli_params_dump(wifi_cli_bulk_buf, sizeof(wifi_cli_bulk_buf)) < 0) {
+      printf("Failed to get the parameters\r\n");
+      return;
+  }
+  printf("%s", wifi_cli_bulk_buf);
+}
+
+/**************************************************************************//**
+ * @brief: Wi-Fi CLI's callback: set parameters from "name=value" arguments
+ *         in one transaction.
+ *****************************************************************************/
+void set_params_bulk(sl_cli_command_arg_t *args)
+{
+  int i;
+  int ret;
+  int argc;
+  uint32_t len = 0;
+  uint32_t arg_len;
+  char *arg_str = NULL;
+  char *bulk_buf = wifi_cli_bulk_buf;
+
+  argc = sl_cli_get_argument_count(args);
+  if (argc == 0) {
+      printf("Usage: wifi set -f <name=value> [name=value ...]\r\n");
+      return;
+  }
+
+  /* Join the arguments into one configuration block */
+  for (i = 0; i < argc; i++) {
+      arg_str = sl_cli_get_argument_string(args, i);
+      arg_len = strlen(arg_str);
+      if ((len + arg_len + 1) >= sizeof(wifi_cli_bulk_buf)) {
+          printf("Configuration block too long\r\n");
+          return;
+      }
+      memcpy(&bulk_buf[len], arg_str, arg_len);
+      len += arg_len;
+      bulk_buf[len++] = '\n';
+  }
+  bulk_buf[len] = '\0';
+
+  /* The current values are saved behind the block, in the same buffer */
+  ret = wifi_cli_params_load(bulk_buf, sizeof(wifi_cli_bulk_buf));
+  if (ret < 0) {
+      printf("Configuration unchanged\r\n");
+      return;
+  }
+  printf("%d parameters set\r\n", ret);
 }
 
 /**************************************************************************//**
@@ -936,8 +781,10 @@ void set_mac_key(sl_cli_command_arg_t *args)
          SL_WFX_SECURE_LINK_ENCRYPTION_BITMAP_SIZE);
 
   /* Call API to set MAC key to WF200 */
+  wifi_cli_wfx_lock();
   result = sl_wfx_secure_link_set_mac_key(wifi.secure_link_mac_key,
                                           SECURE_LINK_MAC_KEY_DEST_RAM);
+  wifi_cli_wfx_unlock();
   if (result == SL_STATUS_OK) {
       printf("Success\r\n");
       return;
@@ -952,6 +799,9 @@ void reset_host_cpu(sl_cli_command_arg_t *args)
 {
   (void)args;
 
+  /* Don't lose the parameter changes not flushed yet */
+  wifi_cli_nvm_flush();
+
   printf("The host CPU reset\r\n");
   __DSB();
   SCB->AIRCR = (uint32_t)( (0x5FAUL << SCB_AIRCR_VECTKEY_Pos)
@@ -981,10 +831,12 @@ void wifi_init(sl_cli_command_arg_t *args)
 
   /* Force the bus de-initialization to ensure a re-initialization from scratch.
      This is especially useful for the SDIO */
+  wifi_cli_wfx_lock();
   sl_wfx_host_deinit_bus();
 
   /* Initialize the Wi-Fi chip */
   status = sl_wfx_init(&wifi);
+  wifi_cli_wfx_unlock();
   switch (status) {
     case SL_STATUS_OK:
       status_msg = success_msg;
@@ -1075,6 +927,7 @@ void wifi_station_connect(sl_cli_command_arg_t *args)
              sizeof(scan_result_list_t) * SL_WFX_MAX_SCAN_RESULTS);
 
       /* Send scan command to WF200 */
+      wifi_cli_wfx_lock();
       status = sl_wfx_send_scan_command(WFM_SCAN_MODE_ACTIVE,
                                         NULL,
                                         0,
@@ -1083,6 +936,7 @@ void wifi_station_connect(sl_cli_command_arg_t *args)
                                         NULL,
                                         0,
                                         NULL);
+      wifi_cli_wfx_unlock();
 
       if ((status == SL_STATUS_OK) || (status == SL_STATUS_WIFI_WARNING)) {
           /* Block CLI to wait for scan_complete indication */
@@ -1135,6 +989,7 @@ void wifi_station_connect(sl_cli_command_arg_t *args)
   */
 
   /* Step 3: Configure scan parameters & Connect to the found AP */
+  wifi_cli_wfx_lock();
   sl_wfx_set_scan_parameters(0, 0, 1);
 
   /* Connect to a Wi-Fi access point */
@@ -1149,6 +1004,7 @@ void wifi_station_connect(sl_cli_command_arg_t *args)
                                     strlen(p_wlan_passkey),
                                     NULL,
                                     0);
+  wifi_cli_wfx_unlock();
   if (status == SL_STATUS_OK) {
       /* Block to wait for a connected confirmation */
       err_code = wifi_cli_wait(&g_cli_sem,
@@ -1190,7 +1046,9 @@ void wifi_station_disconnect(sl_cli_command_arg_t *args)
   }
 
   /* Disconnect from a Wi-Fi access point */
+  wifi_cli_wfx_lock();
   status = sl_wfx_send_disconnect_command();
+  wifi_cli_wfx_unlock();
   if (status == SL_STATUS_OK) {
       /* Block to wait for a confirmation */
       err_code = wifi_cli_wait(&g_cli_sem,
@@ -1227,22 +1085,85 @@ void wifi_station_rssi(sl_cli_command_arg_t *args)
       return;
   }
 
+  wifi_cli_wfx_lock();
   status = sl_wfx_get_signal_strength(&rcpi);
+  wifi_cli_wfx_unlock();
   if (status == SL_STATUS_OK) {
     printf("RSSI value : %d dBm\r\n", (int16_t)(rcpi - 220) / 2);
   } /* else let the generic CLI display the error message */
 }
 
+/***************************************************************************//**
+ * @brief
+ *    This function streams the results of the last scan as a JSON array
+ *
+ * @param[in] None
+ *
+ * @param[out] None
+ *
+ * @return  None
+ ******************************************************************************/
+static void print_scan_results_json(void)
+{
+  json_writer_t json;
+  char bssid[18];
+  uint8_t nb_results = scan_count_web;
+
+  if (nb_results > SL_WFX_MAX_SCAN_RESULTS) {
+      nb_results = SL_WFX_MAX_SCAN_RESULTS;
+  }
+
+  json_writer_init(&json, json_sink_stdout, NULL);
+  json_begin_array(&json);
+
+  for (uint8_t i = 0; i < nb_results; i++) {
+      json_begin_object(&json);
+      json_key(&json, "ssid");
+      json_string_n(&json,
+                    (char *)scan_list[i].ssid_def.ssid,
+                    scan_list[i].ssid_def.ssid_length);
+      snprintf(bssid, sizeof(bssid), "%02X:%02X:%02X:%02X:%02X:%02X",
+               scan_list[i].mac[0],
+               scan_list[i].mac[1],
+               scan_list[i].mac[2],
+               scan_list[i].mac[3],
+               scan_list[i].mac[4],
+               scan_list[i].mac[5]);
+      json_kv_string(&json, "bssid", bssid);
+      json_kv_uint(&json, "channel", scan_list[i].channel);
+      json_kv_int(&json, "rssi", ((int16_t)(scan_list[i].rcpi - 220) / 2));
+      json_kv_uint(&json, "security", *(uint8_t *)&scan_list[i].security_mode);
+      json_end_object(&json);
+  }
+
+  json_end_array(&json);
+  json_writer_finish(&json);
+  printf("\r\n");
+}
+
 /**************************************************************************//**
  * @brief: Wi-Fi CLI's callback: Perform a Wi-Fi scan.
  *****************************************************************************/
 void wifi_station_scan(sl_cli_command_arg_t *args)
 {
-  (void)args;
   RTOS_ERR_CODE err_code;
+  char *arg_str = NULL;
+  bool json_output = false;
 
-  printf("!  # Ch RSSI MAC (BSSID)        Network (SSID) \n");
+  if (sl_cli_get_argument_count(args) > 0) {
+      arg_str = sl_cli_get_argument_string(args, 0);
+      if (strcmp(arg_str, "-j") != 0) {
+          printf("Usage: wifi scan [-j]\r\n");
+          return;
+      }
+      /* The results are displayed once the scan completes */
+      json_output = true;
+      scan_verbose = false;
+  } else {
+      printf("!  # Ch RSSI MAC (BSSID)        Network (SSID) \n");
+  }
   /* Start a scan*/
+  wifi_cli_wfx_lock();
   sl_wfx_send_scan_command(WFM_SCAN_MODE_ACTIVE,
                            NULL,
                            0,
@@ -1251,12 +1172,15 @@ void wifi_station_scan(sl_cli_command_arg_t *args)
                            NULL,
                            0,
                            NULL);
+  wifi_cli_wfx_unlock();
 
   /* Block to wait indication messages */
   err_code = wifi_cli_wait(&g_cli_sem,
                            SL_WFX_SCAN_COMPLETE_IND_ID,
                            SL_WFX_DEFAULT_REQUEST_TIMEOUT_MS);
 
+  scan_verbose = true;
+
   if (err_code == RTOS_ERR_TIMEOUT) {
       LOG_DEBUG("wifi_cli_wait() timeout\r\n");
       goto error;
@@ -1264,6 +1188,10 @@ void wifi_station_scan(sl_cli_command_arg_t *args)
       LOG_DEBUG("wifi_cli_wait() failed: err_code = %d\r\n", err_code);
       goto error;
   }
+
+  if (json_output) {
+      print_scan_results_json();
+  }
   return;
 
 error:
@@ -1303,6 +1231,7 @@ void wifi_start_softap(sl_cli_command_arg_t *args)
   }
 
   /* Send start the SoftAP command to the wifi device */
+  wifi_cli_wfx_lock();
   status = sl_wfx_start_ap_command(*p_softap_channel,
                                    (uint8_t *)p_softap_ssid,
                                    strlen(p_softap_ssid),
@@ -1316,6 +1245,7 @@ void wifi_start_softap(sl_cli_command_arg_t *args)
                                    0,
                                    NULL,
                                    0);
+  wifi_cli_wfx_unlock();
   if (status == SL_STATUS_OK) {
       /* Block CLI to wait the indication message */
       err_code = wifi_cli_wait(&g_cli_sem,
@@ -1348,7 +1278,9 @@ void wifi_stop_softap(sl_cli_command_arg_t *args)
   RTOS_ERR_CODE err_code;
 
   /* Send stop command SoftAP */
+  wifi_cli_wfx_lock();
   status = sl_wfx_stop_ap_command();
+  wifi_cli_wfx_unlock();
 
   if (status == SL_STATUS_OK) {
       /* Block to wait for the confirmation */
@@ -1392,9 +1324,12 @@ void wifi_softap_rssi(sl_cli_command_arg_t *args)
       return;
   }
 
+  wifi_cli_wfx_lock();
   status = sl_wfx_get_ap_client_signal_strength(&mac_address, &rcpi);
+  wifi_cli_wfx_unlock();
 
   if (status == SL_STATUS_OK) {
+    ap_clients_record_rssi(mac_address.octet, (int16_t) (rcpi - 220) / 2);
     printf("Client %s RSSI value : %d dBm\r\n",
             mac_addr_str, (int16_t) (rcpi - 220) / 2);
   } else {
@@ -1402,6 +1337,201 @@ void wifi_softap_rssi(sl_cli_command_arg_t *args)
   }
 }
 
+/**************************************************************************//**
+ * @brief:
+ *    Wi-Fi CLI's callback: Display the statistics of the SoftAP clients as a
+ *    JSON array, "-r" first refreshes the RSSI of the connected clients.
+ *****************************************************************************/
+void wifi_softap_clients(sl_cli_command_arg_t *args)
+{
+  uint32_t i;
+  uint32_t now;
+  uint32_t rcpi;
+  uint32_t nb_clients;
+  sl_status_t status;
+  char field[18];
+  json_writer_t json;
+  ip_addr_t ip_addr;
+  sl_wfx_mac_address_t mac_address;
+  ap_client_stats_t clients[SL_WFX_CLI_MAX_CLIENTS];
+  bool refresh_rssi = false;
+
+  if (sl_cli_get_argument_count(args) > 0) {
+      if (strcmp(sl_cli_get_argument_string(args, 0), "-r") != 0) {
+          printf("Usage: wifi softap_clients [-r]\r\n");
+          return;
+      }
+      refresh_rssi = true;
+  }
+
+  nb_clients = ap_clients_get_all(clients, SL_WFX_CLI_MAX_CLIENTS);
+
+  if (refresh_rssi && (wifi.state & SL_WFX_AP_INTERFACE_UP)) {
+      for (i = 0; i < nb_clients; i++) {
+          if (!clients[i].connected) {
+              continue;
+          }
+          memcpy(mac_address.octet, clients[i].mac, 6);
+          wifi_cli_wfx_lock();
+          status = sl_wfx_get_ap_client_signal_strength(&mac_address, &rcpi);
+          wifi_cli_wfx_unlock();
+          if (status == SL_STATUS_OK) {
+              clients[i].last_rssi = (int16_t)(rcpi - 220) / 2;
+              ap_clients_record_rssi(clients[i].mac, clients[i].last_rssi);
+          }
+      }
+  }
+
+  now = ap_clients_get_time_ms();
+  json_writer_init(&json, json_sink_stdout, NULL);
+  json_begin_array(&json);
+
+  for (i = 0; i < nb_clients; i++) {
+      json_begin_object(&json);
+
+      snprintf(field, sizeof(field), "%02X:%02X:%02X:%02X:%02X:%02X",
+               clients[i].mac[0],
+               clients[i].mac[1],
+               clients[i].mac[2],
+               clients[i].mac[3],
+               clients[i].mac[4],
+               clients[i].mac[5]);
+      json_kv_string(&json, "mac", field);
+
+      ip_addr = dhcpserver_get_ip((struct eth_addr *)clients[i].mac);
+      snprintf(field, sizeof(field), "%d.%d.%d.%d",
+               (int)(ip_addr.addr & 0xff),
+               (int)((ip_addr.addr >> 8) & 0xff),
+               (int)((ip_addr.addr >> 16) & 0xff),
+               (int)((ip_addr.addr >> 24) & 0xff));
+      json_kv_string(&json, "ip", field);
+
+      json_key(&json, "connected");
+      json_bool(&json, clients[i].connected);
+      json_kv_uint(&json, "connected_s", (now - clients[i].connect_time) / 1000);
+      json_kv_uint(&json, "idle_ms", now - clients[i].last_seen);
+      json_kv_uint(&json, "rx_frames", clients[i].rx_frames);
+      json_kv_uint(&json, "rx_bytes", clients[i].rx_bytes);
+      json_kv_uint(&json, "tx_frames", clients[i].tx_frames);
+      json_kv_uint(&json, "tx_bytes", clients[i].tx_bytes);
+      if (clients[i].last_rssi != AP_CLIENT_RSSI_UNKNOWN) {
+          json_kv_int(&json, "rssi", clients[i].last_rssi);
+      }
+
+      json_end_object(&json);
+  }
+
+  json_end_array(&json);
+  json_writer_finish(&json);
+  printf("\r\n");
+}
+
+/**************************************************************************//**
+ * @brief:
+ *    Wi-Fi CLI's callback: Display the TX latency of both interfaces, "-H"
+ *    adds the histogram buckets, "-r" clears the statistics afterwards.
+ *****************************************************************************/
+void wifi_tx_latency(sl_cli_command_arg_t *args)
+{
+  int i;
+  char *arg;
+  bool print_buckets = false;
+  bool reset = false;
+
+  for (i = 0; i < sl_cli_get_argument_count(args); i++) {
+      arg = sl_cli_get_argument_string(args, i);
+      if (strcmp(arg, "-H") == 0) {
+          print_buckets = true;
+      } else if (strcmp(arg, "-r") == 0) {
+          reset = true;
+      } else {
+          printf("Usage: wifi tx_latency [-H] [-r]\r\n");
+          return;
+      }
+  }
+
+  tx_latency_print(print_buckets);
+  if (reset) {
+      tx_latency_reset();
+  }
+}
+
+/**************************************************************************//**
+ * @brief:
+ * Wi-Fi CLI's callback: Enable/disable & tune the adaptive power save policy
+ *                       of the station, then display its state.
+ *****************************************************************************/
+void wifi_ps_policy(sl_cli_command_arg_t *args)
+{
+  int i, argc;
+  int value;
+  char *arg;
+  uint8_t state;
+  int enable = -1;
+  bool config_changed = false;
+  ps_policy_config_t config;
+
+  ps_policy_get_config(&config);
+  argc = sl_cli_get_argument_count(args);
+  for (i = 0; i < argc; i++) {
+      arg = sl_cli_get_argument_string(args, i);
+      if (arg[0] != '-') {
+          if (get_on_off_state(arg, &state) < 0) {
+              goto invalid_arg_err;
+          }
+          enable = state;
+          continue;
+      }
+
+      if ((arg[2] != '\0') || (i + 1 >= argc)) {
+          goto invalid_arg_err;
+      }
+      value = atoi(sl_cli_get_argument_string(args, ++i));
+      if (value < 0) {
+          goto invalid_arg_err;
+      }
+      switch (arg[1]) {
+        case 'p':
+          config.period_ms = (uint32_t)value;
+          break;
+        case 'a':
+          config.active_fps = (uint32_t)value;
+          break;
+        case 'i':
+          config.idle_fps = (uint32_t)value;
+          break;
+        case 'A':
+          config.active_hold_ms = (uint32_t)value;
+          break;
+        case 'I':
+          config.idle_hold_ms = (uint32_t)value;
+          break;
+        case 'd':
+          config.dtim_skip = (value <= UINT8_MAX) ? (uint8_t)value : 0;
+          break;
+        default:
+          goto invalid_arg_err;
+      }
+      config_changed = true;
+  }
+
+  if (config_changed && (ps_policy_set_config(&config) < 0)) {
+      printf("Invalid thresholds: idle_fps must be below active_fps, "
+             "period 100 to 10000 ms, DTIM skip 1 to %d\r\n",
+             PS_POLICY_DTIM_SKIP_MAX);
+      return;
+  }
+  if (enable >= 0) {
+      ps_policy_enable(enable != 0);
+  }
+  ps_policy_print();
+  return;
+
+invalid_arg_err:
+  printf("Usage: wifi ps_policy [ON | OFF] [-p period_ms] [-a active_fps] "
+         "[-i idle_fps] [-A active_hold_ms] [-I idle_hold_ms] [-d dtim_skip]\r\n");
+}
+
 /**************************************************************************//**
  * @brief:
  * Wi-Fi CLI's callback: Set the Power Mode on the WLAN interface
@@ -1425,6 +1555,13 @@ void wifi_station_power_mode(sl_cli_command_arg_t *args)
       printf("Station is not connected to AP! Network up first!\r\n");
       return;
   }
+  /* A manual power mode overrides the adaptive policy. The policy stops in
+   * the Wi-Fi events task & restores the last manual mode, recorded below
+   * under the WF200 lock so that this new mode wins. */
+  if (ps_policy_is_enabled()) {
+      ps_policy_enable(false);
+      printf("Power save policy: OFF\r\n");
+  }
   /* Number of arguments */
   argc = sl_cli_get_argument_count(args);
 
@@ -1439,9 +1576,14 @@ void wifi_station_power_mode(sl_cli_command_arg_t *args)
       }
 
       /* Enable ACTIVE mode */
+      wifi_cli_wfx_lock();
       status = sl_wfx_set_power_mode(WFM_PM_MODE_ACTIVE,
                                      WFM_PM_POLL_FAST_PS,
                                      0);
+      if (status == SL_STATUS_OK) {
+          ps_policy_set_manual_mode(WFM_PM_MODE_ACTIVE, WFM_PM_POLL_FAST_PS, 0);
+      }
+      wifi_cli_wfx_unlock();
       if (status == SL_STATUS_OK) {
           printf("Power Mode: ACTIVE\r\n");
       } else {
@@ -1481,6 +1623,7 @@ void wifi_station_power_mode(sl_cli_command_arg_t *args)
       }
 
       /* Set powermode with strategy */
+      wifi_cli_wfx_lock();
       status = bc > dtim ? sl_wfx_set_power_mode(WFM_PM_MODE_PS,
                                                  uapsd > fast_ps ?
                                                  WFM_PM_POLL_UAPSD :
@@ -1491,6 +1634,14 @@ void wifi_station_power_mode(sl_cli_command_arg_t *args)
                                                  WFM_PM_POLL_UAPSD :
                                                  WFM_PM_POLL_FAST_PS,
                                                  interval);
+      if (status == SL_STATUS_OK) {
+          ps_policy_set_manual_mode(bc > dtim ? WFM_PM_MODE_PS :
+                                                WFM_PM_MODE_DTIM,
+                                    uapsd > fast_ps ? WFM_PM_POLL_UAPSD :
+                                                      WFM_PM_POLL_FAST_PS,
+                                    interval);
+      }
+      wifi_cli_wfx_unlock();
       if (status == SL_STATUS_OK) {
           printf("Power Mode: %s\r\nInterval: %d (%s)\r\n",
                  uapsd > fast_ps ? "U-APSD" : "Fast-PS",
@@ -1534,8 +1685,10 @@ void wifi_station_power_save(sl_cli_command_arg_t *args)
   }
 
   /* Call APIs based on new_state */
+  wifi_cli_wfx_lock();
   status = (new_state == 0) ? sl_wfx_disable_device_power_save() : \
                               sl_wfx_enable_device_power_save();
+  wifi_cli_wfx_unlock();
   if (status == SL_STATUS_OK) {
       printf("Power Save: %s\r\n", new_state == 0 ? "OFF" : "ON");
       old_state = new_state;
@@ -1551,44 +1704,80 @@ error:
  *****************************************************************************/
 void ping_cmd_cb(sl_cli_command_arg_t *args)
 {
+  int i;
   int argc;
-  int req_number;
+  int value;
   char *ip_str = NULL;
+  char *argv_str = NULL;
   char *err_msg = "Command error\r\n";
   char *invalid_arg = "Invalid argument";
   char *help_text = "Examples: ping 192.168.0.1\r\n"
-                       "         ping -n 100 192.168.0.1";
+                       "         ping -n 100 192.168.0.1\r\n"
+                       "         ping -n 1000 -i 10 -s 512 -W 200 192.168.0.1\r\n"
+                       "         ping -n 1000 -f -H 192.168.0.1";
+  ping_params_t params = {
+    .count = PING_DEFAULT_REQ_NB,
+    .interval_ms = PING_DEFAULT_INTERVAL_MS,
+    .timeout_ms = PING_DEFAULT_RCV_TMO_MS,
+    .data_size = PING_DEFAULT_DATA_SIZE,
+    .print_buckets = false,
+  };
 
   argc = sl_cli_get_argument_count(args);
-  switch (argc) {
-    case 1:
-      /* No request msg number: ping ip_addr */ 
-      ip_str = sl_cli_get_argument_string(args, 0);
-      if (ping_cmd(PING_DEFAULT_REQ_NB, ip_str) != SL_STATUS_OK) {
-          printf("%s", err_msg);
-      }
-      break;
+  if (argc < 1) {
+      goto invalid_arg_err;
+  }
 
-    case 3:
-      /* Full options: ping -n nb ip_addr */ 
-      ip_str = sl_cli_get_argument_string(args, 2);
-      if (strcmp(sl_cli_get_argument_string(args, 0), "-n")) {
-        goto invalid_arg_err;
-      }
+  /* Options first, the IP address last */
+  for (i = 0; i < argc - 1; ) {
+      argv_str = sl_cli_get_argument_string(args, i);
 
-      req_number = atoi(sl_cli_get_argument_string(args, 1));
-      if (req_number <= 0) {
-        goto  invalid_arg_err;
+      if (strcmp(argv_str, "-f") == 0) {
+          /* Flood: send as soon as possible */
+          params.interval_ms = 0;
+          i++;
+          continue;
+      }
+      if (strcmp(argv_str, "-H") == 0) {
+          /* Dump the RTT histogram buckets */
+          params.print_buckets = true;
+          i++;
+          continue;
       }
+      if (i + 1 >= argc - 1) {
+          goto invalid_arg_err;
+      }
+      value = atoi(sl_cli_get_argument_string(args, i + 1));
 
-      if (ping_cmd((uint32_t)req_number, ip_str) != SL_STATUS_OK) {
-          printf("%s", err_msg);
+      if (strcmp(argv_str, "-n") == 0) {
+          if (value <= 0) {
+              goto invalid_arg_err;
+          }
+          params.count = (uint32_t)value;
+      } else if (strcmp(argv_str, "-i") == 0) {
+          if (value <= 0) {
+              goto invalid_arg_err;
+          }
+          params.interval_ms = (uint32_t)value;
+      } else if (strcmp(argv_str, "-s") == 0) {
+          if ((value < 0) || (value > PING_MAX_DATA_SIZE)) {
+              goto invalid_arg_err;
+          }
+          params.data_size = (uint16_t)value;
+      } else if (strcmp(argv_str, "-W") == 0) {
+          if (value <= 0) {
+              goto invalid_arg_err;
+          }
+          params.timeout_ms = (uint32_t)value;
+      } else {
+          goto invalid_arg_err;
       }
-      break;
+      i += 2;
+  }
+  ip_str = sl_cli_get_argument_string(args, argc - 1);
 
-    default:
-      goto invalid_arg_err;
-      break;
+  if (ping_cmd(&params, ip_str) != SL_STATUS_OK) {
+      printf("%s", err_msg);
   }
   return;
 
@@ -1600,9 +1789,188 @@ invalid_arg_err:
  * @brief: Wi-Fi CLI's callback: Display the IP stack statistics.
  *****************************************************************************/
 void lwip_ip_stats(sl_cli_command_arg_t *args)
+{
+  int argc;
+  int value;
+  char *option;
+
+  argc = sl_cli_get_argument_count(args);
+  if (argc == 0) {
+      net_stats_report_print(0);
+      return;
+  }
+
+  option = sl_cli_get_argument_string(args, 0);
+  if ((argc == 1) && (strcmp(option, "-a") == 0)) {
+      stats_display(); /*!< Must be enabled in lwipopts.h */
+      return;
+  }
+  if ((argc == 2) && (strcmp(option, "-w") == 0)) {
+      value = atoi(sl_cli_get_argument_string(args, 1));
+      if ((value > 0) && (value <= 60000)) {
+          net_stats_report_print((uint32_t)value);
+          return;
+      }
+  }
+
+  printf("Invalid argument!\r\nExamples: lwip stats (changes since the previous call)\r\n"
+         "          lwip stats -w 5000 (window_ms: 1 to 60000)\r\n"
+         "          lwip stats -a (all the lwIP counters)\r\n");
+}
+
+/**************************************************************************//**
+ * @brief: Wi-Fi CLI's callback: Display the boot timeline.
+ *****************************************************************************/
+void sys_boot_timeline(sl_cli_command_arg_t *args)
 {
   (void)args;
-  stats_display(); /*!< Must be enabled in lwipopts.h */
+  boot_trace_print();
+}
+
+/**************************************************************************//**
+ * @brief: Wi-Fi CLI's callback: Display the task stack & lwIP memory peaks and
+ *         the static RAM budget.
+ *****************************************************************************/
+void sys_ram_report(sl_cli_command_arg_t *args)
+{
+  (void)args;
+  ram_report_print();
+}
+
+/**************************************************************************//**
+ * @brief: Wi-Fi CLI's callback: Display the per-task CPU usage.
+ *****************************************************************************/
+void sys_cpu_report(sl_cli_command_arg_t *args)
+{
+  int argc;
+  int value;
+  uint32_t window_ms = CPU_PROFILE_DEFAULT_WINDOW;
+
+  argc = sl_cli_get_argument_count(args);
+  if (argc == 2) {
+      value = atoi(sl_cli_get_argument_string(args, 1));
+      if ((strcmp(sl_cli_get_argument_string(args, 0), "-w") != 0)
+          || (value <= 0) || (value > 60000)) {
+          goto invalid_arg_err;
+      }
+      window_ms = (uint32_t)value;
+  } else if (argc != 0) {
+      goto invalid_arg_err;
+  }
+
+  cpu_report_print(window_ms);
+  return;
+
+invalid_arg_err:
+  printf("Invalid argument!\r\nExamples: sys cpu\r\n"
+         "          sys cpu -w 5000 (window_ms: 1 to 60000)\r\n");
+}
+
+/**************************************************************************//**
+ * @brief: Wi-Fi CLI's callback: Start/stop the hot-path trace or dump it.
+ *****************************************************************************/
+void sys_trace(sl_cli_command_arg_t *args)
+{
+  int ret;
+  char *action;
+
+  if (sl_cli_get_argument_count(args) != 1) {
+      goto invalid_arg_err;
+  }
+
+  action = sl_cli_get_argument_string(args, 0);
+  if (strcmp(action, "start") == 0) {
+      ret = trace_start();
+  } else if (strcmp(action, "stop") == 0) {
+      ret = trace_stop();
+  } else if (strcmp(action, "dump") == 0) {
+      ret = trace_dump();
+  } else {
+      goto invalid_arg_err;
+  }
+
+  if (ret < 0) {
+      printf("Trace not available (build with WIFI_CLI_TRACE_EN=1)\r\n");
+  }
+  return;
+
+invalid_arg_err:
+  printf("Usage: sys trace <start | stop | dump>\r\n");
+}
+
+/**************************************************************************//**
+ * @brief:
+ *    Wi-Fi CLI's callback: Display the metrics served on /metrics, "-j" for
+ *    the JSON snapshot of /metrics/json.
+ *****************************************************************************/
+void sys_metrics(sl_cli_command_arg_t *args)
+{
+  uint8_t format = METRICS_FORMAT_TEXT;
+
+  if (sl_cli_get_argument_count(args) > 0) {
+      if (strcmp(sl_cli_get_argument_string(args, 0), "-j") != 0) {
+          printf("Usage: sys metrics [-j]\r\n");
+          return;
+      }
+      format = METRICS_FORMAT_JSON;
+  }
+
+  if (metrics_print(format) < 0) {
+      printf("Metrics not available\r\n");
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function converts an iperf size string (e.g. "1500", "64K", "10M")
+ *    to a number of bytes. K and M suffixes are powers of 1024 like in iperf.
+ *
+ * @param[in]
+ *        + size_str: the input string
+ *
+ * @param[out]
+ *        + size: the converted size in bytes
+ *
+ * @return
+ *    0 if successful
+ *    -1 if failed
+ ******************************************************************************/
+static int get_iperf_size(char *size_str, uint32_t *size)
+{
+  char *p_end = NULL;
+  unsigned long value;
+
+  if ((size_str == NULL) || (*size_str == '-')) {
+      return -1;
+  }
+
+  value = strtoul(size_str, &p_end, 10);
+  if ((p_end == size_str) || (value == 0)) {
+      return -1;
+  }
+
+  switch (*p_end) {
+    case 'k':
+    case 'K':
+      value *= 1024;
+      p_end++;
+      break;
+
+    case 'm':
+    case 'M':
+      value *= 1024 * 1024;
+      p_end++;
+      break;
+
+    default:
+      break;
+  }
+
+  if ((*p_end != '\0') || (value > 0x7FFFFFFFUL)) {
+      return -1;
+  }
+  *size = (uint32_t)value;
+  return 0;
 }
 
 /**************************************************************************//**
@@ -1617,10 +1985,19 @@ void iperf(sl_cli_command_arg_t *args)
   char *invalid_msg = "Invalid argument!";
   char *help_text = "Examples: iperf -s\r\n"
                     "          iperf -c 192.168.0.1\r\n"
-                    "          iperf -c 192.168.0.1 -t 5 -p 5001 -k";
+                    "          iperf -c 192.168.0.1 -t 5 -p 5001 -k\r\n"
+                    "          iperf -c 192.168.0.1 -n 10M -l 64\r\n"
+                    "          iperf -s -3\r\n"
+                    "          iperf -c 192.168.0.1 -3 -R\r\n"
+                    "          iperf -c 192.168.0.1 -i";
 
   int duration = IPERF_DEFAULT_DURATION_SEC;
-  int srv_port = IPERF_DEFAULT_PORT;
+  int srv_port = 0;
+  uint32_t amount_bytes = 0;
+  uint32_t buffer_len = 0;
+  bool use_iperf3 = false;
+  bool reverse = false;
+  bool tcp_sampling = false;
   bool iperf_client_foreground_mode = false;
 
   /* Number of arguments only excluding commands */
@@ -1631,11 +2008,18 @@ void iperf(sl_cli_command_arg_t *args)
 
       /* Checking server or client options */
       if (strncmp(argv_str, "-s", 2) == 0) { /*!< In iperf server mode */
-          if (argc != 1) {
-              goto error;
+          for (i = 1; i < argc; i++) {
+              argv_str = sl_cli_get_argument_string(args, i);
+              if (strncmp(argv_str, "-3", 2) == 0) {
+                  use_iperf3 = true;
+              } else if (strncmp(argv_str, "-i", 2) == 0) {
+                  tcp_sampling = true;
+              } else {
+                  goto error;
+              }
           }
           /* Start iperf server*/
-          return iperf_server();
+          return iperf_server(use_iperf3, tcp_sampling);
 
       } else if (strncmp(argv_str, "-c", 2) == 0) { /*!< In iperf client mode */
           /* Parsing client arguments with fall-through */
@@ -1655,6 +2039,20 @@ void iperf(sl_cli_command_arg_t *args)
                       }
                       i += 2;
 
+                    } else if (strncmp(argv_str, "-n", 2) == 0) {
+                      if (get_iperf_size(sl_cli_get_argument_string(args, i + 1),
+                                         &amount_bytes) < 0) {
+                          goto error;
+                      }
+                      i += 2;
+
+                    } else if (strncmp(argv_str, "-l", 2) == 0) {
+                      if (get_iperf_size(sl_cli_get_argument_string(args, i + 1),
+                                         &buffer_len) < 0) {
+                          goto error;
+                      }
+                      i += 2;
+
                     } else if (strncmp(argv_str, "-p", 2) == 0) {
                       srv_port = atoi(sl_cli_get_argument_string(args, i + 1));
                       if (srv_port <= 0) {
@@ -1666,17 +2064,41 @@ void iperf(sl_cli_command_arg_t *args)
                       iperf_client_foreground_mode = true;
                       i++;
 
+                    } else if (strncmp(argv_str, "-3", 2) == 0) {
+                      use_iperf3 = true;
+                      i++;
+
+                    } else if (strncmp(argv_str, "-R", 2) == 0) {
+                      reverse = true;
+                      i++;
+
+                    } else if (strncmp(argv_str, "-i", 2) == 0) {
+                      tcp_sampling = true;
+                      i++;
+
                     } else {
                       /* Unknown option! */
                       goto error;
                     }
                   }
               }
+              if (reverse && !use_iperf3) {
+                  /* Reverse mode is only supported with iperf3 */
+                  goto error;
+              }
+              if (srv_port == 0) {
+                  srv_port = use_iperf3 ? IPERF3_DEFAULT_PORT : IPERF_DEFAULT_PORT;
+              }
               /* Start iperf client mode */
               return iperf_client(ip_str,
                                   (uint32_t)duration,
+                                  amount_bytes,
+                                  buffer_len,
                                   (uint32_t)srv_port,
-                                  iperf_client_foreground_mode);
+                                  use_iperf3,
+                                  reverse,
+                                  iperf_client_foreground_mode,
+                                  tcp_sampling);
           }
       }
       /* go to error */
@@ -1711,7 +2133,9 @@ void wifi_test_agent(sl_cli_command_arg_t *args)
 {
   int argc = sl_cli_get_argument_count(args) + 2;
   sl_wfx_rf_test_agent_init(&rx_stats);
+  wifi_cli_wfx_lock();
   sl_wfx_rf_test_agent(&wifi, argc, (char**)args->argv);
+  wifi_cli_wfx_unlock();
 }
 
 /**************************************************************************//**
@@ -1722,7 +2146,9 @@ void wifi_slk_rekey(sl_cli_command_arg_t *args)
   (void)args;
 
   sl_status_t status;
+  wifi_cli_wfx_lock();
   status = sl_wfx_secure_link_renegotiate_session_key();
+  wifi_cli_wfx_unlock();
   if (status != SL_STATUS_OK) {
     printf("Command error\r\n");
   }
@@ -1818,25 +2244,28 @@ void wifi_slk_bitmap(sl_cli_command_arg_t *args)
 }
 
 /**************************************************************************//**
- * @brief: Wi-Fi CLI's callback: save station's setting params to NVM
+ * @brief: Wi-Fi CLI's callback: write the pending parameter changes to NVM
  *****************************************************************************/
 void wifi_save(sl_cli_command_arg_t *args)
 {
   (void)args;
-  if (strlen(wlan_ssid) > 0)
-    nvm3_writeData(nvm3_defaultHandle,
-                   NVM3_KEY_AP_SSID,
-                   (void *)wlan_ssid,
-                   sizeof(wlan_ssid));
-
-  if (strlen(wlan_passkey) > 0)
-    nvm3_writeData(nvm3_defaultHandle,
-                   NVM3_KEY_AP_PASSKEY,
-                   (void *)wlan_passkey,
-                   sizeof(wlan_passkey));
-
-  nvm3_writeData(nvm3_defaultHandle,
-                 NVM3_KEY_AP_SECURITY_MODE,
-                 (void *)&wlan_security,
-                 sizeof(wlan_security));
+  int ret;
+  wifi_cli_nvm_stats_t stats;
+
+  ret = wifi_cli_nvm_flush();
+  if (ret < 0) {
+      printf("Failed to save some parameters\r\n");
+  } else {
+      printf("%d parameter(s) saved\r\n", ret);
+  }
+
+  wifi_cli_nvm_get_stats(&stats);
+  printf("flushes %lu, writes %lu, unchanged %lu, failures %lu, "
+         "repacks %lu, erase count %lu\r\n",
+         stats.flushes,
+         stats.writes,
+         stats.skipped,
+         stats.failures,
+         stats.repacks,
+         stats.erase_count);
 }
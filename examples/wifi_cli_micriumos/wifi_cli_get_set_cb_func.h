@@ -19,6 +19,7 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <stdlib.h>
 #include <stdint.h>
 #include "sl_cli.h"
 #include "sl_cli_instances.h"
@@ -81,6 +82,7 @@ void get_softap_pmk(sl_cli_command_arg_t *args);
 void get_softap_mac(sl_cli_command_arg_t *args);
 void get_softap_dhcp_server_state(sl_cli_command_arg_t *args);
 void get_softap_client_list(sl_cli_command_arg_t *args);
+void get_all_params(sl_cli_command_arg_t *args);
 
 /*******************************************************************************
  ******************   WI-FI CLI's SET COMMAND PROTOTYPES   *********************
@@ -104,6 +106,7 @@ void set_softap_ip(sl_cli_command_arg_t *args);
 void set_softap_mac(sl_cli_command_arg_t *args);
 void set_softap_dhcp_server_state(sl_cli_command_arg_t *args);
 void set_mac_key(sl_cli_command_arg_t *args);
+void set_params_bulk(sl_cli_command_arg_t *args);
 
 /*******************************************************************************
  **************   WI-FI CLI's STATION COMMAND PROTOTYPES   *********************
@@ -116,6 +119,7 @@ void wifi_station_rssi(sl_cli_command_arg_t *args);
 
 void wifi_station_power_mode(sl_cli_command_arg_t *args);
 void wifi_station_power_save(sl_cli_command_arg_t *args);
+void wifi_ps_policy(sl_cli_command_arg_t *args);
 
 /*******************************************************************************
  **************   WI-FI CLI's SOFTAP COMMAND PROTOTYPES   ********************
@@ -123,12 +127,45 @@ void wifi_station_power_save(sl_cli_command_arg_t *args);
 void wifi_start_softap(sl_cli_command_arg_t *args);
 void wifi_stop_softap(sl_cli_command_arg_t *args);
 void wifi_softap_rssi(sl_cli_command_arg_t *args);
+void wifi_softap_clients(sl_cli_command_arg_t *args);
 
 /**************************************************************************//**
- * @brief: Wi-Fi CLI's callback: Display the IP stack statistics.
+ * @brief: Wi-Fi CLI's callback: Display the TX frame latency.
+ *****************************************************************************/
+void wifi_tx_latency(sl_cli_command_arg_t *args);
+
+/**************************************************************************//**
+ * @brief: Wi-Fi CLI's callback: Display the IP stack counters changed since
+ *         the previous call or over a window, "-a" for all of them.
  *****************************************************************************/
 void lwip_ip_stats(sl_cli_command_arg_t *args);
 
+/**************************************************************************//**
+ * @brief: Wi-Fi CLI's callback: Display the boot timeline.
+ *****************************************************************************/
+void sys_boot_timeline(sl_cli_command_arg_t *args);
+
+/**************************************************************************//**
+ * @brief: Wi-Fi CLI's callback: Display the task stack & lwIP memory peaks and
+ *         the static RAM budget.
+ *****************************************************************************/
+void sys_ram_report(sl_cli_command_arg_t *args);
+
+/**************************************************************************//**
+ * @brief: Wi-Fi CLI's callback: Display the per-task CPU usage.
+ *****************************************************************************/
+void sys_cpu_report(sl_cli_command_arg_t *args);
+
+/**************************************************************************//**
+ * @brief: Wi-Fi CLI's callback: Start/stop the hot-path trace or dump it.
+ *****************************************************************************/
+void sys_trace(sl_cli_command_arg_t *args);
+
+/**************************************************************************//**
+ * @brief: Wi-Fi CLI's callback: Display the metrics snapshot.
+ *****************************************************************************/
+void sys_metrics(sl_cli_command_arg_t *args);
+
 /**************************************************************************//**
  * @brief: Wi-Fi CLI's callback: Send ICMP ECHO_REQUEST to network hosts.
  *****************************************************************************/
@@ -0,0 +1,165 @@
+/***************************************************************************//**
+ * @file
+ * @brief Fixed-memory logarithmic latency histogram
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "wifi_cli_histogram.h"
+
+/***************************************************************************//**
+ * @brief
+ *    This function returns the index of the bucket holding a value
+ *
+ * @param[in]
+ *         + value: recorded value
+ *
+ * @param[out] None
+ *
+ * @return  bucket index
+ ******************************************************************************/
+static uint32_t latency_hist_index(uint32_t value)
+{
+  uint32_t shift;
+
+  if (value < LATENCY_HIST_SUB_BUCKETS) {
+    /* Exact values */
+    return value;
+  }
+  /* Keep the SUB_BUCKET_BITS bits following the most significant one */
+  shift = (31 - __builtin_clz(value)) - LATENCY_HIST_SUB_BUCKET_BITS;
+  return ((shift + 1) * LATENCY_HIST_SUB_BUCKETS)
+         + ((value >> shift) & (LATENCY_HIST_SUB_BUCKETS - 1));
+}
+
+/**************************************************************************//**
+ * Clear all the values of a histogram.
+ *****************************************************************************/
+void latency_hist_reset(latency_hist_t *hist)
+{
+  memset(hist, 0, sizeof(*hist));
+  hist->min = 0xFFFFFFFF;
+}
+
+/**************************************************************************//**
+ * Record a value in a histogram.
+ *****************************************************************************/
+void latency_hist_record(latency_hist_t *hist, uint32_t value)
+{
+  hist->counts[latency_hist_index(value)]++;
+  hist->total++;
+  hist->sum += value;
+  if (value < hist->min) {
+    hist->min = value;
+  }
+  if (value > hist->max) {
+    hist->max = value;
+  }
+}
+
+/**************************************************************************//**
+ * Get the bounds and the count of a bucket.
+ *****************************************************************************/
+uint32_t latency_hist_get_bucket(const latency_hist_t *hist,
+                                 uint32_t index,
+                                 uint32_t *low,
+                                 uint32_t *high)
+{
+  uint32_t shift;
+
+  if (index < LATENCY_HIST_SUB_BUCKETS) {
+    *low = index;
+    *high = index;
+  } else {
+    shift = (index / LATENCY_HIST_SUB_BUCKETS) - 1;
+    *low = (LATENCY_HIST_SUB_BUCKETS + (index % LATENCY_HIST_SUB_BUCKETS)) << shift;
+    *high = *low + ((1u << shift) - 1);
+  }
+  return hist->counts[index];
+}
+
+/**************************************************************************//**
+ * Get the value below which a given part of the recorded values are.
+ *****************************************************************************/
+uint32_t latency_hist_percentile(const latency_hist_t *hist, uint32_t permyriad)
+{
+  uint32_t i;
+  uint32_t low, high;
+  uint64_t rank;
+  uint64_t count = 0;
+
+  if (hist->total == 0) {
+    return 0;
+  }
+  /* Rank of the value, rounded up */
+  rank = (((uint64_t)hist->total * permyriad) + 9999) / 10000;
+  if (rank == 0) {
+    rank = 1;
+  }
+
+  for (i = 0; i < LATENCY_HIST_NB_BUCKETS; i++) {
+    count += latency_hist_get_bucket(hist, i, &low, &high);
+    if (count >= rank) {
+      /* No bucket value is above the largest recorded one */
+      return (high < hist->max) ? high : hist->max;
+    }
+  }
+  return hist->max;
+}
+
+/**************************************************************************//**
+ * Print p50/p90/p99/p99.9 of a histogram, in milli-seconds.
+ *****************************************************************************/
+void latency_hist_print_percentiles(const latency_hist_t *hist)
+{
+  static const struct {
+    const char *name;
+    uint32_t permyriad;
+  } percentiles[] = {
+    { "p50",   5000 },
+    { "p90",   9000 },
+    { "p99",   9900 },
+    { "p99.9", 9990 },
+  };
+  uint32_t i;
+  uint32_t value;
+
+  printf("\t");
+  for (i = 0; i < sizeof(percentiles) / sizeof(percentiles[0]); i++) {
+    value = latency_hist_percentile(hist, percentiles[i].permyriad);
+    printf("%s%s = %lu.%03lums",
+           (i != 0) ? ", " : "",
+           percentiles[i].name,
+           value / 1000,
+           value % 1000);
+  }
+  printf("\r\n");
+}
+
+/**************************************************************************//**
+ * Print the raw counts of the non-empty buckets.
+ *****************************************************************************/
+void latency_hist_print_buckets(const latency_hist_t *hist)
+{
+  uint32_t i;
+  uint32_t low, high, count;
+
+  printf("Histogram buckets (low_us high_us count):\r\n");
+  for (i = 0; i < LATENCY_HIST_NB_BUCKETS; i++) {
+    count = latency_hist_get_bucket(hist, i, &low, &high);
+    if (count != 0) {
+      printf("%lu %lu %lu\r\n", low, high, count);
+    }
+  }
+}
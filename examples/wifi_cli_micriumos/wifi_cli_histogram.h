@@ -0,0 +1,102 @@
+/***************************************************************************//**
+ * @file
+ * @brief Fixed-memory logarithmic latency histogram
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+#ifndef WIFI_CLI_HISTOGRAM_H
+#define WIFI_CLI_HISTOGRAM_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Values are sorted by power of two, each power of two being split into
+ * 2^LATENCY_HIST_SUB_BUCKET_BITS linear sub-buckets (HDR histogram layout).
+ * The relative error of a recorded value is below 1/2^SUB_BUCKET_BITS
+ * (12.5% with 3 bits) over the whole 32-bit range.
+ */
+#ifndef LATENCY_HIST_SUB_BUCKET_BITS
+#define LATENCY_HIST_SUB_BUCKET_BITS    3
+#endif
+#define LATENCY_HIST_SUB_BUCKETS        (1u << LATENCY_HIST_SUB_BUCKET_BITS)
+#define LATENCY_HIST_NB_BUCKETS         ((32 - LATENCY_HIST_SUB_BUCKET_BITS + 1) \
+                                         * LATENCY_HIST_SUB_BUCKETS)
+
+/* Latency histogram, values in micro-seconds */
+typedef struct {
+  uint32_t counts[LATENCY_HIST_NB_BUCKETS];
+  uint32_t total;
+  uint32_t min;
+  uint32_t max;
+  uint64_t sum;
+} latency_hist_t;
+
+/**************************************************************************//**
+ * @brief: Clear all the values of a histogram.
+ *****************************************************************************/
+void latency_hist_reset(latency_hist_t *hist);
+
+/**************************************************************************//**
+ * @brief: Record a value in a histogram.
+ *****************************************************************************/
+void latency_hist_record(latency_hist_t *hist, uint32_t value);
+
+/**************************************************************************//**
+ * @brief: Get the value below which a given part of the recorded values are.
+ *
+ * @param[in]
+ *         + hist: histogram
+ *         + permyriad: percentile in hundredths of percent (9990 for p99.9)
+ *
+ * @return  the highest value of the matching bucket, 0 if hist is empty
+ *****************************************************************************/
+uint32_t latency_hist_percentile(const latency_hist_t *hist, uint32_t permyriad);
+
+/**************************************************************************//**
+ * @brief: Get the bounds and the count of a bucket.
+ *
+ * @param[in]
+ *         + hist: histogram
+ *         + index: bucket index, lower than LATENCY_HIST_NB_BUCKETS
+ *
+ * @param[out]
+ *         + low: lowest value of the bucket
+ *         + high: highest value of the bucket
+ *
+ * @return  the number of values recorded in the bucket
+ *****************************************************************************/
+uint32_t latency_hist_get_bucket(const latency_hist_t *hist,
+                                 uint32_t index,
+                                 uint32_t *low,
+                                 uint32_t *high);
+
+/**************************************************************************//**
+ * @brief: Print p50/p90/p99/p99.9 of a histogram, in milli-seconds.
+ *****************************************************************************/
+void latency_hist_print_percentiles(const latency_hist_t *hist);
+
+/**************************************************************************//**
+ * @brief: Print the raw counts of the non-empty buckets, one per line as
+ *         "low_us high_us count".
+ *****************************************************************************/
+void latency_hist_print_buckets(const latency_hist_t *hist);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WIFI_CLI_HISTOGRAM_H */
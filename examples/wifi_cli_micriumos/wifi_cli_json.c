@@ -0,0 +1,368 @@
+/***************************************************************************//**
+ * @file
+ * @brief Bounded streaming JSON writer
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "wifi_cli_json.h"
+
+/***************************************************************************//**
+ * @brief
+ *    This function hands the buffered chunk to the sink
+ *
+ * @param[in]
+ *    + json: The writer
+ *
+ * @param[out] None
+ *
+ * @return  None
+ ******************************************************************************/
+static void json_flush(json_writer_t *json)
+{
+  if ((json->chunk_len > 0) && !json->error) {
+      if (json->sink(json->sink_ctx, json->chunk, json->chunk_len) < 0) {
+          json->error = true;
+      }
+  }
+  json->chunk_len = 0;
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function appends raw data to the document
+ *
+ * @param[in]
+ *    + json: The writer
+ *    + data: The data
+ *    + len: The data length
+ *
+ * @param[out] None
+ *
+ * @return  None
+ ******************************************************************************/
+static void json_put(json_writer_t *json, const char *data, uint32_t len)
+{
+  uint32_t n;
+
+  while ((len > 0) && !json->error) {
+      n = sizeof(json->chunk) - json->chunk_len;
+      if (n > len) {
+          n = len;
+      }
+      memcpy(&json->chunk[json->chunk_len], data, n);
+      json->chunk_len += n;
+      data += n;
+      len -= n;
+
+      if (json->chunk_len == sizeof(json->chunk)) {
+          json_flush(json);
+      }
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function writes the separator due before a new value
+ *
+ * @param[in]
+ *    + json: The writer
+ *
+ * @param[out] None
+ *
+ * @return  None
+ ******************************************************************************/
+static void json_separate(json_writer_t *json)
+{
+  if (json->after_key) {
+      json->after_key = false;
+      return;
+  }
+
+  if (json->need_comma & (1u << json->depth)) {
+      json_put(json, ",", 1);
+  }
+  json->need_comma |= (1u << json->depth);
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function writes a quoted & escaped string
+ *
+ * @param[in]
+ *    + json: The writer
+ *    + value: The string, not necessarily NULL-terminated
+ *    + len: The string length
+ *
+ * @param[out] None
+ *
+ * @return  None
+ ******************************************************************************/
+static void json_put_string(json_writer_t *json, const char *value, uint32_t len)
+{
+  char esc[7];
+  uint32_t i, start = 0;
+
+  json_put(json, "\"", 1);
+  for (i = 0; i < len; i++) {
+      uint8_t c = (uint8_t)value[i];
+
+      if ((c >= 0x20) && (c != '"') && (c != '\\')) {
+          continue;
+      }
+
+      /* Write the run of plain characters, then the escaped one */
+      json_put(json, &value[start], i - start);
+      if ((c == '"') || (c == '\\')) {
+          esc[0] = '\\';
+          esc[1] = (char)c;
+          json_put(json, esc, 2);
+      } else {
+          snprintf(esc, sizeof(esc), "\\u%04x", c);
+          json_put(json, esc, 6);
+      }
+      start = i + 1;
+  }
+  json_put(json, &value[start], len - start);
+  json_put(json, "\"", 1);
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function opens an object or an array
+ *
+ * @param[in]
+ *    + json: The writer
+ *    + open: '{' or '['
+ *
+ * @param[out] None
+ *
+ * @return  None
+ ******************************************************************************/
+static void json_begin(json_writer_t *json, char open)
+{
+  json_separate(json);
+  if (json->depth + 1 >= JSON_WRITER_MAX_DEPTH) {
+      json->error = true;
+      return;
+  }
+  json_put(json, &open, 1);
+  json->depth++;
+  json->need_comma &= ~(1u << json->depth);
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function closes an object or an array
+ *
+ * @param[in]
+ *    + json: The writer
+ *    + close: '}' or ']'
+ *
+ * @param[out] None
+ *
+ * @return  None
+ ******************************************************************************/
+static void json_end(json_writer_t *json, char close)
+{
+  if ((json->depth == 0) || json->after_key) {
+      json->error = true;
+      return;
+  }
+  json->depth--;
+  json_put(json, &close, 1);
+}
+
+/***************************************************************************//**
+ * @brief
+ *    Console sink
+ ******************************************************************************/
+int json_sink_stdout(void *sink_ctx, const char *data, uint32_t len)
+{
+  (void)sink_ctx;
+
+  printf("%.*s", (int)len, data);
+  return 0;
+}
+
+/***************************************************************************//**
+ * @brief
+ *    Buffer sink: the buffer is left NULL-terminated, the write fails if the
+ *    data doesn't fit
+ ******************************************************************************/
+int json_sink_buffer(void *sink_ctx, const char *data, uint32_t len)
+{
+  json_buffer_t *out = (json_buffer_t *)sink_ctx;
+
+  if ((out->buf == NULL) || (out->len + len >= out->size)) {
+      return -1;
+  }
+  memcpy(&out->buf[out->len], data, len);
+  out->len += len;
+  out->buf[out->len] = '\0';
+  return 0;
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function starts a document written to a sink
+ *
+ * @param[in]
+ *    + sink: The output sink
+ *    + sink_ctx: The sink context
+ *
+ * @param[out]
+ *    + json: The writer
+ *
+ * @return  None
+ ******************************************************************************/
+void json_writer_init(json_writer_t *json, json_sink_fn_t sink, void *sink_ctx)
+{
+  memset(json, 0, sizeof(*json));
+  json->sink = sink;
+  json->sink_ctx = sink_ctx;
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function hands the rest of the document to the sink
+ *
+ * @param[in]
+ *    + json: The writer
+ *
+ * @param[out] None
+ *
+ * @return
+ *    0 if the whole document was written & is complete
+ *    -1 if failed
+ ******************************************************************************/
+int json_writer_finish(json_writer_t *json)
+{
+  json_flush(json);
+  return (json->error || (json->depth != 0)) ? -1 : 0;
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function hands the buffered chunk to the sink, the document can be
+ *    continued afterwards
+ *
+ * @param[in]
+ *    + json: The writer
+ *
+ * @param[out] None
+ *
+ * @return
+ *    0 if the data written so far reached the sink
+ *    -1 if failed
+ ******************************************************************************/
+int json_writer_flush(json_writer_t *json)
+{
+  json_flush(json);
+  return json->error ? -1 : 0;
+}
+
+/*******************************************************************************
+ *  Structure & value writers (see wifi_cli_json.h)
+ ******************************************************************************/
+void json_begin_object(json_writer_t *json)
+{
+  json_begin(json, '{');
+}
+
+void json_end_object(json_writer_t *json)
+{
+  json_end(json, '}');
+}
+
+void json_begin_array(json_writer_t *json)
+{
+  json_begin(json, '[');
+}
+
+void json_end_array(json_writer_t *json)
+{
+  json_end(json, ']');
+}
+
+void json_key(json_writer_t *json, const char *key)
+{
+  json_separate(json);
+  json_put_string(json, key, strlen(key));
+  json_put(json, ":", 1);
+  json->after_key = true;
+}
+
+void json_string(json_writer_t *json, const char *value)
+{
+  json_string_n(json, value, strlen(value));
+}
+
+void json_string_n(json_writer_t *json, const char *value, uint32_t len)
+{
+  json_separate(json);
+  json_put_string(json, value, len);
+}
+
+void json_uint(json_writer_t *json, uint32_t value)
+{
+  char num[11];
+  int len = snprintf(num, sizeof(num), "%lu", (unsigned long)value);
+
+  json_separate(json);
+  json_put(json, num, len);
+}
+
+void json_int(json_writer_t *json, int32_t value)
+{
+  char num[12];
+  int len = snprintf(num, sizeof(num), "%ld", (long)value);
+
+  json_separate(json);
+  json_put(json, num, len);
+}
+
+void json_bool(json_writer_t *json, bool value)
+{
+  json_separate(json);
+  if (value) {
+      json_put(json, "true", 4);
+  } else {
+      json_put(json, "false", 5);
+  }
+}
+
+void json_number(json_writer_t *json, const char *num)
+{
+  json_separate(json);
+  json_put(json, num, strlen(num));
+}
+
+void json_kv_string(json_writer_t *json, const char *key, const char *value)
+{
+  json_key(json, key);
+  json_string(json, value);
+}
+
+void json_kv_uint(json_writer_t *json, const char *key, uint32_t value)
+{
+  json_key(json, key);
+  json_uint(json, value);
+}
+
+void json_kv_int(json_writer_t *json, const char *key, int32_t value)
+{
+  json_key(json, key);
+  json_int(json, value);
+}
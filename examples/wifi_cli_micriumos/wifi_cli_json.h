@@ -0,0 +1,119 @@
+/***************************************************************************//**
+ * @file
+ * @brief Bounded streaming JSON writer
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+#ifndef WIFI_CLI_JSON_H
+#define WIFI_CLI_JSON_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * The writer only holds one chunk: the document is handed to the sink each
+ * time the chunk is full, so its size doesn't depend on the document length.
+ */
+#ifndef JSON_WRITER_CHUNK_LEN
+#define JSON_WRITER_CHUNK_LEN     64
+#endif
+#define JSON_WRITER_MAX_DEPTH     16   ///< Max nested objects/arrays
+
+/**************************************************************************//**
+ * @brief: Output sink: consumes len bytes of the document.
+ *
+ * @return 0 on success, -1 on failure (the document is then dropped).
+ *****************************************************************************/
+typedef int (*json_sink_fn_t)(void *sink_ctx, const char *data, uint32_t len);
+
+/* Streaming JSON writer */
+typedef struct {
+  json_sink_fn_t sink;
+  void *sink_ctx;
+  char chunk[JSON_WRITER_CHUNK_LEN];
+  uint16_t chunk_len;
+  uint16_t need_comma;  ///< Bit per depth: a value was already written
+  uint8_t depth;
+  bool after_key;       ///< The next value follows a key
+  bool error;           ///< Sink failure or nesting error
+} json_writer_t;
+
+/* Context of json_sink_buffer() */
+typedef struct {
+  char *buf;
+  uint32_t size;
+  uint32_t len;         ///< Length written, excluding the NULL terminator
+} json_buffer_t;
+
+/**************************************************************************//**
+ * @brief: Sink writing to the console (stdout).
+ *****************************************************************************/
+int json_sink_stdout(void *sink_ctx, const char *data, uint32_t len);
+
+/**************************************************************************//**
+ * @brief: Sink writing to a json_buffer_t, kept NULL-terminated. Fails
+ *         instead of truncating the document.
+ *****************************************************************************/
+int json_sink_buffer(void *sink_ctx, const char *data, uint32_t len);
+
+/**************************************************************************//**
+ * @brief: Start a document.
+ *****************************************************************************/
+void json_writer_init(json_writer_t *json, json_sink_fn_t sink, void *sink_ctx);
+
+/**************************************************************************//**
+ * @brief: Hand the rest of the document to the sink.
+ *
+ * @return 0 if the whole document was written, -1 otherwise.
+ *****************************************************************************/
+int json_writer_finish(json_writer_t *json);
+
+/**************************************************************************//**
+ * @brief: Hand the buffered chunk to the sink, the document can go on.
+ *
+ * @return 0 if the data written so far reached the sink, -1 otherwise.
+ *****************************************************************************/
+int json_writer_flush(json_writer_t *json);
+
+/**************************************************************************//**
+ * @brief: Structure & values. A value inside an object follows json_key().
+ *         json_number() writes a number already formatted.
+ *****************************************************************************/
+void json_begin_object(json_writer_t *json);
+void json_end_object(json_writer_t *json);
+void json_begin_array(json_writer_t *json);
+void json_end_array(json_writer_t *json);
+void json_key(json_writer_t *json, const char *key);
+void json_string(json_writer_t *json, const char *value);
+void json_string_n(json_writer_t *json, const char *value, uint32_t len);
+void json_uint(json_writer_t *json, uint32_t value);
+void json_int(json_writer_t *json, int32_t value);
+void json_bool(json_writer_t *json, bool value);
+void json_number(json_writer_t *json, const char *num);
+
+/**************************************************************************//**
+ * @brief: Object member helpers: json_key() followed by the value.
+ *****************************************************************************/
+void json_kv_string(json_writer_t *json, const char *key, const char *value);
+void json_kv_uint(json_writer_t *json, const char *key, uint32_t value);
+void json_kv_int(json_writer_t *json, const char *key, int32_t value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WIFI_CLI_JSON_H */
@@ -28,6 +28,11 @@
 #include "dhcp_server.h"
 #include "sl_wfx_task.h"
 #include "sl_wfx_host.h"
+#include "sl_sleeptimer.h"
+#include "wifi_cli_boot.h"
+#include "wifi_cli_ram.h"
+#include "wifi_cli_cpu.h"
+#include "wifi_cli_metrics.h"
 
 /*******************************************************************************
  ******************   Wi-Fi CLI lwIP App Task Configuration   *****************
@@ -41,23 +46,61 @@
 static CPU_STK  wfx_cli_lwip_task_stk[WFX_CLI_LWIP_TASK_STK_SIZE];
 /* LWIP task tcb */
 static OS_TCB   wfx_cli_lwip_task_tcb;
+/* Posted when the interfaces can be added (WF200 firmware booted) */
+static OS_SEM   wfx_cli_lwip_netif_sem;
+/* Posted once the interfaces are added & the DHCP client is started */
+static OS_SEM   wfx_cli_lwip_netif_up_sem;
 
 /************************ Private variables ***********************************/
 static void *iperf_server_session = NULL;
+static void *iperf3_server_session = NULL;
 static void *iperf_client_session = NULL;
+static bool iperf_client_is_iperf3 = false;
 static bool iperf_client_is_foreground_mode = false;
 
 static uint32_t last_client_bytes_transferred = 0;
 static uint32_t last_client_ms_duration = 0;
 static uint32_t last_client_bandwidth_kbitpsec = 0;
 
-static uint16_t ping_nb_packet_received = 0;
-static uint16_t ping_nb_packet_sent = 0;
-static uint32_t ping_echo_total_time = 0;
-static uint32_t ping_echo_min_time = 0xFFFFFFFF;
-static uint32_t ping_echo_max_time = 0;
-static uint16_t ping_seq_num = 0;
-static uint32_t ping_time = 0;
+/* Number of busiest tasks shown with the iperf interval reports */
+#define IPERF_CPU_REPORT_TASKS  3
+
+/* CPU profiles of the iperf interval reports, one per session (tcpip
+ * thread) */
+static cpu_profile_t iperf_server_cpu_prof;
+static cpu_profile_t iperf3_server_cpu_prof;
+static cpu_profile_t iperf_client_cpu_prof;
+static cpu_task_usage_t iperf_cpu_usage[IPERF_CPU_REPORT_TASKS];
+
+#if LWIP_RAW
+/* Send timestamp of a request awaiting its reply */
+typedef struct {
+  uint64_t sent_us;
+  uint16_t seqno;
+  bool pending;
+} ping_slot_t;
+
+/* Ping session, driven from the tcpip thread */
+static struct {
+  struct raw_pcb *pcb;
+  ip_addr_t addr;
+  ping_params_t params;
+  uint64_t next_send_us;
+  latency_hist_t rtt_hist;
+  uint32_t nb_sent;
+  uint32_t nb_received;
+  uint32_t nb_late;
+  uint32_t nb_expired;
+  uint32_t nb_outstanding;
+  uint16_t seq_num;
+  bool running;
+  /* Indexed by sequence number modulo PING_MAX_OUTSTANDING */
+  ping_slot_t slots[PING_MAX_OUTSTANDING];
+} ping_ctx;
+
+static void ping_timer_cb(void *arg);
+static bool ping_send_next(uint64_t now);
+#endif
 
 /**************************************************************************//**
  * Set station link status to up.
@@ -110,6 +153,43 @@ sl_status_t set_ap_link_down(void)
 }
 
 #if LWIP_RAW  /*!< LWIP_RAW is configured in lwipopts.h */
+/***************************************************************************//**
+ * @brief
+ *    This function returns a timestamp in micro-seconds from the sleeptimer,
+ *    whose resolution is below the millisecond of sys_now()
+ *
+ * @param[in] None
+ *
+ * @param[out] None
+ *
+ * @return  timestamp in micro-seconds
+ ******************************************************************************/
+static uint64_t ping_get_time_us(void)
+{
+  return (sl_sleeptimer_get_tick_count64() * 1000000ULL)
+         / sl_sleeptimer_get_timer_frequency();
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function ends the ping session
+ *
+ * @param[in] None
+ *
+ * @param[out] None
+ *
+ * @return  None
+ ******************************************************************************/
+static void ping_stop(void)
+{
+  if (ping_ctx.running) {
+    ping_ctx.running = false;
+    sys_untimeout(ping_timer_cb, NULL);
+    raw_remove(ping_ctx.pcb);
+    ping_ctx.pcb = NULL;
+  }
+}
+
 /***************************************************************************//**
  * @brief
  *    This callback function handles received messages
@@ -131,6 +211,10 @@ static u8_t ping_recv_fnp(void *arg,
   LWIP_ASSERT("p != NULL", p != NULL);
 
   struct icmp_echo_hdr *iecho_hdr_ptr = NULL;
+  ping_slot_t *slot;
+  uint64_t now = ping_get_time_us();
+  uint32_t rtt_us;
+  uint16_t seqno;
 
   /** Filter out the received messages by length, only receive ICMP messages.
    * ICMP message size = sizeof(struct icmp_echo_hdr) + data_size.
@@ -141,27 +225,38 @@ static u8_t ping_recv_fnp(void *arg,
       && (pbuf_remove_header(p, PBUF_IP_HLEN) == 0)) {
 
       iecho_hdr_ptr = (struct icmp_echo_hdr *) p->payload; /*!< ICMP header */
+      seqno = lwip_ntohs(iecho_hdr_ptr->seqno);
 
       if ((iecho_hdr_ptr->id == PING_ID)
-          && (iecho_hdr_ptr->seqno == lwip_htons(ping_seq_num))) {
-
-          /* Update statistic variables */
-          ping_nb_packet_received++;
-
-          uint32_t duration = sys_now() - ping_time;
-          ping_echo_total_time += duration;
-
-          if (duration < ping_echo_min_time) {
-              ping_echo_min_time = duration;
-          }
-
-          if (duration > ping_echo_max_time) {
-              ping_echo_max_time = duration;
+          && (ICMPH_TYPE(iecho_hdr_ptr) == ICMP_ER)
+          && ip_addr_cmp(addr, &ping_ctx.addr)) {
+
+          /* Match the reply with its request, even if others were sent since */
+          slot = &ping_ctx.slots[seqno % PING_MAX_OUTSTANDING];
+          if (slot->pending && (slot->seqno == seqno)) {
+              slot->pending = false;
+              ping_ctx.nb_outstanding--;
+
+              /* Update statistic variables */
+              rtt_us = (uint32_t)(now - slot->sent_us);
+              ping_ctx.nb_received++;
+              latency_hist_record(&ping_ctx.rtt_hist, rtt_us);
+
+              if (ping_ctx.params.interval_ms != 0) {
+                  printf("Reply from %s: bytes=%d, seq=%u, time=%lu.%03lums\r\n",
+                         ipaddr_ntoa(addr),
+                         (int)(p->tot_len - sizeof(struct icmp_echo_hdr)),
+                         seqno,
+                         rtt_us / 1000,
+                         rtt_us % 1000);
+              } else if (ping_ctx.nb_sent < ping_ctx.params.count) {
+                  /* Flood mode: send the next request right away */
+                  ping_send_next(now);
+              }
+          } else if ((uint16_t)(ping_ctx.seq_num - seqno) < ping_ctx.nb_sent) {
+              /* Reply to a request that has already timed out */
+              ping_ctx.nb_late++;
           }
-
-          printf("Reply from %s: bytes=%d, time=%lums\r\n", ipaddr_ntoa(addr),
-                                                            p->len,
-                                                            duration);
           pbuf_free(p);
 
           /* Eat the packet (received ICMP) */
@@ -176,7 +271,6 @@ static u8_t ping_recv_fnp(void *arg,
   return 0;
 }
 
-
 /***************************************************************************//**
  * @brief
  *    This function sends ping ICMP request message
@@ -194,6 +288,7 @@ static int ping_send(struct raw_pcb *ping_raw_pcb,
 
   struct pbuf *pbf = NULL;  /*!< packet buffer pointer (layer 3) */
   struct icmp_echo_hdr *iecho;
+  ping_slot_t *slot;
   size_t ping_msg_size, i;
   int res = -1;
 
@@ -209,7 +304,7 @@ static int ping_send(struct raw_pcb *ping_raw_pcb,
       ICMPH_CODE_SET(iecho, 0);
       iecho->chksum = 0;
       iecho->id = PING_ID;     /*!< MSB = LSB (0xAFAF) - no need to convert */
-      iecho->seqno = lwip_htons(++ping_seq_num);
+      iecho->seqno = lwip_htons(++ping_ctx.seq_num);
 
       /* Fill the additional data buffer with some data */
       for (i = 0; i < data_size; i++) {
@@ -218,21 +313,102 @@ static int ping_send(struct raw_pcb *ping_raw_pcb,
 
       iecho->chksum = inet_chksum(iecho, ping_msg_size);
 
+      slot = &ping_ctx.slots[ping_ctx.seq_num % PING_MAX_OUTSTANDING];
+      slot->seqno = ping_ctx.seq_num;
+      slot->sent_us = ping_get_time_us();
       res = raw_sendto(ping_raw_pcb, pbf, dest_ip_addr);
       if (res == 0) {
-          ping_time = sys_now();
-          ping_nb_packet_sent++;
+          slot->pending = true;
+          ping_ctx.nb_outstanding++;
       }
+      /* A request which could not be sent is counted as lost */
+      ping_ctx.nb_sent++;
       pbuf_free(pbf);
   }
   return res;
 }
 
+/***************************************************************************//**
+ * @brief
+ *    This function sends the next request if its slot in the timestamp table
+ *    is free
+ *
+ * @param[in]
+ *         + now: current time in micro-seconds
+ *
+ * @param[out] None
+ *
+ * @return  true if a request has been sent
+ ******************************************************************************/
+static bool ping_send_next(uint64_t now)
+{
+  ping_slot_t *slot;
+
+  slot = &ping_ctx.slots[(uint16_t)(ping_ctx.seq_num + 1) % PING_MAX_OUTSTANDING];
+  if (slot->pending) {
+      /* Too many requests awaiting a reply */
+      return false;
+  }
+  if (ping_send(ping_ctx.pcb, &ping_ctx.addr, ping_ctx.params.data_size) != 0) {
+      LOG_DEBUG("Send ping request failed\r\n");
+  }
+  ping_ctx.next_send_us = now + (uint64_t)ping_ctx.params.interval_ms * 1000;
+  return true;
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This timer callback expires the requests without reply, sends the
+ *    requests which are due and ends the session once all are completed
+ *
+ * @param[in] None
+ *
+ * @param[out] None
+ *
+ * @return  None
+ ******************************************************************************/
+static void ping_timer_cb(void *arg)
+{
+  uint64_t now = ping_get_time_us();
+  uint64_t timeout_us = (uint64_t)ping_ctx.params.timeout_ms * 1000;
+  uint32_t i;
+
+  (void)arg;
+
+  /* Expire the requests without reply */
+  for (i = 0; i < PING_MAX_OUTSTANDING; i++) {
+      if (ping_ctx.slots[i].pending
+          && ((now - ping_ctx.slots[i].sent_us) >= timeout_us)) {
+          ping_ctx.slots[i].pending = false;
+          ping_ctx.nb_outstanding--;
+          ping_ctx.nb_expired++;
+          if (ping_ctx.params.interval_ms != 0) {
+              printf("Request timed out: seq=%u\r\n", ping_ctx.slots[i].seqno);
+          }
+      }
+  }
+
+  /* Send the requests which are due */
+  if ((ping_ctx.nb_sent < ping_ctx.params.count)
+      && (now >= ping_ctx.next_send_us)) {
+      ping_send_next(now);
+  }
+
+  if ((ping_ctx.nb_sent == ping_ctx.params.count)
+      && (ping_ctx.nb_outstanding == 0)) {
+      ping_stop();
+      /* Give back the hand to the shell */
+      wifi_cli_resume(&g_cli_sem, 0); /*!< "sem_event_type" is 0, a general event */
+  } else {
+      sys_timeout(PING_TIMER_PERIOD_MS, ping_timer_cb, NULL);
+  }
+}
+
 /**************************************************************************//**
  * @brief: Implementation of the ping command.
  *
  * @param[in]
- *         + req_num: Number of request messages (ICMP)
+ *         + params: Number, interval, timeout and size of the requests (ICMP)
  *         + ip_str: Remote IP's address
  *
  * @param[out]  None
@@ -241,14 +417,22 @@ static int ping_send(struct raw_pcb *ping_raw_pcb,
  *        SL_STATUS_OK if success
  *        SL_STATUS_FAIL if error
  *****************************************************************************/
-sl_status_t ping_cmd(uint32_t req_num, char *ip_str)
+sl_status_t ping_cmd(const ping_params_t *params, char *ip_str)
 {
 
   int res = -1;
-
+  uint32_t lost;
+  uint32_t wait_ms;
+  uint32_t progress, last_progress;
+  uint64_t period_ms, idle_ms;
+  uint64_t rtt_avg_us;
   struct raw_pcb *ping_pcb = NULL; /*!< protocol control block */
   ip_addr_t ping_addr;
 
+  if ((params->count == 0) || (params->data_size > PING_MAX_DATA_SIZE)) {
+      return SL_STATUS_INVALID_PARAMETER;
+  }
+
   /* Parsing IP address */
   res = ipaddr_aton(ip_str, &ping_addr);
   if (res == 0) {
@@ -256,9 +440,11 @@ sl_status_t ping_cmd(uint32_t req_num, char *ip_str)
       return SL_STATUS_FAIL;
   }
 
+  LOCK_TCPIP_CORE();
   /* Allocate a new resource raw_pcb */
   ping_pcb = raw_new(IP_PROTO_ICMP);
   if (ping_pcb == NULL) {
+      UNLOCK_TCPIP_CORE();
       LOG_DEBUG("Failed to allocate resource for ping_pcb\r\n");
       return SL_STATUS_ALLOCATION_FAILED;
   }
@@ -267,41 +453,72 @@ sl_status_t ping_cmd(uint32_t req_num, char *ip_str)
   raw_recv(ping_pcb, ping_recv_fnp, NULL);
   raw_bind(ping_pcb, IP_ADDR_ANY);
 
-  printf("Pinging %s with %d bytes of data:\r\n",
-           ip_str, PING_DEFAULT_DATA_SIZE);
+  printf("Pinging %s with %u bytes of data:\r\n", ip_str, params->data_size);
 
   /* Reset internal variables */
-  ping_seq_num = 0;
-  ping_nb_packet_sent = 0;
-  ping_nb_packet_received = 0;
-  ping_echo_total_time = 0;
-  ping_echo_min_time = 0xFFFFFFFF;
-  ping_echo_max_time = 0;
-
-  while(req_num-- > 0) {
-      /* Send ping request to IP destination */
-      res = ping_send(ping_pcb, &ping_addr, PING_DEFAULT_DATA_SIZE);
-      if (res != 0) {
-          printf("Send ping request to IP (%s) failed\r\n", ip_str);
-          return SL_STATUS_FAIL;
+  memset(&ping_ctx, 0, sizeof(ping_ctx));
+  ping_ctx.pcb = ping_pcb;
+  ping_ctx.params = *params;
+  ip_addr_copy(ping_ctx.addr, ping_addr);
+  latency_hist_reset(&ping_ctx.rtt_hist);
+  ping_ctx.running = true;
+
+  /* Send the first request now, the engine timer does the rest */
+  ping_timer_cb(NULL);
+  UNLOCK_TCPIP_CORE();
+
+  /* The engine ends the session by itself: wait as long as it makes
+   * progress, at least one request being sent, answered or expired per
+   * interval + timeout, with a safety margin. In flood mode, the requests
+   * go at the pace of the replies */
+  period_ms = (uint64_t)((params->interval_ms != 0) ? params->interval_ms : PING_TIMER_PERIOD_MS)
+              + params->timeout_ms + 1000;
+  wait_ms = (period_ms < PING_MAX_WAIT_MS) ? (uint32_t)period_ms : PING_MAX_WAIT_MS;
+  idle_ms = 0;
+  last_progress = 0;
+  while (wifi_cli_wait(&g_cli_sem, 0, wait_ms) == RTOS_ERR_TIMEOUT) {
+      if (!ping_ctx.running) {
+          break;
+      }
+      progress = ping_ctx.nb_sent + ping_ctx.nb_received + ping_ctx.nb_expired;
+      if (progress != last_progress) {
+          last_progress = progress;
+          idle_ms = 0;
+          continue;
+      }
+      idle_ms += wait_ms;
+      if (idle_ms >= period_ms) {
+          LOG_DEBUG("Wait timeout!\r\n");
+          LOCK_TCPIP_CORE();
+          ping_stop();
+          UNLOCK_TCPIP_CORE();
+          break;
       }
-      /* Wait for receiving ICMP responses from the destination IP */
-      sys_msleep(PING_DEFAULT_INTERVAL_SEC * 1000);
   }
 
-  if (res == 0) {
-    /* Display statistics */
-    printf("\r\nPing statistics for %s:\r\n", ip_str);
-    printf("\tPackets: Sent = %u, Received = %u, Lost = %u (%u%% loss),\r\n",
-           ping_nb_packet_sent,
-           ping_nb_packet_received,
-           ping_nb_packet_sent-ping_nb_packet_received,
-           ((ping_nb_packet_sent-ping_nb_packet_received)*100)/ping_nb_packet_sent);
+  /* Display statistics */
+  lost = ping_ctx.nb_sent - ping_ctx.nb_received;
+  printf("\r\nPing statistics for %s:\r\n", ip_str);
+  printf("\tPackets: Sent = %lu, Received = %lu, Lost = %lu (%lu%% loss), Late = %lu,\r\n",
+         ping_ctx.nb_sent,
+         ping_ctx.nb_received,
+         lost,
+         (ping_ctx.nb_sent != 0) ? (lost * 100) / ping_ctx.nb_sent : 0,
+         ping_ctx.nb_late);
+  if (ping_ctx.nb_received != 0) {
+    rtt_avg_us = ping_ctx.rtt_hist.sum / ping_ctx.rtt_hist.total;
     printf("Approximate round trip times in milli-seconds:\r\n");
-    printf("\tMinimum = %lums, Maximum = %lums, Average = %lums\r\n",
-           ping_echo_min_time,
-           ping_echo_max_time,
-           ping_echo_total_time/ping_nb_packet_received);
+    printf("\tMinimum = %lu.%03lums, Maximum = %lu.%03lums, Average = %lu.%03lums\r\n",
+           ping_ctx.rtt_hist.min / 1000,
+           ping_ctx.rtt_hist.min % 1000,
+           ping_ctx.rtt_hist.max / 1000,
+           ping_ctx.rtt_hist.max % 1000,
+           (uint32_t)(rtt_avg_us / 1000),
+           (uint32_t)(rtt_avg_us % 1000));
+    latency_hist_print_percentiles(&ping_ctx.rtt_hist);
+    if (params->print_buckets) {
+      latency_hist_print_buckets(&ping_ctx.rtt_hist);
+    }
   }
   return SL_STATUS_OK;
 }
@@ -370,19 +587,85 @@ static void lwip_iperf_results (void *arg,
   }
 }
 
+/***************************************************************************//**
+ * @brief
+ *    Print a sample of the TCP connection internals of a running iperf test
+ *
+ * @param[in]
+ *         + arg: CPU profile of the session
+ *         + sample: TCP connection sample
+ *
+ * @param[out] None
+ *
+ * @return  None
+ ******************************************************************************/
+static void lwip_iperf_tcp_sample(void *arg,
+                                  const struct lwiperf_tcp_sample *sample)
+{
+  cpu_profile_t *cpu_prof = (cpu_profile_t *)arg;
+  uint32_t kbitpsec = 0;
+  int i, nb_usage;
+
+  if (sample->interval_ms != 0) {
+    kbitpsec = (sample->interval_bytes / sample->interval_ms) * 8;
+  }
+
+  printf("[%3lus] %lu.%03lu Mbps cwnd %lu ssthresh %lu snd_wnd %lu "
+         "srtt %lums rto %lums nrtx %u dupacks %u "
+         "queuelen %u unacked %lu unsent %lu\r\n",
+         sample->ms_elapsed / 1000,
+         kbitpsec / 1000,
+         kbitpsec % 1000,
+         sample->cwnd,
+         sample->ssthresh,
+         sample->snd_wnd,
+         sample->srtt_ms,
+         sample->rto_ms,
+         sample->nrtx,
+         sample->dupacks,
+         sample->snd_queuelen,
+         sample->unacked_bytes,
+         sample->unsent_bytes);
+
+  /* Busiest tasks over the interval, the first sample of a test starts
+   * the profile */
+  if (sample->interval_ms == sample->ms_elapsed) {
+    cpu_profile_begin(cpu_prof);
+    return;
+  }
+  nb_usage = cpu_profile_sample(cpu_prof,
+                                iperf_cpu_usage,
+                                IPERF_CPU_REPORT_TASKS);
+  if (nb_usage > 0) {
+    printf("       cpu:");
+    for (i = 0; i < nb_usage; i++) {
+      printf(" %s %lu.%02lu%% (%lu sw)",
+             (iperf_cpu_usage[i].name != NULL) ? iperf_cpu_usage[i].name : "?",
+             (unsigned long)(iperf_cpu_usage[i].usage / 100u),
+             (unsigned long)(iperf_cpu_usage[i].usage % 100u),
+             (unsigned long)iperf_cpu_usage[i].ctx_switches);
+    }
+    printf("\r\n");
+  }
+}
+
 /***************************************************************************//**
  * @brief
  *    Start iperf as server mode.
  *
  * @param[in]
+ *         + use_iperf3: serve iperf3 clients instead of iperf2 ones
+ *         + tcp_sampling: print the TCP internals of the tests every second
  *
  * @param[out] None
  *
  * @return  None
  ******************************************************************************/
-void iperf_server(void)
+void iperf_server(bool use_iperf3, bool tcp_sampling)
 {
-  if (iperf_server_session != NULL) {
+  void **session = use_iperf3 ? &iperf3_server_session : &iperf_server_session;
+
+  if (*session != NULL) {
     /* An iPerf server is already running, kill it first */
     printf("A server is running, stop it first\r\n");
   } else {
@@ -392,14 +675,31 @@ void iperf_server(void)
     last_client_bandwidth_kbitpsec = 0;
 
     LOCK_TCPIP_CORE();
-    iperf_server_session = lwiperf_start_tcp_server_default(lwip_iperf_results,
-                                                            (void *)IPERF_SERVER_MODE);
+    if (use_iperf3) {
+      *session = lwiperf3_start_tcp_server(IP_ADDR_ANY,
+                                           IPERF3_DEFAULT_PORT,
+                                           lwip_iperf_results,
+                                           (void *)IPERF_SERVER_MODE);
+      if ((*session != NULL) && tcp_sampling) {
+        lwiperf3_set_tcp_sample_fn(*session,
+                                   lwip_iperf_tcp_sample,
+                                   &iperf3_server_cpu_prof);
+      }
+    } else {
+      *session = lwiperf_start_tcp_server_default(lwip_iperf_results,
+                                                  (void *)IPERF_SERVER_MODE);
+      if ((*session != NULL) && tcp_sampling) {
+        lwiperf_set_tcp_sample_fn(*session,
+                                  lwip_iperf_tcp_sample,
+                                  &iperf_server_cpu_prof);
+      }
+    }
     UNLOCK_TCPIP_CORE();
 
-    if (iperf_server_session != NULL) {
-      printf("iPerf TCP server started\r\n");
+    if (*session != NULL) {
+      printf("iPerf%s TCP server started\r\n", use_iperf3 ? "3" : "");
     } else {
-      printf("iPerf TCP server error\r\n");
+      printf("iPerf%s TCP server error\r\n", use_iperf3 ? "3" : "");
     }
   }
 }
@@ -410,8 +710,13 @@ void iperf_server(void)
  * @param[in]
  *         + ip_str: IP address string of remote iperf server
  *         + duration: duration in seconds
+ *         + amount_bytes: number of bytes to transmit (0: time-limited test)
+ *         + buffer_len: length of each write in bytes (0: TCP MSS)
  *         + remote_port: Port of remote iperf server
+ *         + use_iperf3: use the iperf3 protocol instead of the iperf2 one
+ *         + reverse: let the iperf3 server send the data
  *         + is_foreground_mode: enable/disable foreground mode
+ *         + tcp_sampling: print the TCP internals of the test every second
  *
  * @param[out] None
  *
@@ -419,11 +724,17 @@ void iperf_server(void)
  *****************************************************************************/
 void iperf_client(char *ip_str,
                   uint32_t duration,
+                  uint32_t amount_bytes,
+                  uint32_t buffer_len,
                   uint32_t remote_port,
-                  bool is_foreground_mode)
+                  bool use_iperf3,
+                  bool reverse,
+                  bool is_foreground_mode,
+                  bool tcp_sampling)
 {
   int res;
   ip_addr_t srv_addr;
+  uint32_t timeout_ms;
   RTOS_ERR_CODE err_code;
 
   /* parse the remote server IP address */
@@ -435,14 +746,38 @@ void iperf_client(char *ip_str,
   }
 
   iperf_client_is_foreground_mode = is_foreground_mode;
+  iperf_client_is_iperf3 = use_iperf3;
 
   LOCK_TCPIP_CORE();
-  iperf_client_session = lwiperf_start_tcp_client(&srv_addr,
-                                                 remote_port,
-                                                 LWIPERF_CLIENT,
-                                                 (uint32_t)duration,
-                                                 lwip_iperf_results,
-                                                 (void *)IPERF_CLIENT_MODE);
+  if (use_iperf3) {
+    iperf_client_session = lwiperf3_start_tcp_client(&srv_addr,
+                                                     remote_port,
+                                                     (uint32_t)duration,
+                                                     amount_bytes,
+                                                     buffer_len,
+                                                     reverse,
+                                                     lwip_iperf_results,
+                                                     (void *)IPERF_CLIENT_MODE);
+    if ((iperf_client_session != NULL) && tcp_sampling) {
+      lwiperf3_set_tcp_sample_fn(iperf_client_session,
+                                 lwip_iperf_tcp_sample,
+                                 &iperf_client_cpu_prof);
+    }
+  } else {
+    iperf_client_session = lwiperf_start_tcp_client(&srv_addr,
+                                                   remote_port,
+                                                   LWIPERF_CLIENT,
+                                                   (uint32_t)duration,
+                                                   amount_bytes,
+                                                   buffer_len,
+                                                   lwip_iperf_results,
+                                                   (void *)IPERF_CLIENT_MODE);
+    if ((iperf_client_session != NULL) && tcp_sampling) {
+      lwiperf_set_tcp_sample_fn(iperf_client_session,
+                                lwip_iperf_tcp_sample,
+                                &iperf_client_cpu_prof);
+    }
+  }
   UNLOCK_TCPIP_CORE();
 
   if (iperf_client_session != NULL) {
@@ -450,10 +785,16 @@ void iperf_client(char *ip_str,
       printf("iPerf TCP client started on server %s\r\n", ip_str);
 
       if (iperf_client_is_foreground_mode == true) {
+          /* A byte-limited test has no known duration and an iperf3 test
+           * ends with a results exchange: wait for their report (the idle
+           * timeout of lwiperf guarantees it comes) */
+          timeout_ms = ((amount_bytes != 0) || use_iperf3) ?
+                       0 : ((uint32_t)duration + 1) * 1000;
+
          /*  Wait at least 1 second until the test is done */
           err_code = wifi_cli_wait(&g_cli_sem,
                                    0,
-                                   ((uint32_t)duration + 1) * 1000);
+                                   timeout_ms);
 
           if (err_code == RTOS_ERR_TIMEOUT) {
               LOG_DEBUG("Wait timeout!\r\n");
@@ -489,6 +830,15 @@ void stop_iperf_server(void)
 
       iperf_server_session = NULL;
     }
+  if (iperf3_server_session != NULL) {
+      printf("Stop iPerf3 server\r\n");
+
+      LOCK_TCPIP_CORE();
+      lwiperf3_abort(iperf3_server_session);
+      UNLOCK_TCPIP_CORE();
+
+      iperf3_server_session = NULL;
+    }
 }
 
 /***************************************************************************//**
@@ -507,7 +857,11 @@ void stop_iperf_client(void)
       printf("Stop client\r\n");
 
       LOCK_TCPIP_CORE();
-      lwiperf_abort(iperf_client_session);
+      if (iperf_client_is_iperf3) {
+        lwiperf3_abort(iperf_client_session);
+      } else {
+        lwiperf_abort(iperf_client_session);
+      }
       UNLOCK_TCPIP_CORE();
 
       iperf_client_session = NULL;
@@ -535,43 +889,15 @@ static void netif_config(void)
     ip_addr_set_zero_ip4(&sta_netmask);
     ip_addr_set_zero_ip4(&sta_gw);
   } else {
-    IP_ADDR4(&sta_ipaddr, \
-             sta_ip_addr0, \
-             sta_ip_addr1, \
-             sta_ip_addr2, \
-             sta_ip_addr3);
-
-    IP_ADDR4(&sta_netmask, \
-             sta_netmask_addr0, \
-             sta_netmask_addr1, \
-             sta_netmask_addr2, \
-             sta_netmask_addr3);
-
-    IP_ADDR4(&sta_gw, \
-             sta_gw_addr0, \
-             sta_gw_addr1, \
-             sta_gw_addr2, \
-             sta_gw_addr3);
+    ip_addr_copy(sta_ipaddr, sta_static_addr.ip_addr);
+    ip_addr_copy(sta_netmask, sta_static_addr.netmask);
+    ip_addr_copy(sta_gw, sta_static_addr.gw);
   }
 
   /* Initialize the SoftAP information */
-  IP_ADDR4(&ap_ipaddr, \
-           ap_ip_addr0, \
-           ap_ip_addr1, \
-           ap_ip_addr2, \
-           ap_ip_addr3);
-
-  IP_ADDR4(&ap_netmask, \
-           ap_netmask_addr0, \
-           ap_netmask_addr1, \
-           ap_netmask_addr2, \
-           ap_netmask_addr3);
-
-  IP_ADDR4(&ap_gw, \
-           ap_gw_addr0, \
-           ap_gw_addr1, \
-           ap_gw_addr2, \
-           ap_gw_addr3);
+  ip_addr_copy(ap_ipaddr, ap_static_addr.ip_addr);
+  ip_addr_copy(ap_netmask, ap_static_addr.netmask);
+  ip_addr_copy(ap_gw, ap_static_addr.gw);
 
   /* Add Station interfaces */
   netif_add(&sta_netif,
@@ -597,8 +923,35 @@ static void netif_config(void)
 
 /***************************************************************************//**
  * @brief
- *    This task create lwIP TCP/IP stack; configure default network interface
- *    & start DHCP client if used
+ *    This function is called from the tcpip thread once it is running
+ *
+ * @param[in]
+ *
+ * @param[out] None
+ *
+ * @return  None
+ ******************************************************************************/
+static void lwip_tcpip_init_done(void *arg)
+{
+  (void)arg;
+
+  /* Application pools, kept apart from the heap of the packets */
+  lwiperf_init();
+  lwiperf3_init();
+  metrics_init();
+  boot_trace_mark(BOOT_STAGE_TCPIP_READY);
+
+#ifdef HTTP_SERVER
+  /* Serves the metrics snapshots (wifi_cli_metrics.c) on both interfaces */
+  httpd_init();
+#endif
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This task create lwIP TCP/IP stack right away, then waits for
+ *    lwip_netif_start() to configure the network interfaces & start DHCP
+ *    client if used
  *
  * @param[in]
  *
@@ -611,24 +964,37 @@ void lwip_init_start_task(void *p_arg)
   (void)p_arg;
   RTOS_ERR err;
 
-  /* Create tcip_ip stack thread */
-  tcpip_init(NULL, NULL);
+  /* Create tcip_ip stack thread, it doesn't need the WF200 */
+  tcpip_init(lwip_tcpip_init_done, NULL);
+
+  /* The interfaces use the WF200 MAC addresses & the restored parameters */
+  OSSemPend(&wfx_cli_lwip_netif_sem,
+            0,
+            OS_OPT_PEND_BLOCKING,
+            NULL,
+            &err);
 
   /* Initialize Wifi network interfaces */
   netif_config();
+  boot_trace_mark(BOOT_STAGE_NETIF_UP);
 
   /* Start DHCP Client*/
   if (use_dhcp_client) {
       dhcpclient_start();
   }
 
+  /* Release lwip_netif_start() */
+  OSSemPost(&wfx_cli_lwip_netif_up_sem, OS_OPT_POST_1, &err);
+
   /* Delete Lwip init task */
+  ram_task_exit();
   OSTaskDel(NULL, &err);
 }
 
 /***************************************************************************//**
  * @brief
- *    Start lwip tcp/ip stack & related tasks
+ *    Start lwip tcp/ip stack & related tasks. The network interfaces are
+ *    added by lwip_netif_start().
  *
  * @param[in]
  *
@@ -640,6 +1006,12 @@ void lwip_init_start(void)
 {
   RTOS_ERR err;
 
+  OSSemCreate(&wfx_cli_lwip_netif_sem, "lwip netif sem", 0, &err);
+  APP_RTOS_ASSERT_DBG((RTOS_ERR_CODE_GET(err) == RTOS_ERR_NONE), 1);
+
+  OSSemCreate(&wfx_cli_lwip_netif_up_sem, "lwip netif up sem", 0, &err);
+  APP_RTOS_ASSERT_DBG((RTOS_ERR_CODE_GET(err) == RTOS_ERR_NONE), 1);
+
   /* Create lwip initialization task */
   OSTaskCreate(&wfx_cli_lwip_task_tcb,
                "lwip start task",
@@ -659,3 +1031,28 @@ void lwip_init_start(void)
   APP_RTOS_ASSERT_DBG((RTOS_ERR_CODE_GET(err) == RTOS_ERR_NONE), 1);
 }
 
+/***************************************************************************//**
+ * @brief
+ *    Add the network interfaces, once the WF200 firmware is booted & the
+ *    parameters are restored. Returns once they are added.
+ *
+ * @param[in]
+ *
+ * @param[out] None
+ *
+ * @return  None
+ ******************************************************************************/
+void lwip_netif_start(void)
+{
+  RTOS_ERR err;
+
+  OSSemPost(&wfx_cli_lwip_netif_sem, OS_OPT_POST_1, &err);
+  APP_RTOS_ASSERT_DBG((RTOS_ERR_CODE_GET(err) == RTOS_ERR_NONE), 1);
+
+  /* Return once the interfaces are added */
+  OSSemPend(&wfx_cli_lwip_netif_up_sem,
+            0,
+            OS_OPT_PEND_BLOCKING,
+            NULL,
+            &err);
+}
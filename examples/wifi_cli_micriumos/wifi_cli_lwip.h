@@ -28,17 +28,24 @@
 #include "lwip/inet_chksum.h"
 #include "lwip/ip.h"
 #include "lwiperf.h"
+#include "lwiperf3.h"
+#include "wifi_cli_histogram.h"
 
 #define IPERF_DEFAULT_DURATION_SEC          10
 #define IPERF_DEFAULT_PORT                  5001
+#define IPERF3_DEFAULT_PORT                 LWIPERF3_TCP_PORT_DEFAULT
 
 #define IPERF_CLIENT_MODE                   0
 #define IPERF_SERVER_MODE                   1
 
 #define PING_DEFAULT_REQ_NB                 3
-#define PING_DEFAULT_INTERVAL_SEC           1
-#define PING_DEFAULT_RCV_TMO_SEC            1
+#define PING_DEFAULT_INTERVAL_MS            1000
+#define PING_DEFAULT_RCV_TMO_MS             1000
 #define PING_DEFAULT_DATA_SIZE              32
+#define PING_MAX_DATA_SIZE                  1472        /*!< 1500-byte MTU */
+#define PING_MAX_OUTSTANDING                16          /*!< Requests awaiting a reply */
+#define PING_TIMER_PERIOD_MS                10          /*!< Engine scheduling period */
+#define PING_MAX_WAIT_MS                    3600000     /*!< Progress check period */
 
 #ifndef PING_ID
 #define PING_ID                             0xAFAF      /*!< LSB = MSB */
@@ -48,6 +55,15 @@
 extern "C" {
 #endif
 
+/* Ping command parameters */
+typedef struct {
+  uint32_t count;           /*!< Number of echo requests */
+  uint32_t interval_ms;     /*!< Time between requests, 0 for flood mode */
+  uint32_t timeout_ms;      /*!< Time after which a request is lost */
+  uint16_t data_size;       /*!< Echo payload size in bytes */
+  bool print_buckets;       /*!< Print the raw RTT histogram at the end */
+} ping_params_t;
+
 /**************************************************************************//**
  * @brief: Set station link status to up.
  *****************************************************************************/
@@ -72,7 +88,7 @@ sl_status_t set_ap_link_down(void);
  * @brief: Implementation of ping command.
  *
  * @param[in]
- *         + req_num: Number of request messages (ICMP)
+ *         + params: Number, interval, timeout and size of the requests (ICMP)
  *         + ip_str: Remote IP's address
  *
  * @param[out]  None
@@ -81,12 +97,16 @@ sl_status_t set_ap_link_down(void);
  *        SL_STATUS_OK if success
  *        SL_STATUS_FAIL if error
  *****************************************************************************/
-sl_status_t ping_cmd(uint32_t req_num, char *ip_str);
+sl_status_t ping_cmd(const ping_params_t *params, char *ip_str);
 
 /**************************************************************************//**
  * @brief: Start iperf server mode.
+ *
+ * @param[in]
+ *         + use_iperf3: serve iperf3 clients instead of iperf2 ones
+ *         + tcp_sampling: print the TCP internals of the tests every second
  *****************************************************************************/
-void iperf_server(void);
+void iperf_server(bool use_iperf3, bool tcp_sampling);
 
 /**************************************************************************//**
  * @brief: Start iperf client mode.
@@ -94,8 +114,13 @@ void iperf_server(void);
  * @param[in]
  *         + ip_str: IP address string of remote iperf server
  *         + duration: duration in seconds
+ *         + amount_bytes: number of bytes to transmit (0: time-limited test)
+ *         + buffer_len: length of each write in bytes (0: TCP MSS)
  *         + remote_port: Port of remote iperf server
+ *         + use_iperf3: use the iperf3 protocol instead of the iperf2 one
+ *         + reverse: let the iperf3 server send the data
  *         + is_foreground_mode: enable/disable foreground mode
+ *         + tcp_sampling: print the TCP internals of the test every second
  *
  * @param[out] None
  *
@@ -103,8 +128,13 @@ void iperf_server(void);
  *****************************************************************************/
 void iperf_client(char *ip_str,
                   uint32_t duration,
+                  uint32_t amount_bytes,
+                  uint32_t buffer_len,
                   uint32_t remote_port,
-                  bool is_foreground_mode);
+                  bool use_iperf3,
+                  bool reverse,
+                  bool is_foreground_mode,
+                  bool tcp_sampling);
 
 /**************************************************************************//**
  * @brief: Stop iperf server mode.
@@ -117,10 +147,16 @@ void stop_iperf_server(void);
 void stop_iperf_client(void);
 
 /**************************************************************************//**
- * @brief: Start lwip-related tasks.
+ * @brief: Start lwip-related tasks. The tcpip thread doesn't need the WF200.
  *****************************************************************************/
 void lwip_init_start(void);
 
+/**************************************************************************//**
+ * @brief: Add the network interfaces & start the DHCP client if used. To call
+ *         once the WF200 is booted & the parameters are restored.
+ *****************************************************************************/
+void lwip_netif_start(void);
+
 #ifdef __cplusplus
 }
 #endif
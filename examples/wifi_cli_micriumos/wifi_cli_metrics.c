@@ -0,0 +1,1018 @@
+/***************************************************************************//**
+ * @file
+ * @brief Metrics snapshot for the HTTP server & the CLI
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <string.h>
+#include <limits.h>
+#include <kernel/include/os.h>
+#include "em_core.h"
+#include "sl_sleeptimer.h"
+#include "lwip/tcpip.h"
+#include "lwip/stats.h"
+#include "lwip/memp.h"
+#include "lwip/priv/memp_priv.h"
+#include "lwip/dhcp.h"
+#include "lwip/apps/fs.h"
+#include "dhcp_server.h"
+#include "ethernetif.h"
+#include "sl_wfx_host.h"
+#include "app_wifi_events.h"
+#include "wifi_cli_params.h"
+#include "wifi_cli_ap_clients.h"
+#include "wifi_cli_boot.h"
+#include "wifi_cli_cpu.h"
+#include "wifi_cli_ram.h"
+#include "wifi_cli_metrics.h"
+
+/* Metric types */
+#define METRICS_COUNTER   0
+#define METRICS_GAUGE     1
+
+/* Sample of a metric family */
+typedef struct {
+  const char *label;      ///< Label value, NULL for an unlabeled family
+  char label_buf[18];     ///< Storage of a formatted label value
+  uint32_t value;
+  bool is_signed;
+} metrics_sample_t;
+
+/**************************************************************************//**
+ * @brief: Get a sample of a family.
+ *
+ * @return true if the sample exists, false past the last sample.
+ *****************************************************************************/
+typedef bool (*metrics_get_fn_t)(metrics_stream_t *stream,
+                                 uint32_t arg,
+                                 uint32_t index,
+                                 metrics_sample_t *sample);
+
+/* Metric family: samples sharing a name, told apart by one label */
+typedef struct {
+  const char *name;
+  const char *help;
+  const char *label;      ///< Label name, NULL for a single sample
+  metrics_get_fn_t get;
+  uint16_t arg;           ///< Getter argument (field, interface...)
+  uint8_t type;
+  uint8_t decimals;       ///< Fixed-point value
+} metrics_family_t;
+
+/* Field arguments of the getters */
+enum {
+  METRICS_FIELD_USED,
+  METRICS_FIELD_MAX,
+  METRICS_FIELD_ERR,
+  METRICS_FIELD_SIZE,
+  METRICS_FIELD_XMIT,
+  METRICS_FIELD_RECV,
+  METRICS_FIELD_DROP,
+  METRICS_FIELD_CHKERR,
+  METRICS_FIELD_MEMERR,
+  METRICS_FIELD_PROTERR,
+  METRICS_FIELD_USAGE,
+  METRICS_FIELD_CTX_SW,
+};
+
+/* Pool element of a snapshot: its task values are kept out of the stream
+   state, which metrics_read() saves before each sample */
+typedef struct {
+  metrics_stream_t stream;
+  metrics_tasks_t tasks;
+} metrics_stream_elem_t;
+
+/* Snapshots being read, by the HTTP server & the CLI */
+LWIP_MEMPOOL_DECLARE(METRICS_STREAM, METRICS_MAX_STREAMS, sizeof(metrics_stream_elem_t), "METRICS_STREAM")
+
+/* Scratch storage of the getters, only used with the tcpip core lock */
+static ap_client_stats_t metrics_clients[SL_WFX_CLI_MAX_CLIENTS];
+
+/* Station RSSI, refreshed by the Wi-Fi events task: the WF200 request can't
+   be issued by the tcpip thread */
+static struct {
+  uint32_t time_ms;       ///< Last refresh
+  int16_t rssi;           ///< dBm
+  bool valid;
+} metrics_sta_rssi;
+
+#if LWIP_STATS
+/* lwIP protocol counters, NULL-terminated */
+static const struct {
+  const char *name;
+  const struct stats_proto *stats;
+} metrics_protos[] = {
+#if LINK_STATS
+  { "link", &lwip_stats.link },
+#endif
+#if ETHARP_STATS
+  { "etharp", &lwip_stats.etharp },
+#endif
+#if IP_STATS
+  { "ip", &lwip_stats.ip },
+#endif
+#if ICMP_STATS
+  { "icmp", &lwip_stats.icmp },
+#endif
+#if UDP_STATS
+  { "udp", &lwip_stats.udp },
+#endif
+#if TCP_STATS
+  { "tcp", &lwip_stats.tcp },
+#endif
+  { NULL, NULL },
+};
+#endif
+
+/* Label values of the interfaces, indexed by sl_wfx_interface_t */
+static const char *const metrics_interfaces[ETHERNETIF_NB_INTERFACES] = {
+  "sta", "ap"
+};
+
+/***************************************************************************//**
+ * @brief
+ *    Getters of the metric families: each one returns the index-th sample
+ ******************************************************************************/
+static bool metrics_get_uptime(metrics_stream_t *stream,
+                               uint32_t arg,
+                               uint32_t index,
+                               metrics_sample_t *sample)
+{
+  (void)stream;
+  (void)arg;
+
+  if (index > 0) {
+      return false;
+  }
+  sample->value = (uint32_t)(sl_sleeptimer_get_tick_count64()
+                             / sl_sleeptimer_get_timer_frequency());
+  return true;
+}
+
+static bool metrics_get_cpu(metrics_stream_t *stream,
+                            uint32_t arg,
+                            uint32_t index,
+                            metrics_sample_t *sample)
+{
+  int32_t usage = cpu_get_usage();
+
+  (void)stream;
+  (void)arg;
+
+  if ((index > 0) || (usage < 0)) {
+      return false;
+  }
+  sample->value = (uint32_t)usage;
+  return true;
+}
+
+static bool metrics_get_task_cpu(metrics_stream_t *stream,
+                                 uint32_t arg,
+                                 uint32_t index,
+                                 metrics_sample_t *sample)
+{
+  const metrics_tasks_t *tasks = stream->tasks;
+  const cpu_task_counters_t *task;
+
+  if ((tasks->nb_tasks < 0) || (index >= (uint32_t)tasks->nb_tasks)) {
+      return false;
+  }
+  task = &tasks->tasks[index];
+  sample->label = (task->name != NULL) ? task->name : "?";
+  sample->value = (arg == METRICS_FIELD_USAGE) ? task->usage : task->ctx_switches;
+  return true;
+}
+
+static bool metrics_get_task_stack(metrics_stream_t *stream,
+                                   uint32_t arg,
+                                   uint32_t index,
+                                   metrics_sample_t *sample)
+{
+  const metrics_tasks_t *tasks = stream->tasks;
+  const ram_task_stack_t *stack;
+
+  if (index >= tasks->nb_stacks) {
+      return false;
+  }
+  stack = &tasks->stacks[index];
+  sample->label = (stack->name != NULL) ? stack->name : "?";
+  sample->value = (arg == METRICS_FIELD_USED) ? stack->used : stack->size;
+  return true;
+}
+
+static bool metrics_get_heap(metrics_stream_t *stream,
+                             uint32_t arg,
+                             uint32_t index,
+                             metrics_sample_t *sample)
+{
+  (void)stream;
+
+  if (index > 0) {
+      return false;
+  }
+  switch (arg) {
+    case METRICS_FIELD_SIZE:
+      sample->value = MEM_SIZE;
+      return true;
+#if MEM_STATS
+    case METRICS_FIELD_USED:
+      sample->value = (uint32_t)lwip_stats.mem.used;
+      return true;
+    case METRICS_FIELD_MAX:
+      sample->value = (uint32_t)lwip_stats.mem.max;
+      return true;
+    case METRICS_FIELD_ERR:
+      sample->value = (uint32_t)lwip_stats.mem.err;
+      return true;
+#endif
+    default:
+      return false;
+  }
+}
+
+static bool metrics_get_pool(metrics_stream_t *stream,
+                             uint32_t arg,
+                             uint32_t index,
+                             metrics_sample_t *sample)
+{
+  (void)stream;
+
+  if (index >= MEMP_MAX) {
+      return false;
+  }
+#if MEMP_STATS
+  sample->label = lwip_stats.memp[index]->name;
+  switch (arg) {
+    case METRICS_FIELD_SIZE:
+      sample->value = memp_pools[index]->num;
+      return true;
+    case METRICS_FIELD_USED:
+      sample->value = (uint32_t)lwip_stats.memp[index]->used;
+      return true;
+    case METRICS_FIELD_MAX:
+      sample->value = (uint32_t)lwip_stats.memp[index]->max;
+      return true;
+    case METRICS_FIELD_ERR:
+      sample->value = (uint32_t)lwip_stats.memp[index]->err;
+      return true;
+    default:
+      return false;
+  }
+#else
+  (void)arg;
+  (void)sample;
+  return false;
+#endif
+}
+
+static bool metrics_get_proto(metrics_stream_t *stream,
+                              uint32_t arg,
+                              uint32_t index,
+                              metrics_sample_t *sample)
+{
+  (void)stream;
+
+#if LWIP_STATS
+  const struct stats_proto *proto;
+
+  if (index >= sizeof(metrics_protos) / sizeof(metrics_protos[0]) - 1) {
+      return false;
+  }
+  proto = metrics_protos[index].stats;
+  sample->label = metrics_protos[index].name;
+  switch (arg) {
+    case METRICS_FIELD_XMIT:
+      sample->value = proto->xmit;
+      return true;
+    case METRICS_FIELD_RECV:
+      sample->value = proto->recv;
+      return true;
+    case METRICS_FIELD_DROP:
+      sample->value = proto->drop;
+      return true;
+    case METRICS_FIELD_CHKERR:
+      sample->value = proto->chkerr;
+      return true;
+    case METRICS_FIELD_MEMERR:
+      sample->value = proto->memerr;
+      return true;
+    case METRICS_FIELD_PROTERR:
+      sample->value = proto->proterr;
+      return true;
+    default:
+      return false;
+  }
+#else
+  (void)arg;
+  (void)index;
+  (void)sample;
+  return false;
+#endif
+}
+
+static bool metrics_get_netif(metrics_stream_t *stream,
+                              uint32_t arg,
+                              uint32_t index,
+                              metrics_sample_t *sample)
+{
+  ethernetif_stats_t stats;
+
+  (void)stream;
+
+  if (index >= ETHERNETIF_NB_INTERFACES) {
+      return false;
+  }
+  ethernetif_get_stats((uint8_t)index, &stats);
+  sample->label = metrics_interfaces[index];
+  sample->value = *(const uint32_t *)((const uint8_t *)&stats + arg);
+  return true;
+}
+
+static bool metrics_get_netif_up(metrics_stream_t *stream,
+                                 uint32_t arg,
+                                 uint32_t index,
+                                 metrics_sample_t *sample)
+{
+  struct netif *netif = (index == 0) ? &sta_netif : &ap_netif;
+
+  (void)stream;
+  (void)arg;
+
+  if (index >= ETHERNETIF_NB_INTERFACES) {
+      return false;
+  }
+  sample->label = metrics_interfaces[index];
+  sample->value = (netif_is_up(netif) && netif_is_link_up(netif)) ? 1 : 0;
+  return true;
+}
+
+static bool metrics_get_tx_queue(metrics_stream_t *stream,
+                                 uint32_t arg,
+                                 uint32_t index,
+                                 metrics_sample_t *sample)
+{
+  (void)stream;
+  (void)arg;
+
+  if (index > 0) {
+      return false;
+  }
+  sample->value = ethernetif_get_tx_queue_depth();
+  return true;
+}
+
+static bool metrics_get_dhcp(metrics_stream_t *stream,
+                             uint32_t arg,
+                             uint32_t index,
+                             metrics_sample_t *sample)
+{
+  uint8_t i;
+  struct eth_addr mac;
+  static const struct eth_addr no_mac = {{ 0, 0, 0, 0, 0, 0 }};
+
+  (void)stream;
+
+  if (index > 0) {
+      return false;
+  }
+  if (arg == 0) {
+#if LWIP_DHCP
+      sample->value = dhcp_supplied_address(&sta_netif) ? 1 : 0;
+#else
+      sample->value = 0;
+#endif
+  } else {
+      sample->value = 0;
+      for (i = 0; dhcpserver_is_started() && (i < DHCPS_MAX_CLIENT); i++) {
+          dhcpserver_get_mac(i, &mac);
+          if (memcmp(&mac, &no_mac, sizeof(mac)) != 0) {
+              sample->value++;
+          }
+      }
+  }
+  return true;
+}
+
+static bool metrics_get_wifi(metrics_stream_t *stream,
+                             uint32_t arg,
+                             uint32_t index,
+                             metrics_sample_t *sample)
+{
+  (void)stream;
+
+  if (index > 0) {
+      return false;
+  }
+  switch (arg) {
+    case 0:
+      sample->value = (wifi.state & SL_WFX_STA_INTERFACE_CONNECTED) ? 1 : 0;
+      break;
+    case 1:
+      sample->value = (wifi.state & SL_WFX_AP_INTERFACE_UP) ? 1 : 0;
+      break;
+    default:
+      sample->value = scan_count_web;
+      break;
+  }
+  return true;
+}
+
+static bool metrics_get_sta_rssi(metrics_stream_t *stream,
+                                 uint32_t arg,
+                                 uint32_t index,
+                                 metrics_sample_t *sample)
+{
+  (void)arg;
+
+  if ((index > 0) || !stream->sta_rssi_valid) {
+      return false;
+  }
+  sample->value = (uint32_t)(int32_t)stream->sta_rssi;
+  sample->is_signed = true;
+  return true;
+}
+
+static bool metrics_get_ap_client(metrics_stream_t *stream,
+                                  uint32_t arg,
+                                  uint32_t index,
+                                  metrics_sample_t *sample)
+{
+  uint32_t i, nb_clients;
+  ap_client_stats_t *client = NULL;
+
+  (void)stream;
+
+  /* Connected clients, with a measured RSSI for the RSSI family */
+  nb_clients = ap_clients_get_all(metrics_clients, SL_WFX_CLI_MAX_CLIENTS);
+  for (i = 0; i < nb_clients; i++) {
+      if (!metrics_clients[i].connected
+          || ((arg == 0)
+              && (metrics_clients[i].last_rssi == AP_CLIENT_RSSI_UNKNOWN))) {
+          continue;
+      }
+      if (index-- == 0) {
+          client = &metrics_clients[i];
+          break;
+      }
+  }
+  if (client == NULL) {
+      return false;
+  }
+
+  snprintf(sample->label_buf, sizeof(sample->label_buf),
+           "%02X:%02X:%02X:%02X:%02X:%02X",
+           client->mac[0], client->mac[1], client->mac[2],
+           client->mac[3], client->mac[4], client->mac[5]);
+  sample->label = sample->label_buf;
+  if (arg == 0) {
+      sample->value = (uint32_t)(int32_t)client->last_rssi;
+      sample->is_signed = true;
+  } else {
+      sample->value = client->tx_bytes;
+  }
+  return true;
+}
+
+/* Exported metrics, in output order */
+static const metrics_family_t metrics_families[] = {
+  { "wfx_uptime_seconds", "Time since boot", NULL,
+    metrics_get_uptime, 0, METRICS_COUNTER, 0 },
+  { "wfx_cpu_usage_percent", "Total CPU usage", NULL,
+    metrics_get_cpu, 0, METRICS_GAUGE, 2 },
+  { "wfx_task_cpu_usage_percent", "CPU usage of a task", "task",
+    metrics_get_task_cpu, METRICS_FIELD_USAGE, METRICS_GAUGE, 2 },
+  { "wfx_task_context_switches_total", "Times a task was switched in", "task",
+    metrics_get_task_cpu, METRICS_FIELD_CTX_SW, METRICS_COUNTER, 0 },
+  { "wfx_task_stack_used_bytes", "Stack high-water mark of a task", "task",
+    metrics_get_task_stack, METRICS_FIELD_USED, METRICS_GAUGE, 0 },
+  { "wfx_task_stack_size_bytes", "Stack size of a task", "task",
+    metrics_get_task_stack, METRICS_FIELD_SIZE, METRICS_GAUGE, 0 },
+  { "wfx_lwip_heap_size_bytes", "lwIP heap size", NULL,
+    metrics_get_heap, METRICS_FIELD_SIZE, METRICS_GAUGE, 0 },
+  { "wfx_lwip_heap_used_bytes", "lwIP heap in use", NULL,
+    metrics_get_heap, METRICS_FIELD_USED, METRICS_GAUGE, 0 },
+  { "wfx_lwip_heap_peak_bytes", "lwIP heap peak usage", NULL,
+    metrics_get_heap, METRICS_FIELD_MAX, METRICS_GAUGE, 0 },
+  { "wfx_lwip_heap_errors_total", "lwIP heap allocation failures", NULL,
+    metrics_get_heap, METRICS_FIELD_ERR, METRICS_COUNTER, 0 },
+  { "wfx_lwip_pool_size", "lwIP pool elements", "pool",
+    metrics_get_pool, METRICS_FIELD_SIZE, METRICS_GAUGE, 0 },
+  { "wfx_lwip_pool_used", "lwIP pool elements in use", "pool",
+    metrics_get_pool, METRICS_FIELD_USED, METRICS_GAUGE, 0 },
+  { "wfx_lwip_pool_peak", "lwIP pool peak usage", "pool",
+    metrics_get_pool, METRICS_FIELD_MAX, METRICS_GAUGE, 0 },
+  { "wfx_lwip_pool_errors_total", "lwIP pool allocation failures", "pool",
+    metrics_get_pool, METRICS_FIELD_ERR, METRICS_COUNTER, 0 },
+  { "wfx_lwip_xmit_total", "Packets sent by a protocol", "proto",
+    metrics_get_proto, METRICS_FIELD_XMIT, METRICS_COUNTER, 0 },
+  { "wfx_lwip_recv_total", "Packets received by a protocol", "proto",
+    metrics_get_proto, METRICS_FIELD_RECV, METRICS_COUNTER, 0 },
+  { "wfx_lwip_drop_total", "Packets dropped by a protocol", "proto",
+    metrics_get_proto, METRICS_FIELD_DROP, METRICS_COUNTER, 0 },
+  { "wfx_lwip_chkerr_total", "Checksum errors of a protocol", "proto",
+    metrics_get_proto, METRICS_FIELD_CHKERR, METRICS_COUNTER, 0 },
+  { "wfx_lwip_memerr_total", "Out of memory errors of a protocol", "proto",
+    metrics_get_proto, METRICS_FIELD_MEMERR, METRICS_COUNTER, 0 },
+  { "wfx_lwip_proterr_total", "Protocol errors", "proto",
+    metrics_get_proto, METRICS_FIELD_PROTERR, METRICS_COUNTER, 0 },
+  { "wfx_netif_up", "Interface up with its link up", "interface",
+    metrics_get_netif_up, 0, METRICS_GAUGE, 0 },
+  { "wfx_netif_rx_frames_total", "Frames received", "interface",
+    metrics_get_netif, offsetof(ethernetif_stats_t, rx_frames), METRICS_COUNTER, 0 },
+  { "wfx_netif_rx_bytes_total", "Bytes received", "interface",
+    metrics_get_netif, offsetof(ethernetif_stats_t, rx_bytes), METRICS_COUNTER, 0 },
+  { "wfx_netif_rx_drops_total", "Received frames dropped", "interface",
+    metrics_get_netif, offsetof(ethernetif_stats_t, rx_drops), METRICS_COUNTER, 0 },
+  { "wfx_netif_tx_frames_total", "Frames sent", "interface",
+    metrics_get_netif, offsetof(ethernetif_stats_t, tx_frames), METRICS_COUNTER, 0 },
+  { "wfx_netif_tx_bytes_total", "Bytes sent", "interface",
+    metrics_get_netif, offsetof(ethernetif_stats_t, tx_bytes), METRICS_COUNTER, 0 },
+  { "wfx_netif_tx_drops_total", "Frames dropped for lack of WF200 buffer", "interface",
+    metrics_get_netif, offsetof(ethernetif_stats_t, tx_drops), METRICS_COUNTER, 0 },
+  { "wfx_tx_queue_depth", "Frames waiting for the bus task", NULL,
+    metrics_get_tx_queue, 0, METRICS_GAUGE, 0 },
+  { "wfx_dhcp_client_bound", "Station address obtained by DHCP", NULL,
+    metrics_get_dhcp, 0, METRICS_GAUGE, 0 },
+  { "wfx_dhcp_server_leases", "Addresses leased by the SoftAP DHCP server", NULL,
+    metrics_get_dhcp, 1, METRICS_GAUGE, 0 },
+  { "wfx_station_connected", "Station connected to an access point", NULL,
+    metrics_get_wifi, 0, METRICS_GAUGE, 0 },
+  { "wfx_station_rssi_dbm", "Station RSSI", NULL,
+    metrics_get_sta_rssi, 0, METRICS_GAUGE, 0 },
+  { "wfx_softap_up", "SoftAP started", NULL,
+    metrics_get_wifi, 1, METRICS_GAUGE, 0 },
+  { "wfx_softap_client_rssi_dbm", "Last RSSI measured for a SoftAP client", "client",
+    metrics_get_ap_client, 0, METRICS_GAUGE, 0 },
+  { "wfx_softap_client_tx_bytes_total", "Bytes sent to a SoftAP client", "client",
+    metrics_get_ap_client, 1, METRICS_COUNTER, 0 },
+  { "wfx_scan_results", "Access points found by the last scan", NULL,
+    metrics_get_wifi, 2, METRICS_GAUGE, 0 },
+};
+
+#define METRICS_NB_FAMILIES (sizeof(metrics_families) / sizeof(metrics_families[0]))
+
+/***************************************************************************//**
+ * @brief
+ *    This function appends formatted text to the reader buffer, the overflow
+ *    flag is set if it doesn't fit
+ *
+ * @param[in]
+ *    + stream: The snapshot
+ *    + format: The printf format
+ *
+ * @param[out] None
+ *
+ * @return  None
+ ******************************************************************************/
+static void metrics_printf(metrics_stream_t *stream, const char *format, ...)
+{
+  va_list args;
+  int len;
+  uint32_t room = stream->out.size - stream->out.len;
+
+  if (stream->overflow) {
+      return;
+  }
+  va_start(args, format);
+  len = vsnprintf(&stream->out.buf[stream->out.len], room, format, args);
+  va_end(args);
+
+  /* The NULL terminator must fit too */
+  if ((len < 0) || ((uint32_t)len >= room)) {
+      stream->overflow = true;
+  } else {
+      stream->out.len += len;
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function formats a sample value
+ *
+ * @param[in]
+ *    + sample: The sample
+ *    + decimals: The fixed-point decimals, 0 to 2
+ *    + size: The output size
+ *
+ * @param[out]
+ *    + num: The formatted value
+ *
+ * @return  None
+ ******************************************************************************/
+static void metrics_format_value(const metrics_sample_t *sample,
+                                 uint8_t decimals,
+                                 char *num,
+                                 uint32_t size)
+{
+  uint32_t value = sample->value;
+  const char *sign = "";
+
+  if (sample->is_signed && ((int32_t)value < 0)) {
+      sign = "-";
+      value = (uint32_t)(-(int32_t)value);
+  }
+  if (decimals == 0) {
+      snprintf(num, size, "%s%lu", sign, (unsigned long)value);
+  } else {
+      snprintf(num, size, "%s%lu.%0*lu", sign,
+               (unsigned long)(value / ((decimals == 1) ? 10 : 100)),
+               (int)decimals,
+               (unsigned long)(value % ((decimals == 1) ? 10 : 100)));
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function renders the next step of a snapshot: the next sample of
+ *    the current family, or the family header before the first one
+ *
+ * @param[in]
+ *    + stream: The snapshot
+ *
+ * @param[out] None
+ *
+ * @return  false once the snapshot is complete, true otherwise
+ ******************************************************************************/
+static bool metrics_step(metrics_stream_t *stream)
+{
+  const metrics_family_t *family;
+  metrics_sample_t sample;
+  char num[16];
+
+  if (!stream->started) {
+      stream->started = true;
+      if (stream->format == METRICS_FORMAT_JSON) {
+          json_begin_object(&stream->json);
+      }
+      return true;
+  }
+
+  if (stream->family >= METRICS_NB_FAMILIES) {
+      if (stream->format == METRICS_FORMAT_JSON) {
+          json_end_object(&stream->json);
+          json_writer_flush(&stream->json);
+      }
+      return false;
+  }
+
+  family = &metrics_families[stream->family];
+  memset(&sample, 0, sizeof(sample));
+  if (!family->get(stream, family->arg, stream->sample, &sample)) {
+      /* Past the last sample: close the family */
+      if ((stream->format == METRICS_FORMAT_JSON)
+          && (family->label != NULL) && (stream->sample > 0)) {
+          json_end_object(&stream->json);
+      }
+      stream->family++;
+      stream->sample = 0;
+      stream->header_sent = false;
+      return true;
+  }
+  metrics_format_value(&sample, family->decimals, num, sizeof(num));
+
+  if (stream->format == METRICS_FORMAT_JSON) {
+      if (stream->sample == 0) {
+          json_key(&stream->json, family->name);
+          if (family->label != NULL) {
+              json_begin_object(&stream->json);
+          }
+      }
+      if (family->label != NULL) {
+          json_key(&stream->json, sample.label);
+      }
+      json_number(&stream->json, num);
+      json_writer_flush(&stream->json);
+  } else {
+      if ((stream->sample == 0) && !stream->header_sent) {
+          /* A step of its own: the sample is fetched again by the next one */
+          metrics_printf(stream, "# HELP %s %s\n# TYPE %s %s\n",
+                         family->name, family->help, family->name,
+                         (family->type == METRICS_COUNTER) ? "counter" : "gauge");
+          stream->header_sent = true;
+          return true;
+      }
+      if (family->label != NULL) {
+          metrics_printf(stream, "%s{%s=\"%s\"} %s\n",
+                         family->name, family->label, sample.label, num);
+      } else {
+          metrics_printf(stream, "%s %s\n", family->name, num);
+      }
+  }
+
+  /* Unlabeled families have a single sample */
+  if (family->label == NULL) {
+      stream->family++;
+      stream->sample = 0;
+      stream->header_sent = false;
+  } else {
+      stream->sample++;
+  }
+  return true;
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function initializes the snapshot pool, before the HTTP server
+ *    starts
+ *
+ * @param[in] None
+ *
+ * @param[out] None
+ *
+ * @return  None
+ ******************************************************************************/
+void metrics_init(void)
+{
+  LWIP_MEMPOOL_INIT(METRICS_STREAM);
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function refreshes the station RSSI served by the snapshots. The
+ *    WF200 request blocks until its confirmation, so it is issued by the Wi-Fi
+ *    events task rather than by the tcpip thread opening a snapshot.
+ *
+ * @param[in] None
+ *
+ * @param[out] None
+ *
+ * @return
+ *    The time until the next refresh in OS ticks
+ *    0 if the station is not connected
+ ******************************************************************************/
+uint32_t metrics_refresh_rssi(void)
+{
+  uint32_t rcpi, now, elapsed, ticks;
+  sl_status_t status;
+  CORE_DECLARE_IRQ_STATE;
+
+  if (!(wifi.state & SL_WFX_STA_INTERFACE_CONNECTED)) {
+      metrics_sta_rssi.valid = false;
+      return 0;
+  }
+
+  now = (uint32_t)((sl_sleeptimer_get_tick_count64() * 1000ULL)
+                   / sl_sleeptimer_get_timer_frequency());
+  elapsed = now - metrics_sta_rssi.time_ms;
+  if (!metrics_sta_rssi.valid || (elapsed >= METRICS_RSSI_PERIOD_MS)) {
+      wifi_cli_wfx_lock();
+      status = sl_wfx_get_signal_strength(&rcpi);
+      wifi_cli_wfx_unlock();
+      if (status == SL_STATUS_OK) {
+          CORE_ENTER_ATOMIC();
+          metrics_sta_rssi.rssi = (int16_t)(((int32_t)rcpi - 220) / 2);
+          metrics_sta_rssi.valid = true;
+          CORE_EXIT_ATOMIC();
+      }
+      /* Retry after a period on failure as well */
+      metrics_sta_rssi.time_ms = now;
+      elapsed = 0;
+  }
+
+  ticks = ((METRICS_RSSI_PERIOD_MS - elapsed) * OSCfg_TickRate_Hz + 999u) / 1000u;
+  return (ticks > 0) ? ticks : 1;
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function opens a snapshot. The task listings are read once here, so
+ *    a sample costs no kernel walk and all the task families agree. The
+ *    station RSSI is the last one refreshed by the Wi-Fi events task.
+ *
+ * @param[in]
+ *    + format: METRICS_FORMAT_TEXT or METRICS_FORMAT_JSON
+ *
+ * @param[out] None
+ *
+ * @return
+ *    The snapshot
+ *    NULL if METRICS_MAX_STREAMS snapshots are already open
+ ******************************************************************************/
+metrics_stream_t *metrics_open(uint8_t format)
+{
+  metrics_stream_elem_t *elem;
+  metrics_stream_t *stream;
+  CORE_DECLARE_IRQ_STATE;
+
+  elem = (metrics_stream_elem_t *)LWIP_MEMPOOL_ALLOC(METRICS_STREAM);
+  if (elem == NULL) {
+      return NULL;
+  }
+
+  stream = &elem->stream;
+  memset(stream, 0, sizeof(*stream));
+  stream->format = format;
+  stream->tasks = &elem->tasks;
+  json_writer_init(&stream->json, json_sink_buffer, &stream->out);
+
+  elem->tasks.nb_tasks = cpu_get_task_counters(elem->tasks.tasks,
+                                               CPU_PROFILE_MAX_TASKS);
+  elem->tasks.nb_stacks = ram_get_task_stacks(elem->tasks.stacks,
+                                              RAM_REPORT_MAX_TASKS);
+
+  CORE_ENTER_ATOMIC();
+  stream->sta_rssi = metrics_sta_rssi.rssi;
+  stream->sta_rssi_valid = metrics_sta_rssi.valid;
+  CORE_EXIT_ATOMIC();
+  return stream;
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function reads the next part of a snapshot. The samples are
+ *    rendered until the buffer is full: a sample that doesn't fit is rendered
+ *    again by the next read. The values are read without copies, the tcpip
+ *    core lock must be held.
+ *
+ * @param[in]
+ *    + stream: The snapshot
+ *    + len: The buffer size
+ *
+ * @param[out]
+ *    + buf: The snapshot text, not NULL-terminated
+ *
+ * @return
+ *    The number of bytes written, 0 at the end of the snapshot
+ *    -1 if the buffer can't hold a single sample
+ ******************************************************************************/
+int metrics_read(metrics_stream_t *stream, char *buf, uint32_t len)
+{
+  metrics_stream_t saved;
+  bool more;
+
+  stream->out.buf = buf;
+  stream->out.size = len;
+  stream->out.len = 0;
+
+  while (!stream->done) {
+      saved = *stream;
+      more = metrics_step(stream);
+      if (stream->overflow || stream->json.error) {
+          /* Render the sample again in the next buffer */
+          *stream = saved;
+          if (stream->out.len == 0) {
+              LOG_DEBUG("Metrics buffer too small (%lu bytes)", (unsigned long)len);
+              return -1;
+          }
+          break;
+      }
+      stream->done = !more;
+  }
+  return (int)stream->out.len;
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function closes a snapshot
+ *
+ * @param[in]
+ *    + stream: The snapshot
+ *
+ * @param[out] None
+ *
+ * @return  None
+ ******************************************************************************/
+void metrics_close(metrics_stream_t *stream)
+{
+  if (stream != NULL) {
+      LWIP_MEMPOOL_FREE(METRICS_STREAM, stream);
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function writes a snapshot to the console
+ *
+ * @param[in]
+ *    + format: METRICS_FORMAT_TEXT or METRICS_FORMAT_JSON
+ *
+ * @param[out] None
+ *
+ * @return
+ *    0 if succeeded
+ *    -1 if lwIP isn't started or no snapshot is free
+ ******************************************************************************/
+int metrics_print(uint8_t format)
+{
+  char buf[128];
+  int len;
+  uint32_t time_us;
+  metrics_stream_t *stream;
+
+  /* The core lock only exists once the tcpip thread runs */
+  if (!boot_trace_get(BOOT_STAGE_TCPIP_READY, &time_us)) {
+      return -1;
+  }
+
+  stream = metrics_open(format);
+  if (stream == NULL) {
+      return -1;
+  }
+
+  do {
+      LOCK_TCPIP_CORE();
+      len = metrics_read(stream, buf, sizeof(buf));
+      UNLOCK_TCPIP_CORE();
+      if (len > 0) {
+          printf("%.*s", len, buf);
+      }
+  } while (len > 0);
+  printf("\r\n");
+
+  metrics_close(stream);
+  return (len < 0) ? -1 : 0;
+}
+
+#if LWIP_HTTPD_CUSTOM_FILES && LWIP_HTTPD_DYNAMIC_FILE_READ
+/*******************************************************************************
+ *  lwIP httpd custom files: the snapshots are read by the tcpip thread. Their
+ *  length isn't known, so they carry their own HTTP header without a
+ *  Content-Length and the connection is closed once they are complete.
+ ******************************************************************************/
+static const char *const metrics_http_headers[] = {
+  [METRICS_FORMAT_TEXT] = "HTTP/1.0 200 OK\r\n"
+                          "Server: lwIP\r\n"
+                          "Content-Type: text/plain; version=0.0.4\r\n"
+                          "Connection: close\r\n\r\n",
+  [METRICS_FORMAT_JSON] = "HTTP/1.0 200 OK\r\n"
+                          "Server: lwIP\r\n"
+                          "Content-Type: application/json\r\n"
+                          "Connection: close\r\n\r\n",
+};
+
+int fs_open_custom(struct fs_file *file, const char *name)
+{
+  metrics_stream_t *stream;
+
+  if (strcmp(name, METRICS_HTTP_PATH) == 0) {
+      stream = metrics_open(METRICS_FORMAT_TEXT);
+  } else if (strcmp(name, METRICS_HTTP_JSON_PATH) == 0) {
+      stream = metrics_open(METRICS_FORMAT_JSON);
+  } else {
+      return 0;
+  }
+
+  if (stream == NULL) {
+      return 0;
+  }
+
+  file->data = NULL;
+  /* Never reached: the end is signaled by fs_read_custom() */
+  file->len = INT_MAX;
+  file->index = 0;
+  file->flags = FS_FILE_FLAGS_HEADER_INCLUDED;
+  file->pextension = stream;
+  return 1;
+}
+
+void fs_close_custom(struct fs_file *file)
+{
+  metrics_close((metrics_stream_t *)file->pextension);
+  file->pextension = NULL;
+}
+
+int fs_read_custom(struct fs_file *file, char *buffer, int count)
+{
+  metrics_stream_t *stream = (metrics_stream_t *)file->pextension;
+  int header_len = 0;
+  int len;
+
+  if (file->index == 0) {
+      header_len = (int)strlen(metrics_http_headers[stream->format]);
+      if (header_len > count) {
+          return FS_READ_EOF;
+      }
+      memcpy(buffer, metrics_http_headers[stream->format], (size_t)header_len);
+  }
+
+  len = metrics_read(stream, buffer + header_len, (uint32_t)(count - header_len));
+  if (len < 0) {
+      /* No room left for a sample after the header: next read */
+      len = 0;
+  }
+  len += header_len;
+  if (len == 0) {
+      return FS_READ_EOF;
+  }
+
+  file->index += len;
+  if (stream->done) {
+      /* Let httpd close the connection after this part */
+      file->index = file->len;
+  }
+  return len;
+}
+#endif
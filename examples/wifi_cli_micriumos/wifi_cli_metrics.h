@@ -0,0 +1,118 @@
+/***************************************************************************//**
+ * @file
+ * @brief Metrics snapshot for the HTTP server & the CLI
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+#ifndef WIFI_CLI_METRICS_H
+#define WIFI_CLI_METRICS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "lwip/memp.h"
+#include "wifi_cli_json.h"
+#include "wifi_cli_cpu.h"
+#include "wifi_cli_ram.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define METRICS_MAX_STREAMS     2             ///< Snapshots read at once
+#define METRICS_HTTP_PATH       "/metrics"
+#define METRICS_HTTP_JSON_PATH  "/metrics/json"   ///< No extension, not parsed for SSI tags
+#define METRICS_RSSI_PERIOD_MS  5000          ///< Station RSSI refresh period
+
+/* Snapshot formats */
+#define METRICS_FORMAT_TEXT     0   ///< Prometheus text exposition format
+#define METRICS_FORMAT_JSON     1   ///< Compact JSON object
+
+/**
+ * Task values of a snapshot, read once when it is opened so that all the
+ * samples of a task family come from the same listing.
+ */
+typedef struct {
+  cpu_task_counters_t tasks[CPU_PROFILE_MAX_TASKS];
+  ram_task_stack_t stacks[RAM_REPORT_MAX_TASKS];
+  int nb_tasks;           ///< -1 without the kernel statistic task
+  uint32_t nb_stacks;
+} metrics_tasks_t;
+
+/**
+ * Snapshot being read. The metrics are rendered one sample at a time into
+ * the reader buffer, so a snapshot needs no buffer of its own.
+ */
+typedef struct {
+  json_writer_t json;
+  json_buffer_t out;      ///< Reader buffer of the current read
+  metrics_tasks_t *tasks; ///< Task values, stored after the snapshot
+  uint16_t family;        ///< Next metric family
+  uint16_t sample;        ///< Next sample of the family
+  int16_t sta_rssi;       ///< dBm, last refresh before the snapshot opened
+  uint8_t format;
+  bool sta_rssi_valid;
+  bool started;
+  bool header_sent;       ///< Text header of the current family written
+  bool done;
+  bool overflow;          ///< The current sample doesn't fit
+} metrics_stream_t;
+
+/* Pool of the snapshots, for its usage statistics */
+LWIP_MEMPOOL_PROTOTYPE(METRICS_STREAM);
+
+/**************************************************************************//**
+ * @brief: Initialize the snapshot pool (tcpip thread, before httpd).
+ *****************************************************************************/
+void metrics_init(void);
+
+/**************************************************************************//**
+ * @brief: Refresh the station RSSI served by the snapshots (Wi-Fi events
+ *         task, on each wake-up).
+ *
+ * @return the time until the next refresh in OS ticks, 0 if the station is
+ *         not connected.
+ *****************************************************************************/
+uint32_t metrics_refresh_rssi(void);
+
+/**************************************************************************//**
+ * @brief: Open a snapshot, reading the task values.
+ *
+ * @return the snapshot, NULL if METRICS_MAX_STREAMS are already open.
+ *****************************************************************************/
+metrics_stream_t *metrics_open(uint8_t format);
+
+/**************************************************************************//**
+ * @brief: Read the next part of a snapshot, tcpip core lock held.
+ *
+ * @return the number of bytes written, 0 at the end, -1 if the buffer is too
+ *         small for a single sample.
+ *****************************************************************************/
+int metrics_read(metrics_stream_t *stream, char *buf, uint32_t len);
+
+/**************************************************************************//**
+ * @brief: Close a snapshot.
+ *****************************************************************************/
+void metrics_close(metrics_stream_t *stream);
+
+/**************************************************************************//**
+ * @brief: Write a snapshot to the console.
+ *
+ * @return 0 on success, -1 if lwIP isn't started or no snapshot is free.
+ *****************************************************************************/
+int metrics_print(uint8_t format);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WIFI_CLI_METRICS_H */
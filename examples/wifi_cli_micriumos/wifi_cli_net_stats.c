@@ -0,0 +1,340 @@
+/***************************************************************************//**
+ * @file
+ * @brief lwIP statistics snapshots, deltas & rates
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "os.h"
+#include "sl_sleeptimer.h"
+#include "lwip/tcpip.h"
+#include "lwip/stats.h"
+#include "wifi_cli_boot.h"
+#include "wifi_cli_net_stats.h"
+
+static const char *const net_stats_proto_names[NET_STATS_NB_PROTOS] = {
+  "link", "etharp", "ip", "icmp", "udp", "tcp"
+};
+
+static const char *const net_stats_counter_names[NET_STATS_NB_COUNTERS] = {
+  "xmit", "recv", "fw", "drop", "chkerr", "lenerr",
+  "memerr", "rterr", "proterr", "opterr", "err"
+};
+
+/* Report storage (the report is only displayed by the CLI task) */
+static net_stats_snapshot_t net_stats_report_prev;
+static net_stats_snapshot_t net_stats_report_cur;
+static bool net_stats_report_prev_valid;
+
+/***************************************************************************//**
+ * @brief
+ *    This function returns the time base of the snapshots
+ *
+ * @param[in] None
+ *
+ * @param[out] None
+ *
+ * @return  milliseconds since boot
+ ******************************************************************************/
+static uint32_t net_stats_get_time_ms(void)
+{
+  return (uint32_t)((sl_sleeptimer_get_tick_count64() * 1000ULL)
+                    / sl_sleeptimer_get_timer_frequency());
+}
+
+#if LWIP_STATS
+/***************************************************************************//**
+ * @brief
+ *    This function copies the counters of a protocol block
+ *
+ * @param[in]
+ *    + src: The lwIP protocol block
+ *
+ * @param[out]
+ *    + dst: The snapshot counters, indexed by net_stats_counter_t
+ *
+ * @return  None
+ ******************************************************************************/
+static void net_stats_copy_proto(const struct stats_proto *src, uint32_t *dst)
+{
+  dst[NET_STATS_XMIT] = src->xmit;
+  dst[NET_STATS_RECV] = src->recv;
+  dst[NET_STATS_FW] = src->fw;
+  dst[NET_STATS_DROP] = src->drop;
+  dst[NET_STATS_CHKERR] = src->chkerr;
+  dst[NET_STATS_LENERR] = src->lenerr;
+  dst[NET_STATS_MEMERR] = src->memerr;
+  dst[NET_STATS_RTERR] = src->rterr;
+  dst[NET_STATS_PROTERR] = src->proterr;
+  dst[NET_STATS_OPTERR] = src->opterr;
+  dst[NET_STATS_ERR] = src->err;
+}
+#endif
+
+/***************************************************************************//**
+ * @brief
+ *    This function copies lwip_stats, the tcpip core lock is taken: not to
+ *    call from the tcpip thread
+ *
+ * @param[in] None
+ *
+ * @param[out]
+ *    + snap: The snapshot
+ *
+ * @return
+ *    0 if succeeded
+ *    -1 if lwIP isn't started
+ ******************************************************************************/
+int net_stats_take(net_stats_snapshot_t *snap)
+{
+  uint32_t i;
+  uint32_t time_us;
+
+  memset(snap, 0, sizeof(*snap));
+
+  /* The core lock only exists once the tcpip thread runs */
+  if (!boot_trace_get(BOOT_STAGE_TCPIP_READY, &time_us)) {
+      return -1;
+  }
+
+  LOCK_TCPIP_CORE();
+  snap->time_ms = net_stats_get_time_ms();
+#if LINK_STATS
+  net_stats_copy_proto(&lwip_stats.link, snap->proto[NET_STATS_LINK]);
+#endif
+#if ETHARP_STATS
+  net_stats_copy_proto(&lwip_stats.etharp, snap->proto[NET_STATS_ETHARP]);
+#endif
+#if IP_STATS
+  net_stats_copy_proto(&lwip_stats.ip, snap->proto[NET_STATS_IP]);
+#endif
+#if ICMP_STATS
+  net_stats_copy_proto(&lwip_stats.icmp, snap->proto[NET_STATS_ICMP]);
+#endif
+#if UDP_STATS
+  net_stats_copy_proto(&lwip_stats.udp, snap->proto[NET_STATS_UDP]);
+#endif
+#if TCP_STATS
+  net_stats_copy_proto(&lwip_stats.tcp, snap->proto[NET_STATS_TCP]);
+#endif
+#if MEM_STATS
+  snap->heap.used = lwip_stats.mem.used;
+  snap->heap.max = lwip_stats.mem.max;
+  snap->heap.err = lwip_stats.mem.err;
+#endif
+  for (i = 0; i < MEMP_MAX; i++) {
+#if MEMP_STATS
+      snap->pools[i].used = lwip_stats.memp[i]->used;
+      snap->pools[i].max = lwip_stats.memp[i]->max;
+      snap->pools[i].err = lwip_stats.memp[i]->err;
+#endif
+  }
+  UNLOCK_TCPIP_CORE();
+
+  return 0;
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function returns the increase of a counter between two snapshots.
+ *    The lwIP counters are STAT_COUNTER wide: a wrap-around between the
+ *    snapshots is accounted for.
+ *
+ * @param[in]
+ *    + prev: The previous snapshot, NULL for the boot
+ *    + cur: The current snapshot
+ *    + proto: The protocol block
+ *    + counter: The counter
+ *
+ * @param[out] None
+ *
+ * @return  The counter increase
+ ******************************************************************************/
+uint32_t net_stats_delta(const net_stats_snapshot_t *prev,
+                         const net_stats_snapshot_t *cur,
+                         net_stats_proto_t proto,
+                         net_stats_counter_t counter)
+{
+  uint32_t prev_value = (prev != NULL) ? prev->proto[proto][counter] : 0;
+
+  return (STAT_COUNTER)(cur->proto[proto][counter] - prev_value);
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function returns the rate of a counter between two snapshots
+ *
+ * @param[in]
+ *    + prev: The previous snapshot, NULL for the boot
+ *    + cur: The current snapshot
+ *    + proto: The protocol block
+ *    + counter: The counter
+ *
+ * @param[out] None
+ *
+ * @return  The rate in 0.01/s, 0 if the snapshots were taken at the same time
+ ******************************************************************************/
+uint32_t net_stats_rate(const net_stats_snapshot_t *prev,
+                        const net_stats_snapshot_t *cur,
+                        net_stats_proto_t proto,
+                        net_stats_counter_t counter)
+{
+  uint32_t elapsed_ms = cur->time_ms - ((prev != NULL) ? prev->time_ms : 0);
+
+  if (elapsed_ms == 0) {
+      return 0;
+  }
+  return (uint32_t)(((uint64_t)net_stats_delta(prev, cur, proto, counter) * 100000ULL)
+                    / elapsed_ms);
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function displays a heap or pool usage if not 0 or changed
+ *
+ * @param[in]
+ *    + name: The heap or pool name
+ *    + prev: The previous usage, NULL for the boot
+ *    + cur: The current usage
+ *
+ * @param[out] None
+ *
+ * @return  None
+ ******************************************************************************/
+static void net_stats_print_mem(const char *name,
+                                const net_stats_mem_t *prev,
+                                const net_stats_mem_t *cur)
+{
+  static const net_stats_mem_t boot = { 0, 0, 0 };
+
+  if (prev == NULL) {
+      prev = &boot;
+  }
+  if ((cur->used == 0) && (cur->max == 0) && (cur->err == 0)
+      && (memcmp(prev, cur, sizeof(*cur)) == 0)) {
+      return;
+  }
+  printf("%-16.16s %7lu %7lu %+7ld %7lu %+7ld\r\n",
+         (name != NULL) ? name : "?",
+         (unsigned long)cur->used,
+         (unsigned long)cur->max,
+         (long)(cur->max - prev->max),
+         (unsigned long)cur->err,
+         (long)(STAT_COUNTER)(cur->err - prev->err));
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function displays the non-zero counters of a snapshot, with their
+ *    increase & rate since a previous one
+ *
+ * @param[in]
+ *    + prev: The previous snapshot, NULL for the boot
+ *    + cur: The current snapshot
+ *
+ * @param[out] None
+ *
+ * @return  None
+ ******************************************************************************/
+void net_stats_print(const net_stats_snapshot_t *prev,
+                     const net_stats_snapshot_t *cur)
+{
+  uint32_t proto, counter, i;
+  uint32_t delta, rate;
+  uint32_t elapsed_ms = cur->time_ms - ((prev != NULL) ? prev->time_ms : 0);
+  bool any = false;
+
+  printf("lwIP statistics over %lu.%03lu s%s\r\n",
+         (unsigned long)(elapsed_ms / 1000),
+         (unsigned long)(elapsed_ms % 1000),
+         (prev == NULL) ? " (since boot)" : "");
+
+  printf("%-16s %10s %10s %10s\r\n", "counter", "total", "delta", "rate/s");
+  for (proto = 0; proto < NET_STATS_NB_PROTOS; proto++) {
+      for (counter = 0; counter < NET_STATS_NB_COUNTERS; counter++) {
+          delta = net_stats_delta(prev, cur, (net_stats_proto_t)proto,
+                                  (net_stats_counter_t)counter);
+          if ((cur->proto[proto][counter] == 0) && (delta == 0)) {
+              continue;
+          }
+          rate = net_stats_rate(prev, cur, (net_stats_proto_t)proto,
+                                (net_stats_counter_t)counter);
+          printf("%-6s %-9s %10lu %+10ld %7lu.%02lu\r\n",
+                 net_stats_proto_names[proto],
+                 net_stats_counter_names[counter],
+                 (unsigned long)cur->proto[proto][counter],
+                 (long)delta,
+                 (unsigned long)(rate / 100),
+                 (unsigned long)(rate % 100));
+          any = true;
+      }
+  }
+  if (!any) {
+      printf("(no packet)\r\n");
+  }
+
+  printf("%-16s %7s %7s %7s %7s %7s\r\n",
+         "memory", "used", "peak", "delta", "errors", "delta");
+  net_stats_print_mem("heap",
+                      (prev != NULL) ? &prev->heap : NULL,
+                      &cur->heap);
+#if MEMP_STATS
+  for (i = 0; i < MEMP_MAX; i++) {
+      net_stats_print_mem(lwip_stats.memp[i]->name,
+                          (prev != NULL) ? &prev->pools[i] : NULL,
+                          &cur->pools[i]);
+  }
+#else
+  (void)i;
+#endif
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function displays the counters changed since the previous report,
+ *    or over a window: the calling task then sleeps during the window
+ *
+ * @param[in]
+ *    + window_ms: The window in milliseconds, 0 for the previous report
+ *
+ * @param[out] None
+ *
+ * @return  None
+ ******************************************************************************/
+void net_stats_report_print(uint32_t window_ms)
+{
+  RTOS_ERR err;
+
+  if (window_ms > 0) {
+      if (net_stats_take(&net_stats_report_prev) < 0) {
+          printf("lwIP: not started\r\n");
+          return;
+      }
+      net_stats_report_prev_valid = true;
+      OSTimeDly((OS_TICK)((window_ms * OSCfg_TickRate_Hz + 999u) / 1000u),
+                OS_OPT_TIME_DLY,
+                &err);
+  }
+
+  if (net_stats_take(&net_stats_report_cur) < 0) {
+      printf("lwIP: not started\r\n");
+      return;
+  }
+  net_stats_print(net_stats_report_prev_valid ? &net_stats_report_prev : NULL,
+                  &net_stats_report_cur);
+
+  /* Baseline of the next report */
+  net_stats_report_prev = net_stats_report_cur;
+  net_stats_report_prev_valid = true;
+}
@@ -0,0 +1,114 @@
+/***************************************************************************//**
+ * @file
+ * @brief lwIP statistics snapshots, deltas & rates
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+#ifndef WIFI_CLI_NET_STATS_H
+#define WIFI_CLI_NET_STATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "lwip/memp.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Protocol blocks of lwip_stats */
+typedef enum {
+  NET_STATS_LINK,
+  NET_STATS_ETHARP,
+  NET_STATS_IP,
+  NET_STATS_ICMP,
+  NET_STATS_UDP,
+  NET_STATS_TCP,
+  NET_STATS_NB_PROTOS
+} net_stats_proto_t;
+
+/* Counters of a protocol block (struct stats_proto) */
+typedef enum {
+  NET_STATS_XMIT,
+  NET_STATS_RECV,
+  NET_STATS_FW,
+  NET_STATS_DROP,
+  NET_STATS_CHKERR,
+  NET_STATS_LENERR,
+  NET_STATS_MEMERR,
+  NET_STATS_RTERR,
+  NET_STATS_PROTERR,
+  NET_STATS_OPTERR,
+  NET_STATS_ERR,
+  NET_STATS_NB_COUNTERS
+} net_stats_counter_t;
+
+/* Heap or pool usage */
+typedef struct {
+  uint32_t used;
+  uint32_t max;           ///< Peak usage
+  uint32_t err;           ///< Allocation failures
+} net_stats_mem_t;
+
+/**
+ * Copy of lwip_stats at a given time. The counters of the blocks disabled in
+ * lwipopts.h stay at 0.
+ */
+typedef struct {
+  uint32_t time_ms;
+  uint32_t proto[NET_STATS_NB_PROTOS][NET_STATS_NB_COUNTERS];
+  net_stats_mem_t heap;
+  net_stats_mem_t pools[MEMP_MAX];
+} net_stats_snapshot_t;
+
+/**************************************************************************//**
+ * @brief: Copy lwip_stats, under the tcpip core lock.
+ *
+ * @return 0 on success, -1 if lwIP isn't started.
+ *****************************************************************************/
+int net_stats_take(net_stats_snapshot_t *snap);
+
+/**************************************************************************//**
+ * @brief: Get the increase of a counter between two snapshots, counter
+ *         wrap-around included.
+ *****************************************************************************/
+uint32_t net_stats_delta(const net_stats_snapshot_t *prev,
+                         const net_stats_snapshot_t *cur,
+                         net_stats_proto_t proto,
+                         net_stats_counter_t counter);
+
+/**************************************************************************//**
+ * @brief: Get the rate of a counter between two snapshots, in 0.01/s.
+ *****************************************************************************/
+uint32_t net_stats_rate(const net_stats_snapshot_t *prev,
+                        const net_stats_snapshot_t *cur,
+                        net_stats_proto_t proto,
+                        net_stats_counter_t counter);
+
+/**************************************************************************//**
+ * @brief: Display the non-zero counters of a snapshot, with their increase
+ *         & rate since a previous one (NULL: since boot).
+ *****************************************************************************/
+void net_stats_print(const net_stats_snapshot_t *prev,
+                     const net_stats_snapshot_t *cur);
+
+/**************************************************************************//**
+ * @brief: Display the counters changed since the previous call (blocking
+ *         over window_ms if not 0).
+ *****************************************************************************/
+void net_stats_report_print(uint32_t window_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WIFI_CLI_NET_STATS_H */
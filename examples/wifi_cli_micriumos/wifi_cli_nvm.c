@@ -0,0 +1,461 @@
+/***************************************************************************//**
+ * @file
+ * @brief Write-behind NVM3 persistence of the Wi-Fi CLI parameters
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <common/include/rtos_utils.h>
+#include "em_core.h"
+#include "nvm3_default.h"
+#include "wifi_cli_params.h"
+#include "wifi_cli_nvm.h"
+
+/*******************************************************************************
+ ****************  Wi-Fi CLI Parameters Persistence Task Config  ***************
+ ******************************************************************************/
+#define WFX_CLI_NVM_TASK_PRIO       35u
+#define WFX_CLI_NVM_TASK_STK_SIZE   512u
+
+/* Persistence task stack */
+static CPU_STK wfx_cli_nvm_task_stk[WFX_CLI_NVM_TASK_STK_SIZE];
+
+/* Persistence task TCB */
+static OS_TCB wfx_cli_nvm_task_tcb;
+
+/* Posted on each parameter change */
+static OS_SEM nvm_dirty_sem;
+
+/* Serializes the flushes of the task & of the CLI */
+static OS_MUTEX nvm_flush_mutex;
+
+/* Parameters changed since the last flush, indexed as wifi_params[] */
+static uint32_t nvm_dirty[(WIFI_CLI_NVM_MAX_PARAMS + 31) / 32];
+
+/* Flush working buffers, protected by nvm_flush_mutex */
+static char nvm_obj_buf[WIFI_CLI_NVM_OBJ_MAX_LEN];
+static char nvm_stored_buf[WIFI_CLI_NVM_OBJ_MAX_LEN];
+
+static wifi_cli_nvm_stats_t nvm_stats;
+
+/***************************************************************************//**
+ * @brief
+ *    This function tells whether a parameter is persisted: it must be
+ *    writable & both rendered & applied through the table callbacks
+ *
+ * @param[in]
+ *    + param_idx: The index of the parameter in wifi_params[]
+ *
+ * @param[out] None
+ *
+ * @return  true if persisted
+ ******************************************************************************/
+static bool nvm_param_persisted(int param_idx)
+{
+  const param_t *param;
+
+  if ((param_idx < 0)
+      || ((uint32_t)param_idx >= wifi_params_count)
+      || (param_idx >= WIFI_CLI_NVM_MAX_PARAMS)) {
+      return false;
+  }
+
+  param = &wifi_params[param_idx];
+  return ((param->rights & SL_WFX_CLI_PARAM_SET_RIGHT) != 0)
+         && (param->get_func != NULL)
+         && (param->set_func != NULL);
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function returns the NVM3 key of a parameter (FNV-1a hash of its
+ *    name folded to 16 bits)
+ *
+ * @param[in]
+ *    + name: The parameter name
+ *
+ * @param[out] None
+ *
+ * @return  The NVM3 key
+ ******************************************************************************/
+static nvm3_ObjectKey_t nvm_param_key(const char *name)
+{
+  uint32_t hash = 2166136261u;
+
+  while (*name != '\0') {
+      hash ^= (uint8_t)*name++;
+      hash *= 16777619u;
+  }
+  return WIFI_CLI_NVM_KEY_BASE + ((hash >> 16) ^ (hash & 0xFFFF));
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function reads the "name=value" object of a parameter
+ *
+ * @param[in]
+ *    + param: The parameter
+ *    + buf_len: The output buffer length
+ *
+ * @param[out]
+ *    + buf: The object, NULL-terminated
+ *
+ * @return
+ *    The object length if found
+ *    -1 if not found or not belonging to this parameter
+ ******************************************************************************/
+static int nvm_read_object(const param_t *param, char *buf, uint32_t buf_len)
+{
+  Ecode_t ecode;
+  uint32_t type;
+  size_t len;
+  size_t name_len = strlen(param->name);
+
+  ecode = nvm3_getObjectInfo(nvm3_defaultHandle,
+                             nvm_param_key(param->name),
+                             &type,
+                             &len);
+  if ((ecode != ECODE_NVM3_OK)
+      || (type != NVM3_OBJECTTYPE_DATA)
+      || (len >= buf_len)) {
+      return -1;
+  }
+
+  ecode = nvm3_readData(nvm3_defaultHandle,
+                        nvm_param_key(param->name),
+                        buf,
+                        len);
+  if (ecode != ECODE_NVM3_OK) {
+      return -1;
+  }
+  buf[len] = '\0';
+
+  /* Objects of colliding names are rejected */
+  if ((len <= name_len)
+      || (strncmp(buf, param->name, name_len) != 0)
+      || (buf[name_len] != '=')) {
+      return -1;
+  }
+  return (int)len;
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function writes a parameter unless its stored value is unchanged
+ *
+ * @param[in]
+ *    + param: The parameter
+ *
+ * @param[out] None
+ *
+ * @return
+ *    1 if written
+ *    0 if unchanged
+ *    -1 if failed
+ ******************************************************************************/
+static int nvm_write_param(const param_t *param)
+{
+  int ret;
+  Ecode_t ecode;
+  uint32_t obj_len;
+  size_t name_len = strlen(param->name);
+
+  if (name_len + 2 > sizeof(nvm_obj_buf)) {
+      return -1;
+  }
+
+  /* Render the current value as "name=value" */
+  memcpy(nvm_obj_buf, param->name, name_len);
+  nvm_obj_buf[name_len] = '=';
+  ret = param->get_func(param->name,
+                        param->address,
+                        param->size,
+                        &nvm_obj_buf[name_len + 1],
+                        sizeof(nvm_obj_buf) - name_len - 1);
+  if (ret < 0) {
+      return -1;
+  }
+  obj_len = strlen(nvm_obj_buf);
+
+  /* Spare the flash if the stored value is the same */
+  ret = nvm_read_object(param, nvm_stored_buf, sizeof(nvm_stored_buf));
+  if ((ret == (int)obj_len)
+      && (memcmp(nvm_stored_buf, nvm_obj_buf, obj_len) == 0)) {
+      return 0;
+  }
+
+  ecode = nvm3_writeData(nvm3_defaultHandle,
+                         nvm_param_key(param->name),
+                         nvm_obj_buf,
+                         obj_len);
+  if (ecode != ECODE_NVM3_OK) {
+      LOG_DEBUG("nvm3_writeData(%s) failed (0x%lx)", param->name, ecode);
+      return -1;
+  }
+  return 1;
+}
+
+/***************************************************************************//**
+ * @brief
+ *    Persistence task: coalesces the parameter changes & flushes them once
+ *    they settle
+ *
+ * @param[in]
+ *    + p_arg: Unused
+ *
+ * @param[out] None
+ *
+ * @return  None
+ ******************************************************************************/
+static void wfx_cli_nvm_task(void *p_arg)
+{
+  (void)p_arg;
+  RTOS_ERR err;
+  uint32_t first_change;
+  uint32_t delay_ticks = (WIFI_CLI_NVM_FLUSH_DELAY_MS * OSCfg_TickRate_Hz) / 1000;
+  uint32_t max_ticks = (WIFI_CLI_NVM_FLUSH_MAX_DELAY_MS * OSCfg_TickRate_Hz) / 1000;
+
+  for (;;) {
+      /* Wait for a first change */
+      OSSemPend(&nvm_dirty_sem, 0, OS_OPT_PEND_BLOCKING, NULL, &err);
+      first_change = OSTimeGet(&err);
+
+      /* Wait for the changes to settle */
+      do {
+          OSSemPend(&nvm_dirty_sem,
+                    delay_ticks,
+                    OS_OPT_PEND_BLOCKING,
+                    NULL,
+                    &err);
+      } while ((RTOS_ERR_CODE_GET(err) == RTOS_ERR_NONE)
+               && ((OSTimeGet(&err) - first_change) < max_ticks));
+
+      OSSemSet(&nvm_dirty_sem, 0, &err);
+      wifi_cli_nvm_flush();
+
+      /* Reclaim the flash space now rather than in a later write */
+      if (nvm3_repackNeeded(nvm3_defaultHandle)) {
+          if (nvm3_repack(nvm3_defaultHandle) == ECODE_NVM3_OK) {
+              nvm_stats.repacks++;
+          }
+      }
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function starts the parameter persistence task
+ *
+ * @param[in] None
+ *
+ * @param[out] None
+ *
+ * @return  None
+ ******************************************************************************/
+void wifi_cli_nvm_init(void)
+{
+  RTOS_ERR err;
+  uint32_t i, j;
+
+  if (wifi_params_count > WIFI_CLI_NVM_MAX_PARAMS) {
+      LOG_DEBUG("Only the first %d parameters are persisted",
+                WIFI_CLI_NVM_MAX_PARAMS);
+  }
+
+  /* Colliding keys would make the parameters overwrite each other: rename one
+   * of them before shipping the table */
+  for (i = 0; i < wifi_params_count; i++) {
+      for (j = i + 1; j < wifi_params_count; j++) {
+          if (nvm_param_persisted(i)
+              && nvm_param_persisted(j)
+              && (nvm_param_key(wifi_params[i].name)
+                  == nvm_param_key(wifi_params[j].name))) {
+              printf("NVM3 key collision: %s & %s\r\n",
+                     wifi_params[i].name,
+                     wifi_params[j].name);
+              APP_RTOS_ASSERT_DBG(false, 1);
+          }
+      }
+  }
+
+  OSSemCreate(&nvm_dirty_sem, "wifi cli nvm dirty", 0, &err);
+  APP_RTOS_ASSERT_DBG((RTOS_ERR_CODE_GET(err) == RTOS_ERR_NONE), 1);
+
+  OSMutexCreate(&nvm_flush_mutex, "wifi cli nvm flush", &err);
+  APP_RTOS_ASSERT_DBG((RTOS_ERR_CODE_GET(err) == RTOS_ERR_NONE), 1);
+
+  OSTaskCreate(&wfx_cli_nvm_task_tcb,
+               "wifi cli nvm task",
+               wfx_cli_nvm_task,
+               DEF_NULL,
+               WFX_CLI_NVM_TASK_PRIO,
+               &wfx_cli_nvm_task_stk[0],
+               (WFX_CLI_NVM_TASK_STK_SIZE / 10u),
+               WFX_CLI_NVM_TASK_STK_SIZE,
+               0u,
+               0u,
+               DEF_NULL,
+               (OS_OPT_TASK_STK_CLR),
+               &err);
+  APP_RTOS_ASSERT_DBG((RTOS_ERR_CODE_GET(err) == RTOS_ERR_NONE), 1);
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function marks a parameter as changed & wakes up the persistence
+ *    task. Parameters that are not persisted are ignored.
+ *
+ * @param[in]
+ *    + param_idx: The index of the parameter in wifi_params[]
+ *
+ * @param[out] None
+ *
+ * @return  None
+ ******************************************************************************/
+void wifi_cli_nvm_mark_dirty(int param_idx)
+{
+  RTOS_ERR err;
+  CORE_DECLARE_IRQ_STATE;
+
+  if (!nvm_param_persisted(param_idx)) {
+      return;
+  }
+
+  CORE_ENTER_ATOMIC();
+  nvm_dirty[param_idx / 32] |= (1u << (param_idx % 32));
+  CORE_EXIT_ATOMIC();
+
+  OSSemPost(&nvm_dirty_sem, OS_OPT_POST_1, &err);
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function writes all the changed parameters, skipping those whose
+ *    stored value is unchanged
+ *
+ * @param[in] None
+ *
+ * @param[out] None
+ *
+ * @return
+ *    The number of objects written
+ *    -1 if at least one parameter failed
+ ******************************************************************************/
+int wifi_cli_nvm_flush(void)
+{
+  RTOS_ERR err;
+  int ret;
+  int nb_written = 0;
+  bool failed = false;
+  uint32_t i;
+  uint32_t dirty[sizeof(nvm_dirty) / sizeof(nvm_dirty[0])];
+  CORE_DECLARE_IRQ_STATE;
+
+  OSMutexPend(&nvm_flush_mutex, 0, OS_OPT_PEND_BLOCKING, NULL, &err);
+
+  /* Take the changes, later ones are left to the next flush */
+  CORE_ENTER_ATOMIC();
+  memcpy(dirty, nvm_dirty, sizeof(dirty));
+  memset(nvm_dirty, 0, sizeof(nvm_dirty));
+  CORE_EXIT_ATOMIC();
+
+  for (i = 0; i < WIFI_CLI_NVM_MAX_PARAMS; i++) {
+      if ((dirty[i / 32] & (1u << (i % 32))) == 0) {
+          continue;
+      }
+
+      ret = nvm_write_param(&wifi_params[i]);
+      if (ret > 0) {
+          nb_written++;
+          nvm_stats.writes++;
+      } else if (ret == 0) {
+          nvm_stats.skipped++;
+      } else {
+          /* Retry with the next flush */
+          CORE_ENTER_ATOMIC();
+          nvm_dirty[i / 32] |= (1u << (i % 32));
+          CORE_EXIT_ATOMIC();
+          nvm_stats.failures++;
+          failed = true;
+      }
+  }
+
+  for (i = 0; i < sizeof(dirty) / sizeof(dirty[0]); i++) {
+      if (dirty[i] != 0) {
+          nvm_stats.flushes++;
+          break;
+      }
+  }
+  nvm3_getEraseCount(nvm3_defaultHandle, &nvm_stats.erase_count);
+
+  OSMutexPost(&nvm_flush_mutex, OS_OPT_POST_NONE, &err);
+
+  return failed ? -1 : nb_written;
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function reads the persisted value of a parameter
+ *
+ * @param[in]
+ *    + param_idx: The index of the parameter in wifi_params[]
+ *    + value_len: The output buffer length
+ *
+ * @param[out]
+ *    + value: The persisted value, NULL-terminated
+ *
+ * @return
+ *    0 if found
+ *    -1 if not persisted or not found
+ ******************************************************************************/
+int wifi_cli_nvm_read(int param_idx, char *value, uint32_t value_len)
+{
+  int len;
+  size_t name_len;
+  char obj_buf[WIFI_CLI_NVM_OBJ_MAX_LEN];
+
+  if (!nvm_param_persisted(param_idx) || (value == NULL)) {
+      return -1;
+  }
+
+  len = nvm_read_object(&wifi_params[param_idx], obj_buf, sizeof(obj_buf));
+  if (len < 0) {
+      return -1;
+  }
+
+  /* Skip "name=" */
+  name_len = strlen(wifi_params[param_idx].name) + 1;
+  if ((uint32_t)len - name_len >= value_len) {
+      return -1;
+  }
+  memcpy(value, &obj_buf[name_len], len - name_len + 1);
+  return 0;
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function gets the persistence counters
+ *
+ * @param[in] None
+ *
+ * @param[out]
+ *    + stats: The counters
+ *
+ * @return  None
+ ******************************************************************************/
+void wifi_cli_nvm_get_stats(wifi_cli_nvm_stats_t *stats)
+{
+  *stats = nvm_stats;
+}
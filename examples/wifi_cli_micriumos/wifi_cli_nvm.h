@@ -0,0 +1,89 @@
+/***************************************************************************//**
+ * @file
+ * @brief Write-behind NVM3 persistence of the Wi-Fi CLI parameters
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+#ifndef WIFI_CLI_NVM_H
+#define WIFI_CLI_NVM_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Each persisted parameter is stored as a "name=value" object. Its key is a
+ * hash of the parameter name so that it doesn't depend on the position of the
+ * parameter in the table. The legacy NVM3_KEY_AP_* keys are below the base.
+ */
+#ifndef WIFI_CLI_NVM_KEY_BASE
+#define WIFI_CLI_NVM_KEY_BASE         0x10000
+#endif
+#define WIFI_CLI_NVM_MAX_PARAMS       64   ///< Max parameters tracked
+#define WIFI_CLI_NVM_OBJ_MAX_LEN      160  ///< Max "name=value" object length
+
+/* Parameter changes are written once no other change occurred for the flush
+ * delay, or at the latest after the max delay since the first change. */
+#ifndef WIFI_CLI_NVM_FLUSH_DELAY_MS
+#define WIFI_CLI_NVM_FLUSH_DELAY_MS   2000
+#endif
+#ifndef WIFI_CLI_NVM_FLUSH_MAX_DELAY_MS
+#define WIFI_CLI_NVM_FLUSH_MAX_DELAY_MS   10000
+#endif
+
+/* Persistence counters */
+typedef struct {
+  uint32_t flushes;     ///< Flushes with at least one dirty parameter
+  uint32_t writes;      ///< Objects written
+  uint32_t skipped;     ///< Dirty parameters whose stored value was unchanged
+  uint32_t failures;    ///< Failed renderings or writes
+  uint32_t repacks;     ///< NVM3 repacks run by the flush task
+  uint32_t erase_count; ///< NVM3 page erase count at the last flush
+} wifi_cli_nvm_stats_t;
+
+/**************************************************************************//**
+ * @brief: Start the parameter persistence task.
+ *****************************************************************************/
+void wifi_cli_nvm_init(void);
+
+/**************************************************************************//**
+ * @brief: Mark a parameter as changed, it is written by the next flush.
+ *****************************************************************************/
+void wifi_cli_nvm_mark_dirty(int param_idx);
+
+/**************************************************************************//**
+ * @brief: Write all the changed parameters now.
+ *
+ * @return the number of objects written, -1 on failure.
+ *****************************************************************************/
+int wifi_cli_nvm_flush(void);
+
+/**************************************************************************//**
+ * @brief: Read the persisted value of a parameter.
+ *
+ * @return 0 if found, -1 otherwise.
+ *****************************************************************************/
+int wifi_cli_nvm_read(int param_idx, char *value, uint32_t value_len);
+
+/**************************************************************************//**
+ * @brief: Get the persistence counters.
+ *****************************************************************************/
+void wifi_cli_nvm_get_stats(wifi_cli_nvm_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WIFI_CLI_NVM_H */
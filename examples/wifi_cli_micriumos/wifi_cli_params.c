@@ -16,8 +16,11 @@
  *
  ******************************************************************************/
 #include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <stdint.h>
 #include "wifi_cli_params.h"
+#include "wifi_cli_nvm.h"
 #include "lwip/netif.h"
 #include "lwip/tcpip.h"
 #include "lwip/apps/httpd.h"
@@ -28,23 +31,15 @@
 #include "ethernetif.h"
 #include "sl_wfx_task.h"
 #include "sl_wfx_host.h"
-
-/* CLI's parameters registration configuration */
-#define WFX_CLI_PARAMS_TASK_PRIO        32u
-#define WFX_CLI_PARAMS_TASK_STK_SIZE    800u
-
-/* CLI's parameters registration task stack */
-static CPU_STK wfx_cli_params_task_stk[WFX_CLI_PARAMS_TASK_STK_SIZE];
-/* CLI's parameters registration task TCB */
-static OS_TCB wfx_cli_params_task_tcb;
-/* CLI's parameters registration task */
-static void wfx_cli_params_task(void *p_arg);
+#include "wifi_cli_boot.h"
 
 /* global wifi context */
 extern sl_wfx_context_t   wifi;
 
 /* User-defined sem type is used to force CLI to wait */
 sem_type_t g_cli_sem;
+/* Serializes the WF200 requests of the CLI, the events task & the metrics */
+static OS_MUTEX wfx_request_mutex;
 /* rx_stats */
 sl_wfx_rx_stats_t rx_stats;
 
@@ -58,59 +53,37 @@ uint8_t use_dhcp_client = USE_DHCP_CLIENT_DEFAULT;
 /* Enable or disable DHCP server for SoftAP */
 uint8_t use_dhcp_server = USE_DHCP_SERVER_DEFAULT;
 
-/* Station IP address octet 0. */
-uint8_t sta_ip_addr0 = STA_IP_ADDR0_DEFAULT;
-/* Station IP address octet 1. */
-uint8_t sta_ip_addr1 = STA_IP_ADDR1_DEFAULT;
-/* Station IP address octet 2. */
-uint8_t sta_ip_addr2 = STA_IP_ADDR2_DEFAULT;
-/* Station IP address octet 3. */
-uint8_t sta_ip_addr3 = STA_IP_ADDR3_DEFAULT;
-
-/* Station net mask octet 0. */
-uint8_t sta_netmask_addr0 = STA_NETMASK_ADDR0_DEFAULT;
-/* Station net mask octet 1. */
-uint8_t sta_netmask_addr1 = STA_NETMASK_ADDR1_DEFAULT;
-/* Station net mask octet 2. */
-uint8_t sta_netmask_addr2 = STA_NETMASK_ADDR2_DEFAULT;
-/* Station net mask octet 3. */
-uint8_t sta_netmask_addr3 = STA_NETMASK_ADDR3_DEFAULT;
-
-/* Station gateway IP octet 0. */
-uint8_t sta_gw_addr0 = STA_GW_ADDR0_DEFAULT;
-/* Station gateway IP octet 1. */
-uint8_t sta_gw_addr1 = STA_GW_ADDR1_DEFAULT;
-/* Station gateway IP octet 2. */
-uint8_t sta_gw_addr2 = STA_GW_ADDR2_DEFAULT;
-/* Station gateway IP octet 3. */
-uint8_t sta_gw_addr3 = STA_GW_ADDR3_DEFAULT;
-
-/* AP IP address octet 0. */
-uint8_t ap_ip_addr0 = AP_IP_ADDR0_DEFAULT;
-/* AP IP address octet 1. */
-uint8_t ap_ip_addr1 = AP_IP_ADDR1_DEFAULT;
-/* AP IP address octet 2. */
-uint8_t ap_ip_addr2 = AP_IP_ADDR2_DEFAULT;
-/* AP IP address octet 3. */
-uint8_t ap_ip_addr3 = AP_IP_ADDR3_DEFAULT;
-
-/* AP net mask octet 0. */
-uint8_t ap_netmask_addr0 = AP_NETMASK_ADDR0_DEFAULT;
-/* AP net mask octet 1. */
-uint8_t ap_netmask_addr1 = AP_NETMASK_ADDR1_DEFAULT;
-/* AP net mask octet 2. */
-uint8_t ap_netmask_addr2 = AP_NETMASK_ADDR2_DEFAULT;
-/* AP net mask octet 3. */
-uint8_t ap_netmask_addr3 = AP_NETMASK_ADDR3_DEFAULT;
-
-/* AP gateway IP octet 0. */
-uint8_t ap_gw_addr0 = AP_GW_ADDR0_DEFAULT;
-/* AP gateway IP octet 1. */
-uint8_t ap_gw_addr1 = AP_GW_ADDR1_DEFAULT;
-/* AP gateway IP octet 2. */
-uint8_t ap_gw_addr2 = AP_GW_ADDR2_DEFAULT;
-/* AP gateway IP octet 3 */
-uint8_t ap_gw_addr3 = AP_GW_ADDR3_DEFAULT;
+/* Station static addresses (used without DHCP or on DHCP timeout) */
+netif_addr_t sta_static_addr = {
+  .ip_addr = IPADDR4_INIT_BYTES(STA_IP_ADDR0_DEFAULT,
+                                STA_IP_ADDR1_DEFAULT,
+                                STA_IP_ADDR2_DEFAULT,
+                                STA_IP_ADDR3_DEFAULT),
+  .netmask = IPADDR4_INIT_BYTES(STA_NETMASK_ADDR0_DEFAULT,
+                                STA_NETMASK_ADDR1_DEFAULT,
+                                STA_NETMASK_ADDR2_DEFAULT,
+                                STA_NETMASK_ADDR3_DEFAULT),
+  .gw      = IPADDR4_INIT_BYTES(STA_GW_ADDR0_DEFAULT,
+                                STA_GW_ADDR1_DEFAULT,
+                                STA_GW_ADDR2_DEFAULT,
+                                STA_GW_ADDR3_DEFAULT),
+};
+
+/* SoftAP static addresses */
+netif_addr_t ap_static_addr = {
+  .ip_addr = IPADDR4_INIT_BYTES(AP_IP_ADDR0_DEFAULT,
+                                AP_IP_ADDR1_DEFAULT,
+                                AP_IP_ADDR2_DEFAULT,
+                                AP_IP_ADDR3_DEFAULT),
+  .netmask = IPADDR4_INIT_BYTES(AP_NETMASK_ADDR0_DEFAULT,
+                                AP_NETMASK_ADDR1_DEFAULT,
+                                AP_NETMASK_ADDR2_DEFAULT,
+                                AP_NETMASK_ADDR3_DEFAULT),
+  .gw      = IPADDR4_INIT_BYTES(AP_GW_ADDR0_DEFAULT,
+                                AP_GW_ADDR1_DEFAULT,
+                                AP_GW_ADDR2_DEFAULT,
+                                AP_GW_ADDR3_DEFAULT),
+};
 
 /* Wi-Fi station connection parameters */
 char wlan_ssid[32 + 1]                      = WLAN_SSID_DEFAULT;
@@ -126,18 +99,8 @@ char softap_pmk[64 + 3]                     = "0";
 uint8_t softap_channel                      = SOFTAP_CHANNEL_DEFAULT;
 sl_wfx_mac_address_t client_mac_address     = { { 0, 0, 0, 0, 0, 0 } };
 
-/* Memory to store WiFi scan results from web server */
-char string_list[4096];
 /* Memory to store an event to display in the web page */
 char event_log[50];
-/* Number of registered parameters */
-static int number_registered_params = 0;
-/* Wifi parameters struct array */
-param_t wifi_params[SL_WFX_CLI_MAX_PARAMS] = {0};
-/* Number of connected client */
-int number_connected_clients = 0;
-/* Wifi client list */
-uint8_t wifi_clients[SL_WFX_CLI_MAX_CLIENTS][6] = {0};
 
 /* Host-to-Wi-Fi bus */
 #ifdef SL_CATALOG_WFX_BUS_SDIO_PRESENT
@@ -236,22 +199,28 @@ int convert_str_to_mac_addr(char *mac_str, sl_wfx_mac_address_t *mac_addr)
  * @return
  *        The index of parameter in the wifi_params arrays, if success.
  *        -1 if not found
+ * @note: wifi_params is sorted by name, a binary search is used.
  ******************************************************************************/
 int param_search (char *name)
 {
-  int param_index = -1;
-  int i;
-
-  for (i = 0; i < number_registered_params; i++) {
-
-      /* Loop through & search the matching name with NULL-terminated string */
-      if ((strncmp(name, wifi_params[i].name, strlen(wifi_params[i].name)) == 0)
-          && (name[strlen(wifi_params[i].name)] == '\0')) {
-        param_index = i;
-        break;
+  int low = 0;
+  int high = (int)wifi_params_count - 1;
+  int mid;
+  int cmp;
+
+  while (low <= high) {
+      mid = low + ((high - low) / 2);
+      cmp = strcmp(name, wifi_params[mid].name);
+      if (cmp == 0) {
+          return mid;
+      }
+      if (cmp < 0) {
+          high = mid - 1;
+      } else {
+          low = mid + 1;
       }
   }
-  return param_index;
+  return -1;
 }
 
 /***************************************************************************//**
@@ -309,6 +278,51 @@ void wifi_cli_sem_init(sem_type_t *p_cli_sem, RTOS_ERR *err)
               err);
 }
 
+/***************************************************************************//**
+ * @brief
+ *    This function takes the WF200 request lock. A request waits for its
+ *    confirmation, which the driver matches by request ID only: two tasks
+ *    must not have a request in flight at the same time. The lock is held
+ *    around the request only, never while waiting for an indication.
+ *
+ * @param[in] None
+ *
+ * @param[out] None
+ *
+ * @return  None
+ ******************************************************************************/
+void wifi_cli_wfx_lock(void)
+{
+  RTOS_ERR err;
+
+  OSMutexPend(&wfx_request_mutex,
+              0,
+              OS_OPT_PEND_BLOCKING,
+              NULL,
+              &err);
+  if ((RTOS_ERR_CODE_GET(err) != RTOS_ERR_NONE)
+      && (RTOS_ERR_CODE_GET(err) != RTOS_ERR_IS_OWNER)) {
+      LOG_DEBUG("WF200 request lock failed (%d)", RTOS_ERR_CODE_GET(err));
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function releases the WF200 request lock
+ *
+ * @param[in] None
+ *
+ * @param[out] None
+ *
+ * @return  None
+ ******************************************************************************/
+void wifi_cli_wfx_unlock(void)
+{
+  RTOS_ERR err;
+
+  OSMutexPost(&wfx_request_mutex, OS_OPT_POST_NONE, &err);
+}
+
 /***************************************************************************//**
  * @brief
  *    This function forces CLI to wait for an event with given timeout in ms
@@ -412,7 +426,43 @@ int wifi_cli_resume(sem_type_t *p_cli_sem,
 
 /***************************************************************************//**
  * @brief
- *    This callback function gets (displays) the string type parameter in the
+ *    This function copies a parameter value rendered by a get callback
+ *    to the caller's output buffer.
+ *
+ * @param[in]
+ *    + value: The NULL-terminated parameter value
+ *
+ * @param[out]
+ *    + out_buf: The output buffer
+ *    + out_buf_len: the output buffer size
+ *
+ * @return
+ *    0 if sucess
+ *    -1 if the output buffer is missing or too small
+ ******************************************************************************/
+static int output_param_value(const char *value,
+                              char *out_buf,
+                              uint32_t out_buf_len)
+{
+  uint32_t value_len;
+
+  if (out_buf == NULL) {
+      LOG_DEBUG("No output buffer");
+      return -1;
+  }
+
+  value_len = strlen(value);
+  if (value_len >= out_buf_len) {
+      LOG_DEBUG("Output buffer too small (%lu/%lu)", value_len, out_buf_len);
+      return -1;
+  }
+  memcpy(out_buf, value, value_len + 1);
+  return 0;
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This callback function gets the string type parameter in the
  *    global parameter structure "wifi_params".
  *
  * @param[in]
@@ -434,16 +484,9 @@ static int get_string_param(char *param_name,
                             char *out_buf,
                             uint32_t out_buf_len)
 {
-    (void)param_name, (void)out_buf, (void)out_buf_len, (void)param_size;
-
-    int ret = 0;
-    if (out_buf == NULL) {
-        printf("%s\r\n", (char *)param_addr);
-    } else {
-        /* Later, if need to copy string to out_buf */
-        LOG_DEBUG("Copy string to the output buffer hasn't been implemented");
-    }
-    return ret;
+  (void)param_name, (void)param_size;
+
+  return output_param_value((char *)param_addr, out_buf, out_buf_len);
 }
 
 /***************************************************************************//**
@@ -490,7 +533,7 @@ static int set_string_param(char *param_name,
 
 /***************************************************************************//**
  * @brief
- *    This function gets (display) the current station/AP security mode
+ *    This function gets the current station/AP security mode
  *
  * @param[in]
  *    + param_name: The name of parameter
@@ -511,7 +554,7 @@ static int get_security_mode(char *param_name,
                              char *out_buf,
                              uint32_t out_buf_len)
 {
-  (void)param_name, (void)out_buf, (void)out_buf_len;
+  (void)param_name;
 
   int security_idx;
 
@@ -540,11 +583,17 @@ static int get_security_mode(char *param_name,
   if (security_idx < 0) {
       LOG_DEBUG("Unknown size of sl_wfx_security_mode_t "
                 "enum type! Only support 1, 2, 4 byte-size\r\n");
-      printf("Failed to get security mode\r\n");
       return -1;
   }
-  printf("%s\r\n", security_modes[security_idx]);
-  return 0;
+
+  if ((security_idx >= (int)(sizeof(security_modes) / sizeof(char*)))
+      || (security_modes[security_idx] == NULL)) {
+      LOG_DEBUG("Unknown security mode %d\r\n", security_idx);
+      return -1;
+  }
+  return output_param_value(security_modes[security_idx],
+                            out_buf,
+                            out_buf_len);
 }
 
 /***************************************************************************//**
@@ -583,7 +632,7 @@ static int set_security_mode(char *param_name,
 
   for (i = 0; i < security_mode_nb; i++) {
       /* Loop through & compare the input security mode vs supported ones */
-      is_matched = strlen(security_modes[i]) && /*!< Skips the NULL entry */
+      is_matched = (security_modes[i] != NULL) && /*!< Skips the NULL entry */
                   (!strcmp(new_value, security_modes[i]));
 
       /* If the security mode is found, update the new security mode then exit */
@@ -596,239 +645,1083 @@ static int set_security_mode(char *param_name,
   return -1;
 }
 
+/**************************************************************************//**
+ * @brief: Staged addresses of a network interface
+ *****************************************************************************/
+typedef struct netif_stage_s {
+  struct netif *netif;
+  const char *name;           /*!< Parameter prefix of the interface */
+  netif_addr_t *static_addr;  /*!< Static addresses of the interface */
+  netif_addr_t staged;        /*!< Addresses applied by the next commit */
+  netif_addr_t undo_static;   /*!< Static addresses before the last apply */
+  netif_addr_t undo_netif;    /*!< Interface addresses before the last apply */
+  bool pending;               /*!< Addresses have been staged */
+  bool applied;               /*!< The last apply can be reverted */
+} netif_stage_t;
+
+static netif_stage_t netif_stages[] = {
+  { .netif = &sta_netif, .name = "station", .static_addr = &sta_static_addr },
+  { .netif = &ap_netif,  .name = "softap",  .static_addr = &ap_static_addr },
+};
+
+/* Registered address change notifications */
+static wifi_cli_netif_change_fn_t netif_change_cbs[SL_WFX_CLI_MAX_NETIF_CHANGE_CB];
+
+/* Network interface setters only stage their address while set */
+static bool netif_commit_deferred = false;
+
 /***************************************************************************//**
  * @brief
- *    This function gets (displays) network interfaces such as
- *    ip, gateway, netmask address
+ *    This function returns the staging slot of a network interface
  *
  * @param[in]
- *    + param_name: The name of parameter
- *    + param_addr: The address of parameter
- *    + param_size: The size of parameter
+ *    + netif: The network interface
  *
- * @param[out]
- *    + out_buf: The output buffer
- *    + out_buf_len: the output buffer size
+ * @param[out] None
  *
  * @return
- *    0 if sucess
- *    -1 if failed
+ *    The staging slot if found
+ *    NULL if not found
  ******************************************************************************/
-static int get_network_interface(char *param_name,
-                                 void *param_addr,
-                                 uint32_t param_size,
-                                 char *out_buf,
-                                 uint32_t out_buf_len)
+static netif_stage_t *netif_stage_get(struct netif *netif)
 {
-  (void)param_size, (void)out_buf, (void)out_buf_len;
-
-  uint8_t *ip_ptr = NULL;
-  uint8_t *netmask_ip_ptr = NULL;
-  uint8_t *gateway_ip_ptr = NULL;
-  struct netif *netif_ptr = NULL;
+  uint32_t i;
 
-  /* Pointer to sta_netif or ap_netif struct */
-  netif_ptr = (struct netif *)param_addr;
+  for (i = 0; i < sizeof(netif_stages) / sizeof(netif_stages[0]); i++) {
+      if (netif_stages[i].netif == netif) {
+          return &netif_stages[i];
+      }
+  }
+  return NULL;
+}
 
-  if (strstr(param_name, "netmask") != NULL) {
-      /* Pointer to the netmask address */
-      netmask_ip_ptr = (uint8_t *)&(netif_ptr->netmask.addr);
+/***************************************************************************//**
+ * @brief
+ *    This function copies the current addresses of a network interface
+ *
+ * @param[in]
+ *    + netif: The network interface
+ *
+ * @param[out]
+ *    + addr: The current addresses
+ *
+ * @return  None
+ ******************************************************************************/
+static void netif_addr_read(struct netif *netif, netif_addr_t *addr)
+{
+  ip_addr_copy(addr->ip_addr, netif->ip_addr);
+  ip_addr_copy(addr->netmask, netif->netmask);
+  ip_addr_copy(addr->gw, netif->gw);
+}
 
-      /*< Get the network interface's netmask address */
-      printf("%d.%d.%d.%d\r\n", netmask_ip_ptr[0], \
-                                netmask_ip_ptr[1], \
-                                netmask_ip_ptr[2], \
-                                netmask_ip_ptr[3]);
+/***************************************************************************//**
+ * @brief
+ *    This function checks that a set of addresses is a consistent IPv4
+ *    configuration: contiguous net mask, unicast host address inside its
+ *    subnet & gateway on the same subnet.
+ *
+ * @param[in]
+ *    + stage: The staging slot to check
+ *
+ * @param[out] None
+ *
+ * @return
+ *    NULL if valid
+ *    The reason otherwise
+ ******************************************************************************/
+static const char *netif_stage_check(const netif_stage_t *stage)
+{
+  const char *err_msg = NULL;
+  const ip4_addr_t *ip = ip_2_ip4(&stage->staged.ip_addr);
+  const ip4_addr_t *netmask = ip_2_ip4(&stage->staged.netmask);
+  const ip4_addr_t *gw = ip_2_ip4(&stage->staged.gw);
+  uint32_t host_mask = ~ip4_addr_get_u32(netmask);
+  uint32_t host_part = ip4_addr_get_u32(ip) & host_mask;
+
+  if (!ip4_addr_netmask_valid(ip4_addr_get_u32(netmask))) {
+      err_msg = "non-contiguous net mask";
+
+  } else if (ip4_addr_isany(ip)) {
+      /* No address (e.g. waiting for DHCP): nothing else to check */
+      if (!ip4_addr_isany(gw)) {
+          err_msg = "gateway without IP address";
+      }
 
-  } else if (strstr(param_name, "gateway") != NULL) {
-      /* Pointer to network interface's gateway address */
-      gateway_ip_ptr = (uint8_t *)&(netif_ptr->gw.addr);
+  } else if (ip4_addr_ismulticast(ip)
+             || (ip4_addr_get_u32(ip) == IPADDR_BROADCAST)) {
+      err_msg = "IP address is not unicast";
 
-      /* Get the network interface's netmask address */
-      printf("%d.%d.%d.%d\r\n", gateway_ip_ptr[0], \
-                                gateway_ip_ptr[1], \
-                                gateway_ip_ptr[2], \
-                                gateway_ip_ptr[3]);
+  } else if (ip4_addr_isany(netmask)) {
+      err_msg = "missing net mask";
 
-  } else if (strstr(param_name, "ip") != NULL) {
-      /* Pointer to network interface's ip address */
-      ip_ptr = (uint8_t *)&(netif_ptr->ip_addr.addr);
+  } else if ((lwip_ntohl(host_mask) > 1)
+             && ((host_part == 0) || (host_part == host_mask))) {
+      /* Subnet & broadcast addresses, except for /31 & /32 subnets */
+      err_msg = "IP address is the subnet or broadcast address";
 
-      /* Get the network interface's ip address */
-      printf("%d.%d.%d.%d\r\n", ip_ptr[0], ip_ptr[1], ip_ptr[2], ip_ptr[3]);
+  } else if (!ip4_addr_isany(gw)
+             && (!ip4_addr_netcmp(gw, ip, netmask) || ip4_addr_cmp(gw, ip))) {
+      err_msg = "gateway is not a host of the subnet";
   }
-  return 0;
+
+  return err_msg;
 }
 
 /***************************************************************************//**
  * @brief
- *    This function sets network interfaces such as ip, gateway, netmask address
+ *    This function checks the staged addresses of a network interface &
+ *    displays the reason if they are invalid
  *
  * @param[in]
- *    + param_name: The name of parameter
- *    + param_addr: The address of parameter
- *    + param_size: The size of parameter
- *    + new_value:  The value needs to be set
+ *    + stage: The staging slot to check
  *
  * @param[out] None
  *
  * @return
- *    0 if sucess
- *    -1 if failed
+ *    0 if valid
+ *    -1 if invalid
  ******************************************************************************/
-static int set_network_interface(char *param_name,
-                                 void *param_addr,
-                                 uint32_t param_size,
-                                 char *new_value)
+static int netif_stage_validate(const netif_stage_t *stage)
 {
-  (void)param_size;
-  ip_addr_t newIP;
-  struct netif *netif_ptr = NULL;
-
-  /* Pointer to sta_netif or ap_netif struct */
-  netif_ptr = (struct netif *)param_addr;
+  const char *err_msg = netif_stage_check(stage);
 
-  if (ipaddr_aton(new_value, &newIP) == 0) {
-      printf("Failed to convert %s (%s) to ipv4 format\r\n",
-             param_name, new_value);
+  if (err_msg != NULL) {
+      printf("Invalid %s addresses: %s\r\n", stage->name, err_msg);
       return -1;
   }
+  return 0;
+}
 
-  if (strstr(param_name, "netmask") != NULL) {
-      /* Update the interface's netmask address */
-      netif_set_netmask(netif_ptr, &newIP);
-
-  } else if (strstr(param_name, "gateway") == 0) {
-      /* Set new gateway to network interface */
-      netif_set_gw(netif_ptr, &newIP);
+/***************************************************************************//**
+ * @brief
+ *    This function marks the address parameters of a network interface as
+ *    changed, for their persistence
+ *
+ * @param[in]
+ *    + stage: The staging slot of the interface
+ *
+ * @param[out] None
+ *
+ * @return  None
+ ******************************************************************************/
+static void netif_stage_mark_dirty(const netif_stage_t *stage)
+{
+  static const char *const fields[] = { "gateway", "ip", "netmask" };
+  char name[32];
+  uint32_t i;
 
-  } else if (strstr(param_name, "ip") == 0) {
-      /* Set new station IP address to network interface */
-      netif_set_ipaddr(netif_ptr, &newIP);
+  for (i = 0; i < sizeof(fields) / sizeof(fields[0]); i++) {
+      snprintf(name, sizeof(name), "%s.%s", stage->name, fields[i]);
+      wifi_cli_nvm_mark_dirty(param_search(name));
   }
-  return 0;
 }
 
 /***************************************************************************//**
  * @brief
- *    This function sets MAC address
+ *    This function sets the addresses of a network interface in one netifapi
+ *    call & notifies the registered applications
  *
  * @param[in]
- *    + param_name: The name of parameter
- *    + param_addr: The address of parameter
- *    + param_size: The size of parameter
- *    + new_value:  The value needs to be set
+ *    + stage: The staging slot of the interface
+ *    + old_addr: The current addresses
+ *    + new_addr: The new addresses
  *
  * @param[out] None
  *
  * @return
- *    0 if sucess
+ *    0 if success
  *    -1 if failed
  ******************************************************************************/
-static int set_mac_addr(char *param_name,
-                        void *param_addr,
-                        uint32_t param_size,
-                        char *new_value)
+static int netif_stage_set_addr(const netif_stage_t *stage,
+                                const netif_addr_t *old_addr,
+                                const netif_addr_t *new_addr)
 {
+  err_t err;
+  uint32_t i;
 
-  (void)param_size, (void)param_addr, (void)param_size;
-
-  int ret;
-  int param_idx;
-  netif_init_fn netif_init;
-  sl_wfx_interface_t interface;
-  sl_wfx_mac_address_t new_mac;
-  struct netif *netif_ptr = NULL;
-
-  if (strcmp(param_name, "station.mac") == 0) {
-      /* Station: search for the "sta_netif" parameter */
-      param_idx = param_search("station.ip");
-      if (param_idx < 0) {
-          LOG_DEBUG("The sta_netif parameter not registered yet\r\n");
-          goto error;
-      }
-
-      interface = SL_WFX_STA_INTERFACE;
-      netif_init = sta_ethernetif_init;
-
-  } else if (strcmp(param_name, "softap.mac") == 0) {
-      /* SoftAP: search for the "ap_netif" parameter */
-      param_idx = param_search("softap.ip");
-      if (param_idx < 0) {
-          LOG_DEBUG("The ap_netif parameter not registered yet\r\n");
-          goto error;
-      }
-
-      interface = SL_WFX_SOFTAP_INTERFACE;
-      netif_init = ap_ethernetif_init;
-
-  } else {
-      LOG_DEBUG("Does not support set \"%s\"\r\n", param_name);
-      goto error;
+  if (ip_addr_cmp(&old_addr->ip_addr, &new_addr->ip_addr)
+      && ip_addr_cmp(&old_addr->netmask, &new_addr->netmask)
+      && ip_addr_cmp(&old_addr->gw, &new_addr->gw)) {
+      return 0; /* Unchanged: don't touch the interface */
   }
 
-  /* Pointer to sta_netif or ap_netif */
-  netif_ptr = (struct netif *)wifi_params[param_idx].address;
-
-  /* Convert mac_str to MAC address */
-  if (convert_str_to_mac_addr(new_value, &new_mac)) {
-      printf("Failed to convert the input string (%s) "
-             "to MAC address \r\n", new_value);
+  err = netifapi_netif_set_addr(stage->netif,
+                                ip_2_ip4(&new_addr->ip_addr),
+                                ip_2_ip4(&new_addr->netmask),
+                                ip_2_ip4(&new_addr->gw));
+  if (err != ERR_OK) {
+      LOG_DEBUG("netifapi_netif_set_addr() failed (%d)", err);
       return -1;
   }
 
-  /* Apply the new MAC address */
-  ret = sl_wfx_set_mac_address(&new_mac, interface);
-  if (ret == 0) {
-      /** Update to the global param "wifi.mac_addr_0.octet[]"
-       *  @note This has been done in FMAC driver
-       * */
-      /*< Update the LwIP stack state */
-      netif_init(netif_ptr);
-      return 0;
+  for (i = 0; i < SL_WFX_CLI_MAX_NETIF_CHANGE_CB; i++) {
+      if (netif_change_cbs[i] != NULL) {
+          netif_change_cbs[i](stage->netif, old_addr, new_addr);
+      }
   }
-
-error:
-  printf("Failed to set %s\r\n", param_name);
-  return -1;
+  return 0;
 }
 
 /***************************************************************************//**
  * @brief
- *    This function converts the Message Authentication Code
- *    (MAC) key string to a 32-byte array.
+ *    This function applies the staged addresses of a network interface &
+ *    makes them its static addresses. The previous addresses are kept for
+ *    netif_stage_revert().
  *
  * @param[in]
- *    + mackey_str: The input string of mac key in the square brackets form
- *    + arrSize:  The output buffer size
- *
- * @param[out]
- *    + mackey_arr: The output array contains converted MAC key
+ *    + stage: The staging slot, already validated
  *
- * @return  
- *          0 if success
- *          -1 if failed
+ * @param[out] None
  *
- * @note    mackey_str must be expressed in the 32-byte array form of square
- *          brackets.
- *          E.g.: [0x42, 0x44,.., 0xB3].
+ * @return
+ *    0 if success
+ *    -1 if failed, the interface & its static addresses are unchanged
  ******************************************************************************/
-int convert_mac_key_string_to_array(char *mackey_str,
-                                    uint8_t *mackey_arr,
-                                    uint8_t arrSize)
+static int netif_stage_apply(netif_stage_t *stage)
 {
-  uint8_t i;
-  char *p_end = NULL;
-  char *p_str = mackey_str;
-  int strLen = strlen(mackey_str);
-  char *err_msg = "Format or array size error\r\n";
+  stage->pending = false;
+  stage->applied = false;
+  stage->undo_static = *stage->static_addr;
+  netif_addr_read(stage->netif, &stage->undo_netif);
 
-  if ((mackey_str[0] != '[') && (mackey_str[strLen - 1] != ']')) {
-      /* mackey_str is not having opening & closing square brackets [...] */
-      goto error;
+  if (netif_stage_set_addr(stage, &stage->undo_netif, &stage->staged) < 0) {
+      printf("Failed to apply %s addresses\r\n", stage->name);
+      return -1;
   }
 
-  p_str++;    /*!< Skips the opening square bracket '[' */
+  /* The static configuration is the staged input, never a DHCP lease */
+  *stage->static_addr = stage->staged;
+  stage->applied = true;
+  netif_stage_mark_dirty(stage);
+  return 0;
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function reverts the last apply of a network interface
+ *
+ * @param[in]
+ *    + stage: The staging slot
+ *
+ * @param[out] None
+ *
+ * @return  None
+ ******************************************************************************/
+static void netif_stage_revert(netif_stage_t *stage)
+{
+  netif_addr_t cur_addr;
+
+  if (!stage->applied) {
+      return;
+  }
+  stage->applied = false;
+
+  netif_addr_read(stage->netif, &cur_addr);
+  if (netif_stage_set_addr(stage, &cur_addr, &stage->undo_netif) < 0) {
+      printf("Failed to restore %s addresses\r\n", stage->name);
+  }
+  *stage->static_addr = stage->undo_static;
+  netif_stage_mark_dirty(stage);
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function stages a network interface address, applied by the next
+ *    commit. The first staged address starts from the static addresses of
+ *    the interface.
+ *
+ * @param[in]
+ *    + netif: The network interface (sta_netif or ap_netif)
+ *    + field: The address to stage
+ *    + addr: The new address
+ *
+ * @param[out] None
+ *
+ * @return
+ *    0 if success
+ *    -1 if failed
+ ******************************************************************************/
+int wifi_cli_netif_stage(struct netif *netif,
+                         netif_addr_field_t field,
+                         const ip_addr_t *addr)
+{
+  netif_stage_t *stage = netif_stage_get(netif);
+
+  if ((stage == NULL) || (addr == NULL)) {
+      return -1;
+  }
+
+  if (!stage->pending) {
+      stage->staged = *stage->static_addr;
+      stage->pending = true;
+  }
+
+  switch (field) {
+    case NETIF_ADDR_IP:
+      ip_addr_copy(stage->staged.ip_addr, *addr);
+      break;
+
+    case NETIF_ADDR_NETMASK:
+      ip_addr_copy(stage->staged.netmask, *addr);
+      break;
+
+    case NETIF_ADDR_GW:
+      ip_addr_copy(stage->staged.gw, *addr);
+      break;
+
+    default:
+      return -1;
+  }
+  return 0;
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function validates the staged addresses of a network interface &
+ *    applies them all at once. The staged addresses are dropped if invalid.
+ *
+ * @param[in]
+ *    + netif: The network interface (sta_netif or ap_netif)
+ *
+ * @param[out] None
+ *
+ * @return
+ *    0 if success (or nothing staged)
+ *    -1 if failed
+ * @note: Not to be called from the tcpip thread (netifapi)
+ ******************************************************************************/
+int wifi_cli_netif_commit(struct netif *netif)
+{
+  netif_stage_t *stage = netif_stage_get(netif);
+
+  if (stage == NULL) {
+      return -1;
+  }
+
+  if (!stage->pending) {
+      return 0;
+  }
+
+  if (netif_stage_validate(stage) < 0) {
+      stage->pending = false;
+      return -1;
+  }
+  return netif_stage_apply(stage);
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function validates the staged addresses of all network interfaces
+ *    then applies them: no interface is changed if one of them is invalid or
+ *    cannot be applied.
+ *
+ * @param[in] None
+ *
+ * @param[out] None
+ *
+ * @return
+ *    0 if success
+ *    -1 if failed
+ * @note: Not to be called from the tcpip thread (netifapi)
+ ******************************************************************************/
+int wifi_cli_netif_commit_all(void)
+{
+  int ret = 0;
+  uint32_t i;
+
+  for (i = 0; i < sizeof(netif_stages) / sizeof(netif_stages[0]); i++) {
+      if (netif_stages[i].pending
+          && (netif_stage_validate(&netif_stages[i]) < 0)) {
+          wifi_cli_netif_discard_all();
+          return -1;
+      }
+  }
+
+  for (i = 0; i < sizeof(netif_stages) / sizeof(netif_stages[0]); i++) {
+      netif_stages[i].applied = false;
+  }
+  for (i = 0; i < sizeof(netif_stages) / sizeof(netif_stages[0]); i++) {
+      if (netif_stages[i].pending
+          && (netif_stage_apply(&netif_stages[i]) < 0)) {
+          ret = -1;
+          break;
+      }
+  }
+
+  if (ret < 0) {
+      /* All or nothing: revert the interfaces already applied */
+      while (i-- > 0) {
+          netif_stage_revert(&netif_stages[i]);
+      }
+      wifi_cli_netif_discard_all();
+  }
+  return ret;
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function applies the staged addresses of a network interface once
+ *    they are consistent. Until then they stay staged, so an interface can
+ *    move to another subnet one address at a time.
+ *
+ * @param[in]
+ *    + netif: The network interface (sta_netif or ap_netif)
+ *
+ * @param[out] None
+ *
+ * @return
+ *    0 if applied or still staged
+ *    -1 if failed
+ * @note: Not to be called from the tcpip thread (netifapi)
+ ******************************************************************************/
+static int netif_stage_commit_when_valid(struct netif *netif)
+{
+  const char *err_msg;
+  netif_stage_t *stage = netif_stage_get(netif);
+
+  if ((stage == NULL) || !stage->pending) {
+      return -1;
+  }
+
+  err_msg = netif_stage_check(stage);
+  if (err_msg != NULL) {
+      printf("%s addresses staged, applied once consistent (%s)\r\n",
+             stage->name, err_msg);
+      return 0;
+  }
+  return netif_stage_apply(stage);
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function drops the staged addresses of all network interfaces
+ *
+ * @param[in] None
+ *
+ * @param[out] None
+ *
+ * @return  None
+ ******************************************************************************/
+void wifi_cli_netif_discard_all(void)
+{
+  uint32_t i;
+
+  for (i = 0; i < sizeof(netif_stages) / sizeof(netif_stages[0]); i++) {
+      netif_stages[i].pending = false;
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function applies the static addresses of a network interface
+ *    through the staging & commit path
+ *
+ * @param[in]
+ *    + netif: The network interface (sta_netif or ap_netif)
+ *
+ * @param[out] None
+ *
+ * @return
+ *    0 if success
+ *    -1 if failed
+ ******************************************************************************/
+int wifi_cli_netif_set_static(struct netif *netif)
+{
+  netif_stage_t *stage = netif_stage_get(netif);
+
+  if (stage == NULL) {
+      return -1;
+  }
+
+  stage->staged = *stage->static_addr;
+  stage->pending = true;
+  return wifi_cli_netif_commit(netif);
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function registers a function called each time the addresses of a
+ *    network interface are changed by a commit
+ *
+ * @param[in]
+ *    + change_fn: The notification function
+ *
+ * @param[out] None
+ *
+ * @return
+ *    0 if success
+ *    -1 if no slot is available
+ ******************************************************************************/
+int wifi_cli_netif_register_change_cb(wifi_cli_netif_change_fn_t change_fn)
+{
+  uint32_t i;
+
+  for (i = 0; i < SL_WFX_CLI_MAX_NETIF_CHANGE_CB; i++) {
+      if (netif_change_cbs[i] == NULL) {
+          netif_change_cbs[i] = change_fn;
+          return 0;
+      }
+  }
+  return -1;
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function gets the static addresses of network interfaces such as
+ *    ip, gateway, netmask address
+ *
+ * @param[in]
+ *    + param_name: The name of parameter
+ *    + param_addr: The address of parameter
+ *    + param_size: The size of parameter
+ *
+ * @param[out]
+ *    + out_buf: The output buffer
+ *    + out_buf_len: the output buffer size
+ *
+ * @return
+ *    0 if sucess
+ *    -1 if failed
+ ******************************************************************************/
+static int get_network_interface(char *param_name,
+                                 void *param_addr,
+                                 uint32_t param_size,
+                                 char *out_buf,
+                                 uint32_t out_buf_len)
+{
+  (void)param_size;
+
+  uint8_t *addr_ptr = NULL;
+  netif_stage_t *stage = NULL;
+  char addr_str[IP4ADDR_STRLEN_MAX];
+
+  /* The static configuration of sta_netif or ap_netif: the live addresses
+   * may come from a DHCP lease and must not be persisted as static ones */
+  stage = netif_stage_get((struct netif *)param_addr);
+  if (stage == NULL) {
+      return -1;
+  }
+
+  if (strstr(param_name, "netmask") != NULL) {
+      /* Pointer to the netmask address */
+      addr_ptr = (uint8_t *)ip_2_ip4(&stage->static_addr->netmask);
+
+  } else if (strstr(param_name, "gateway") != NULL) {
+      /* Pointer to network interface's gateway address */
+      addr_ptr = (uint8_t *)ip_2_ip4(&stage->static_addr->gw);
+
+  } else if (strstr(param_name, "ip") != NULL) {
+      /* Pointer to network interface's ip address */
+      addr_ptr = (uint8_t *)ip_2_ip4(&stage->static_addr->ip_addr);
+
+  } else {
+      LOG_DEBUG("Does not support get \"%s\"\r\n", param_name);
+      return -1;
+  }
+
+  snprintf(addr_str, sizeof(addr_str), "%d.%d.%d.%d", addr_ptr[0],
+                                                      addr_ptr[1],
+                                                      addr_ptr[2],
+                                                      addr_ptr[3]);
+  return output_param_value(addr_str, out_buf, out_buf_len);
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function sets network interfaces such as ip, gateway, netmask address
+ *    through the staging & commit path
+ *
+ * @param[in]
+ *    + param_name: The name of parameter
+ *    + param_addr: The address of parameter
+ *    + param_size: The size of parameter
+ *    + new_value:  The value needs to be set
+ *
+ * @param[out] None
+ *
+ * @return
+ *    0 if sucess
+ *    -1 if failed
+ ******************************************************************************/
+static int set_network_interface(char *param_name,
+                                 void *param_addr,
+                                 uint32_t param_size,
+                                 char *new_value)
+{
+  (void)param_size;
+  ip_addr_t newIP;
+  netif_addr_field_t field;
+  struct netif *netif_ptr = NULL;
+
+  /* Pointer to sta_netif or ap_netif struct */
+  netif_ptr = (struct netif *)param_addr;
+
+  if (ipaddr_aton(new_value, &newIP) == 0) {
+      printf("Failed to convert %s (%s) to ipv4 format\r\n",
+             param_name, new_value);
+      return -1;
+  }
+
+  if (strstr(param_name, "netmask") != NULL) {
+      /* Stage the interface's netmask address */
+      field = NETIF_ADDR_NETMASK;
+
+  } else if (strstr(param_name, "gateway") != NULL) {
+      /* Stage the interface's gateway address */
+      field = NETIF_ADDR_GW;
+
+  } else if (strstr(param_name, "ip") != NULL) {
+      /* Stage the interface's IP address */
+      field = NETIF_ADDR_IP;
+
+  } else {
+      LOG_DEBUG("Does not support set \"%s\"\r\n", param_name);
+      return -1;
+  }
+
+  if (wifi_cli_netif_stage(netif_ptr, field, &newIP) < 0) {
+      return -1;
+  }
+
+  /* A configuration block commits all its addresses at once */
+  if (netif_commit_deferred) {
+      return 0;
+  }
+  return netif_stage_commit_when_valid(netif_ptr);
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function gets a 1-byte unsigned integer parameter
+ *
+ * @param[in]
+ *    + param_name: The name of parameter
+ *    + param_addr: The address of parameter
+ *    + param_size: The size of parameter
+ *
+ * @param[out]
+ *    + out_buf: The output buffer
+ *    + out_buf_len: the output buffer size
+ *
+ * @return
+ *    0 if sucess
+ *    -1 if failed
+ ******************************************************************************/
+static int get_uint8_param(char *param_name,
+                           void *param_addr,
+                           uint32_t param_size,
+                           char *out_buf,
+                           uint32_t out_buf_len)
+{
+  (void)param_name, (void)param_size;
+
+  char value_str[4];
+
+  snprintf(value_str, sizeof(value_str), "%u", *(uint8_t *)param_addr);
+  return output_param_value(value_str, out_buf, out_buf_len);
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function sets the SoftAP channel
+ *
+ * @param[in]
+ *    + param_name: The name of parameter
+ *    + param_addr: The address of parameter
+ *    + param_size: The size of parameter
+ *    + new_value:  The value needs to be set
+ *
+ * @param[out] None
+ *
+ * @return
+ *    0 if sucess
+ *    -1 if failed
+ ******************************************************************************/
+static int set_channel_param(char *param_name,
+                             void *param_addr,
+                             uint32_t param_size,
+                             char *new_value)
+{
+  (void)param_size;
+
+  char *end_ptr = NULL;
+  unsigned long channel;
+
+  channel = strtoul(new_value, &end_ptr, 10);
+  if ((end_ptr == new_value) || (*end_ptr != '\0')
+      || (channel == 0) || (channel > SOFTAP_CHANNEL_MAX)) {
+      printf("Invalid %s value (%s)\r\n", param_name, new_value);
+      return -1;
+  }
+  *(uint8_t *)param_addr = (uint8_t)channel;
+  return 0;
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function parses a DHCP state value: "1"/"on" or "0"/"off", as
+ *    typed in the CLI or rendered by get_uint8_param()
+ *
+ * @param[in]
+ *    + value: The value string
+ *
+ * @param[out]
+ *    + state: 1 for on, 0 for off
+ *
+ * @return
+ *    0 if sucess
+ *    -1 if failed
+ ******************************************************************************/
+static int parse_dhcp_state(const char *value, uint8_t *state)
+{
+  char lower[4];
+
+  if (strlen(value) >= sizeof(lower)) {
+      return -1;
+  }
+  strcpy(lower, value);
+  convert_to_lower_case_string(lower);
+
+  if ((strcmp(lower, "1") == 0) || (strcmp(lower, "on") == 0)) {
+      *state = 1;
+  } else if ((strcmp(lower, "0") == 0) || (strcmp(lower, "off") == 0)) {
+      *state = 0;
+  } else {
+      return -1;
+  }
+  return 0;
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function sets the station DHCP client state. Before the interfaces
+ *    are added, only the state is stored: netif_config() applies it.
+ *
+ * @param[in]
+ *    + param_name: The name of parameter
+ *    + param_addr: The address of parameter
+ *    + param_size: The size of parameter
+ *    + new_value:  The value needs to be set
+ *
+ * @param[out] None
+ *
+ * @return
+ *    0 if sucess
+ *    -1 if failed
+ ******************************************************************************/
+static int set_dhcp_client_state(char *param_name,
+                                 void *param_addr,
+                                 uint32_t param_size,
+                                 char *new_value)
+{
+  (void)param_size;
+
+  uint8_t new_state;
+  uint32_t time_us;
+  netif_stage_t *stage;
+
+  if (parse_dhcp_state(new_value, &new_state) < 0) {
+      printf("Invalid %s value (%s): ON or OFF\r\n", param_name, new_value);
+      return -1;
+  }
+
+  if (*(uint8_t *)param_addr == new_state) {
+      return 0;
+  }
+
+  if (!boot_trace_get(BOOT_STAGE_NETIF_UP, &time_us)) {
+      *(uint8_t *)param_addr = new_state;
+      return 0;
+  }
+
+  /** To limit undefined behaviors and ease the development
+  *   only accept a DHCP state change while the WLAN interface is down.
+  */
+  if (wifi.state & SL_WFX_STA_INTERFACE_CONNECTED) {
+      printf("Operation denied: stop WLAN first\r\n");
+      return -1;
+  }
+
+  *(uint8_t *)param_addr = new_state;
+
+  if (new_state == 0) {
+      /* Disable the DHCP requests */
+      dhcpclient_set_link_state(0);
+
+      /* Restore the static addresses. In a configuration block, the block
+       * commit applies them, with the addresses the block sets. */
+      stage = netif_stage_get(&sta_netif);
+      if (netif_commit_deferred && (stage != NULL)) {
+          if (!stage->pending) {
+              stage->staged = *stage->static_addr;
+              stage->pending = true;
+          }
+          return 0;
+      }
+      wifi_cli_netif_set_static(&sta_netif);
+  } else {
+      /* Clear the current addresses, the connect event enables the DHCP
+       * requests */
+      netifapi_netif_set_addr(&sta_netif, NULL, NULL, NULL);
+  }
+  return 0;
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function sets the SoftAP DHCP server state. The SoftAP start
+ *    configures the server when enabled.
+ *
+ * @param[in]
+ *    + param_name: The name of parameter
+ *    + param_addr: The address of parameter
+ *    + param_size: The size of parameter
+ *    + new_value:  The value needs to be set
+ *
+ * @param[out] None
+ *
+ * @return
+ *    0 if sucess
+ *    -1 if failed
+ ******************************************************************************/
+static int set_dhcp_server_state(char *param_name,
+                                 void *param_addr,
+                                 uint32_t param_size,
+                                 char *new_value)
+{
+  (void)param_size;
+
+  uint8_t new_state;
+
+  if (parse_dhcp_state(new_value, &new_state) < 0) {
+      printf("Invalid %s value (%s): ON or OFF\r\n", param_name, new_value);
+      return -1;
+  }
+
+  if (*(uint8_t *)param_addr == new_state) {
+      return 0;
+  }
+
+  /* No known issues but limit this update for consistency with the DHCP client */
+  if (wifi.state & SL_WFX_AP_INTERFACE_UP) {
+      printf("Operation denied: stop SoftAP first\r\n");
+      return -1;
+  }
+
+  *(uint8_t *)param_addr = new_state;
+  if ((new_state == 0) && dhcpserver_is_started()) {
+      dhcpserver_stop();
+  }
+  return 0;
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function gets MAC address (EUI-48 format)
+ *
+ * @param[in]
+ *    + param_name: The name of parameter
+ *    + param_addr: The address of parameter
+ *    + param_size: The size of parameter
+ *
+ * @param[out]
+ *    + out_buf: The output buffer
+ *    + out_buf_len: the output buffer size
+ *
+ * @return
+ *    0 if sucess
+ *    -1 if failed
+ ******************************************************************************/
+static int get_mac_addr(char *param_name,
+                        void *param_addr,
+                        uint32_t param_size,
+                        char *out_buf,
+                        uint32_t out_buf_len)
+{
+  (void)param_name, (void)param_size;
+
+  uint8_t *mac_ptr = (uint8_t *)param_addr;
+  char mac_str[18];
+
+  snprintf(mac_str, sizeof(mac_str), "%02X:%02X:%02X:%02X:%02X:%02X",
+           mac_ptr[0], mac_ptr[1], mac_ptr[2],
+           mac_ptr[3], mac_ptr[4], mac_ptr[5]);
+  return output_param_value(mac_str, out_buf, out_buf_len);
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function gets the station/AP pairwise master key from the Wi-Fi
+ *    chip & caches it in the parameter
+ *
+ * @param[in]
+ *    + param_name: The name of parameter
+ *    + param_addr: The address of parameter
+ *    + param_size: The size of parameter
+ *
+ * @param[out]
+ *    + out_buf: The output buffer
+ *    + out_buf_len: the output buffer size
+ *
+ * @return
+ *    0 if sucess (empty key if the interface is down)
+ *    -1 if failed
+ ******************************************************************************/
+static int get_pmk_param(char *param_name,
+                         void *param_addr,
+                         uint32_t param_size,
+                         char *out_buf,
+                         uint32_t out_buf_len)
+{
+  sl_status_t status;
+  uint32_t password_length;
+  sl_wfx_password_t pmk = {0};
+  sl_wfx_interface_t interface;
+  char *pmk_str = (char *)param_addr;
+
+  interface = (strncmp(param_name, "softap.", 7) == 0) ?
+              SL_WFX_SOFTAP_INTERFACE : SL_WFX_STA_INTERFACE;
+
+  wifi_cli_wfx_lock();
+  status = sl_wfx_get_pmk(&pmk, &password_length, interface);
+  wifi_cli_wfx_unlock();
+  if (status != SL_STATUS_OK) {
+      /* Interface down: no key */
+      return output_param_value("", out_buf, out_buf_len);
+  }
+
+  if (param_size <= password_length) {
+      LOG_DEBUG("Parameter too small (%lu/%lu)\r\n",
+                password_length, param_size);
+      return -1;
+  }
+  memcpy(pmk_str, pmk.password, password_length);
+  pmk_str[password_length] = '\0';
+  return output_param_value(pmk_str, out_buf, out_buf_len);
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function sets MAC address
+ *
+ * @param[in]
+ *    + param_name: The name of parameter
+ *    + param_addr: The address of parameter
+ *    + param_size: The size of parameter
+ *    + new_value:  The value needs to be set
+ *
+ * @param[out] None
+ *
+ * @return
+ *    0 if sucess
+ *    -1 if failed
+ ******************************************************************************/
+static int set_mac_addr(char *param_name,
+                        void *param_addr,
+                        uint32_t param_size,
+                        char *new_value)
+{
+
+  (void)param_size, (void)param_addr, (void)param_size;
+
+  int ret;
+  int param_idx;
+  netif_init_fn netif_init;
+  sl_wfx_interface_t interface;
+  sl_wfx_mac_address_t new_mac;
+  struct netif *netif_ptr = NULL;
+
+  if (strcmp(param_name, "station.mac") == 0) {
+      /* Station: search for the "sta_netif" parameter */
+      param_idx = param_search("station.ip");
+      if (param_idx < 0) {
+          LOG_DEBUG("The sta_netif parameter not registered yet\r\n");
+          goto error;
+      }
+
+      interface = SL_WFX_STA_INTERFACE;
+      netif_init = sta_ethernetif_init;
+
+  } else if (strcmp(param_name, "softap.mac") == 0) {
+      /* SoftAP: search for the "ap_netif" parameter */
+      param_idx = param_search("softap.ip");
+      if (param_idx < 0) {
+          LOG_DEBUG("The ap_netif parameter not registered yet\r\n");
+          goto error;
+      }
+
+      interface = SL_WFX_SOFTAP_INTERFACE;
+      netif_init = ap_ethernetif_init;
+
+  } else {
+      LOG_DEBUG("Does not support set \"%s\"\r\n", param_name);
+      goto error;
+  }
+
+  /* Pointer to sta_netif or ap_netif */
+  netif_ptr = (struct netif *)wifi_params[param_idx].address;
+
+  /* Convert mac_str to MAC address */
+  if (convert_str_to_mac_addr(new_value, &new_mac)) {
+      printf("Failed to convert the input string (%s) "
+             "to MAC address \r\n", new_value);
+      return -1;
+  }
+
+  /* Apply the new MAC address */
+  wifi_cli_wfx_lock();
+  ret = sl_wfx_set_mac_address(&new_mac, interface);
+  wifi_cli_wfx_unlock();
+  if (ret == 0) {
+      /** Update to the global param "wifi.mac_addr_0.octet[]"
+       *  @note This has been done in FMAC driver
+       * */
+      /*< Update the LwIP stack state */
+      netif_init(netif_ptr);
+      return 0;
+  }
+
+error:
+  printf("Failed to set %s\r\n", param_name);
+  return -1;
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function converts the Message Authentication Code
+ *    (MAC) key string to a 32-byte array.
+ *
+ * @param[in]
+ *    + mackey_str: The input string of mac key in the square brackets form
+ *    + arrSize:  The output buffer size
+ *
+ * @param[out]
+ *    + mackey_arr: The output array contains converted MAC key
+ *
+ * @return  
+ *          0 if success
+ *          -1 if failed
+ *
+ * @note    mackey_str must be expressed in the 32-byte array form of square
+ *          brackets.
+ *          E.g.: [0x42, 0x44,.., 0xB3].
+ ******************************************************************************/
+int convert_mac_key_string_to_array(char *mackey_str,
+                                    uint8_t *mackey_arr,
+                                    uint8_t arrSize)
+{
+  uint8_t i;
+  char *p_end = NULL;
+  char *p_str = mackey_str;
+  int strLen = strlen(mackey_str);
+  char *err_msg = "Format or array size error\r\n";
+
+  if ((mackey_str[0] != '[') && (mackey_str[strLen - 1] != ']')) {
+      /* mackey_str is not having opening & closing square brackets [...] */
+      goto error;
+  }
+
+  p_str++;    /*!< Skips the opening square bracket '[' */
 
   for (i = 0; i < arrSize; i++) {
       /* Convert a string to long integer, the base is determined by string. */
@@ -855,339 +1748,452 @@ error:
   return -1;
 }
 
+/* Parameter rights shorthands used by the table below */
+#define PARAM_RO  SL_WFX_CLI_PARAM_GET_RIGHT
+#define PARAM_RW  (SL_WFX_CLI_PARAM_GET_RIGHT | SL_WFX_CLI_PARAM_SET_RIGHT)
+
+/**************************************************************************//**
+ * @brief: Wi-Fi CLI's get/set parameters.
+ * @note:  X(name, backing global, size field, description, get_func, set_func,
+ *           type, rights)
+ *         The list MUST be kept sorted by name (strcmp order): param_search()
+ *         relies on it to do a binary search.
+ *****************************************************************************/
+#define WIFI_CLI_PARAMS(X)                                                     \
+  X("softap.channel", softap_channel, softap_channel,                          \
+    "SoftAP channel (decimal)",                                                \
+    get_uint8_param, set_channel_param, UNSIGNED_INTEGER, PARAM_RW)            \
+  X("softap.dhcp_server_state", use_dhcp_server, use_dhcp_server,              \
+    "SoftAP DHCP server state",                                                \
+    get_uint8_param, set_dhcp_server_state, UNSIGNED_INTEGER, PARAM_RW)        \
+  X("softap.gateway", ap_netif, ap_netif.gw,                                   \
+    "SoftAP gateway IP address (IPv4)",                                        \
+    get_network_interface, set_network_interface, CUSTOM, PARAM_RW)            \
+  X("softap.ip", ap_netif, ap_netif.ip_addr,                                   \
+    "SoftAP IP (IPv4)",                                                        \
+    get_network_interface, set_network_interface, CUSTOM, PARAM_RW)            \
+  X("softap.mac", wifi.mac_addr_1.octet, wifi.mac_addr_1.octet,                \
+    "SoftAP MAC address (EUI-48 format)",                                      \
+    get_mac_addr, set_mac_addr, CUSTOM, PARAM_RW)                              \
+  X("softap.netmask", ap_netif, ap_netif.netmask,                              \
+    "SoftAP net mask (IPv4)",                                                  \
+    get_network_interface, set_network_interface, CUSTOM, PARAM_RW)            \
+  X("softap.passkey", softap_passkey, softap_passkey,                          \
+    "Softap passkey (Max 64 bytes length)",                                    \
+    get_string_param, set_string_param, STRING, PARAM_RW)                      \
+  X("softap.pmk", softap_pmk, softap_pmk,                                      \
+    "SoftAP wlan pairwise master key",                                         \
+    get_pmk_param, NULL, CUSTOM, PARAM_RO)                                     \
+  X("softap.security", softap_security, softap_security,                       \
+    "SoftAP security mode [OPEN, WEP, WPA1/WPA2, WPA2,WPA3]",                  \
+    get_security_mode, set_security_mode, CUSTOM, PARAM_RW)                    \
+  X("softap.ssid", softap_ssid, softap_ssid,                                   \
+    "Softap ssid (Max 32 bytes length)",                                       \
+    get_string_param, set_string_param, STRING, PARAM_RW)                      \
+  X("station.dhcp_client_state", use_dhcp_client, use_dhcp_client,             \
+    "Station DHCP client state",                                               \
+    get_uint8_param, set_dhcp_client_state, INTEGER, PARAM_RW)                 \
+  X("station.gateway", sta_netif, sta_netif.gw,                                \
+    "Station gateway IP address (IPv4)",                                       \
+    get_network_interface, set_network_interface, CUSTOM, PARAM_RW)            \
+  X("station.ip", sta_netif, sta_netif.ip_addr,                                \
+    "Station IP (IPv4)",                                                       \
+    get_network_interface, set_network_interface, CUSTOM, PARAM_RW)            \
+  X("station.mac", wifi.mac_addr_0.octet, wifi.mac_addr_0.octet,               \
+    "Station wlan MAC address (EUI-48 format)",                                \
+    get_mac_addr, set_mac_addr, CUSTOM, PARAM_RW)                              \
+  X("station.netmask", sta_netif, sta_netif.netmask,                           \
+    "Station net mask (IPv4)",                                                 \
+    get_network_interface, set_network_interface, CUSTOM, PARAM_RW)            \
+  X("station.passkey", wlan_passkey, wlan_passkey,                             \
+    "wlan passkey (max 64 characters)",                                        \
+    get_string_param, set_string_param, STRING, PARAM_RW)                      \
+  X("station.pmk", wlan_pmk, wlan_pmk,                                         \
+    "Station wlan pairwise master key",                                        \
+    get_pmk_param, NULL, CUSTOM, PARAM_RO)                                     \
+  X("station.security", wlan_security, wlan_security,                          \
+    "WLAN security mode[OPEN, WEP, WPA1/WPA2, WPA2,WPA3]",                     \
+    get_security_mode, set_security_mode, CUSTOM, PARAM_RW)                    \
+  X("station.ssid", wlan_ssid, wlan_ssid,                                      \
+    "wlan ssid (max 32 characters)",                                           \
+    get_string_param, set_string_param, STRING, PARAM_RW)                      \
+  X("wifi.bus", bus_name, bus_name,                                            \
+    "bus between the WiFi chip & the host",                                    \
+    get_string_param, NULL, STRING, PARAM_RO)
+
+/* The size field must fit in its backing global and in param_t.size */
+#define WIFI_CLI_PARAM_SIZE_CHECK(param_name, var, field,                      \
+                                  desc, get, set, type, rights)                \
+  _Static_assert(sizeof(field) <= sizeof(var),                                 \
+                 param_name ": size exceeds the backing global");              \
+  _Static_assert(sizeof(field) <= UINT8_MAX,                                   \
+                 param_name ": size does not fit in param_t");
+WIFI_CLI_PARAMS(WIFI_CLI_PARAM_SIZE_CHECK)
+
+#define WIFI_CLI_PARAM_ENTRY(param_name, var, field,                           \
+                             desc, get, set, param_type, param_rights)         \
+  {                                                                            \
+    .name        = param_name,                                                 \
+    .address     = (void *)&(var),                                             \
+    .description = desc,                                                       \
+    .get_func    = get,                                                        \
+    .set_func    = set,                                                        \
+    .type        = SL_WFX_CLI_PARAM_TYPE_##param_type,                         \
+    .size        = sizeof(field),                                              \
+    .rights      = param_rights,                                               \
+  },
+
+/* Wi-Fi CLI's get/set parameter table, resident in flash */
+const param_t wifi_params[] = {
+  WIFI_CLI_PARAMS(WIFI_CLI_PARAM_ENTRY)
+};
+
+/* Number of wifi get/set parameters */
+const uint32_t wifi_params_count = sizeof(wifi_params) / sizeof(wifi_params[0]);
+
+/* Bulk dump/load buffer, shared by the commands of the CLI task */
+char wifi_cli_bulk_buf[SL_WFX_CLI_BULK_BUF_LEN];
+
+/* Bulk load working storage (the load is not reentrant) */
+static char *bulk_values[SL_WFX_CLI_MAX_BULK_PARAMS];
+static char *bulk_undo_values[SL_WFX_CLI_MAX_BULK_PARAMS];
+
+/* Characters escaped with '\' in the values of a configuration block */
+#define PARAMS_BLOCK_ESCAPED_CHARS  ";\r\n\\"
+static int bulk_param_idx[SL_WFX_CLI_MAX_BULK_PARAMS];
+
 /***************************************************************************//**
  * @brief
- *    This function registers wifi get/set parameters & corresponding processing
- *    callback functions to the global wifi_params struct array.
+ *    This function renders a readable parameter into the output buffer
+ *    (NULL-terminated), without going through the console.
  *
  * @param[in]
- *    + name: The name of parameter
- *    + address: The address of parameter
- *    + description: The parameter description
- *    + get_func: The get callback function
- *    + set_func: The set callback function
- *    + type: The type of parameter
- *    + size: The size of parameter
- *    + right: The permission to get/set
+ *    + param_name: The name of parameter
+ *    + out_buf_len: the output buffer size
  *
- * @param[out] None
+ * @param[out]
+ *    + out_buf: The output buffer
  *
  * @return
- *    0 if sucess
+ *    0 if success
  *    -1 if failed
  ******************************************************************************/
-static int sl_wfx_cli_register_wifi_param(char *name,
-                                          void *address,
-                                          char *description,
-                                          sl_wfx_cli_param_custom_get_func_t get_func,
-                                          sl_wfx_cli_param_custom_set_func_t set_func,
-                                          sl_wfx_cli_param_type_t type,
-                                          uint8_t size,
-                                          uint8_t rights)
+int wifi_cli_param_get(char *param_name, char *out_buf, uint32_t out_buf_len)
 {
-  int ret = -1;
-  param_t param = {0};
-
-  if (number_registered_params < SL_WFX_CLI_MAX_PARAMS) {
-    param.name = name;
-    param.address = address;
-    param.description = description;
-    param.size = size;
-    param.rights = rights;
-    param.type = type;
-    param.get_func = get_func;
-    param.set_func = set_func;
-
-    //if (check_validity(&param)) { // update check_validity later
-      memcpy(&wifi_params[number_registered_params], &param, sizeof(param_t));
-      number_registered_params++;
-      ret = 0;
-    //} //end of if check_validity()
+  int param_idx;
+  const param_t *param;
+
+  if ((param_name == NULL) || (out_buf == NULL)) {
+      return -1;
   }
 
-  return ret;
+  param_idx = param_search(param_name);
+  if (param_idx < 0) {
+      return -1;
+  }
+
+  param = &wifi_params[param_idx];
+  if (!(param->rights & SL_WFX_CLI_PARAM_GET_RIGHT)
+      || (param->get_func == NULL)) {
+      return -1;
+  }
+  return param->get_func(param->name,
+                         param->address,
+                         param->size,
+                         out_buf,
+                         out_buf_len);
 }
 
 /***************************************************************************//**
  * @brief
- *    This function registers all wifi param to the global wifi_param struct array
+ *    This function escapes the separators of a configuration block (';', CR,
+ *    LF) & the escape character '\' in a rendered value, in place
  *
  * @param[in]
+ *    + value_size: The size of the value buffer
  *
- * @param[out] None
+ * @param[out]
+ *    + value: The NULL-terminated value
  *
  * @return
- *    0 if success
+ *    The escaped value length if success
+ *    -1 if the escaped value doesn't fit
+ ******************************************************************************/
+static int params_escape_value(char *value, uint32_t value_size)
+{
+  uint32_t i, len, nb_escapes = 0;
+
+  for (len = 0; value[len] != '\0'; len++) {
+      if (strchr(PARAMS_BLOCK_ESCAPED_CHARS, value[len]) != NULL) {
+          nb_escapes++;
+      }
+  }
+  if (len + nb_escapes >= value_size) {
+      return -1;
+  }
+
+  /* Shift from the end, the NULL terminator included */
+  value[len + nb_escapes] = '\0';
+  for (i = len; (i > 0) && (nb_escapes > 0); i--) {
+      value[i - 1 + nb_escapes] = value[i - 1];
+      if (strchr(PARAMS_BLOCK_ESCAPED_CHARS, value[i - 1]) != NULL) {
+          nb_escapes--;
+          value[i - 1 + nb_escapes] = '\\';
+      }
+  }
+  return (int)strlen(value);
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function serializes all readable parameters into the output buffer,
+ *    one "name=value" line per parameter. The block separators in the values
+ *    are escaped with '\', so the output can be loaded back.
+ *
+ * @param[in]
+ *    + out_buf_len: the output buffer size
+ *
+ * @param[out]
+ *    + out_buf: The output buffer
+ *
+ * @return
+ *    The output length (without the NULL terminator) if success
  *    -1 if failed
  ******************************************************************************/
-int register_wifi_params(void)
+int wifi_cli_params_dump(char *out_buf, uint32_t out_buf_len)
 {
-  int ret = -1;
-
-  /* Add wifi-bus to global params struct */
-  ret = sl_wfx_cli_register_wifi_param("wifi.bus",
-                                       (void *)&bus_name[0],
-                                       "bus between the WiFi chip & the host",
-                                       get_string_param,
-                                       NULL,
-                                       SL_WFX_CLI_PARAM_TYPE_STRING,
-                                       sizeof(bus_name),
-                                       SL_WFX_CLI_PARAM_GET_RIGHT);
-
-  /* Add station ssid to global params struct */
-  ret |= sl_wfx_cli_register_wifi_param("station.ssid",
-                                        (void *)&wlan_ssid[0],
-                                        "wlan ssid (max 32 characters)",
-                                        get_string_param,
-                                        set_string_param,
-                                        SL_WFX_CLI_PARAM_TYPE_STRING,
-                                        sizeof(wlan_ssid),
-                                        SL_WFX_CLI_PARAM_GET_RIGHT | \
-                                        SL_WFX_CLI_PARAM_SET_RIGHT);
-
-  /* Add station passkey to global params struct */
-  ret |= sl_wfx_cli_register_wifi_param("station.passkey",
-                                        (void *)&wlan_passkey[0],
-                                        "wlan passkey (max 64 characters)",
-                                        get_string_param,
-                                        set_string_param,
-                                        SL_WFX_CLI_PARAM_TYPE_STRING,
-                                        sizeof(wlan_passkey),
-                                        SL_WFX_CLI_PARAM_GET_RIGHT | \
-                                        SL_WFX_CLI_PARAM_SET_RIGHT);
-
-  /* Add station security to global params struct */
-  ret |= sl_wfx_cli_register_wifi_param("station.security",
-                                        (void *)&wlan_security,
-                                        "WLAN security mode"
-                                        "[OPEN, WEP, WPA1/WPA2, WPA2,WPA3]",
-                                        get_security_mode,
-                                        set_security_mode,
-                                        SL_WFX_CLI_PARAM_TYPE_CUSTOM,
-                                        sizeof(wlan_security),
-                                        SL_WFX_CLI_PARAM_GET_RIGHT | \
-                                        SL_WFX_CLI_PARAM_SET_RIGHT);
-
-  /* Add station dhcp client state to global params struct */
-  ret |= sl_wfx_cli_register_wifi_param("station.dhcp_client_state",
-                                        (void *)&use_dhcp_client,
-                                        "Station DHCP client state",
-                                        NULL,
-                                        NULL,
-                                        SL_WFX_CLI_PARAM_TYPE_INTEGER,
-                                        sizeof(use_dhcp_client),
-                                        SL_WFX_CLI_PARAM_GET_RIGHT | \
-                                        SL_WFX_CLI_PARAM_SET_RIGHT);
-
-  /* Add station network interface to global params struct */
-  ret |= sl_wfx_cli_register_wifi_param("station.netmask",
-                                        (void *)&sta_netif,
-                                        "Station net mask (IPv4)",
-                                        get_network_interface,
-                                        set_network_interface,
-                                        SL_WFX_CLI_PARAM_TYPE_CUSTOM,
-                                        sizeof(sta_netif.netmask),
-                                        SL_WFX_CLI_PARAM_GET_RIGHT | \
-                                        SL_WFX_CLI_PARAM_SET_RIGHT);
-
-  /* Add station gateway to global params struct */
-  ret |= sl_wfx_cli_register_wifi_param("station.gateway",
-                                        (void *)&sta_netif,
-                                        "Station gateway IP address (IPv4)",
-                                        get_network_interface,
-                                        set_network_interface,
-                                        SL_WFX_CLI_PARAM_TYPE_CUSTOM,
-                                        sizeof(sta_netif.gw),
-                                        SL_WFX_CLI_PARAM_GET_RIGHT | \
-                                        SL_WFX_CLI_PARAM_SET_RIGHT);
-
-  /* Add station ip to global params struct */
-  ret |= sl_wfx_cli_register_wifi_param("station.ip",
-                                        (void *)&sta_netif,
-                                        "Station IP (IPv4)",
-                                        get_network_interface,
-                                        set_network_interface,
-                                        SL_WFX_CLI_PARAM_TYPE_CUSTOM,
-                                        sizeof(sta_netif.ip_addr),
-                                        SL_WFX_CLI_PARAM_GET_RIGHT | \
-                                        SL_WFX_CLI_PARAM_SET_RIGHT);
-
-  /* Add station pmk to global params struct */
-  ret |= sl_wfx_cli_register_wifi_param("station.pmk",
-                                        (void *)&wlan_pmk,
-                                        "Station wlan pairwise master key",
-                                        NULL,
-                                        NULL,
-                                        SL_WFX_CLI_PARAM_TYPE_CUSTOM,
-                                        sizeof(wlan_pmk),
-                                        SL_WFX_CLI_PARAM_GET_RIGHT);
-
-  /* Add station mac to global params struct */
-  ret |= sl_wfx_cli_register_wifi_param("station.mac",
-                                       (void *)&wifi.mac_addr_0.octet,
-                                       "Station wlan MAC address (EUI-48 format)",
-                                       NULL,
-                                       set_mac_addr,
-                                       SL_WFX_CLI_PARAM_TYPE_CUSTOM,
-                                       sizeof(wifi.mac_addr_0.octet),
-                                       SL_WFX_CLI_PARAM_GET_RIGHT | \
-                                       SL_WFX_CLI_PARAM_SET_RIGHT);
-
-  /** ---- Adding SoftAP wifi params to the global wifi_params struct --------*/
-  /* Add softap ssid to the global wifi_params struct */
-  ret |= sl_wfx_cli_register_wifi_param("softap.ssid",
-                                        (void *)&softap_ssid[0],
-                                        "Softap ssid (Max 32 bytes length)",
-                                        get_string_param,
-                                        set_string_param,
-                                        SL_WFX_CLI_PARAM_TYPE_STRING,
-                                        sizeof(softap_ssid),
-                                        SL_WFX_CLI_PARAM_GET_RIGHT | \
-                                        SL_WFX_CLI_PARAM_SET_RIGHT);
-
-  /* Add softap passkey to the global wifi_params struct */
-  ret |= sl_wfx_cli_register_wifi_param("softap.passkey",
-                                        (void *)&softap_passkey[0],
-                                        "Softap passkey (Max 64 bytes length)",
-                                        get_string_param,
-                                        set_string_param,
-                                        SL_WFX_CLI_PARAM_TYPE_STRING,
-                                        sizeof(softap_passkey),
-                                        SL_WFX_CLI_PARAM_GET_RIGHT | \
-                                        SL_WFX_CLI_PARAM_SET_RIGHT);
-
-  /* Add softap security to the global wifi_params struct */
-  ret |= sl_wfx_cli_register_wifi_param("softap.security",
-                                        (void *)&softap_security,
-                                        "SoftAP security mode "
-                                        "[OPEN, WEP, WPA1/WPA2, WPA2,WPA3]",
-                                        get_security_mode,
-                                        set_security_mode,
-                                        SL_WFX_CLI_PARAM_TYPE_CUSTOM,
-                                        sizeof(softap_security),
-                                        SL_WFX_CLI_PARAM_GET_RIGHT | \
-                                        SL_WFX_CLI_PARAM_SET_RIGHT);
-
-  /* Add softap channel to global params struct */
-  ret |= sl_wfx_cli_register_wifi_param("softap.channel",
-                                        (void *)&softap_channel,
-                                        "SoftAP channel (decimal)",
-                                        NULL,
-                                        NULL,
-                                        SL_WFX_CLI_PARAM_TYPE_UNSIGNED_INTEGER,
-                                        sizeof(softap_channel),
-                                        SL_WFX_CLI_PARAM_GET_RIGHT | \
-                                        SL_WFX_CLI_PARAM_SET_RIGHT);
-
-  /* Add softap network interface to global params struct */
-  ret |= sl_wfx_cli_register_wifi_param("softap.netmask",
-                                        (void *)&ap_netif,
-                                        "SoftAP net mask (IPv4)",
-                                        get_network_interface,
-                                        set_network_interface,
-                                        SL_WFX_CLI_PARAM_TYPE_CUSTOM,
-                                        sizeof(ap_netif.netmask),
-                                        SL_WFX_CLI_PARAM_GET_RIGHT | \
-                                        SL_WFX_CLI_PARAM_SET_RIGHT);
-
-  /* Add softap gateway to global params struct */
-  ret |= sl_wfx_cli_register_wifi_param("softap.gateway",
-                                        (void *)&ap_netif,
-                                        "SoftAP gateway IP address (IPv4)",
-                                        get_network_interface,
-                                        set_network_interface,
-                                        SL_WFX_CLI_PARAM_TYPE_CUSTOM,
-                                        sizeof(ap_netif.gw),
-                                        SL_WFX_CLI_PARAM_GET_RIGHT | \
-                                        SL_WFX_CLI_PARAM_SET_RIGHT);
-
-  /* Add softap ip to global params struct */
-  ret |= sl_wfx_cli_register_wifi_param("softap.ip",
-                                        (void *)&ap_netif,
-                                        "SoftAP IP (IPv4)",
-                                        get_network_interface,
-                                        set_network_interface,
-                                        SL_WFX_CLI_PARAM_TYPE_CUSTOM,
-                                        sizeof(ap_netif.ip_addr),
-                                        SL_WFX_CLI_PARAM_GET_RIGHT | \
-                                        SL_WFX_CLI_PARAM_SET_RIGHT);
-
-  /* Add Softap pmk to global params struct */
-  ret |= sl_wfx_cli_register_wifi_param("softap.pmk",
-                                        (void *)&softap_pmk,
-                                        "SoftAP wlan pairwise master key",
-                                        NULL,
-                                        NULL,
-                                        SL_WFX_CLI_PARAM_TYPE_CUSTOM,
-                                        sizeof(softap_pmk),
-                                        SL_WFX_CLI_PARAM_GET_RIGHT);
-
-  /* Add SoftAP mac to global params struct */
-  ret |= sl_wfx_cli_register_wifi_param("softap.mac",
-                                       (void *)&wifi.mac_addr_1.octet,
-                                       "SoftAP MAC address (EUI-48 format)",
-                                       NULL,
-                                       set_mac_addr,
-                                       SL_WFX_CLI_PARAM_TYPE_CUSTOM,
-                                       sizeof(wifi.mac_addr_1.octet),
-                                       SL_WFX_CLI_PARAM_GET_RIGHT | \
-                                       SL_WFX_CLI_PARAM_SET_RIGHT);
-
-  /* Add SoftAP dhcp server state to global params struct */
-  ret |= sl_wfx_cli_register_wifi_param("softap.dhcp_server_state",
-                                        (void *)&use_dhcp_server,
-                                        "SoftAP DHCP server state",
-                                        NULL,
-                                        NULL,
-                                        SL_WFX_CLI_PARAM_TYPE_UNSIGNED_INTEGER,
-                                        sizeof(use_dhcp_server),
-                                        SL_WFX_CLI_PARAM_GET_RIGHT | \
-                                        SL_WFX_CLI_PARAM_SET_RIGHT);
-  /* NOTE: Add maximum SL_WFX_CLI_MAX_PARAMS parameters to this global struct */
-
-  nvm3_readData(nvm3_defaultHandle, 
-                NVM3_KEY_AP_SSID, 
-                (void *)wlan_ssid, 
-                sizeof(wlan_ssid));
+  int ret;
+  uint32_t i;
+  uint32_t len = 0;
+  uint32_t name_len;
+  const param_t *param;
 
-  nvm3_readData(nvm3_defaultHandle, 
-                NVM3_KEY_AP_PASSKEY,
-                (void *)wlan_passkey, 
-                sizeof(wlan_passkey));
+  if ((out_buf == NULL) || (out_buf_len == 0)) {
+      return -1;
+  }
 
-  nvm3_readData(nvm3_defaultHandle, 
-                NVM3_KEY_AP_SECURITY_MODE, 
-                (void *)&wlan_security, 
-                sizeof(wlan_security));
-  return ret;
+  for (i = 0; i < wifi_params_count; i++) {
+      param = &wifi_params[i];
+      if (!(param->rights & SL_WFX_CLI_PARAM_GET_RIGHT)
+          || (param->get_func == NULL)) {
+          continue;
+      }
+
+      /* Room for "name=", an empty value, "\r\n" & the NULL terminator */
+      name_len = strlen(param->name);
+      if ((len + name_len + 4) > out_buf_len) {
+          LOG_DEBUG("Output buffer too small (%lu)", out_buf_len);
+          return -1;
+      }
+      memcpy(&out_buf[len], param->name, name_len);
+      len += name_len;
+      out_buf[len++] = '=';
+
+      /* Render the value in place, keeping room for "\r\n" */
+      ret = param->get_func(param->name,
+                            param->address,
+                            param->size,
+                            &out_buf[len],
+                            out_buf_len - len - 2);
+      if (ret < 0) {
+          LOG_DEBUG("Failed to get the %s parameter", param->name);
+          return -1;
+      }
+      ret = params_escape_value(&out_buf[len], out_buf_len - len - 2);
+      if (ret < 0) {
+          LOG_DEBUG("Output buffer too small (%lu)", out_buf_len);
+          return -1;
+      }
+      len += ret;
+      out_buf[len++] = '\r';
+      out_buf[len++] = '\n';
+  }
+  out_buf[len] = '\0';
+  return (int)len;
 }
 
 /***************************************************************************//**
  * @brief
- *    The task registers all wifi get/set parameters
+ *    This function applies a configuration block of "name=value" pairs
+ *    separated by ';', CR or LF. A '\' in a value escapes the next
+ *    character, so a value can hold a separator.
+ *    All pairs are validated before any parameter is set & the parameters
+ *    already set are restored if a set callback fails, so the configuration
+ *    is either fully applied or left unchanged. The current values are saved
+ *    behind the block, in the rest of its buffer: a block filling its buffer
+ *    is rejected.
  *
  * @param[in]
+ *    + block: The NULL-terminated configuration block (modified in place)
+ *    + block_buf_len: The size of the buffer holding the block
  *
  * @param[out] None
  *
- * @return  None
+ * @return
+ *    The number of parameters set if success
+ *    -1 if failed
  ******************************************************************************/
-static void wfx_cli_params_task(void *p_arg) {
-  RTOS_ERR err;
-  PP_UNUSED_PARAM(p_arg);
+int wifi_cli_params_load(char *block, uint32_t block_buf_len)
+{
+  int ret;
+  int i, j;
+  int nb_pairs = 0;
+  uint32_t undo_len = 0;
+  uint32_t undo_buf_len;
+  char *undo_buf;
+  char sep;
+  char *pair = NULL;
+  char *value = NULL;
+  char *p_ch = block;
+  char *p_out;
+  const param_t *param;
+
+  if (block == NULL) {
+      return -1;
+  }
+
+  /* Unescaping only shrinks the block: the end of its buffer stays free */
+  undo_buf = block + strlen(block) + 1;
+  if (undo_buf >= block + block_buf_len) {
+      return -1;
+  }
+  undo_buf_len = block_buf_len - (uint32_t)(undo_buf - block);
+
+  /* Split & validate all the pairs before setting anything */
+  while (*p_ch != '\0') {
+      /* Unescape the pair in place, up to its separator */
+      pair = p_ch;
+      p_out = p_ch;
+      while ((*p_ch != '\0') && (strchr(";\r\n", *p_ch) == NULL)) {
+          if ((*p_ch == '\\') && (p_ch[1] != '\0')) {
+              p_ch++;
+          }
+          *p_out++ = *p_ch++;
+      }
+      sep = *p_ch;
+      *p_out = '\0';
+      if (sep != '\0') {
+          p_ch++;
+      }
+      if (*pair == '\0') {
+          continue; /* Empty pair */
+      }
+
+      value = strchr(pair, '=');
+      if (value == NULL) {
+          printf("Missing value for %s\r\n", pair);
+          return -1;
+      }
+      *value++ = '\0';
+
+      ret = param_search(pair);
+      if (ret < 0) {
+          printf("Unknown parameter %s\r\n", pair);
+          return -1;
+      }
+
+      param = &wifi_params[ret];
+      if (!(param->rights & SL_WFX_CLI_PARAM_SET_RIGHT)) {
+          printf("%s is read-only\r\n", pair);
+          return -1;
+      }
+      if ((param->set_func == NULL) || (param->get_func == NULL)) {
+          printf("%s cannot be set in a configuration block\r\n", pair);
+          return -1;
+      }
+
+      for (j = 0; j < nb_pairs; j++) {
+          if (bulk_param_idx[j] == ret) {
+              printf("%s is set twice\r\n", pair);
+              return -1;
+          }
+      }
+
+      if (nb_pairs >= SL_WFX_CLI_MAX_BULK_PARAMS) {
+          printf("Too many parameters (max %d)\r\n", SL_WFX_CLI_MAX_BULK_PARAMS);
+          return -1;
+      }
+      bulk_param_idx[nb_pairs] = ret;
+      bulk_values[nb_pairs] = value;
+      nb_pairs++;
+  }
+
+  /* Save the current values to restore them on failure */
+  for (i = 0; i < nb_pairs; i++) {
+      param = &wifi_params[bulk_param_idx[i]];
+      ret = param->get_func(param->name,
+                            param->address,
+                            param->size,
+                            &undo_buf[undo_len],
+                            undo_buf_len - undo_len);
+      if (ret < 0) {
+          printf("No room left to save the current %s\r\n", param->name);
+          return -1;
+      }
+      bulk_undo_values[i] = &undo_buf[undo_len];
+      undo_len += strlen(bulk_undo_values[i]) + 1;
+  }
+
+  /* Apply the new values, network addresses are only staged */
+  netif_commit_deferred = true;
+  for (i = 0; i < nb_pairs; i++) {
+      param = &wifi_params[bulk_param_idx[i]];
+      ret = param->set_func(param->name,
+                            param->address,
+                            param->size,
+                            bulk_values[i]);
+      if (ret < 0) {
+          break;
+      }
+  }
 
-  /* Register global get/set wifi parameters */
-  if (register_wifi_params()) {
-      LOG_DEBUG("Failed to register the Wi-Fi's get/set parameters\r\n");
+  /* Validate & apply all the staged network addresses at once */
+  if ((i == nb_pairs) && (wifi_cli_netif_commit_all() == 0)) {
+      netif_commit_deferred = false;
+      for (i = 0; i < nb_pairs; i++) {
+          wifi_cli_nvm_mark_dirty(bulk_param_idx[i]);
+      }
+      return nb_pairs;
+  }
+
+  /* Roll back the parameters already set */
+  for (j = i - 1; j >= 0; j--) {
+      param = &wifi_params[bulk_param_idx[j]];
+      param->set_func(param->name,
+                      param->address,
+                      param->size,
+                      bulk_undo_values[j]);
   }
+  wifi_cli_netif_discard_all();
+  netif_commit_deferred = false;
+  return -1;
+}
 
-  /* Delete this task */
-  OSTaskDel(NULL, &err);
+/***************************************************************************//**
+ * @brief
+ *    This function tells whether a parameter is applied to the WF200, it can
+ *    only be restored once the firmware is booted
+ *
+ * @param[in]
+ *    + param: The parameter
+ *
+ * @param[out] None
+ *
+ * @return
+ *    true if the parameter needs the WF200
+ *    false otherwise
+ ******************************************************************************/
+static bool param_needs_wfx(const param_t *param)
+{
+  return param->set_func == set_mac_addr;
 }
 
 /***************************************************************************//**
  * @brief
- *    Create Wi-Fi CLI's get/set parameter initialization task
+ *    Initialize Wi-Fi CLI's get/set parameters: check the parameter table
+ *    & restore the persisted parameters from NVM3. It runs during the WF200
+ *    firmware download: the parameters applied to the WF200 are restored by
+ *    wifi_cli_params_restore_wfx().
  *
  * @param[in]
  *
@@ -1197,23 +2203,91 @@ static void wfx_cli_params_task(void *p_arg) {
  ******************************************************************************/
 void wifi_cli_params_init(void)
 {
+  uint32_t i;
+  char value_buf[BUF_LEN];
   RTOS_ERR err;
 
-  /* Create the wifi cli params registration task. */
-  OSTaskCreate(&wfx_cli_params_task_tcb,
-               "Start wifi CLI params registration task",
-               wfx_cli_params_task,
-               DEF_NULL,
-               WFX_CLI_PARAMS_TASK_PRIO,
-               &wfx_cli_params_task_stk[0],
-               (WFX_CLI_PARAMS_TASK_STK_SIZE / 10u),
-               WFX_CLI_PARAMS_TASK_STK_SIZE,
-               0u,
-               0u,
-               DEF_NULL,
-               (OS_OPT_TASK_STK_CLR),
-               &err);
-
-  /* Check err code */
+  /* Before the first WF200 request, the restore of the MAC addresses */
+  OSMutexCreate(&wfx_request_mutex, "wfx_request_mutex", &err);
   APP_RTOS_ASSERT_DBG((RTOS_ERR_CODE_GET(err) == RTOS_ERR_NONE), 1);
+
+  /* The binary search in param_search() requires a sorted table: an entry
+   * out of order would be silently unreachable */
+  for (i = 1; i < wifi_params_count; i++) {
+      if (strcmp(wifi_params[i - 1].name, wifi_params[i].name) >= 0) {
+          printf("wifi_params is not sorted at %s\r\n", wifi_params[i].name);
+          APP_RTOS_ASSERT_DBG(false, 1);
+      }
+  }
+
+  nvm3_readData(nvm3_defaultHandle,
+                NVM3_KEY_AP_SSID,
+                (void *)wlan_ssid,
+                sizeof(wlan_ssid));
+
+  nvm3_readData(nvm3_defaultHandle,
+                NVM3_KEY_AP_PASSKEY,
+                (void *)wlan_passkey,
+                sizeof(wlan_passkey));
+
+  nvm3_readData(nvm3_defaultHandle,
+                NVM3_KEY_AP_SECURITY_MODE,
+                (void *)&wlan_security,
+                sizeof(wlan_security));
+
+  /* Restore the persisted parameters through their set functions. The
+   * interfaces are not added yet: their addresses are staged on top of the
+   * static ones & become the new static addresses. */
+  for (i = 0; i < sizeof(netif_stages) / sizeof(netif_stages[0]); i++) {
+      netif_stages[i].staged = *netif_stages[i].static_addr;
+      netif_stages[i].pending = true;
+  }
+
+  netif_commit_deferred = true;
+  for (i = 0; i < wifi_params_count; i++) {
+      if (param_needs_wfx(&wifi_params[i])) {
+          continue;
+      }
+      if (wifi_cli_nvm_read(i, value_buf, sizeof(value_buf)) == 0) {
+          wifi_params[i].set_func(wifi_params[i].name,
+                                  wifi_params[i].address,
+                                  wifi_params[i].size,
+                                  value_buf);
+      }
+  }
+  netif_commit_deferred = false;
+
+  for (i = 0; i < sizeof(netif_stages) / sizeof(netif_stages[0]); i++) {
+      if (netif_stage_validate(&netif_stages[i]) == 0) {
+          *netif_stages[i].static_addr = netif_stages[i].staged;
+      }
+      netif_stages[i].pending = false;
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *    Restore the persisted parameters applied to the WF200, once its firmware
+ *    is booted & before the network interfaces are added
+ *
+ * @param[in]
+ *
+ * @param[out] None
+ *
+ * @return  None
+ ******************************************************************************/
+void wifi_cli_params_restore_wfx(void)
+{
+  uint32_t i;
+  char value_buf[BUF_LEN];
+
+  for (i = 0; i < wifi_params_count; i++) {
+      if (param_needs_wfx(&wifi_params[i])
+          && (wifi_cli_nvm_read(i, value_buf, sizeof(value_buf)) == 0)) {
+          wifi_params[i].set_func(wifi_params[i].name,
+                                  wifi_params[i].address,
+                                  wifi_params[i].size,
+                                  value_buf);
+      }
+  }
 }
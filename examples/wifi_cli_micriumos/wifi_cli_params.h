@@ -53,7 +53,9 @@
 #define SPI_BUS   "spi"
 
 #define BUF_LEN   128
-#define SL_WFX_CLI_MAX_PARAMS   30
+#define SL_WFX_CLI_BULK_BUF_LEN     1024 ///< Bulk dump/load buffer length
+#define SL_WFX_CLI_MAX_BULK_PARAMS  32   ///< Max parameters in a config block
+#define SL_WFX_CLI_MAX_NETIF_CHANGE_CB  4 ///< Max netif change callbacks
 #define SL_WFX_CLI_MAX_CLIENTS  10
 
 /* Parameter edit rights mask */
@@ -129,6 +131,7 @@
  * */
 #define SOFTAP_SECURITY_DEFAULT WFM_SECURITY_MODE_WPA2_PSK
 #define SOFTAP_CHANNEL_DEFAULT  6                  ///< wifi channel for soft ap
+#define SOFTAP_CHANNEL_MAX      14                 ///< 2.4 GHz band channels 1 to 14
 
 extern char wlan_ssid[32 + 1];
 extern char wlan_passkey[64 + 1];
@@ -141,46 +144,27 @@ extern char softap_pmk[64 + 3];
 extern uint8_t softap_channel;
 extern sl_wfx_security_mode_t softap_security;
 
-extern uint8_t sta_ip_addr0;
-extern uint8_t sta_ip_addr1;
-extern uint8_t sta_ip_addr2;
-extern uint8_t sta_ip_addr3;
-
-extern uint8_t sta_netmask_addr0;
-extern uint8_t sta_netmask_addr1;
-extern uint8_t sta_netmask_addr2;
-extern uint8_t sta_netmask_addr3;
-
-extern uint8_t sta_gw_addr0;
-extern uint8_t sta_gw_addr1;
-extern uint8_t sta_gw_addr2;
-extern uint8_t sta_gw_addr3;
-
-extern uint8_t ap_ip_addr0;
-extern uint8_t ap_ip_addr1;
-extern uint8_t ap_ip_addr2;
-extern uint8_t ap_ip_addr3;
-
-extern uint8_t ap_netmask_addr0;
-extern uint8_t ap_netmask_addr1;
-extern uint8_t ap_netmask_addr2;
-extern uint8_t ap_netmask_addr3;
+/**************************************************************************//**
+ * @brief: IPv4 addresses of a network interface
+ *****************************************************************************/
+typedef struct netif_addr_s {
+  ip_addr_t ip_addr;
+  ip_addr_t netmask;
+  ip_addr_t gw;
+} netif_addr_t;
 
-extern uint8_t ap_gw_addr0;
-extern uint8_t ap_gw_addr1;
-extern uint8_t ap_gw_addr2;
-extern uint8_t ap_gw_addr3;
+extern netif_addr_t sta_static_addr;
+extern netif_addr_t ap_static_addr;
 
 extern struct netif ap_netif;
 extern struct netif sta_netif;
 
 extern uint8_t use_dhcp_client;
 extern uint8_t use_dhcp_server;
-extern uint8_t wifi_clients[SL_WFX_CLI_MAX_CLIENTS][6];
 extern sl_wfx_rx_stats_t rx_stats;
 
-extern int number_connected_clients;
-extern char string_list[4096];
+/* Bulk dump/load buffer, shared by the commands of the CLI task */
+extern char wifi_cli_bulk_buf[SL_WFX_CLI_BULK_BUF_LEN];
 
 #ifdef __cplusplus
 extern "C" {
@@ -201,6 +185,8 @@ typedef enum {
 
 /**************************************************************************//**
  * @brief: get/set function pointers.
+ * @note:  get functions render the value (NULL-terminated) into output_buf
+ *         & never print; they return 0 on success, -1 on failure.
  *****************************************************************************/
 typedef int (*sl_wfx_cli_param_custom_get_func_t)(char *param_name,
                                                   void *param_addr,
@@ -213,6 +199,23 @@ typedef int (*sl_wfx_cli_param_custom_set_func_t)(char *param_name,
                                                   uint32_t param_size,
                                                   char *new_value);
 
+/**************************************************************************//**
+ * @brief: Network interface address fields
+ *****************************************************************************/
+typedef enum {
+  NETIF_ADDR_IP,
+  NETIF_ADDR_NETMASK,
+  NETIF_ADDR_GW
+} netif_addr_field_t;
+
+/**************************************************************************//**
+ * @brief: Network interface address change notification function pointer.
+ *         Called from the committing task, after the new addresses are applied.
+ *****************************************************************************/
+typedef void (*wifi_cli_netif_change_fn_t)(struct netif *netif,
+                                           const netif_addr_t *old_addr,
+                                           const netif_addr_t *new_addr);
+
 /**************************************************************************//**
  * @brief: wifi get/set parameters types
  *****************************************************************************/
@@ -267,11 +270,12 @@ typedef struct sem_type_s {
 extern sem_type_t g_cli_sem;
 
 /**************************************************************************//**
- * @brief: Wi-Fi CLI's the global wifi param instance used for managing all
+ * @brief: Wi-Fi CLI's the global wifi param table used for managing all
  *         get/set parameters.
- * @note:  Maximum number of elements is "SL_WFX_CLI_MAX_PARAMS"
+ * @note:  Constant table sorted by name, "wifi_params_count" elements
  *****************************************************************************/
-extern param_t wifi_params[SL_WFX_CLI_MAX_PARAMS];
+extern const param_t wifi_params[];
+extern const uint32_t wifi_params_count;
 
 /***************************************************************************//**
  * @brief
@@ -320,6 +324,62 @@ int convert_mac_key_string_to_array(char *mackey_str,
                                     uint8_t *mackey_arr,
                                     uint8_t arrLen);
 
+/**************************************************************************//**
+ * @brief: Render a parameter value into a caller-supplied buffer
+ *****************************************************************************/
+int wifi_cli_param_get(char *param_name, char *out_buf, uint32_t out_buf_len);
+
+/**************************************************************************//**
+ * @brief: Serialize all readable parameters ("name=value" lines) to a buffer
+ *****************************************************************************/
+int wifi_cli_params_dump(char *out_buf, uint32_t out_buf_len);
+
+/**************************************************************************//**
+ * @brief: Apply a "name=value" configuration block in one transaction. The
+ *         current values are saved after the block, in the rest of its
+ *         buffer.
+ *****************************************************************************/
+int wifi_cli_params_load(char *block, uint32_t block_buf_len);
+
+/**************************************************************************//**
+ * @brief: Stage a network interface address, applied by the next commit
+ *****************************************************************************/
+int wifi_cli_netif_stage(struct netif *netif,
+                         netif_addr_field_t field,
+                         const ip_addr_t *addr);
+
+/**************************************************************************//**
+ * @brief: Validate & apply the staged addresses of a network interface
+ *****************************************************************************/
+int wifi_cli_netif_commit(struct netif *netif);
+
+/**************************************************************************//**
+ * @brief: Validate all staged network interfaces then apply them
+ *****************************************************************************/
+int wifi_cli_netif_commit_all(void);
+
+/**************************************************************************//**
+ * @brief: Drop all the staged network interface addresses
+ *****************************************************************************/
+void wifi_cli_netif_discard_all(void);
+
+/**************************************************************************//**
+ * @brief: Apply the static addresses of a network interface
+ *****************************************************************************/
+int wifi_cli_netif_set_static(struct netif *netif);
+
+/**************************************************************************//**
+ * @brief: Register a network interface address change notification
+ *****************************************************************************/
+int wifi_cli_netif_register_change_cb(wifi_cli_netif_change_fn_t change_fn);
+
+/**************************************************************************//**
+ * @brief: Serialize the WF200 requests (CLI, Wi-Fi events task, metrics):
+ *         held around a request only, not while waiting for an indication
+ *****************************************************************************/
+void wifi_cli_wfx_lock(void);
+void wifi_cli_wfx_unlock(void);
+
 /**************************************************************************//**
  * @brief: Wi-Fi CLI's event-based semaphore initialization
  *****************************************************************************/
@@ -339,14 +399,15 @@ int wifi_cli_resume(sem_type_t *p_cli_sem,
                     sl_wfx_indications_ids_t sem_event_type);
 
 /**************************************************************************//**
- * @brief: Registering Wi-Fi's get/set parameters to the wifi_param array
+ * @brief: Initialize Wi-Fi CLI's get/set parameters
  *****************************************************************************/
-int register_wifi_params(void);
+void wifi_cli_params_init(void);
 
 /**************************************************************************//**
- * @brief: Create Wi-Fi CLI's get/set parameter initialization task
+ * @brief: Restore the parameters applied to the WF200 (MAC addresses), once
+ *         its firmware is booted
  *****************************************************************************/
-void wifi_cli_params_init(void);
+void wifi_cli_params_restore_wfx(void);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,524 @@
+/***************************************************************************//**
+ * @file
+ * @brief Adaptive power save policy of the station interface
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+#include <stdio.h>
+#include "os.h"
+#include "em_core.h"
+#include "sl_sleeptimer.h"
+#include "sl_wfx.h"
+#include "ethernetif.h"
+#include "app_wifi_events.h"
+#include "wifi_cli_params.h"
+#include "wifi_cli_ps_policy.h"
+
+static const char *const ps_policy_mode_names[PS_POLICY_NB_MODES] = {
+  "NONE", "ACTIVE", "FAST_PS", "DTIM_SKIP"
+};
+
+/* Thresholds & switch, written by the CLI task */
+static ps_policy_config_t ps_policy_config = {
+  PS_POLICY_PERIOD_MS_DEFAULT,
+  PS_POLICY_ACTIVE_FPS_DEFAULT,
+  PS_POLICY_IDLE_FPS_DEFAULT,
+  PS_POLICY_ACTIVE_HOLD_MS_DEFAULT,
+  PS_POLICY_IDLE_HOLD_MS_DEFAULT,
+  PS_POLICY_DTIM_SKIP_DEFAULT
+};
+static bool ps_policy_enabled;
+static bool ps_policy_restart;
+
+/* Power mode set with "wifi powermode", restored when the policy stops.
+ * Written & read with the WF200 lock held. */
+static struct {
+  uint8_t mode;                               ///< WFM_PM_MODE_*
+  uint8_t strategy;                           ///< WFM_PM_POLL_*
+  uint16_t interval;
+} ps_policy_manual = { WFM_PM_MODE_ACTIVE, WFM_PM_POLL_FAST_PS, 0 };
+
+/* Policy state, written by the Wi-Fi events task */
+static struct {
+  ps_policy_mode_t mode;
+  uint32_t mode_since_ms;
+  uint32_t mode_time_ms[PS_POLICY_NB_MODES];  ///< Time spent in the left modes
+  uint32_t transitions;
+  uint32_t errors;                            ///< Power mode requests failed
+  uint32_t rate;                              ///< Last rate, frames/s
+  uint32_t sample_ms;
+  uint32_t sample_frames;
+  uint32_t low_since_ms;                      ///< End of the last busy sample
+} ps_policy;
+
+/***************************************************************************//**
+ * @brief
+ *    This function returns the time base of the policy
+ *
+ * @param[in] None
+ *
+ * @param[out] None
+ *
+ * @return  milliseconds since boot
+ ******************************************************************************/
+static uint32_t ps_policy_get_time_ms(void)
+{
+  return (uint32_t)((sl_sleeptimer_get_tick_count64() * 1000ULL)
+                    / sl_sleeptimer_get_timer_frequency());
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function converts a delay into OS ticks, rounded up
+ *
+ * @param[in]
+ *    + ms: The delay in milliseconds
+ *
+ * @param[out] None
+ *
+ * @return  The delay in ticks, at least 1
+ ******************************************************************************/
+static uint32_t ps_policy_ms_to_ticks(uint32_t ms)
+{
+  uint32_t ticks = (ms * OSCfg_TickRate_Hz + 999u) / 1000u;
+
+  return (ticks > 0) ? ticks : 1;
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function returns the frames received & sent on the station
+ *    interface since boot
+ *
+ * @param[in] None
+ *
+ * @param[out] None
+ *
+ * @return  The frame count
+ ******************************************************************************/
+static uint32_t ps_policy_get_frames(void)
+{
+  ethernetif_stats_t stats;
+
+  ethernetif_get_stats(SL_WFX_STA_INTERFACE, &stats);
+  return stats.rx_frames + stats.tx_frames;
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function returns the name of the power mode set with
+ *    "wifi powermode"
+ *
+ * @param[in] None
+ *
+ * @param[out] None
+ *
+ * @return  The mode name
+ ******************************************************************************/
+static const char *ps_policy_manual_name(void)
+{
+  switch (ps_policy_manual.mode) {
+    case WFM_PM_MODE_ACTIVE:
+      return "ACTIVE";
+    case WFM_PM_MODE_PS:
+      return "BEACONS";
+    default:
+      return "DTIM";
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function requests a power mode to the WF200 & records the
+ *    transition
+ *
+ * @param[in]
+ *    + mode: The new mode, PS_POLICY_MODE_NONE stops the policy & restores
+ *            the mode set with "wifi powermode" if the station is still
+ *            connected
+ *    + config: The thresholds
+ *    + now: The current time
+ *
+ * @param[out] None
+ *
+ * @return
+ *    0 if succeeded
+ *    -1 if the WF200 rejected the power mode
+ ******************************************************************************/
+static int ps_policy_switch(ps_policy_mode_t mode,
+                            const ps_policy_config_t *config,
+                            uint32_t now)
+{
+  sl_status_t status = SL_STATUS_OK;
+  const char *restored = NULL;
+  CORE_DECLARE_IRQ_STATE;
+
+  /* The CLI & the metrics issue WF200 requests as well */
+  wifi_cli_wfx_lock();
+  switch (mode) {
+    case PS_POLICY_MODE_ACTIVE:
+      status = sl_wfx_set_power_mode(WFM_PM_MODE_ACTIVE, WFM_PM_POLL_FAST_PS, 0);
+      break;
+    case PS_POLICY_MODE_FAST_PS:
+      status = sl_wfx_set_power_mode(WFM_PM_MODE_PS, WFM_PM_POLL_FAST_PS, 1);
+      break;
+    case PS_POLICY_MODE_DTIM_SKIP:
+      status = sl_wfx_set_power_mode(WFM_PM_MODE_DTIM,
+                                     WFM_PM_POLL_FAST_PS,
+                                     config->dtim_skip);
+      break;
+    default:
+      /* Nothing to restore once the station is down, the SoftAP sets its
+       * own mode */
+      if ((wifi.state & SL_WFX_STA_INTERFACE_CONNECTED)
+          && !(wifi.state & SL_WFX_AP_INTERFACE_UP)) {
+          restored = ps_policy_manual_name();
+          status = sl_wfx_set_power_mode(ps_policy_manual.mode,
+                                         ps_policy_manual.strategy,
+                                         ps_policy_manual.interval);
+      }
+      break;
+  }
+  wifi_cli_wfx_unlock();
+
+  if (status != SL_STATUS_OK) {
+      ps_policy.errors++;
+      printf("PS policy: %s rejected (0x%lx)\r\n",
+             (restored != NULL) ? restored : ps_policy_mode_names[mode],
+             (unsigned long)status);
+      /* Stop anyway, the mode is left as is */
+      if (mode != PS_POLICY_MODE_NONE) {
+          return -1;
+      }
+      restored = NULL;
+  }
+
+  if (mode == PS_POLICY_MODE_NONE) {
+      printf("PS policy: %s -> stopped%s%s\r\n",
+             ps_policy_mode_names[ps_policy.mode],
+             (restored != NULL) ? ", restored " : "",
+             (restored != NULL) ? restored : "");
+  } else {
+      printf("PS policy: %s -> %s (%lu frames/s)\r\n",
+             ps_policy_mode_names[ps_policy.mode],
+             ps_policy_mode_names[mode],
+             (unsigned long)ps_policy.rate);
+  }
+
+  /* The CLI task displays the mode times */
+  CORE_ENTER_ATOMIC();
+  ps_policy.mode_time_ms[ps_policy.mode] += now - ps_policy.mode_since_ms;
+  ps_policy.mode_since_ms = now;
+  ps_policy.mode = mode;
+  ps_policy.low_since_ms = now;
+  if (mode != PS_POLICY_MODE_NONE) {
+      ps_policy.transitions++;
+  }
+  CORE_EXIT_ATOMIC();
+  return 0;
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function records the power mode set with "wifi powermode", to be
+ *    restored when the policy stops. The caller holds the WF200 lock so that
+ *    a policy stopping at the same time restores this mode, not the previous
+ *    one.
+ *
+ * @param[in]
+ *    + mode: WFM_PM_MODE_*
+ *    + strategy: WFM_PM_POLL_*
+ *    + interval: The listen interval, in beacons or DTIMs
+ *
+ * @param[out] None
+ *
+ * @return  None
+ ******************************************************************************/
+void ps_policy_set_manual_mode(uint8_t mode,
+                               uint8_t strategy,
+                               uint16_t interval)
+{
+  ps_policy_manual.mode = mode;
+  ps_policy_manual.strategy = strategy;
+  ps_policy_manual.interval = interval;
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function enables/disables the policy. The Wi-Fi events task is
+ *    woken up to start sampling or to stop.
+ *
+ * @param[in]
+ *    + enable: true to let the policy drive the power mode
+ *
+ * @param[out] None
+ *
+ * @return  None
+ ******************************************************************************/
+void ps_policy_enable(bool enable)
+{
+  RTOS_ERR err;
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_ATOMIC();
+  ps_policy_enabled = enable;
+  ps_policy_restart = true;
+  CORE_EXIT_ATOMIC();
+
+  /* The task may be waiting without a timeout, no task waiting isn't an error */
+  OSQPendAbort(&wifi_events, OS_OPT_PEND_ABORT_1, &err);
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function tells whether the policy drives the power mode
+ *
+ * @param[in] None
+ *
+ * @param[out] None
+ *
+ * @return  true if enabled
+ ******************************************************************************/
+bool ps_policy_is_enabled(void)
+{
+  return ps_policy_enabled;
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function gets the thresholds
+ *
+ * @param[in] None
+ *
+ * @param[out]
+ *    + config: The thresholds
+ *
+ * @return  None
+ ******************************************************************************/
+void ps_policy_get_config(ps_policy_config_t *config)
+{
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_ATOMIC();
+  *config = ps_policy_config;
+  CORE_EXIT_ATOMIC();
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function sets the thresholds, used from the next sample
+ *
+ * @param[in]
+ *    + config: The thresholds
+ *
+ * @param[out] None
+ *
+ * @return
+ *    0 if succeeded
+ *    -1 if a threshold is out of range or idle_fps >= active_fps
+ ******************************************************************************/
+int ps_policy_set_config(const ps_policy_config_t *config)
+{
+  CORE_DECLARE_IRQ_STATE;
+
+  if ((config->period_ms < 100) || (config->period_ms > 10000)
+      || (config->idle_fps == 0)
+      || (config->idle_fps >= config->active_fps)
+      || (config->active_fps > 100000)
+      || (config->active_hold_ms > 600000)
+      || (config->idle_hold_ms > 600000)
+      || (config->dtim_skip == 0)
+      || (config->dtim_skip > PS_POLICY_DTIM_SKIP_MAX)) {
+      return -1;
+  }
+
+  CORE_ENTER_ATOMIC();
+  ps_policy_config = *config;
+  CORE_EXIT_ATOMIC();
+  return 0;
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function restarts the policy after a link change: a new connection
+ *    starts in ACTIVE, traffic (DHCP, ARP) being expected
+ *
+ * @param[in] None
+ *
+ * @param[out] None
+ *
+ * @return  None
+ ******************************************************************************/
+void ps_policy_link_changed(void)
+{
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_ATOMIC();
+  ps_policy_restart = true;
+  CORE_EXIT_ATOMIC();
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function samples the station traffic rate once per period & moves
+ *    between the power modes. The rate steps up at once, so latency &
+ *    throughput come back with the traffic, and steps down only after the
+ *    hold times.
+ *
+ * @param[in] None
+ *
+ * @param[out] None
+ *
+ * @return  The time until the next sample in OS ticks, 0 if the policy is
+ *          stopped
+ ******************************************************************************/
+uint32_t ps_policy_poll(void)
+{
+  ps_policy_config_t config;
+  ps_policy_mode_t next;
+  uint32_t now, elapsed, frames;
+  bool enabled, restart, low;
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_ATOMIC();
+  config = ps_policy_config;
+  enabled = ps_policy_enabled;
+  restart = ps_policy_restart;
+  ps_policy_restart = false;
+  CORE_EXIT_ATOMIC();
+
+  now = ps_policy_get_time_ms();
+
+  /* The power mode only applies to the station, the SoftAP stays awake */
+  if (!enabled
+      || !(wifi.state & SL_WFX_STA_INTERFACE_CONNECTED)
+      || (wifi.state & SL_WFX_AP_INTERFACE_UP)) {
+      if (ps_policy.mode != PS_POLICY_MODE_NONE) {
+          ps_policy_switch(PS_POLICY_MODE_NONE, &config, now);
+      }
+      return 0;
+  }
+
+  if (restart || (ps_policy.mode == PS_POLICY_MODE_NONE)) {
+      ps_policy.rate = 0;
+      ps_policy.sample_ms = now;
+      ps_policy.sample_frames = ps_policy_get_frames();
+      ps_policy_switch(PS_POLICY_MODE_ACTIVE, &config, now);
+      return ps_policy_ms_to_ticks(config.period_ms);
+  }
+
+  /* Events wake the task up before the end of the period */
+  elapsed = now - ps_policy.sample_ms;
+  if (elapsed < config.period_ms) {
+      return ps_policy_ms_to_ticks(config.period_ms - elapsed);
+  }
+
+  frames = ps_policy_get_frames();
+  ps_policy.rate = (uint32_t)(((uint64_t)(frames - ps_policy.sample_frames) * 1000u)
+                              / elapsed);
+  ps_policy.sample_frames = frames;
+  ps_policy.sample_ms = now;
+
+  next = ps_policy.mode;
+  switch (ps_policy.mode) {
+    case PS_POLICY_MODE_ACTIVE:
+      /* Hysteresis: leave ACTIVE at half its entry rate */
+      low = (ps_policy.rate * 2 < config.active_fps);
+      if (low && (now - ps_policy.low_since_ms >= config.active_hold_ms)) {
+          next = PS_POLICY_MODE_FAST_PS;
+      }
+      break;
+    case PS_POLICY_MODE_FAST_PS:
+      low = (ps_policy.rate < config.idle_fps);
+      if (ps_policy.rate >= config.active_fps) {
+          next = PS_POLICY_MODE_ACTIVE;
+      } else if (low && (now - ps_policy.low_since_ms >= config.idle_hold_ms)) {
+          next = PS_POLICY_MODE_DTIM_SKIP;
+      }
+      break;
+    default:
+      low = true;
+      if (ps_policy.rate >= config.active_fps) {
+          next = PS_POLICY_MODE_ACTIVE;
+      } else if (ps_policy.rate >= config.idle_fps * 2) {
+          /* Hysteresis: leave DTIM_SKIP at twice its entry rate */
+          next = PS_POLICY_MODE_FAST_PS;
+      }
+      break;
+  }
+
+  if (next != ps_policy.mode) {
+      ps_policy_switch(next, &config, now);
+  } else if (!low) {
+      ps_policy.low_since_ms = now;
+  }
+  return ps_policy_ms_to_ticks(config.period_ms);
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function displays the policy state, thresholds & time spent in
+ *    each power mode
+ *
+ * @param[in] None
+ *
+ * @param[out] None
+ *
+ * @return  None
+ ******************************************************************************/
+void ps_policy_print(void)
+{
+  uint32_t i;
+  uint32_t now;
+  uint32_t time_ms[PS_POLICY_NB_MODES];
+  uint32_t transitions, errors, rate;
+  ps_policy_mode_t mode;
+  ps_policy_config_t config;
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_ATOMIC();
+  now = ps_policy_get_time_ms();
+  mode = ps_policy.mode;
+  for (i = 0; i < PS_POLICY_NB_MODES; i++) {
+      time_ms[i] = ps_policy.mode_time_ms[i];
+  }
+  time_ms[mode] += now - ps_policy.mode_since_ms;
+  transitions = ps_policy.transitions;
+  errors = ps_policy.errors;
+  rate = ps_policy.rate;
+  config = ps_policy_config;
+  CORE_EXIT_ATOMIC();
+
+  printf("Power save policy: %s, mode %s, %lu frames/s\r\n",
+         ps_policy_enabled ? "ON" : "OFF",
+         ps_policy_mode_names[mode],
+         (unsigned long)rate);
+  printf("ACTIVE from %lu frames/s, left below %lu frames/s for %lu ms\r\n",
+         (unsigned long)config.active_fps,
+         (unsigned long)(config.active_fps / 2),
+         (unsigned long)config.active_hold_ms);
+  printf("DTIM_SKIP (%u DTIMs) below %lu frames/s for %lu ms, period %lu ms\r\n",
+         config.dtim_skip,
+         (unsigned long)config.idle_fps,
+         (unsigned long)config.idle_hold_ms,
+         (unsigned long)config.period_ms);
+  for (i = PS_POLICY_MODE_ACTIVE; i < PS_POLICY_NB_MODES; i++) {
+      printf("%-10s %8lu.%01lu s\r\n",
+             ps_policy_mode_names[i],
+             (unsigned long)(time_ms[i] / 1000),
+             (unsigned long)((time_ms[i] % 1000) / 100));
+  }
+  printf("Transitions: %lu, errors: %lu\r\n",
+         (unsigned long)transitions,
+         (unsigned long)errors);
+}
@@ -0,0 +1,108 @@
+/***************************************************************************//**
+ * @file
+ * @brief Adaptive power save policy of the station interface
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+#ifndef WIFI_CLI_PS_POLICY_H
+#define WIFI_CLI_PS_POLICY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Power modes applied by the policy, from the most reactive */
+typedef enum {
+  PS_POLICY_MODE_NONE = 0,    ///< Station down, SoftAP up or policy off
+  PS_POLICY_MODE_ACTIVE,      ///< Always awake
+  PS_POLICY_MODE_FAST_PS,     ///< Wakes up on each beacon, Fast-PS polling
+  PS_POLICY_MODE_DTIM_SKIP,   ///< Wakes up every dtim_skip DTIMs
+  PS_POLICY_NB_MODES
+} ps_policy_mode_t;
+
+/**
+ * Thresholds of the policy, in frames per second received & sent on the
+ * station interface. A rate above active_fps switches to ACTIVE at once, the
+ * policy steps down only after the rate stayed low for a hold time:
+ *  - ACTIVE -> FAST_PS below active_fps / 2 for active_hold_ms,
+ *  - FAST_PS -> DTIM_SKIP below idle_fps for idle_hold_ms,
+ *  - DTIM_SKIP -> FAST_PS at once from 2 * idle_fps.
+ */
+typedef struct {
+  uint32_t period_ms;         ///< Rate sampling period
+  uint32_t active_fps;
+  uint32_t idle_fps;
+  uint32_t active_hold_ms;
+  uint32_t idle_hold_ms;
+  uint8_t dtim_skip;          ///< Listen interval of DTIM_SKIP, in DTIMs
+} ps_policy_config_t;
+
+#define PS_POLICY_PERIOD_MS_DEFAULT       500
+#define PS_POLICY_ACTIVE_FPS_DEFAULT      50
+#define PS_POLICY_IDLE_FPS_DEFAULT        4
+#define PS_POLICY_ACTIVE_HOLD_MS_DEFAULT  2000
+#define PS_POLICY_IDLE_HOLD_MS_DEFAULT    10000
+#define PS_POLICY_DTIM_SKIP_DEFAULT       3
+#define PS_POLICY_DTIM_SKIP_MAX           10
+
+/**************************************************************************//**
+ * @brief: Enable/disable the policy. The Wi-Fi events task applies the
+ *         change, disabling restores the mode set with "wifi powermode"
+ *         (ACTIVE if none).
+ *****************************************************************************/
+void ps_policy_enable(bool enable);
+bool ps_policy_is_enabled(void);
+
+/**************************************************************************//**
+ * @brief: Record the mode set with "wifi powermode" (CLI task, WF200 lock
+ *         held).
+ *****************************************************************************/
+void ps_policy_set_manual_mode(uint8_t mode,
+                               uint8_t strategy,
+                               uint16_t interval);
+
+/**************************************************************************//**
+ * @brief: Get/set the thresholds.
+ *
+ * @return 0 on success, -1 if the thresholds are inconsistent.
+ *****************************************************************************/
+void ps_policy_get_config(ps_policy_config_t *config);
+int ps_policy_set_config(const ps_policy_config_t *config);
+
+/**************************************************************************//**
+ * @brief: Restart the policy after a station or SoftAP link change (Wi-Fi
+ *         events task).
+ *****************************************************************************/
+void ps_policy_link_changed(void);
+
+/**************************************************************************//**
+ * @brief: Sample the traffic & switch the power mode if needed (Wi-Fi
+ *         events task, on each wake-up).
+ *
+ * @return the time until the next sample in OS ticks, 0 if none is needed.
+ *****************************************************************************/
+uint32_t ps_policy_poll(void);
+
+/**************************************************************************//**
+ * @brief: Display the policy state, thresholds & time spent in each mode.
+ *****************************************************************************/
+void ps_policy_print(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WIFI_CLI_PS_POLICY_H */
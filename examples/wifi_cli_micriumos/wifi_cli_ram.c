@@ -0,0 +1,309 @@
+/***************************************************************************//**
+ * @file
+ * @brief Task stack & RAM usage report
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "os.h"
+#include "em_core.h"
+#include "lwip/tcpip.h"
+#include "lwip/stats.h"
+#include "lwip/memp.h"
+#include "lwip/priv/memp_priv.h"
+#include "sl_wfx_host.h"
+#include "app_wifi_events.h"
+#include "wifi_cli_params.h"
+#include "wifi_cli_nvm.h"
+#include "wifi_cli_ap_clients.h"
+#include "wifi_cli_tx_latency.h"
+#include "wifi_cli_metrics.h"
+#include "lwiperf.h"
+#include "lwiperf3.h"
+#include "wifi_cli_boot.h"
+#include "wifi_cli_ram.h"
+
+/* The stack high-water marks need the kernel task list & stack checking */
+#if (OS_CFG_DBG_EN == DEF_ENABLED) && (OS_CFG_STAT_TASK_STK_CHK_EN == DEF_ENABLED)
+#define RAM_TASK_STACKS_EN  1
+#else
+#define RAM_TASK_STACKS_EN  0
+#endif
+
+/* Stacks of the short-lived tasks, measured before their deletion */
+static ram_task_stack_t ram_exited_tasks[RAM_MAX_EXITED_TASKS];
+static uint32_t ram_exited_count;
+
+/* Report working storage (the report is only displayed by the CLI task) */
+static ram_task_stack_t ram_report_stacks[RAM_REPORT_MAX_TASKS];
+
+/* Application buffers of the static RAM budget */
+static const struct {
+  const char *name;
+  uint32_t size;
+} ram_app_buffers[] = {
+  { "scan_list",      SL_WFX_MAX_SCAN_RESULTS * sizeof(scan_result_list_t) },
+  { "ap_clients",     SL_WFX_CLI_MAX_CLIENTS * sizeof(ap_client_stats_t) },
+  /* Shared dump/load buffer & the per-pair tables of the bulk load */
+  { "params bulk",    sizeof(wifi_cli_bulk_buf)
+                      + SL_WFX_CLI_MAX_BULK_PARAMS * (2 * sizeof(char *)
+                                                      + sizeof(int)) },
+  { "nvm buffers",    2 * WIFI_CLI_NVM_OBJ_MAX_LEN },
+  { "tx_latency",     TX_LATENCY_NB_INTERFACES * sizeof(tx_latency_stats_t) },
+};
+
+/* Application pools, declared with LWIP_MEMPOOL_DECLARE() */
+static const struct memp_desc *const ram_app_pools[] = {
+  &memp_LWIPERF_STATE,
+  &memp_LWIPERF3_STATE,
+  &memp_METRICS_STREAM,
+};
+
+/***************************************************************************//**
+ * @brief
+ *    This function records the stack usage of the calling task. A short-lived
+ *    task calls it right before deleting itself: its stack is not in the
+ *    kernel task list anymore once deleted.
+ *
+ * @param[in] None
+ *
+ * @param[out] None
+ *
+ * @return  None
+ ******************************************************************************/
+void ram_task_exit(void)
+{
+#if RAM_TASK_STACKS_EN
+  RTOS_ERR err;
+  CPU_STK_SIZE stk_free, stk_used;
+  ram_task_stack_t *entry;
+  CORE_DECLARE_IRQ_STATE;
+
+  OSTaskStkChk(NULL, &stk_free, &stk_used, &err);
+  if (RTOS_ERR_CODE_GET(err) != RTOS_ERR_NONE) {
+      return;
+  }
+
+  CORE_ENTER_ATOMIC();
+  if (ram_exited_count < RAM_MAX_EXITED_TASKS) {
+      entry = &ram_exited_tasks[ram_exited_count++];
+      entry->name = OSTCBCurPtr->NamePtr;
+      entry->size = (stk_free + stk_used) * sizeof(CPU_STK);
+      entry->used = stk_used * sizeof(CPU_STK);
+      entry->exited = true;
+  }
+  CORE_EXIT_ATOMIC();
+#endif
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function returns the stack usage of the running tasks, followed by
+ *    the one of the exited short-lived tasks
+ *
+ * @param[in]
+ *    + max_stacks: The output array size
+ *
+ * @param[out]
+ *    + stacks: The task stack entries
+ *
+ * @return  The number of entries written
+ ******************************************************************************/
+uint32_t ram_get_task_stacks(ram_task_stack_t *stacks, uint32_t max_stacks)
+{
+  uint32_t i, nb_stacks = 0;
+#if RAM_TASK_STACKS_EN
+  RTOS_ERR err;
+  OS_TCB *p_tcb;
+  CPU_STK_SIZE stk_free, stk_used;
+
+  /* Keep the task list stable while walking it */
+  OSSchedLock(&err);
+  for (p_tcb = OSTaskDbgListPtr;
+       (p_tcb != NULL) && (nb_stacks < max_stacks);
+       p_tcb = p_tcb->DbgNextPtr) {
+      OSTaskStkChk(p_tcb, &stk_free, &stk_used, &err);
+      if (RTOS_ERR_CODE_GET(err) != RTOS_ERR_NONE) {
+          continue;
+      }
+      stacks[nb_stacks].name = p_tcb->NamePtr;
+      stacks[nb_stacks].size = (stk_free + stk_used) * sizeof(CPU_STK);
+      stacks[nb_stacks].used = stk_used * sizeof(CPU_STK);
+      stacks[nb_stacks].exited = false;
+      nb_stacks++;
+  }
+  OSSchedUnlock(&err);
+#endif
+
+  for (i = 0; (i < ram_exited_count) && (nb_stacks < max_stacks); i++) {
+      stacks[nb_stacks++] = ram_exited_tasks[i];
+  }
+  return nb_stacks;
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function displays the task stack high-water marks
+ *
+ * @param[in] None
+ *
+ * @param[out] None
+ *
+ * @return  The total size of the stacks listed, in bytes
+ ******************************************************************************/
+static uint32_t ram_print_task_stacks(void)
+{
+  uint32_t i, nb_stacks, total = 0;
+  ram_task_stack_t *stack;
+
+  nb_stacks = ram_get_task_stacks(ram_report_stacks, RAM_REPORT_MAX_TASKS);
+  if (nb_stacks == 0) {
+      printf("Task stacks: not available (OS_CFG_DBG_EN & "
+             "OS_CFG_STAT_TASK_STK_CHK_EN needed)\r\n");
+      return 0;
+  }
+
+  printf("%-32s %7s %7s %7s %5s\r\n", "task", "size", "peak", "free", "use%");
+  for (i = 0; i < nb_stacks; i++) {
+      stack = &ram_report_stacks[i];
+      printf("%-32.32s %7lu %7lu %7lu %4lu%%%s\r\n",
+             (stack->name != NULL) ? stack->name : "?",
+             (unsigned long)stack->size,
+             (unsigned long)stack->used,
+             (unsigned long)(stack->size - stack->used),
+             (unsigned long)((stack->size > 0) ? (stack->used * 100) / stack->size : 0),
+             stack->exited ? " (exited)" : "");
+      total += stack->size;
+  }
+  return total;
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function displays the lwIP heap & pool usage peaks
+ *
+ * @param[in] None
+ *
+ * @param[out]
+ *    + pools_size: The total size of the pools, in bytes
+ *
+ * @return  None
+ ******************************************************************************/
+static void ram_print_lwip(uint32_t *pools_size)
+{
+  uint32_t i;
+  uint32_t time_us;
+#if MEM_STATS
+  struct stats_mem heap;
+#endif
+#if MEMP_STATS
+  struct stats_mem pool;
+#endif
+
+  /* The pools are static, their size is known before lwIP starts */
+  *pools_size = 0;
+  for (i = 0; i < MEMP_MAX; i++) {
+      *pools_size += (uint32_t)memp_pools[i]->size * memp_pools[i]->num;
+  }
+  for (i = 0; i < sizeof(ram_app_pools) / sizeof(ram_app_pools[0]); i++) {
+      *pools_size += (uint32_t)ram_app_pools[i]->size * ram_app_pools[i]->num;
+  }
+
+  printf("lwIP profile: %s\r\n", LWIPOPTS_PROFILE_NAME);
+
+  /* The core lock only exists once the tcpip thread runs */
+  if (!boot_trace_get(BOOT_STAGE_TCPIP_READY, &time_us)) {
+      printf("lwIP: not started\r\n");
+      return;
+  }
+
+#if MEM_STATS
+  LOCK_TCPIP_CORE();
+  heap = lwip_stats.mem;
+  UNLOCK_TCPIP_CORE();
+  printf("lwIP heap: size %lu, used %lu, peak %lu, errors %lu\r\n",
+         (unsigned long)MEM_SIZE,
+         (unsigned long)heap.used,
+         (unsigned long)heap.max,
+         (unsigned long)heap.err);
+#else
+  printf("lwIP heap: size %lu (MEM_STATS disabled)\r\n",
+         (unsigned long)MEM_SIZE);
+#endif
+
+#if MEMP_STATS
+  printf("%-16s %7s %5s %5s %5s %6s\r\n",
+         "lwIP pool", "bytes", "num", "used", "peak", "errors");
+  for (i = 0; i < MEMP_MAX; i++) {
+      LOCK_TCPIP_CORE();
+      pool = *lwip_stats.memp[i];
+      UNLOCK_TCPIP_CORE();
+      printf("%-16.16s %7lu %5u %5u %5u %6u\r\n",
+             pool.name,
+             (unsigned long)((uint32_t)memp_pools[i]->size * memp_pools[i]->num),
+             (unsigned int)memp_pools[i]->num,
+             (unsigned int)pool.used,
+             (unsigned int)pool.max,
+             (unsigned int)pool.err);
+  }
+  for (i = 0; i < sizeof(ram_app_pools) / sizeof(ram_app_pools[0]); i++) {
+      LOCK_TCPIP_CORE();
+      pool = *ram_app_pools[i]->stats;
+      UNLOCK_TCPIP_CORE();
+      printf("%-16.16s %7lu %5u %5u %5u %6u\r\n",
+             ram_app_pools[i]->desc,
+             (unsigned long)((uint32_t)ram_app_pools[i]->size * ram_app_pools[i]->num),
+             (unsigned int)ram_app_pools[i]->num,
+             (unsigned int)pool.used,
+             (unsigned int)pool.max,
+             (unsigned int)pool.err);
+  }
+#else
+  printf("lwIP pools: MEMP_STATS disabled\r\n");
+#endif
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function displays the task stack high-water marks, the lwIP heap &
+ *    pool peaks and the static RAM budget of the application
+ *
+ * @param[in] None
+ *
+ * @param[out] None
+ *
+ * @return  None
+ ******************************************************************************/
+void ram_report_print(void)
+{
+  uint32_t i;
+  uint32_t stacks_size, pools_size, total;
+
+  stacks_size = ram_print_task_stacks();
+  printf("\r\n");
+  ram_print_lwip(&pools_size);
+
+  printf("\r\n%-24s %7s\r\n", "static RAM budget", "bytes");
+  printf("%-24s %7lu\r\n", "task stacks", (unsigned long)stacks_size);
+  printf("%-24s %7lu\r\n", "lwIP heap (MEM_SIZE)", (unsigned long)MEM_SIZE);
+  printf("%-24s %7lu\r\n", "lwIP & app pools", (unsigned long)pools_size);
+  total = stacks_size + MEM_SIZE + pools_size;
+  for (i = 0; i < sizeof(ram_app_buffers) / sizeof(ram_app_buffers[0]); i++) {
+      printf("%-24s %7lu\r\n",
+             ram_app_buffers[i].name,
+             (unsigned long)ram_app_buffers[i].size);
+      total += ram_app_buffers[i].size;
+  }
+  printf("%-24s %7lu\r\n", "total", (unsigned long)total);
+}
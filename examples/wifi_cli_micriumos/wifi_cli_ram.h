@@ -0,0 +1,64 @@
+/***************************************************************************//**
+ * @file
+ * @brief Task stack & RAM usage report
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+#ifndef WIFI_CLI_RAM_H
+#define WIFI_CLI_RAM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RAM_REPORT_MAX_TASKS      24  ///< Max tasks listed in a report
+#define RAM_MAX_EXITED_TASKS       4  ///< Max short-lived tasks recorded
+
+/**
+ * Stack usage of a task. The used size is the high-water mark: the deepest
+ * the stack has been written since the task creation.
+ */
+typedef struct {
+  const char *name;
+  uint32_t size;        ///< bytes
+  uint32_t used;        ///< bytes
+  bool exited;          ///< Short-lived task, measured before its deletion
+} ram_task_stack_t;
+
+/**************************************************************************//**
+ * @brief: Record the stack usage of the calling task, to call by a
+ *         short-lived task right before it deletes itself.
+ *****************************************************************************/
+void ram_task_exit(void);
+
+/**************************************************************************//**
+ * @brief: Get the stack usage of the running tasks & the exited ones.
+ *
+ * @return the number of entries written.
+ *****************************************************************************/
+uint32_t ram_get_task_stacks(ram_task_stack_t *stacks, uint32_t max_stacks);
+
+/**************************************************************************//**
+ * @brief: Display the task stacks, lwIP heap & pool peaks and the static RAM
+ *         budget.
+ *****************************************************************************/
+void ram_report_print(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WIFI_CLI_RAM_H */
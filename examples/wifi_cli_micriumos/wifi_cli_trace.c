@@ -0,0 +1,203 @@
+/***************************************************************************//**
+ * @file
+ * @brief Hot-path event trace ring
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "em_device.h"
+#include "wifi_cli_trace.h"
+
+#if WIFI_CLI_TRACE_EN
+
+#if (WIFI_CLI_TRACE_RING_LEN & (WIFI_CLI_TRACE_RING_LEN - 1)) != 0
+#error "WIFI_CLI_TRACE_RING_LEN must be a power of 2"
+#endif
+
+/* Records of the dump, as hex lines */
+#define TRACE_DUMP_RECORDS_PER_LINE   2
+
+/* Record ring, the write index runs freely */
+static trace_record_t trace_ring[WIFI_CLI_TRACE_RING_LEN];
+static volatile uint32_t trace_head;
+static volatile bool trace_running;
+
+/***************************************************************************//**
+ * @brief
+ *    This function adds a record to the ring. Producers only reserve a slot
+ *    with an atomic increment: the trace can be called from any task or
+ *    interrupt without lock.
+ *
+ * @param[in]
+ *    + event: The event ID
+ *    + arg0, arg1: The event arguments
+ *
+ * @param[out] None
+ *
+ * @return  None
+ ******************************************************************************/
+void trace_record(uint16_t event, uint16_t arg0, uint32_t arg1)
+{
+  trace_record_t *rec;
+  uint32_t idx;
+
+  if (!trace_running) {
+      return;
+  }
+
+  idx = __atomic_fetch_add(&trace_head, 1, __ATOMIC_RELAXED);
+  rec = &trace_ring[idx & (WIFI_CLI_TRACE_RING_LEN - 1)];
+  rec->cycles = DWT->CYCCNT;
+  rec->event = event;
+  rec->arg0 = arg0;
+  rec->arg1 = arg1;
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function clears the ring & starts recording
+ *
+ * @param[in] None
+ *
+ * @param[out] None
+ *
+ * @return  0
+ ******************************************************************************/
+int trace_start(void)
+{
+  trace_running = false;
+
+  /* Enable the core cycle counter (also used by the kernel timestamps) */
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+  memset(trace_ring, 0, sizeof(trace_ring));
+  trace_head = 0;
+  trace_running = true;
+  return 0;
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function stops recording, the ring is kept
+ *
+ * @param[in] None
+ *
+ * @param[out] None
+ *
+ * @return  0
+ ******************************************************************************/
+int trace_stop(void)
+{
+  trace_running = false;
+  return 0;
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function stops recording & dumps the ring, oldest record first.
+ *    The console converts line feeds, so the binary records are written as
+ *    hex lines between a header & an end line:
+ *      TRACE <version> <record size> <records> <cycles per second> <lost>
+ *      <hex records>
+ *      TRACE END
+ *
+ * @param[in] None
+ *
+ * @param[out] None
+ *
+ * @return  0
+ ******************************************************************************/
+int trace_dump(void)
+{
+  uint32_t i, j, head, first, nb_records;
+  const uint8_t *data;
+
+  trace_running = false;
+  head = trace_head;
+  nb_records = (head < WIFI_CLI_TRACE_RING_LEN) ? head : WIFI_CLI_TRACE_RING_LEN;
+  first = head - nb_records;
+
+  printf("TRACE %u %u %lu %lu %lu\r\n",
+         WIFI_CLI_TRACE_VERSION,
+         (unsigned int)sizeof(trace_record_t),
+         (unsigned long)nb_records,
+         (unsigned long)SystemCoreClockGet(),
+         (unsigned long)(head - nb_records));
+
+  for (i = 0; i < nb_records; i++) {
+      data = (const uint8_t *)&trace_ring[(first + i) & (WIFI_CLI_TRACE_RING_LEN - 1)];
+      for (j = 0; j < sizeof(trace_record_t); j++) {
+          printf("%02x", data[j]);
+      }
+      if (((i + 1) % TRACE_DUMP_RECORDS_PER_LINE == 0) || (i + 1 == nb_records)) {
+          printf("\r\n");
+      }
+  }
+  printf("TRACE END\r\n");
+  return 0;
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function is called by lwIP (LWIP_HOOK_TCP_INPACKET_PCB) for each
+ *    TCP segment matched to a connection, it records the ACKs
+ *
+ * @param[in]
+ *    + ackno: The acknowledgment number (host order)
+ *    + flags: The TCP header flags
+ *
+ * @param[out] None
+ *
+ * @return  None
+ ******************************************************************************/
+void trace_tcp_input(unsigned long ackno, unsigned int flags)
+{
+  /* TCP_ACK */
+  if (flags & 0x10u) {
+      trace_record(TRACE_EV_TCP_ACK, (uint16_t)flags, (uint32_t)ackno);
+  }
+}
+
+#else /* WIFI_CLI_TRACE_EN */
+
+void trace_record(uint16_t event, uint16_t arg0, uint32_t arg1)
+{
+  (void)event;
+  (void)arg0;
+  (void)arg1;
+}
+
+int trace_start(void)
+{
+  return -1;
+}
+
+int trace_stop(void)
+{
+  return -1;
+}
+
+int trace_dump(void)
+{
+  return -1;
+}
+
+void trace_tcp_input(unsigned long ackno, unsigned int flags)
+{
+  (void)ackno;
+  (void)flags;
+}
+
+#endif /* WIFI_CLI_TRACE_EN */
@@ -0,0 +1,96 @@
+/***************************************************************************//**
+ * @file
+ * @brief Hot-path event trace ring
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+#ifndef WIFI_CLI_TRACE_H
+#define WIFI_CLI_TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * The trace is compiled out unless WIFI_CLI_TRACE_EN is defined to 1 (project
+ * defines): the TRACE_EVENT() calls of the hot paths then cost nothing.
+ */
+#ifndef WIFI_CLI_TRACE_EN
+#define WIFI_CLI_TRACE_EN         0
+#endif
+
+/* Number of records kept, a power of 2: the oldest records are overwritten */
+#ifndef WIFI_CLI_TRACE_RING_LEN
+#define WIFI_CLI_TRACE_RING_LEN   256
+#endif
+
+#define WIFI_CLI_TRACE_VERSION    1
+
+/* Trace event IDs, also known by tools/trace_decode.py */
+typedef enum {
+  TRACE_EV_TX_ENQUEUE = 1,    ///< Frame queued by low_level_output(), arg0: interface, arg1: length
+  TRACE_EV_TX_NO_BUFFER,      ///< No buffer to queue a frame, arg0: interface, arg1: length
+  TRACE_EV_TX_BUS_WAKE,       ///< SL_WFX_BUS_EVENT_FLAG_TX posted, arg0: interface
+  TRACE_EV_RX_DISPATCH,       ///< Frame received from the WF200, arg0: interface, arg1: length
+  TRACE_EV_TCPIP_INPUT,       ///< Frame handed to tcpip_input(), arg0: interface, arg1: lwIP error
+  TRACE_EV_TCP_ACK,           ///< TCP segment with ACK processed, arg0: TCP flags, arg1: ack number
+} trace_event_t;
+
+/* Trace record, dumped as is (little endian) */
+typedef struct {
+  uint32_t cycles;            ///< Core cycle counter
+  uint16_t event;             ///< trace_event_t
+  uint16_t arg0;
+  uint32_t arg1;
+} trace_record_t;
+
+#if WIFI_CLI_TRACE_EN
+#define TRACE_EVENT(event, arg0, arg1) \
+  trace_record((uint16_t)(event), (uint16_t)(arg0), (uint32_t)(arg1))
+#else
+#define TRACE_EVENT(event, arg0, arg1) do { } while (0)
+#endif
+
+/**************************************************************************//**
+ * @brief: Add a record to the ring (any task or interrupt, lock-free).
+ *****************************************************************************/
+void trace_record(uint16_t event, uint16_t arg0, uint32_t arg1);
+
+/**************************************************************************//**
+ * @brief: Clear the ring & start/stop recording.
+ *
+ * @return 0 on success, -1 if the trace is compiled out.
+ *****************************************************************************/
+int trace_start(void);
+int trace_stop(void);
+
+/**************************************************************************//**
+ * @brief: Stop recording & dump the ring to the console, oldest record first.
+ *
+ * @return 0 on success, -1 if the trace is compiled out.
+ *****************************************************************************/
+int trace_dump(void);
+
+/**************************************************************************//**
+ * @brief: Called by lwIP for each TCP segment matched to a connection.
+ *****************************************************************************/
+void trace_tcp_input(unsigned long ackno, unsigned int flags);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WIFI_CLI_TRACE_H */
@@ -0,0 +1,290 @@
+/***************************************************************************//**
+ * @file
+ * @brief TX frame latency from enqueue to firmware confirmation
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "em_core.h"
+#include "sl_sleeptimer.h"
+#include "wifi_cli_tx_latency.h"
+
+/* The driver numbers the data frames in the order it sends them, which is
+ * the order of the TX queue */
+#define TX_LATENCY_PACKET_ID_MASK   0xFFFFu
+
+/* Stamp of a frame between its enqueueing & its confirmation */
+typedef struct {
+  uint32_t queued_us;   ///< Enqueue time, wraps after 71 minutes
+  uint16_t seq;         ///< Queue order, on both interfaces
+  bool pending;         ///< Not confirmed nor expired yet
+} tx_stamp_t;
+
+/* Pending frames of an interface in queue order, the indexes run freely */
+typedef struct {
+  tx_stamp_t stamps[TX_LATENCY_MAX_PENDING];
+  uint32_t head;        ///< Next frame queued
+  uint32_t tail;        ///< Oldest frame pending
+} tx_stamp_ring_t;
+
+static tx_stamp_ring_t tx_stamp_rings[TX_LATENCY_NB_INTERFACES];
+static uint16_t tx_seq;             ///< Queue order of the next frame
+static uint16_t tx_seq_offset;      ///< packet_id - seq
+static bool tx_seq_synced;          ///< tx_seq_offset is known
+
+static tx_latency_stats_t tx_latency_stats[TX_LATENCY_NB_INTERFACES];
+
+/***************************************************************************//**
+ * @brief
+ *    This function returns the time base of the stamps
+ *
+ * @param[in] None
+ *
+ * @param[out] None
+ *
+ * @return  microseconds since boot
+ ******************************************************************************/
+static uint32_t tx_latency_get_time_us(void)
+{
+  return (uint32_t)((sl_sleeptimer_get_tick_count64() * 1000000ULL)
+                    / sl_sleeptimer_get_timer_frequency());
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function moves the tail of an interface past the stamps that are
+ *    no longer pending, dropping those older than the timeout or than the
+ *    ring size. Called with interrupts masked.
+ *
+ * @param[in]
+ *    + interface: The interface index
+ *    + now: The current time, in microseconds
+ *    + room: Make room for a new stamp
+ *
+ * @param[out] None
+ *
+ * @return  None
+ ******************************************************************************/
+static void tx_latency_expire(uint32_t interface, uint32_t now, bool room)
+{
+  tx_stamp_ring_t *ring = &tx_stamp_rings[interface];
+  tx_stamp_t *stamp;
+
+  while (ring->tail != ring->head) {
+      stamp = &ring->stamps[ring->tail % TX_LATENCY_MAX_PENDING];
+      if (stamp->pending) {
+          if (!(room && (ring->head - ring->tail >= TX_LATENCY_MAX_PENDING))
+              && (now - stamp->queued_us
+                  < TX_LATENCY_STAMP_TIMEOUT_MS * 1000u)) {
+              break;
+          }
+          /* Never confirmed */
+          stamp->pending = false;
+          tx_latency_stats[interface].unmatched++;
+      }
+      ring->tail++;
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function stamps a frame queued for the bus task. When too many
+ *    frames are pending, the oldest stamp is dropped.
+ *
+ * @param[in]
+ *    + interface: The frame interface (sl_wfx_interface_t)
+ *
+ * @param[out] None
+ *
+ * @return  None
+ ******************************************************************************/
+void tx_latency_frame_queued(uint8_t interface)
+{
+  uint32_t now = tx_latency_get_time_us();
+  tx_stamp_ring_t *ring;
+  tx_stamp_t *stamp;
+  CORE_DECLARE_IRQ_STATE;
+
+  interface %= TX_LATENCY_NB_INTERFACES;
+  ring = &tx_stamp_rings[interface];
+
+  CORE_ENTER_ATOMIC();
+  tx_latency_expire(interface, now, true);
+  stamp = &ring->stamps[ring->head % TX_LATENCY_MAX_PENDING];
+  stamp->queued_us = now;
+  stamp->seq = tx_seq++;
+  stamp->pending = true;
+  ring->head++;
+  CORE_EXIT_ATOMIC();
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function records the firmware confirmation of a frame. The packet
+ *    ID gives the queue order of the frame, relative to the first frame
+ *    confirmed: it is looked up among the pending frames of its interface.
+ *    A confirmation not found makes the next one resynchronize on the
+ *    oldest pending frame of its interface.
+ *
+ * @param[in]
+ *    + interface: The frame interface (sl_wfx_interface_t)
+ *    + packet_id: The packet ID of the confirmation
+ *    + status: The confirmation status
+ *
+ * @param[out] None
+ *
+ * @return  None
+ ******************************************************************************/
+void tx_latency_frame_confirmed(uint8_t interface,
+                                uint32_t packet_id,
+                                uint32_t status)
+{
+  uint32_t now = tx_latency_get_time_us();
+  tx_latency_stats_t *stats;
+  tx_stamp_ring_t *ring;
+  tx_stamp_t *stamp = NULL;
+  uint16_t seq;
+  uint32_t idx;
+  CORE_DECLARE_IRQ_STATE;
+
+  interface %= TX_LATENCY_NB_INTERFACES;
+  stats = &tx_latency_stats[interface];
+  ring = &tx_stamp_rings[interface];
+
+  CORE_ENTER_ATOMIC();
+  stats->confirmed++;
+  if (status != 0) {
+      stats->errors++;
+  }
+
+  tx_latency_expire(interface, now, false);
+  if (!tx_seq_synced && (ring->tail != ring->head)) {
+      tx_seq_offset = (uint16_t)(packet_id
+                                 - ring->stamps[ring->tail % TX_LATENCY_MAX_PENDING].seq);
+      tx_seq_synced = true;
+  }
+
+  seq = (uint16_t)((packet_id - tx_seq_offset) & TX_LATENCY_PACKET_ID_MASK);
+  for (idx = ring->tail; tx_seq_synced && (idx != ring->head); idx++) {
+      if (ring->stamps[idx % TX_LATENCY_MAX_PENDING].pending
+          && (ring->stamps[idx % TX_LATENCY_MAX_PENDING].seq == seq)) {
+          stamp = &ring->stamps[idx % TX_LATENCY_MAX_PENDING];
+          break;
+      }
+  }
+
+  if (stamp == NULL) {
+      stats->unmatched++;
+      tx_seq_synced = false;
+  } else {
+      latency_hist_record(&stats->total_delay, now - stamp->queued_us);
+      stamp->pending = false;
+      tx_latency_expire(interface, now, false);
+  }
+  CORE_EXIT_ATOMIC();
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function clears the statistics & the pending stamps
+ *
+ * @param[in] None
+ *
+ * @param[out] None
+ *
+ * @return  None
+ ******************************************************************************/
+void tx_latency_reset(void)
+{
+  uint32_t i;
+  CORE_DECLARE_IRQ_STATE;
+
+  for (i = 0; i < TX_LATENCY_NB_INTERFACES; i++) {
+      CORE_ENTER_ATOMIC();
+      while (tx_stamp_rings[i].tail != tx_stamp_rings[i].head) {
+          tx_stamp_rings[i].stamps[tx_stamp_rings[i].tail++
+                                   % TX_LATENCY_MAX_PENDING].pending = false;
+      }
+      latency_hist_reset(&tx_latency_stats[i].total_delay);
+      tx_latency_stats[i].confirmed = 0;
+      tx_latency_stats[i].errors = 0;
+      tx_latency_stats[i].unmatched = 0;
+      CORE_EXIT_ATOMIC();
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function displays a latency histogram
+ *
+ * @param[in]
+ *    + name: The histogram name
+ *    + hist: The histogram
+ *    + print_buckets: Display the histogram buckets too
+ *
+ * @param[out] None
+ *
+ * @return  None
+ ******************************************************************************/
+static void tx_latency_print_hist(const char *name,
+                                  const latency_hist_t *hist,
+                                  bool print_buckets)
+{
+  printf("  %s: %lu frames", name, (unsigned long)hist->total);
+  if (hist->total == 0) {
+      printf("\r\n");
+      return;
+  }
+  printf(", min %lu.%03lums, max %lu.%03lums, avg %lu.%03lums\r\n",
+         (unsigned long)(hist->min / 1000),
+         (unsigned long)(hist->min % 1000),
+         (unsigned long)(hist->max / 1000),
+         (unsigned long)(hist->max % 1000),
+         (unsigned long)((hist->sum / hist->total) / 1000),
+         (unsigned long)((hist->sum / hist->total) % 1000));
+  latency_hist_print_percentiles(hist);
+  if (print_buckets) {
+      latency_hist_print_buckets(hist);
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *    This function displays the statistics of both interfaces
+ *
+ * @param[in]
+ *    + print_buckets: Display the histogram buckets too
+ *
+ * @param[out] None
+ *
+ * @return  None
+ ******************************************************************************/
+void tx_latency_print(bool print_buckets)
+{
+  static const char *const interface_names[TX_LATENCY_NB_INTERFACES] = {
+    "Station", "SoftAP"
+  };
+  tx_latency_stats_t *stats;
+  uint32_t i;
+
+  for (i = 0; i < TX_LATENCY_NB_INTERFACES; i++) {
+      stats = &tx_latency_stats[i];
+      printf("%s TX: %lu confirmed, %lu errors, %lu unmatched\r\n",
+             interface_names[i],
+             (unsigned long)stats->confirmed,
+             (unsigned long)stats->errors,
+             (unsigned long)stats->unmatched);
+      tx_latency_print_hist("total", &stats->total_delay, print_buckets);
+  }
+}
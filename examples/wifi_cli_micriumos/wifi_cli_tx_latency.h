@@ -0,0 +1,74 @@
+/***************************************************************************//**
+ * @file
+ * @brief TX frame latency from enqueue to firmware confirmation
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+#ifndef WIFI_CLI_TX_LATENCY_H
+#define WIFI_CLI_TX_LATENCY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "wifi_cli_histogram.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Frames followed per interface between their enqueueing & their
+ * confirmation, power of 2 */
+#define TX_LATENCY_MAX_PENDING    32
+#define TX_LATENCY_NB_INTERFACES  2   ///< Indexed by sl_wfx_interface_t
+/* A frame not confirmed within this delay is counted as unmatched */
+#define TX_LATENCY_STAMP_TIMEOUT_MS  2000
+
+/**
+ * TX latency of an interface, in microseconds. The bus task of the WF200
+ * driver sends the frames outside of this application, so only the total
+ * delay is measured.
+ */
+typedef struct {
+  latency_hist_t total_delay;     ///< Enqueue -> firmware confirmation
+  uint32_t confirmed;             ///< Confirmations received
+  uint32_t errors;                ///< Confirmations with an error status
+  uint32_t unmatched;             ///< Frames without stamp or confirmation
+} tx_latency_stats_t;
+
+/**************************************************************************//**
+ * @brief: Stamp a frame queued for the bus task (TX queue mutex held).
+ *****************************************************************************/
+void tx_latency_frame_queued(uint8_t interface);
+
+/**************************************************************************//**
+ * @brief: Record the firmware confirmation of a frame (SL_WFX_SEND_FRAME_CNF).
+ *****************************************************************************/
+void tx_latency_frame_confirmed(uint8_t interface,
+                                uint32_t packet_id,
+                                uint32_t status);
+
+/**************************************************************************//**
+ * @brief: Clear the statistics & the pending stamps.
+ *****************************************************************************/
+void tx_latency_reset(void);
+
+/**************************************************************************//**
+ * @brief: Display the statistics of both interfaces, with the histogram
+ *         buckets if requested.
+ *****************************************************************************/
+void tx_latency_print(bool print_buckets);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WIFI_CLI_TX_LATENCY_H */